@@ -15,9 +15,9 @@
 
 
 /**
- * Numerus example main that only starts the Numerus CLI.
+ * Numerus example main that only starts the Numerus CLI, exiting with 1 when
+ * a command of the arguments fails.
  */
 int main(int argc, char **args) {
-    numerus_cli(argc, args);
-    return 0;
+    return numerus_cli(argc, args) == 0 ? 0 : 1;
 }
@@ -7,8 +7,19 @@
  * the BSD 3-clause license.
  *
  * This header allows access to all public functionality of Numerus.
+ *
+ * When the library is compiled with NUMERUS_NO_MALLOC defined, as for small
+ * targets without a heap, the functions returning heap-allocated strings and
+ * the table file are left out: use the `_into()` and `_using()` variants
+ * instead, with buffers of NUMERUS_MAX_LENGTH, NUMERUS_MAX_OVERLINED_LENGTH
+ * and NUMERUS_MAX_PRETTY_VALUE_LENGTH chars.
  */
 
+#ifndef NUMERUS_H
+#define NUMERUS_H
+
+#include <stddef.h>  /* For `size_t` */
+#include <stdint.h>  /* For `int64_t` */
 #include "numerus_error_codes.h"
 
 
@@ -19,22 +30,58 @@ extern const long   NUMERUS_MAX_LONG_NONFLOAT_VALUE;
 extern const long   NUMERUS_MIN_LONG_NONFLOAT_VALUE;
 extern const double NUMERUS_MAX_NONLONG_FLOAT_VALUE;
 extern const double NUMERUS_MIN_NONLONG_FLOAT_VALUE;
+extern const short  NUMERUS_MAX_SHORT_VALUE;
+extern const short  NUMERUS_MIN_SHORT_VALUE;
 
 
 /* Special values */
 extern const short  NUMERUS_MAX_LENGTH;
+extern const short  NUMERUS_MAX_OVERLINED_LENGTH;
+extern const short  NUMERUS_MAX_PRETTY_VALUE_LENGTH;
 extern const char  *NUMERUS_ZERO;
 
 
-/* Error code global variable */
-extern int numerus_error_code;
+/**
+ * Hooks used by the conversions to allocate the memory of the numerals they
+ * return, instead of malloc().
+ *
+ * `allocate` returns `size` bytes, char-aligned, or NULL on failure; it's
+ * called with the `context` pointer, to reach the state of the allocator.
+ */
+struct numerus_allocator {
+    void *(*allocate)(size_t size, void *context);
+    void *context;
+};
+
+
+/* Error code global variable, one per thread where the compiler allows */
+#if defined(__GNUC__)
+#define NUMERUS_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define NUMERUS_THREAD_LOCAL __declspec(thread)
+#else
+#define NUMERUS_THREAD_LOCAL
+#endif
+extern NUMERUS_THREAD_LOCAL int numerus_error_code;
 
 
 /* Conversion function from value to roman numeral */
+#ifndef NUMERUS_NO_MALLOC
 char *numerus_double_to_roman(double double_value, int *errcode);
 char *numerus_int_to_roman(long int_value, int *errcode);
 char *numerus_int_with_twelfth_to_roman(long int_part, short twelfths,
                                         int *errcode);
+#endif
+char *numerus_int_with_twelfth_to_roman_using(
+        long int_part, short twelfths,
+        const struct numerus_allocator *allocator, int *errcode);
+short numerus_double_to_roman_into(double double_value, char *roman,
+                                   int *errcode);
+short numerus_int_to_roman_into(long int_value, char *roman, int *errcode);
+short numerus_int_with_twelfth_to_roman_into(long int_part, short twelfths,
+                                             char *roman, int *errcode);
+short numerus_int_with_twelfth_to_roman_length(long int_part, short twelfths,
+                                               int *errcode);
 
 
 /* Conversion function from roman numeral to value */
@@ -44,6 +91,93 @@ long numerus_roman_to_int_part_and_twelfths(char *roman, short *twelfths,
                                             int *errcode);
 
 
+/* Conversion functions specialised for integers without underscores */
+short numerus_short_int_to_roman_into(long value, char *roman, int *errcode);
+short numerus_roman_to_short_int(char *roman, int *errcode);
+
+
+/* Conversion functions of whole blocks of values or roman numerals */
+size_t numerus_int_with_twelfth_to_roman_batch(const long *int_parts,
+                                               const short *twelfths,
+                                               size_t count, char *romans,
+                                               size_t stride, int *errcodes);
+size_t numerus_roman_to_int_part_and_twelfths_batch(char *romans, size_t stride,
+                                                    size_t count,
+                                                    long *int_parts,
+                                                    short *twelfths,
+                                                    int *errcodes);
+size_t numerus_int_with_twelfth_to_roman_batch_lengths(const long *int_parts,
+                                                       const short *twelfths,
+                                                       size_t count,
+                                                       size_t *lengths,
+                                                       int *errcodes);
+size_t numerus_int_with_twelfth_to_roman_batch_packed(const long *int_parts,
+                                                      const short *twelfths,
+                                                      size_t count,
+                                                      char *romans,
+                                                      const size_t *offsets,
+                                                      int *errcodes);
+
+
+/* Iteration over arithmetic sequences of roman numerals */
+#define NUMERUS_ITER_GROUPS 9
+
+/**
+ * State of an iterator over the numerals of a sequence of values, see
+ * numerus_iter_init(). The `roman` field holds the numeral of the last value
+ * returned by numerus_iter_next(); the other fields are private.
+ */
+struct numerus_iter {
+    char roman[37];  /* NUMERUS_MAX_LENGTH chars */
+    short length;
+    short started;
+    short exhausted;
+    long value;
+    long step;
+    unsigned char keys[NUMERUS_ITER_GROUPS];
+    unsigned char group_starts[NUMERUS_ITER_GROUPS];
+};
+
+void numerus_iter_init(struct numerus_iter *iter, long int_part,
+                       short twelfths, long step_twelfths, int *errcode);
+short numerus_iter_next(struct numerus_iter *iter, char *roman, int *errcode);
+size_t numerus_iter_batch(struct numerus_iter *iter, size_t count,
+                          char *romans, size_t stride, short *lengths);
+
+
+/* Enumeration of all the roman numerals */
+#define NUMERUS_ENUM_SHORT 0x01
+#define NUMERUS_ENUM_LONG 0x02
+#define NUMERUS_ENUM_FLOAT 0x04
+#define NUMERUS_ENUM_POSITIVE 0x08
+#define NUMERUS_ENUM_NEGATIVE 0x10
+#define NUMERUS_ENUM_ALL 0x1F
+#define NUMERUS_ENUM_BY_VALUE 0
+#define NUMERUS_ENUM_BY_LENGTH 1
+
+/**
+ * Numerals listed by numerus_enumerate(): the ones of the NUMERUS_ENUM_*
+ * kinds, with length and integer part within the given ranges, inclusive.
+ */
+struct numerus_enum_filter {
+    int kinds;
+    short min_length;
+    short max_length;
+    long min_int_part;
+    long max_int_part;
+};
+
+typedef int (*numerus_enum_callback)(const char *roman, short length,
+                                     long int_part, short twelfths,
+                                     void *context);
+void numerus_enum_filter_init(struct numerus_enum_filter *filter, int kinds);
+size_t numerus_enumerate(const struct numerus_enum_filter *filter, int order,
+                         numerus_enum_callback callback, void *context);
+size_t numerus_enumerate_into(const struct numerus_enum_filter *filter,
+                              int order, char *romans, size_t capacity,
+                              size_t *used);
+
+
 /* Functions to manage twelfths */
 double numerus_parts_to_double(long int_part, short twelfths);
 long numerus_double_to_parts(double value, short *twelfths);
@@ -61,11 +195,183 @@ short numerus_compare_value(char *roman_bigger, char *roman_smaller,
 
 
 /* Output formatting functions */
+#ifndef NUMERUS_NO_MALLOC
 char *numerus_overline_long_numerals(char *roman, int *errcode);
 char *numerus_create_pretty_value_as_double(double double_value);
 char *numerus_create_pretty_value_as_parts(long int_part, short twelfths);
+#endif
+short numerus_overline_long_numerals_into(char *roman, char *pretty_roman,
+                                          int *errcode);
+short numerus_pretty_value_as_double_into(double double_value,
+                                          char *pretty_value);
+short numerus_pretty_value_as_parts_into(long int_part, short twelfths,
+                                         char *pretty_value);
 const char *numerus_explain_error(int error_code);
 
 
+/* Conversions through the memory-mapped table file */
+#ifndef NUMERUS_NO_MALLOC
+struct numerus_table;
+int numerus_write_table_file(const char *path);
+struct numerus_table *numerus_open_table_file(const char *path, int *errcode);
+void numerus_close_table_file(struct numerus_table *table);
+short numerus_table_int_with_twelfth_to_roman_into(
+        const struct numerus_table *table, long int_part, short twelfths,
+        char *roman, int *errcode);
+long numerus_table_roman_to_int_part_and_twelfths(
+        const struct numerus_table *table, char *roman, short *twelfths,
+        int *errcode);
+
+
+/* Compact columnar files of values of numerals */
+#define NUMERUS_PACK_BLOCK_VALUES 4096
+struct numerus_pack_writer;
+struct numerus_pack;
+
+/**
+ * Statistics of a block of a packed file, from its directory: number of
+ * values, min and max value and bits per packed value.
+ */
+struct numerus_pack_block_info {
+    size_t count;
+    long min_int_part;
+    short min_twelfths;
+    long max_int_part;
+    short max_twelfths;
+    short bits;
+};
+
+struct numerus_pack_writer *numerus_pack_writer_open(const char *path,
+                                                     int *errcode);
+int numerus_pack_writer_append(struct numerus_pack_writer *writer,
+                               long int_part, short twelfths);
+int numerus_pack_writer_close(struct numerus_pack_writer *writer);
+struct numerus_pack *numerus_pack_open(const char *path, int *errcode);
+void numerus_pack_close(struct numerus_pack *pack);
+size_t numerus_pack_value_count(const struct numerus_pack *pack);
+size_t numerus_pack_block_count(const struct numerus_pack *pack);
+int numerus_pack_block_info(const struct numerus_pack *pack, size_t block,
+                            struct numerus_pack_block_info *info);
+size_t numerus_pack_decode_block(const struct numerus_pack *pack,
+                                 size_t block, long *int_parts,
+                                 short *twelfths);
+size_t numerus_pack_decode_block_romans(const struct numerus_pack *pack,
+                                        size_t block, char *romans,
+                                        size_t stride, short *lengths);
+#endif
+
+
+/* Conversions of the extended range with nested overlines */
+extern const short   NUMERUS_EXT_MAX_LEVELS;
+extern const int64_t NUMERUS_EXT_MAX_VALUE;
+extern const int64_t NUMERUS_EXT_MIN_VALUE;
+extern const short   NUMERUS_EXT_MAX_LENGTH;
+extern const short   NUMERUS_EXT_MAX_STYLED_LENGTH;
+short numerus_ext_max_length(short levels);
+short numerus_ext_int_with_twelfth_to_roman_into(int64_t int_part,
+                                                 short twelfths, char *roman,
+                                                 int *errcode);
+short numerus_ext_int_to_roman_into(int64_t int_value, char *roman,
+                                    int *errcode);
+int64_t numerus_ext_roman_to_int_part_and_twelfths(char *roman,
+                                                   short *twelfths,
+                                                   int *errcode);
+short numerus_ext_overline_into(char *roman, char *styled, int *errcode);
+
+
+/* Suggestions of valid numerals close to malformed ones */
+#define NUMERUS_SUGGEST_MAX_EDITS 8
+#define NUMERUS_SUGGEST_EDIT_COST 2
+#define NUMERUS_SUGGEST_CONFUSABLE_COST 1
+
+/**
+ * Valid numeral suggested by numerus_suggest(), with its value and its cost,
+ * in half edits: NUMERUS_SUGGEST_EDIT_COST per edit.
+ */
+struct numerus_suggestion {
+    char roman[37];  /* NUMERUS_MAX_LENGTH chars */
+    long int_part;
+    short twelfths;
+    short cost;
+};
+
+size_t numerus_suggest(const char *bad, short max_edits,
+                       struct numerus_suggestion *out, size_t n,
+                       int *errcode);
+
+
+/* Completion of prefixes of numerals */
+size_t numerus_complete(const char *prefix, char *completions, size_t n);
+short numerus_prefix_value_range(const char *prefix, double *min_value,
+                                 double *max_value);
+
+
+/* Workloads of numerals with the distributions of real traffic */
+#define NUMERUS_WORKLOAD_UNIFORM 0
+#define NUMERUS_WORKLOAD_ZIPF 1
+#define NUMERUS_WORKLOAD_SHORT 0
+#define NUMERUS_WORKLOAD_LONG 1
+#define NUMERUS_WORKLOAD_FLOAT 2
+#define NUMERUS_WORKLOAD_KINDS 3
+#define NUMERUS_WORKLOAD_ERRORS 16  /* Codes from NUMERUS_ERROR_GENERIC */
+#define NUMERUS_WORKLOAD_MAX_LENGTH 64
+
+/**
+ * Mix of the numerals of a workload, see numerus_workload_generate().
+ *
+ * The kind of each numeral is drawn by `kind_weights` and its value within
+ * the range of the kind by `distribution`: with NUMERUS_WORKLOAD_ZIPF, the
+ * value r - 1 below `zipf_center` has a frequency proportional to
+ * `1 / r^zipf_exponent`. The rates are probabilities within [0, 1]; the
+ * rate of the error code `code` is `error_rates[code - NUMERUS_ERROR_GENERIC]`.
+ */
+struct numerus_workload {
+    uint64_t seed;
+    int distribution;
+    double zipf_exponent;
+    long zipf_center;
+    double kind_weights[NUMERUS_WORKLOAD_KINDS];
+    double negative_rate;
+    double error_rates[NUMERUS_WORKLOAD_ERRORS];
+    double lowercase_rate;
+    double mixed_case_rate;
+    double whitespace_rate;
+};
+
+void numerus_workload_uniform(struct numerus_workload *workload,
+                              uint64_t seed);
+void numerus_workload_production(struct numerus_workload *workload,
+                                 uint64_t seed);
+int numerus_workload_check(const struct numerus_workload *workload);
+size_t numerus_workload_generate(const struct numerus_workload *workload,
+                                 size_t first, size_t count, char *romans,
+                                 size_t stride, long *int_parts,
+                                 short *twelfths, int *errcodes);
+#ifndef NUMERUS_NO_MALLOC
+int numerus_workload_write_files(const struct numerus_workload *workload,
+                                 size_t count, const char *romans_path,
+                                 const char *expected_path);
+#endif
+
+
+/* Formatting of dates and times */
+struct tm;
+short numerus_format_date(const struct tm *date, const char *pattern,
+                          char *formatted, size_t size, int *errcode);
+short numerus_format_epoch(int64_t epoch_seconds, const char *pattern,
+                           char *formatted, size_t size, int *errcode);
+
+
+/* Runtime selection of the SIMD kernels */
+#define NUMERUS_SIMD_SCALAR 0
+#define NUMERUS_SIMD_SSE41 1
+#define NUMERUS_SIMD_AVX2 2
+#define NUMERUS_SIMD_AVX512 3
+int numerus_simd_level(void);
+int numerus_set_simd_level(int level);
+
+
 /* Command line interface */
 int numerus_cli(int argc, char **args);
+
+#endif /* NUMERUS_H */
@@ -0,0 +1,1489 @@
+/**
+ * @file numerus.hpp
+ * @brief Numerus roman numerals library C++ header
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This header allows access to all public functionality of Numerus from C++
+ * and adds header-only `constexpr` versions of the conversion functions, so
+ * that numerals known at compile time cost nothing at runtime. Requires C++17.
+ *
+ * The `constexpr` conversions follow the same grammar, rules and error codes
+ * of the C library functions with the same name, but never touch the global
+ * `numerus_error_code` variable and never allocate: numerals are returned in
+ * a fixed-capacity character array.
+ */
+
+#ifndef NUMERUS_HPP
+#define NUMERUS_HPP
+
+#include <cstddef>      /* For `std::size_t` */
+#include <functional>   /* For `std::hash` */
+#include <stdexcept>    /* For `std::invalid_argument` */
+#include <string_view>  /* For `std::string_view` */
+#include <type_traits>  /* For `std::is_integral_v` */
+
+extern "C" {
+#include "numerus.h"
+}
+
+
+/**
+ * @internal
+ * Specifier for functions that have to be evaluated at compile time.
+ *
+ * With C++20 the roman numerals literal is `consteval`, so an invalid numeral
+ * is always a compilation error. With C++17 it is `constexpr`: invalid
+ * numerals are a compilation error when the literal is used in a constant
+ * expression, otherwise `std::invalid_argument` is thrown at runtime.
+ */
+#if defined(__cpp_consteval)
+#define NUMERUS_CONSTEVAL consteval
+#else
+#define NUMERUS_CONSTEVAL constexpr
+#endif
+
+
+namespace numerus {
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-+-{   CONSTANTS   }-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Compile-time copy of NUMERUS_MAX_LONG_NONFLOAT_VALUE.
+ */
+constexpr long max_long_nonfloat_value = 3999999;
+
+
+/**
+ * Compile-time copy of NUMERUS_MIN_LONG_NONFLOAT_VALUE.
+ */
+constexpr long min_long_nonfloat_value = -max_long_nonfloat_value;
+
+
+/**
+ * Compile-time copy of NUMERUS_MAX_VALUE.
+ */
+constexpr double max_value = max_long_nonfloat_value + 11.5 / 12.0;
+
+
+/**
+ * Compile-time copy of NUMERUS_MIN_VALUE.
+ */
+constexpr double min_value = -max_value;
+
+
+/**
+ * Compile-time copy of NUMERUS_MAX_NONLONG_FLOAT_VALUE.
+ */
+constexpr double max_nonlong_float_value = 3999 + 11.5 / 12.0;
+
+
+/**
+ * Compile-time copy of NUMERUS_MIN_NONLONG_FLOAT_VALUE.
+ */
+constexpr double min_nonlong_float_value = -max_nonlong_float_value;
+
+
+/**
+ * Compile-time copy of NUMERUS_MAX_LENGTH, including '\0'.
+ */
+constexpr short max_length = 37;
+
+
+/**
+ * The maximum length a numeral of any variant of the grammar may have,
+ * including '\0': additive numerals are longer than the standard ones.
+ *
+ * @see numerus::grammar, numerus::fixed_roman_of
+ */
+constexpr short max_grammar_length = 43;
+
+
+/**
+ * Compile-time copy of NUMERUS_ZERO.
+ */
+constexpr std::string_view zero = "NULLA";
+
+
+
+/*  -+-+-+-+-+-+-+-+-{   VARIABLES and DATA STRUCTURES   }-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Roman numeral stored in a fixed-capacity character array of Capacity
+ * chars, null-terminated.
+ *
+ * Returned by the `constexpr` value to roman numeral conversions, with the
+ * capacity of the longest numeral of their grammar, so the numerals of the
+ * C library grammar take NUMERUS_MAX_LENGTH chars and only the longer
+ * additive ones more. An empty numeral is returned when the conversion
+ * fails.
+ *
+ * @see numerus::fixed_roman, numerus::fixed_roman_of
+ */
+template<short Capacity>
+struct basic_fixed_roman {
+    char chars[Capacity] = {};
+    short length = 0;
+
+    constexpr const char *c_str() const {
+        return chars;
+    }
+
+    constexpr std::size_t size() const {
+        return static_cast<std::size_t>(length);
+    }
+
+    constexpr bool empty() const {
+        return length == 0;
+    }
+
+    constexpr std::string_view view() const {
+        return std::string_view(chars, size());
+    }
+
+    constexpr operator std::string_view() const {
+        return view();
+    }
+};
+
+
+template<short Capacity>
+constexpr bool operator==(const basic_fixed_roman<Capacity> &roman,
+                          std::string_view other) {
+    return roman.view() == other;
+}
+
+template<short Capacity>
+constexpr bool operator!=(const basic_fixed_roman<Capacity> &roman,
+                          std::string_view other) {
+    return roman.view() != other;
+}
+
+
+/**
+ * Roman numeral of the grammar of the C library, of NUMERUS_MAX_LENGTH
+ * chars.
+ */
+using fixed_roman = basic_fixed_roman<max_length>;
+
+
+/**
+ * Exception thrown by the C++ API when a conversion fails, carrying the
+ * NUMERUS_ERROR_* error code.
+ *
+ * The message is the one of numerus_explain_error().
+ */
+class error : public std::invalid_argument {
+public:
+    explicit error(int error_code)
+            : std::invalid_argument(numerus_explain_error(error_code)),
+              error_code(error_code) {
+    }
+
+    int code() const noexcept {
+        return error_code;
+    }
+
+private:
+    int error_code;
+};
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * Compile-time copy of the _num_dictionary_char struct.
+ */
+struct dictionary_char {
+    int value;
+    const char *characters;
+    short max_repetitions;
+};
+
+
+} /* namespace detail */
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-+-{   GRAMMARS   }-+-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Compile-time description of a variant of the roman numerals grammar.
+ *
+ * The `constexpr` conversions take the grammar as template argument, so each
+ * variant is a separate instance of the parser and of the encoder with its
+ * rules folded in at compile time: no mode flag is checked per character and
+ * strict and lenient variants can be used in the same program.
+ *
+ * The grammar is the dictionary walked by the conversions, with the same
+ * indices of _NUM_DICTIONARY, built from these rules:
+ *
+ * @tparam MaxRepetitions how many times "I", "X" and "C" may be repeated: 3
+ * as in "III", or 4 to accept "IIII", "XXXX" and "CCCC".
+ * @tparam SubtractiveFours whether 4, 40 and 400 may be "IV", "XL" and "CD".
+ * If false, they must be written with MaxRepetitions 4 as "IIII", "XXXX"
+ * and "CCCC", which are then also what the encoder writes.
+ * @tparam SubtractiveNines whether 9, 90 and 900 may be "IX", "XC" and "CM".
+ * If false, they must be written as "VIIII", "LXXXX" and "DCCCC".
+ * @tparam Twelfths whether the numerals may have the twelfths "S" and ".".
+ * If false, those chars result in NUMERUS_ERROR_ILLEGAL_CHARACTER and values
+ * with twelfths in NUMERUS_ERROR_VALUE_OUT_OF_RANGE.
+ * @tparam AdditiveNines whether 9, 90 and 900 may be "VIIII", "LXXXX" and
+ * "DCCCC", that is whether "I", "X" and "C" may be repeated 4 times after
+ * "V", "L" and "D". By default only when SubtractiveNines is false, so a
+ * grammar with "IX" rejects "VIIII" with NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE
+ * and each value has a single accepted numeral.
+ */
+template<short MaxRepetitions, bool SubtractiveFours, bool SubtractiveNines,
+         bool Twelfths, bool AdditiveNines = !SubtractiveNines>
+struct grammar {
+    static_assert(MaxRepetitions == 3 || MaxRepetitions == 4,
+                  "Roman chars may be repeated 3 or 4 times.");
+    static_assert(MaxRepetitions == 4
+                  || (SubtractiveFours && SubtractiveNines),
+                  "Additive fours and nines need 4 repetitions.");
+    static_assert(SubtractiveNines || AdditiveNines,
+                  "Nines must be either subtractive or additive.");
+    static_assert(MaxRepetitions == 4 || !AdditiveNines,
+                  "Additive nines need 4 repetitions.");
+
+    static constexpr short max_repetitions = MaxRepetitions;
+    static constexpr bool has_twelfths = Twelfths;
+    static constexpr bool has_additive_nines = AdditiveNines;
+
+    /**
+     * The maximum length a numeral may have, including '\0': minus,
+     * underscores, "MMM", three decades of up to MaxRepetitions + 1 chars
+     * twice and the twelfths "S.....".
+     */
+    static constexpr short max_length = 1 + 2 + 3 + 6 * (MaxRepetitions + 1)
+                                        + 6 + 1;
+    static_assert(max_length <= max_grammar_length, "");
+
+    /**
+     * The dictionary of the grammar. Disabled subtractive pairs have an empty
+     * pattern, so they never match and are never written.
+     */
+    static constexpr detail::dictionary_char dictionary[] = {
+        { 1000, "M" ,  3 }, // index: 0
+        {  900, SubtractiveNines ? "CM" : "",  1 }, // index: 1
+        {  500, "D" ,  1 }, // index: 2
+        {  400, SubtractiveFours ? "CD" : "",  1 }, // index: 3
+        {  100, "C" ,  MaxRepetitions }, // index: 4
+        {   90, SubtractiveNines ? "XC" : "",  1 }, // index: 5
+        {   50, "L" ,  1 }, // index: 6
+        {   40, SubtractiveFours ? "XL" : "",  1 }, // index: 7
+        {   10, "X" ,  MaxRepetitions }, // index: 8
+        {    9, SubtractiveNines ? "IX" : "",  1 }, // index: 9
+        {    5, "V" ,  1 }, // index: 10
+        {    4, SubtractiveFours ? "IV" : "",  1 }, // index: 11
+        {    1, "I" ,  MaxRepetitions }, // index: 12
+        {    6, "S" ,  1 }, // index: 13
+        {    1, "." ,  5 }, // index: 14
+        {    0, nullptr, 0 }  // index: 15
+    };
+};
+
+
+/**
+ * The grammar of the C library, compile-time copy of _NUM_DICTIONARY.
+ */
+using standard_grammar = grammar<3, true, true, true>;
+
+
+/**
+ * Grammar of clock faces: 4 is "IIII" and "IV" is rejected. As a
+ * consequence, 40 is "XXXX" and 400 "CCCC". Nines stay subtractive, so
+ * "VIIII" is rejected like "IV".
+ */
+using clock_face_grammar = grammar<4, false, true, true>;
+
+
+/**
+ * Medieval additive grammar without subtractive pairs: 9 is "VIIII", 4 is
+ * "IIII".
+ */
+using additive_grammar = grammar<4, false, false, true>;
+
+
+/**
+ * Grammar accepting both the subtractive and the additive forms, like "IV",
+ * "IIII" and "VIIII". Encodes like the standard grammar.
+ */
+using lenient_grammar = grammar<4, true, true, true, true>;
+
+
+/**
+ * The standard grammar without twelfths, for integers only.
+ */
+using integer_grammar = grammar<3, true, true, false>;
+
+
+/**
+ * Roman numeral of a variant of the grammar, with room for its longest
+ * numeral.
+ */
+template<typename Grammar>
+using fixed_roman_of = basic_fixed_roman<Grammar::max_length>;
+
+static_assert(standard_grammar::max_length == max_length,
+              "The standard grammar is the one of the C library.");
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * `constexpr` version of `isspace()` for the "C" locale.
+ */
+constexpr bool is_space(char current) {
+    return current == ' ' || current == '\t' || current == '\n'
+           || current == '\v' || current == '\f' || current == '\r';
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `toupper()` for the "C" locale.
+ */
+constexpr char to_upper(char current) {
+    if (current >= 'a' && current <= 'z') {
+        return static_cast<char>(current - 'a' + 'A');
+    }
+    return current;
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `strlen()`.
+ */
+constexpr std::size_t length_of(const char *string) {
+    std::size_t length = 0;
+    while (string[length] != '\0') {
+        length++;
+    }
+    return length;
+}
+
+
+/**
+ * @internal
+ * Returns the char at the position of the numeral, reading '\0' past its end,
+ * so that the string view can be parsed like a null-terminated string.
+ */
+constexpr char char_at(std::string_view roman, std::size_t position) {
+    return position < roman.size() ? roman[position] : '\0';
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_is_zero()` starting at the given position.
+ */
+constexpr bool is_zero(std::string_view roman, std::size_t position) {
+    if (char_at(roman, position) == '-') {
+        position++;
+    }
+    for (char zero_char : zero) {
+        if (to_upper(char_at(roman, position)) != zero_char) {
+            return false;
+        }
+        position++;
+    }
+    return char_at(roman, position) == '\0';
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `numerus_count_roman_chars()`, returning just the
+ * check status.
+ */
+template<typename Grammar>
+constexpr int check_roman_chars(std::string_view roman) {
+    std::size_t position = 0;
+    while (is_space(char_at(roman, position))) {
+        position++;
+    }
+    if (char_at(roman, position) == '\0') {
+        return NUMERUS_ERROR_EMPTY_ROMAN;
+    }
+    if (is_zero(roman, position)) {
+        return NUMERUS_OK;
+    }
+    short i = 0;
+    while (char_at(roman, position) != '\0') {
+        if (i > Grammar::max_length) {
+            return NUMERUS_ERROR_TOO_LONG_NUMERAL;
+        }
+        switch (to_upper(char_at(roman, position))) {
+            case '_': {
+                position++; // ignore underscores
+                break;
+            }
+            case '-':
+            case 'M':
+            case 'D':
+            case 'C':
+            case 'L':
+            case 'X':
+            case 'V':
+            case 'I': {
+                position++;
+                i++; // count every other roman char
+                break;
+            }
+            case 'S':
+            case '.': {
+                if (!Grammar::has_twelfths) {
+                    return NUMERUS_ERROR_ILLEGAL_CHARACTER;
+                }
+                position++;
+                i++; // count every other roman char
+                break;
+            }
+            default: {
+                if (is_space(char_at(roman, position))) {
+                    return NUMERUS_ERROR_WHITESPACE_CHARACTER;
+                } else {
+                    return NUMERUS_ERROR_ILLEGAL_CHARACTER;
+                }
+            }
+        }
+    }
+    return NUMERUS_OK;
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of the _num_numeral_parser_data struct, with positions
+ * as indices in the numeral and in the dictionary of the grammar.
+ */
+template<typename Grammar>
+struct parser_data {
+    std::string_view roman;
+    std::size_t current_numeral_position = 0;
+    std::size_t current_dictionary_char = 0;
+    bool numeral_is_long = false;
+    short numeral_sign = 1;
+    long int_part = 0;
+    short twelfths = 0;
+    short char_repetitions = 0;
+    std::size_t dictionary_char_after_five = 0;
+    bool repetitions_follow_five = false;
+
+    constexpr char current() const {
+        return char_at(roman, current_numeral_position);
+    }
+
+    constexpr const dictionary_char &dictionary_current() const {
+        return Grammar::dictionary[current_dictionary_char];
+    }
+};
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_char_is_in_string()`.
+ */
+constexpr bool char_is_in_string(char current, const char *terminating_chars) {
+    if (current == '\0') {
+        return true;
+    }
+    while (*terminating_chars != '\0') {
+        if (current == *terminating_chars) {
+            return true;
+        }
+        terminating_chars++;
+    }
+    return false;
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_string_begins_with()`.
+ */
+template<typename Grammar>
+constexpr short string_begins_with(const parser_data<Grammar> &parser,
+                                   const char *pattern) {
+    std::size_t pattern_length = length_of(pattern);
+    for (std::size_t i = 0; i < pattern_length; i++) {
+        if (to_upper(char_at(parser.roman,
+                             parser.current_numeral_position + i))
+            != pattern[i]) {
+            return 0;
+        }
+    }
+    return static_cast<short>(pattern_length);
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_skip_to_next_non_unique_dictionary_char()`.
+ */
+template<typename Grammar>
+constexpr void skip_to_next_non_unique_dictionary_char(
+        parser_data<Grammar> &parser) {
+    bool current_char_is_multiple_of_five =
+            length_of(parser.dictionary_current().characters) == 1;
+    while (parser.dictionary_current().max_repetitions == 1) {
+        parser.current_dictionary_char++;
+        parser.char_repetitions = 0;
+    }
+    if (!current_char_is_multiple_of_five) {
+        parser.current_dictionary_char++;
+    }
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_compare_numeral_position_with_dictionary()`.
+ */
+template<typename Grammar>
+constexpr int compare_numeral_position_with_dictionary(
+        parser_data<Grammar> &parser) {
+    short num_of_matching_chars = string_begins_with(
+            parser, parser.dictionary_current().characters);
+    if (num_of_matching_chars > 0) {
+        /* Chars match */
+        parser.char_repetitions++;
+        if (parser.char_repetitions
+            > parser.dictionary_current().max_repetitions) {
+            return NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS;
+        }
+        if (parser.char_repetitions == 1) {
+            parser.repetitions_follow_five =
+                    parser.current_dictionary_char
+                    == parser.dictionary_char_after_five;
+        }
+        if (!Grammar::has_additive_nines && parser.repetitions_follow_five
+            && parser.char_repetitions > 3) {
+            /* "VIIII", "LXXXX" or "DCCCC" where the nines are subtractive */
+            return NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE;
+        }
+        /* "V", "L" and "D" are followed by the "I", "X" and "C" after the
+         * subtractive fours in the dictionary */
+        parser.dictionary_char_after_five =
+                num_of_matching_chars == 1
+                && parser.dictionary_current().max_repetitions == 1
+                ? parser.current_dictionary_char + 2 : 0;
+        parser.current_numeral_position += num_of_matching_chars;
+        char first = *parser.dictionary_current().characters;
+        if (first == 'S' || first == '.') {
+            /* Add to decimal part value */
+            parser.twelfths += parser.dictionary_current().value;
+        } else {
+            /* Add to integer part value */
+            parser.int_part += parser.dictionary_current().value;
+        }
+        skip_to_next_non_unique_dictionary_char(parser);
+    } else {
+        /* Chars don't match */
+        parser.char_repetitions = 0;
+        parser.current_dictionary_char++;
+        if (parser.dictionary_current().max_repetitions == 0) {
+            return NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE;
+        }
+    }
+    return NUMERUS_OK;
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_parse_part_in_underscores()`.
+ */
+template<typename Grammar>
+constexpr int parse_part_in_underscores(parser_data<Grammar> &parser) {
+    while (!char_is_in_string(parser.current(), "_Ss.-")) {
+        int result_code = compare_numeral_position_with_dictionary(parser);
+        if (result_code != NUMERUS_OK) {
+            return result_code;
+        }
+    }
+    if (parser.current() == '\0') {
+        return NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE;
+    }
+    if (char_is_in_string(parser.current(), "sS.")) {
+        return NUMERUS_ERROR_DECIMALS_IN_LONG_PART;
+    }
+    if (parser.current() == '-') {
+        return NUMERUS_ERROR_ILLEGAL_MINUS;
+    }
+    return NUMERUS_OK;
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_parse_part_after_underscores()`.
+ */
+template<typename Grammar>
+constexpr int parse_part_after_underscores(parser_data<Grammar> &parser) {
+    const char *stop_chars = parser.numeral_is_long ? "Ss.M_-" : "Ss._-";
+    while (!char_is_in_string(parser.current(), stop_chars)) {
+        int result_code = compare_numeral_position_with_dictionary(parser);
+        if (result_code != NUMERUS_OK) {
+            return result_code;
+        }
+    }
+    if (parser.current() == '_') {
+        if (parser.numeral_is_long) {
+            return NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART;
+        } else {
+            return NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG;
+        }
+    }
+    if (parser.current() == 'M') {
+        return NUMERUS_ERROR_M_IN_SHORT_PART;
+    }
+    if (parser.current() == '-') {
+        return NUMERUS_ERROR_ILLEGAL_MINUS;
+    }
+    return NUMERUS_OK;
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_parse_decimal_part()`.
+ */
+template<typename Grammar>
+constexpr int parse_decimal_part(parser_data<Grammar> &parser) {
+    while (!char_is_in_string(parser.current(), "_-")) {
+        int result_code = compare_numeral_position_with_dictionary(parser);
+        if (result_code != NUMERUS_OK) {
+            return result_code;
+        }
+    }
+    if (parser.current() == '_') {
+        if (parser.numeral_is_long) {
+            return NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART;
+        } else {
+            return NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG;
+        }
+    }
+    if (parser.current() == '-') {
+        return NUMERUS_ERROR_ILLEGAL_MINUS;
+    }
+    return NUMERUS_OK;
+}
+
+
+/**
+ * @internal
+ * `constexpr` version of `_num_value_part_to_roman()`, appending to the
+ * fixed_roman and skipping the pairs disabled in the grammar.
+ */
+template<typename Grammar>
+constexpr void value_part_to_roman(long value,
+                                   fixed_roman_of<Grammar> &roman,
+                                   std::size_t dictionary_start_char) {
+    const dictionary_char *current_dictionary_char =
+            &Grammar::dictionary[dictionary_start_char];
+    while (value > 0) {
+        while (value >= current_dictionary_char->value
+               && *current_dictionary_char->characters != '\0') {
+            const char *characters = current_dictionary_char->characters;
+            while (*characters != '\0') {
+                roman.chars[roman.length++] = *(characters++);
+            }
+            value -= current_dictionary_char->value;
+        }
+        current_dictionary_char++;
+    }
+}
+
+
+} /* namespace detail */
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   TWELFTHS MANAGEMENT   }-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * `constexpr` version of `numerus_parts_to_double()`.
+ */
+constexpr double parts_to_double(long int_part, short twelfths) {
+    return static_cast<double>(int_part) + twelfths / 12.0;
+}
+
+
+/**
+ * `constexpr` version of `numerus_shorten_and_same_sign_to_parts()`.
+ */
+constexpr void shorten_and_same_sign_to_parts(long *int_part,
+                                              short *twelfths) {
+    *int_part += *twelfths / 12;
+    *twelfths = static_cast<short>(*twelfths % 12);
+    if (*int_part > 0 && *twelfths < 0) {
+        *int_part -= 1;
+        *twelfths += 12;
+    } else if (*int_part < 0 && *twelfths > 0) {
+        *int_part += 1;
+        *twelfths -= 12;
+    }
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-{   CONVERSION ROMAN -> VALUE   }-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * `constexpr` version of `numerus_roman_to_int_part_and_twelfths()`.
+ *
+ * Accepts and rejects exactly the same numerals with the same error codes.
+ * The global `numerus_error_code` is not modified.
+ *
+ * Other variants of the grammar can be parsed passing a numerus::grammar as
+ * template argument, like
+ * `roman_to_int_part_and_twelfths<numerus::clock_face_grammar>("IIII")`.
+ *
+ * @tparam Grammar variant of the grammar to parse, by default the one of the
+ * C library.
+ * @param roman string with a roman numeral.
+ * @param *twelfths number of twelfths from 0 to 11. NULL is interpreted as 0
+ * twelfths.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns long as the integer part of the value of the roman numeral or a
+ * value outside the the possible range of values when an error occurs.
+ */
+template<typename Grammar = standard_grammar>
+constexpr long roman_to_int_part_and_twelfths(std::string_view roman,
+                                              short *twelfths = nullptr,
+                                              int *errcode = nullptr) {
+    short zero_twelfths = 0;
+    int ignored_errcode = NUMERUS_OK;
+    if (twelfths == nullptr) {
+        twelfths = &zero_twelfths;
+    }
+    if (errcode == nullptr) {
+        errcode = &ignored_errcode;
+    }
+    detail::parser_data<Grammar> parser;
+    parser.roman = roman;
+
+    /* Check for illegal symbols or length */
+    int response_code = detail::check_roman_chars<Grammar>(roman);
+    if (response_code != NUMERUS_OK) {
+        *errcode = response_code;
+        return max_long_nonfloat_value + 10;
+    }
+
+    /* Conversion if NUMERUS_NULLA, after the initial whitespace */
+    std::size_t first_non_space = 0;
+    while (detail::is_space(detail::char_at(roman, first_non_space))) {
+        first_non_space++;
+    }
+    if (detail::is_zero(roman, first_non_space)) {
+        *twelfths = 0;
+        *errcode = NUMERUS_OK;
+        return 0;
+    }
+
+    /* Conversion of other cases */
+    if (parser.current() == '-') {
+        parser.numeral_sign = -1;
+        parser.current_numeral_position++;
+    }
+    if (parser.current() == '_') {
+        parser.current_numeral_position++;
+        parser.numeral_is_long = true;
+    }
+    if (parser.numeral_is_long) {
+        response_code = detail::parse_part_in_underscores(parser);
+        if (response_code != NUMERUS_OK) {
+            *errcode = response_code;
+            return max_long_nonfloat_value + 10;
+        }
+        parser.current_numeral_position++; /* Skip second underscore */
+        parser.int_part *= 1000;
+        parser.current_dictionary_char = 1;
+        parser.char_repetitions = 0;
+        parser.dictionary_char_after_five = 0;
+    }
+    response_code = detail::parse_part_after_underscores(parser);
+    if (response_code != NUMERUS_OK) {
+        *errcode = response_code;
+        return max_long_nonfloat_value + 10;
+    }
+    response_code = detail::parse_decimal_part(parser);
+    if (response_code != NUMERUS_OK) {
+        *errcode = response_code;
+        return max_long_nonfloat_value + 10;
+    }
+    *twelfths = static_cast<short>(parser.numeral_sign * parser.twelfths);
+    *errcode = NUMERUS_OK;
+    return parser.numeral_sign * parser.int_part;
+}
+
+
+/**
+ * `constexpr` version of `numerus_roman_to_int()`.
+ *
+ * @see roman_to_int_part_and_twelfths()
+ */
+template<typename Grammar = standard_grammar>
+constexpr long roman_to_int(std::string_view roman, int *errcode = nullptr) {
+    return roman_to_int_part_and_twelfths<Grammar>(roman, nullptr, errcode);
+}
+
+
+/**
+ * `constexpr` version of `numerus_roman_to_double()`.
+ *
+ * @see roman_to_int_part_and_twelfths()
+ */
+template<typename Grammar = standard_grammar>
+constexpr double roman_to_double(std::string_view roman,
+                                 int *errcode = nullptr) {
+    short twelfths = 0;
+    long int_part = roman_to_int_part_and_twelfths<Grammar>(roman, &twelfths,
+                                                            errcode);
+    return parts_to_double(int_part, twelfths);
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-{   CONVERSION VALUE -> ROMAN   }-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * `constexpr` version of `numerus_int_with_twelfth_to_roman()`.
+ *
+ * Generates exactly the same numerals, but stores them in a fixed_roman
+ * instead of allocating them, sized for the grammar. The global
+ * `numerus_error_code` is not modified.
+ *
+ * @tparam Grammar variant of the grammar to write, by default the one of the
+ * C library. With an additive grammar 9 is "VIIII".
+ * @param int_part long integer part of a value to be added to the twelfths
+ * and converted to roman numeral.
+ * @param twelfths short integer as number of twelfths (1/12) to be added to the
+ * integer part and converted to roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns fixed_roman containing the roman numeral or an empty one when an
+ * error occurs.
+ */
+template<typename Grammar = standard_grammar>
+constexpr fixed_roman_of<Grammar> int_with_twelfth_to_roman(
+        long int_part, short twelfths, int *errcode = nullptr) {
+    /* Prepare variables */
+    int ignored_errcode = NUMERUS_OK;
+    if (errcode == nullptr) {
+        errcode = &ignored_errcode;
+    }
+    shorten_and_same_sign_to_parts(&int_part, &twelfths);
+    double double_value = parts_to_double(int_part, twelfths);
+    fixed_roman_of<Grammar> roman;
+
+    /* Out of range check */
+    if (double_value < min_value || double_value > max_value
+        || (!Grammar::has_twelfths && twelfths != 0)) {
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return roman;
+    }
+
+    /* Save sign or return NUMERUS_ZERO for 0 */
+    if (int_part == 0 && twelfths == 0) {
+        for (char zero_char : zero) {
+            roman.chars[roman.length++] = zero_char;
+        }
+        *errcode = NUMERUS_OK;
+        return roman;
+    } else if (int_part < 0 || (int_part == 0 && twelfths < 0)) {
+        int_part = -int_part;
+        twelfths = static_cast<short>(-twelfths);
+        double_value = -double_value;
+        roman.chars[roman.length++] = '-';
+    }
+
+    /* Create part between underscores */
+    if (double_value > max_nonlong_float_value) {
+        roman.chars[roman.length++] = '_';
+        detail::value_part_to_roman<Grammar>(int_part / 1000, roman, 0);
+        int_part -= (int_part / 1000) * 1000;
+        roman.chars[roman.length++] = '_';
+        detail::value_part_to_roman<Grammar>(int_part, roman, 1);
+    } else {
+        detail::value_part_to_roman<Grammar>(int_part, roman, 0);
+    }
+    /* Decimal part, starting with "S" char */
+    detail::value_part_to_roman<Grammar>(twelfths, roman, 13);
+    *errcode = NUMERUS_OK;
+    return roman;
+}
+
+
+/**
+ * `constexpr` version of `numerus_int_to_roman()`.
+ *
+ * @see int_with_twelfth_to_roman()
+ */
+template<typename Grammar = standard_grammar>
+constexpr fixed_roman_of<Grammar> int_to_roman(long int_value,
+                                               int *errcode = nullptr) {
+    return int_with_twelfth_to_roman<Grammar>(int_value, 0, errcode);
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   NUMERAL VALUE TYPE   }-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+namespace detail {
+struct roman_builder;
+}
+
+
+/**
+ * Roman numeral value type with inline storage.
+ *
+ * Stores the numeral in an inline fixed_roman buffer together
+ * with its length and its cached value as integer part and twelfths, so it
+ * never allocates: containers of romans allocate only their own storage, not
+ * one string per element. The numeral is always kept in its canonical
+ * (uppercase) form, so two romans have the same numeral if and only if they
+ * have the same value.
+ *
+ * Comparisons and arithmetic operate on the cached value, without parsing the
+ * numeral again. Any operation resulting in a value out of range or any
+ * invalid numeral throws a numerus::error.
+ *
+ * Example:
+ *
+ * <pre>
+ * numerus::roman year(2016);
+ * numerus::roman next = year + 1;      // "MMXVII"
+ * numerus::roman half("s");            // "S", 0.5
+ * std::string_view text = next.view(); // no copies, no allocations
+ * </pre>
+ */
+class roman {
+public:
+
+    /**
+     * Creates a roman numeral with value zero, NUMERUS_ZERO.
+     */
+    constexpr roman() noexcept : roman(int_with_twelfth_to_roman(0, 0), 0, 0) {
+    }
+
+    /**
+     * Creates the roman numeral of an integer part and a number of twelfths.
+     *
+     * @throws numerus::error if the value is out of range.
+     */
+    template<typename Integer,
+             typename = std::enable_if_t<std::is_integral_v<Integer>>>
+    constexpr explicit roman(Integer int_part, short twelfths = 0)
+            : roman(checked(static_cast<long>(int_part), twelfths)) {
+    }
+
+    /**
+     * Creates the roman numeral of a double value, rounded to the nearest
+     * twelfth like numerus_double_to_roman().
+     *
+     * @throws numerus::error if the value is out of range.
+     */
+    explicit roman(double value) : roman(from_double(value)) {
+    }
+
+    /**
+     * Parses a roman numeral, with the same syntax accepted by
+     * numerus_roman_to_int_part_and_twelfths().
+     *
+     * @throws numerus::error if the numeral has a wrong syntax.
+     */
+    constexpr explicit roman(std::string_view numeral)
+            : roman(parsed(numeral)) {
+    }
+
+    /**
+     * @throws numerus::error with NUMERUS_ERROR_NULL_ROMAN if the numeral is
+     * NULL, as the C library reports it.
+     */
+    constexpr explicit roman(const char *numeral)
+            : roman(non_null(numeral)) {
+    }
+
+    constexpr std::string_view view() const noexcept {
+        return numeral.view();
+    }
+
+    constexpr operator std::string_view() const noexcept {
+        return numeral.view();
+    }
+
+    constexpr const char *c_str() const noexcept {
+        return numeral.c_str();
+    }
+
+    constexpr const char *data() const noexcept {
+        return numeral.c_str();
+    }
+
+    constexpr std::size_t size() const noexcept {
+        return numeral.size();
+    }
+
+    constexpr long int_part() const noexcept {
+        return cached_int_part;
+    }
+
+    constexpr short twelfths() const noexcept {
+        return cached_twelfths;
+    }
+
+    /**
+     * Returns the value as the total number of twelfths, which is the
+     * quantity all comparisons and arithmetic operate on.
+     */
+    constexpr long long total_twelfths() const noexcept {
+        return static_cast<long long>(cached_int_part) * 12 + cached_twelfths;
+    }
+
+    constexpr double to_double() const noexcept {
+        return parts_to_double(cached_int_part, cached_twelfths);
+    }
+
+    constexpr bool is_long() const noexcept {
+        return cached_int_part > 3999 || cached_int_part < -3999;
+    }
+
+    constexpr bool is_float() const noexcept {
+        return cached_twelfths != 0;
+    }
+
+    constexpr short sign() const noexcept {
+        long long total = total_twelfths();
+        return static_cast<short>((total > 0) - (total < 0));
+    }
+
+    constexpr roman operator-() const {
+        return from_total_twelfths(-total_twelfths());
+    }
+
+    constexpr roman &operator+=(const roman &other) {
+        return *this = from_total_twelfths(total_twelfths()
+                                           + other.total_twelfths());
+    }
+
+    constexpr roman &operator-=(const roman &other) {
+        return *this = from_total_twelfths(total_twelfths()
+                                           - other.total_twelfths());
+    }
+
+    /**
+     * @throws numerus::error with NUMERUS_ERROR_VALUE_OUT_OF_RANGE if the
+     * product is beyond the range of values, checked before multiplying, so
+     * no factor can overflow.
+     */
+    constexpr roman &operator*=(long factor) {
+        const long long max_total = max_long_nonfloat_value * 12LL + 11;
+        if (total_twelfths() != 0
+            && (factor > max_total || factor < -max_total)) {
+            throw error(NUMERUS_ERROR_VALUE_OUT_OF_RANGE);
+        }
+        return *this = from_total_twelfths(total_twelfths() * factor);
+    }
+
+    /**
+     * Divides the value, truncating it to a whole number of twelfths.
+     *
+     * @throws std::domain_error if the divisor is zero.
+     */
+    constexpr roman &operator/=(long divisor) {
+        if (divisor == 0) {
+            throw std::domain_error("Division of a roman numeral by zero.");
+        }
+        return *this = from_total_twelfths(total_twelfths() / divisor);
+    }
+
+    friend constexpr roman operator+(roman left, const roman &right) {
+        return left += right;
+    }
+
+    friend constexpr roman operator+(roman left, long right) {
+        return left += roman(right);
+    }
+
+    friend constexpr roman operator-(roman left, const roman &right) {
+        return left -= right;
+    }
+
+    friend constexpr roman operator-(roman left, long right) {
+        return left -= roman(right);
+    }
+
+    friend constexpr roman operator*(roman left, long right) {
+        return left *= right;
+    }
+
+    friend constexpr roman operator*(long left, roman right) {
+        return right *= left;
+    }
+
+    friend constexpr roman operator/(roman left, long right) {
+        return left /= right;
+    }
+
+    friend constexpr bool operator==(const roman &left, const roman &right) {
+        return left.total_twelfths() == right.total_twelfths();
+    }
+
+    friend constexpr bool operator!=(const roman &left, const roman &right) {
+        return left.total_twelfths() != right.total_twelfths();
+    }
+
+    friend constexpr bool operator<(const roman &left, const roman &right) {
+        return left.total_twelfths() < right.total_twelfths();
+    }
+
+    friend constexpr bool operator<=(const roman &left, const roman &right) {
+        return left.total_twelfths() <= right.total_twelfths();
+    }
+
+    friend constexpr bool operator>(const roman &left, const roman &right) {
+        return left.total_twelfths() > right.total_twelfths();
+    }
+
+    friend constexpr bool operator>=(const roman &left, const roman &right) {
+        return left.total_twelfths() >= right.total_twelfths();
+    }
+
+private:
+    friend struct detail::roman_builder;
+
+    fixed_roman numeral;
+    long cached_int_part;
+    short cached_twelfths;
+
+    constexpr roman(const fixed_roman &numeral, long int_part, short twelfths)
+            : numeral(numeral), cached_int_part(int_part),
+              cached_twelfths(twelfths) {
+    }
+
+    static constexpr roman checked(long int_part, short twelfths) {
+        int errcode = NUMERUS_OK;
+        shorten_and_same_sign_to_parts(&int_part, &twelfths);
+        fixed_roman numeral = int_with_twelfth_to_roman(int_part, twelfths,
+                                                        &errcode);
+        if (errcode != NUMERUS_OK) {
+            throw error(errcode);
+        }
+        return roman(numeral, int_part, twelfths);
+    }
+
+    static constexpr roman from_total_twelfths(long long total) {
+        if (total > max_long_nonfloat_value * 12LL + 11
+            || total < min_long_nonfloat_value * 12LL - 11) {
+            throw error(NUMERUS_ERROR_VALUE_OUT_OF_RANGE);
+        }
+        return checked(static_cast<long>(total / 12),
+                       static_cast<short>(total % 12));
+    }
+
+    static constexpr std::string_view non_null(const char *numeral) {
+        if (numeral == nullptr) {
+            throw error(NUMERUS_ERROR_NULL_ROMAN);
+        }
+        return std::string_view(numeral);
+    }
+
+    static roman from_double(double value) {
+        short twelfths;
+        long int_part = numerus_double_to_parts(value, &twelfths);
+        return checked(int_part, twelfths);
+    }
+
+    static constexpr roman parsed(std::string_view numeral) {
+        int errcode = NUMERUS_OK;
+        short twelfths = 0;
+        long int_part = roman_to_int_part_and_twelfths(numeral, &twelfths,
+                                                       &errcode);
+        if (errcode != NUMERUS_OK) {
+            throw error(errcode);
+        }
+        return checked(int_part, twelfths);
+    }
+};
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * Builds romans from numerals already converted by the batch conversion
+ * functions, without converting them again.
+ */
+struct roman_builder {
+    /**
+     * @param numeral valid canonical numeral, null-terminated.
+     * @param int_part integer part of the value of the numeral.
+     * @param twelfths twelfths of the value of the numeral, same sign.
+     */
+    static roman from_valid_numeral(const char *numeral, long int_part,
+                                    short twelfths) {
+        fixed_roman copy;
+        while (numeral[copy.length] != '\0') {
+            copy.chars[copy.length] = numeral[copy.length];
+            copy.length++;
+        }
+        copy.chars[copy.length] = '\0';
+        return roman(copy, int_part, twelfths);
+    }
+};
+
+
+} /* namespace detail */
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   NUMERAL KINDS   }-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Tag selecting the conversions of integers without underscores, within
+ * [NUMERUS_MIN_SHORT_VALUE, NUMERUS_MAX_SHORT_VALUE]. Values to convert are
+ * taken as `long`, so wider ones are refused instead of being truncated.
+ */
+struct short_numeral {
+    using value_type = short;
+    using argument_type = long;
+};
+
+
+/**
+ * Tag selecting the conversions of integers, long numerals included.
+ */
+struct long_numeral {
+    using value_type = long;
+    using argument_type = long;
+};
+
+
+/**
+ * Tag selecting the conversions of any value, twelfths included.
+ */
+struct float_numeral {
+    using value_type = double;
+    using argument_type = double;
+};
+
+
+/**
+ * Converts a value to roman numeral with the conversion specialised for the
+ * kind of numerals, one of numerus::short_numeral, numerus::long_numeral and
+ * numerus::float_numeral.
+ *
+ * Example: `numerus::to_roman<numerus::short_numeral>(2016)`.
+ *
+ * @throws numerus::error if the value is outside the domain of the kind.
+ */
+template<typename Kind>
+fixed_roman to_roman(typename Kind::argument_type value);
+
+
+/**
+ * Converts a roman numeral to its value with the conversion specialised for
+ * the kind of numerals, one of numerus::short_numeral, numerus::long_numeral
+ * and numerus::float_numeral.
+ *
+ * @throws numerus::error if the numeral has wrong syntax or its value is
+ * outside the domain of the kind, NUMERUS_ERROR_VALUE_OUT_OF_RANGE.
+ */
+template<typename Kind>
+typename Kind::value_type from_roman(std::string_view numeral);
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * Capacity of the buffer where numerals are copied null-terminated before
+ * passing them to the C library. Longer ones are parsed by the `constexpr`
+ * parser instead.
+ */
+constexpr std::size_t c_numeral_capacity = 64;
+
+
+/**
+ * @internal
+ * Calls the C conversion with a null-terminated copy of the numeral if it
+ * fits the buffer, otherwise the `constexpr` parser with the numeral itself.
+ * Throws the error of the conversion, if any.
+ */
+template<typename Result, typename CConversion, typename Conversion>
+Result parse_kind(std::string_view numeral, CConversion c_conversion,
+                  Conversion conversion) {
+    int errcode = NUMERUS_OK;
+    Result value;
+    if (numeral.size() < c_numeral_capacity) {
+        char buffer[c_numeral_capacity];
+        numeral.copy(buffer, numeral.size());
+        buffer[numeral.size()] = '\0';
+        value = c_conversion(buffer, &errcode);
+    } else {
+        value = conversion(numeral, &errcode);
+    }
+    if (errcode != NUMERUS_OK) {
+        throw error(errcode);
+    }
+    return value;
+}
+
+
+/**
+ * @internal
+ * Calls the C conversion into a fixed_roman, throwing its error, if any.
+ */
+template<typename Value, typename CConversion>
+fixed_roman encode_kind(Value value, CConversion c_conversion) {
+    int errcode = NUMERUS_OK;
+    fixed_roman numeral;
+    numeral.length = c_conversion(value, numeral.chars, &errcode);
+    if (errcode != NUMERUS_OK) {
+        throw error(errcode);
+    }
+    return numeral;
+}
+
+
+} /* namespace detail */
+
+
+template<>
+inline fixed_roman to_roman<short_numeral>(long value) {
+    return detail::encode_kind(value, numerus_short_int_to_roman_into);
+}
+
+
+template<>
+inline fixed_roman to_roman<long_numeral>(long value) {
+    return detail::encode_kind(value, numerus_int_to_roman_into);
+}
+
+
+template<>
+inline fixed_roman to_roman<float_numeral>(double value) {
+    return detail::encode_kind(value, numerus_double_to_roman_into);
+}
+
+
+template<>
+inline short from_roman<short_numeral>(std::string_view numeral) {
+    return detail::parse_kind<short>(
+            numeral, numerus_roman_to_short_int,
+            [](std::string_view roman, int *errcode) {
+                short twelfths = 0;
+                long int_part = roman_to_int_part_and_twelfths(
+                        roman, &twelfths, errcode);
+                if (*errcode == NUMERUS_OK
+                    && (twelfths != 0 || int_part > NUMERUS_MAX_SHORT_VALUE
+                        || int_part < NUMERUS_MIN_SHORT_VALUE)) {
+                    *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+                }
+                return static_cast<short>(int_part);
+            });
+}
+
+
+template<>
+inline long from_roman<long_numeral>(std::string_view numeral) {
+    auto integer_only = [](long int_part, short twelfths, int *errcode) {
+        if (*errcode == NUMERUS_OK && twelfths != 0) {
+            *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        }
+        return int_part;
+    };
+    return detail::parse_kind<long>(
+            numeral,
+            [&](char *roman, int *errcode) {
+                short twelfths = 0;
+                long int_part = numerus_roman_to_int_part_and_twelfths(
+                        roman, &twelfths, errcode);
+                return integer_only(int_part, twelfths, errcode);
+            },
+            [&](std::string_view roman, int *errcode) {
+                short twelfths = 0;
+                long int_part = roman_to_int_part_and_twelfths(
+                        roman, &twelfths, errcode);
+                return integer_only(int_part, twelfths, errcode);
+            });
+}
+
+
+template<>
+inline double from_roman<float_numeral>(std::string_view numeral) {
+    return detail::parse_kind<double>(
+            numeral, numerus_roman_to_double,
+            [](std::string_view roman, int *errcode) {
+                return roman_to_double(roman, errcode);
+            });
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-{   LITERALS   }-+-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+namespace literals {
+
+
+/**
+ * Roman numeral literal, evaluating to the value of the numeral as double.
+ *
+ * Invalid numerals are rejected at compile time.
+ *
+ * Example: `"XIV"_roman == 14`, `"-_V_S"_roman == -5000.5`.
+ */
+NUMERUS_CONSTEVAL double operator""_roman(const char *roman,
+                                          std::size_t length) {
+    int errcode = NUMERUS_OK;
+    double value = roman_to_double(std::string_view(roman, length), &errcode);
+    if (errcode != NUMERUS_OK) {
+        throw std::invalid_argument("Invalid roman numeral literal.");
+    }
+    return value;
+}
+
+
+} /* namespace literals */
+
+
+} /* namespace numerus */
+
+
+/**
+ * Hashes a roman numeral by its value, consistently with its operator==.
+ */
+namespace std {
+template<>
+struct hash<numerus::roman> {
+    std::size_t operator()(const numerus::roman &roman) const noexcept {
+        return std::hash<long long>()(roman.total_twelfths());
+    }
+};
+} /* namespace std */
+
+#endif /* NUMERUS_HPP */
@@ -0,0 +1,1762 @@
+/**
+ * @file numerus_bench.c
+ * @brief Numerus microbenchmarks of the public functions.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Times the public functions converting, analysing, pretty printing,
+ * enumerating, searching and packing numerals, on inputs drawn from fixed
+ * distributions with a fixed seed, so two runs on two versions or two
+ * backends time the same work, and writes the results as JSON. Not timed
+ * are the functions setting up or querying the others, like the ones opening
+ * files, initialising iterators and workloads or reading the counts of a
+ * packed file, the variants of timed ones, like the batch encoders of
+ * lengths and packed numerals, the encoder with a custom allocator and the
+ * styling of the extended range, and the command line interface. The parsers
+ * are also timed on the numerals of numerus_workload_production(), with
+ * their skew, their malformed numerals and their mixed case.
+ *
+ * Each benchmark calls its function on consecutive inputs in samples of a
+ * few dozen calls, timed one by one with a monotonic clock, after a few
+ * passes of warm-up filling the caches and the branch predictors. The
+ * nanoseconds per call of each sample, without the cost of reading the
+ * clock, give the median and the 99th percentile of the benchmark.
+ *
+ * The backends are the library functions, the header-only ones of
+ * numerus_inline.h, the table file, when given, and each SIMD level the CPU
+ * supports, for the batch conversions decoding the numerals with them.
+ *
+ * On Linux each benchmark then runs again, untimed, counting cycles,
+ * instructions, branch misses and L1D read misses per call with
+ * perf_event_open(), and the allocations per call by wrapping malloc().
+ * Where the counters are not permitted the results have only the times.
+ *
+ * Usage: `numerus_bench [--repetitions N] [--seed N] [--filter TEXT]
+ * [--table path/to/numerus.table] [--output path/to/results.json]
+ * [--no-counters]`
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* For `clock_gettime()` */
+#define _DEFAULT_SOURCE          /* For `syscall()` on Linux */
+
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include <stdint.h>   /* For `uint64_t` */
+#include <stdio.h>    /* For `fprintf()`, `fopen()` */
+#include <stdlib.h>   /* For `qsort()`, `strtoul()`, `free()` */
+#include <string.h>   /* For `strcmp()`, `strstr()`, `memcpy()` */
+#include <time.h>     /* For `clock_gettime()`, `clock()` */
+#include <errno.h>    /* For `errno` */
+#include "numerus.h"
+#include "numerus_inline.h"
+
+
+/**
+ * @internal
+ * Number of inputs of each distribution, used in a loop by each benchmark.
+ */
+#define _NUM_BENCH_INPUTS 4096
+
+
+/**
+ * @internal
+ * Samples timed per pass over the inputs and passes of warm-up, not timed.
+ */
+#define _NUM_BENCH_SAMPLES_PER_PASS 64
+#define _NUM_BENCH_WARMUP_PASSES 3
+
+
+/**
+ * @internal
+ * Default number of timed passes and seed of the inputs.
+ */
+#define _NUM_BENCH_DEFAULT_REPETITIONS 20
+#define _NUM_BENCH_DEFAULT_SEED 2016
+
+
+/**
+ * @internal
+ * Max number of samples of a benchmark, with the max repetitions.
+ */
+#define _NUM_BENCH_MAX_REPETITIONS 1000
+#define _NUM_BENCH_MAX_SAMPLES \
+    (_NUM_BENCH_MAX_REPETITIONS * _NUM_BENCH_SAMPLES_PER_PASS)
+
+
+/**
+ * @internal
+ * Size of the buffers of the numerals, large enough for any function.
+ */
+#define _NUM_BENCH_ROMAN_SIZE 256
+
+
+/**
+ * @internal
+ * The clock is the monotonic one where POSIX has it, the CPU clock of
+ * clock() otherwise, too coarse for short samples.
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#define _NUM_BENCH_MONOTONIC 1
+#else
+#define _NUM_BENCH_MONOTONIC 0
+#endif
+
+
+/**
+ * @internal
+ * The hardware counters are read with perf_event_open() on Linux only.
+ */
+#if defined(__linux__)
+#define _NUM_BENCH_PERF 1
+#include <linux/perf_event.h>  /* For `struct perf_event_attr` */
+#include <sys/ioctl.h>         /* For `ioctl()` */
+#include <sys/syscall.h>       /* For `SYS_perf_event_open` */
+#include <unistd.h>            /* For `syscall()`, `read()`, `close()` */
+#else
+#define _NUM_BENCH_PERF 0
+#endif
+
+
+/**
+ * @internal
+ * Hardware counters read for each benchmark, in the order of the JSON
+ * output, the first one leading the group.
+ */
+#define _NUM_BENCH_COUNTERS 4
+static const char *const _NUM_BENCH_COUNTER_NAMES[_NUM_BENCH_COUNTERS] = {
+    "cycles", "instructions", "branch_misses", "l1d_misses"
+};
+
+
+/**
+ * @internal
+ * Names of the NUMERUS_SIMD_* levels, as in the NUMERUS_SIMD_LEVEL
+ * environment variable.
+ */
+static const char *const _NUM_BENCH_SIMD_NAMES[] = {
+    "scalar", "sse4.1", "avx2", "avx512"
+};
+
+
+/**
+ * @internal
+ * Backend of a benchmark: the backends which are not always available are
+ * skipped when missing and the SIMD one is run once per supported level.
+ */
+enum _num_bench_backend {
+    _NUM_BENCH_LIBRARY,
+    _NUM_BENCH_INLINE,
+    _NUM_BENCH_TABLE,
+    _NUM_BENCH_SIMD
+};
+
+
+/**
+ * @internal
+ * A benchmark: runs its function on `count` consecutive inputs from the
+ * `first` one, wrapping around, and returns a checksum of the results so
+ * the calls can't be optimised away.
+ */
+struct _num_bench {
+    const char *function;
+    const char *input;
+    enum _num_bench_backend backend;
+    size_t calls_per_sample;
+    uint64_t (*run)(size_t first, size_t count);
+};
+
+
+/**
+ * @internal
+ * Inputs of the benchmarks, generated by _num_bench_generate_inputs().
+ *
+ * Short values are within [-3999, 3999], long ones beyond, float ones have
+ * a short integer part and twelfths. The mixed inputs cycle the three kinds.
+ */
+static long _num_bench_short_values[_NUM_BENCH_INPUTS];
+static long _num_bench_long_values[_NUM_BENCH_INPUTS];
+static long _num_bench_float_int_parts[_NUM_BENCH_INPUTS];
+static short _num_bench_float_twelfths[_NUM_BENCH_INPUTS];
+static double _num_bench_float_doubles[_NUM_BENCH_INPUTS];
+static long _num_bench_mixed_int_parts[_NUM_BENCH_INPUTS];
+static short _num_bench_mixed_twelfths[_NUM_BENCH_INPUTS];
+static char _num_bench_short_romans[_NUM_BENCH_INPUTS][_NUM_BENCH_ROMAN_SIZE];
+static char _num_bench_long_romans[_NUM_BENCH_INPUTS][_NUM_BENCH_ROMAN_SIZE];
+static char _num_bench_float_romans[_NUM_BENCH_INPUTS][_NUM_BENCH_ROMAN_SIZE];
+static char _num_bench_mixed_romans[_NUM_BENCH_INPUTS][_NUM_BENCH_ROMAN_SIZE];
+static char _num_bench_typos[_NUM_BENCH_INPUTS][_NUM_BENCH_ROMAN_SIZE];
+static char _num_bench_prefixes[_NUM_BENCH_INPUTS][4];
+static int64_t _num_bench_epochs[_NUM_BENCH_INPUTS];
+static struct tm _num_bench_dates[_NUM_BENCH_INPUTS];
+static int _num_bench_error_codes[_NUM_BENCH_INPUTS];
+static char _num_bench_production_romans[_NUM_BENCH_INPUTS][
+        _NUM_BENCH_ROMAN_SIZE];
+
+
+/**
+ * @internal
+ * Outputs of the benchmarks, overwritten by each call.
+ */
+static char _num_bench_roman[_NUM_BENCH_ROMAN_SIZE];
+static char _num_bench_batch_romans[_NUM_BENCH_INPUTS * 37];
+static long _num_bench_batch_int_parts[_NUM_BENCH_INPUTS];
+static short _num_bench_batch_twelfths[_NUM_BENCH_INPUTS];
+static int _num_bench_batch_errcodes[_NUM_BENCH_INPUTS];
+static short _num_bench_batch_lengths[_NUM_BENCH_INPUTS];
+static struct numerus_suggestion _num_bench_suggestions[4];
+static char _num_bench_completions[10 * 37];
+
+
+#ifndef NUMERUS_NO_MALLOC
+/**
+ * @internal
+ * Table file of the table backend, NULL when not given.
+ */
+static struct numerus_table *_num_bench_table = NULL;
+
+
+/**
+ * @internal
+ * Packed files of the pack benchmarks, in the temporary directory: one
+ * appended to by the writer, one with a block of the mixed values read back.
+ */
+static char _num_bench_pack_writer_path[4096];
+static char _num_bench_pack_path[4096];
+static struct numerus_pack_writer *_num_bench_pack_writer = NULL;
+static struct numerus_pack *_num_bench_pack = NULL;
+#endif
+
+
+/**
+ * @internal
+ * State of the pseudorandom generator of the inputs, splitmix64, the same
+ * on every platform for the same seed.
+ */
+static uint64_t _num_bench_random_state;
+
+
+/**
+ * @internal
+ * Next pseudorandom number of the generator.
+ */
+static uint64_t _num_bench_random(void) {
+    uint64_t z = (_num_bench_random_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * @internal
+ * Pseudorandom integer uniformly distributed within [min, max].
+ */
+static long _num_bench_uniform(long min, long max) {
+    return min + (long) (_num_bench_random() % (uint64_t) (max - min + 1));
+}
+
+
+/**
+ * @internal
+ * Fills the inputs of the benchmarks from the seed.
+ */
+static void _num_bench_generate_inputs(uint64_t seed) {
+    _num_bench_random_state = seed;
+    for (size_t i = 0; i < _NUM_BENCH_INPUTS; i++) {
+        long sign = _num_bench_random() % 2 ? -1 : 1;
+        _num_bench_short_values[i] = _num_bench_uniform(
+                NUMERUS_MIN_SHORT_VALUE, NUMERUS_MAX_SHORT_VALUE);
+        _num_bench_long_values[i] = sign * _num_bench_uniform(
+                NUMERUS_MAX_SHORT_VALUE + 1, NUMERUS_MAX_LONG_NONFLOAT_VALUE);
+        _num_bench_float_int_parts[i] = sign * _num_bench_uniform(
+                0, NUMERUS_MAX_SHORT_VALUE);
+        _num_bench_float_twelfths[i] = (short) (sign * _num_bench_uniform(
+                1, 11));
+        _num_bench_float_doubles[i] = numerus_parts_to_double(
+                _num_bench_float_int_parts[i], _num_bench_float_twelfths[i]);
+        numerus_int_to_roman_into(_num_bench_short_values[i],
+                                  _num_bench_short_romans[i], NULL);
+        numerus_int_to_roman_into(_num_bench_long_values[i],
+                                  _num_bench_long_romans[i], NULL);
+        numerus_int_with_twelfth_to_roman_into(
+                _num_bench_float_int_parts[i], _num_bench_float_twelfths[i],
+                _num_bench_float_romans[i], NULL);
+        switch (i % 3) {
+            case 0:
+                _num_bench_mixed_int_parts[i] = _num_bench_short_values[i];
+                _num_bench_mixed_twelfths[i] = 0;
+                break;
+            case 1:
+                _num_bench_mixed_int_parts[i] = _num_bench_long_values[i];
+                _num_bench_mixed_twelfths[i] = 0;
+                break;
+            default:
+                _num_bench_mixed_int_parts[i] = _num_bench_float_int_parts[i];
+                _num_bench_mixed_twelfths[i] = _num_bench_float_twelfths[i];
+        }
+        numerus_int_with_twelfth_to_roman_into(
+                _num_bench_mixed_int_parts[i], _num_bench_mixed_twelfths[i],
+                _num_bench_mixed_romans[i], NULL);
+        /* A short numeral with one char replaced by a random roman char */
+        size_t length = strlen(_num_bench_short_romans[i]);
+        memcpy(_num_bench_typos[i], _num_bench_short_romans[i], length + 1);
+        _num_bench_typos[i][_num_bench_random() % length] =
+                "IVXLCDM"[_num_bench_random() % 7];
+        memcpy(_num_bench_prefixes[i], _num_bench_mixed_romans[i], 3);
+        _num_bench_prefixes[i][3] = '\0';
+        /* From 1900 to 2100 */
+        _num_bench_epochs[i] = (int64_t) (_num_bench_random() % 6311433600ULL)
+                               - INT64_C(2208988800);
+        memset(&_num_bench_dates[i], 0, sizeof(struct tm));
+        _num_bench_dates[i].tm_year = (int) _num_bench_uniform(0, 200);
+        _num_bench_dates[i].tm_mon = (int) _num_bench_uniform(0, 11);
+        _num_bench_dates[i].tm_mday = (int) _num_bench_uniform(1, 28);
+        _num_bench_dates[i].tm_hour = (int) _num_bench_uniform(0, 23);
+        _num_bench_dates[i].tm_min = (int) _num_bench_uniform(0, 59);
+        _num_bench_dates[i].tm_sec = (int) _num_bench_uniform(0, 59);
+        _num_bench_error_codes[i] = (int) _num_bench_uniform(
+                NUMERUS_ERROR_GENERIC - 1, NUMERUS_ERROR_WORKLOAD + 1);
+    }
+    struct numerus_workload production;
+    numerus_workload_production(&production, seed);
+    numerus_workload_generate(&production, 0, _NUM_BENCH_INPUTS,
+                              _num_bench_production_romans[0],
+                              _NUM_BENCH_ROMAN_SIZE, NULL, NULL, NULL);
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-+-+-{   BENCHMARKS   }-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+static uint64_t _num_bench_int_to_roman_into_short(size_t first,
+                                                   size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_int_to_roman_into(
+                _num_bench_short_values[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_int_to_roman_into_long(size_t first,
+                                                  size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_int_to_roman_into(
+                _num_bench_long_values[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_int_with_twelfth_to_roman_into_float(
+        size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_int_with_twelfth_to_roman_into(
+                _num_bench_float_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_float_twelfths[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_double_to_roman_into_float(size_t first,
+                                                      size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_double_to_roman_into(
+                _num_bench_float_doubles[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_length_mixed(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_int_with_twelfth_to_roman_length(
+                _num_bench_mixed_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_mixed_twelfths[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_short_int_to_roman_into_short(size_t first,
+                                                         size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_short_int_to_roman_into(
+                _num_bench_short_values[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
+static uint64_t _num_bench_int_with_twelfth_to_roman_mixed(size_t first,
+                                                           size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        char *roman = numerus_int_with_twelfth_to_roman(
+                _num_bench_mixed_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_mixed_twelfths[i % _NUM_BENCH_INPUTS], NULL);
+        sum += (uint64_t) roman[0];
+        free(roman);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_int_to_roman_long(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        char *roman = numerus_int_to_roman(
+                _num_bench_long_values[i % _NUM_BENCH_INPUTS], NULL);
+        sum += (uint64_t) roman[0];
+        free(roman);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_double_to_roman_float(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        char *roman = numerus_double_to_roman(
+                _num_bench_float_doubles[i % _NUM_BENCH_INPUTS], NULL);
+        sum += (uint64_t) roman[0];
+        free(roman);
+    }
+    return sum;
+}
+#endif
+
+
+static uint64_t _num_bench_int_with_twelfth_to_roman_batch_mixed(
+        size_t first, size_t count) {
+    first %= _NUM_BENCH_INPUTS;
+    if (first + count > _NUM_BENCH_INPUTS) {
+        first = 0;
+    }
+    return numerus_int_with_twelfth_to_roman_batch(
+            _num_bench_mixed_int_parts + first,
+            _num_bench_mixed_twelfths + first, count, _num_bench_batch_romans,
+            37, _num_bench_batch_errcodes);
+}
+
+
+static uint64_t _num_bench_inline_to_roman_into_short(size_t first,
+                                                      size_t count) {
+    uint64_t sum = 0;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_inline_int_to_roman_into(
+                _num_bench_short_values[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, &errcode);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_inline_to_roman_into_long(size_t first,
+                                                     size_t count) {
+    uint64_t sum = 0;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_inline_int_to_roman_into(
+                _num_bench_long_values[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, &errcode);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_inline_to_roman_into_float(size_t first,
+                                                      size_t count) {
+    uint64_t sum = 0;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_inline_int_with_twelfth_to_roman_into(
+                _num_bench_float_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_float_twelfths[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, &errcode);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_ext_int_to_roman_into_long(size_t first,
+                                                      size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_ext_int_to_roman_into(
+                _num_bench_long_values[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_iter_next_sequence(size_t first, size_t count) {
+    struct numerus_iter iter;
+    uint64_t sum = 0;
+    /* Starting low enough to stay within the short numerals */
+    numerus_iter_init(&iter, _num_bench_short_values[first % _NUM_BENCH_INPUTS]
+                             % 3000, 0, 12, NULL);
+    for (size_t i = 0; i < count; i++) {
+        sum += (uint64_t) numerus_iter_next(&iter, _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_iter_batch_sequence(size_t first, size_t count) {
+    struct numerus_iter iter;
+    numerus_iter_init(&iter, _num_bench_short_values[first % _NUM_BENCH_INPUTS]
+                             % 3000, 0, 12, NULL);
+    if (count > _NUM_BENCH_INPUTS) {
+        count = _NUM_BENCH_INPUTS;
+    }
+    return numerus_iter_batch(&iter, count, _num_bench_batch_romans, 37,
+                              _num_bench_batch_lengths);
+}
+
+
+/**
+ * @internal
+ * Callback of numerus_enumerate() summing the lengths of the numerals.
+ */
+static int _num_bench_sum_lengths(const char *roman, short length,
+                                  long int_part, short twelfths,
+                                  void *context) {
+    (void) roman;
+    (void) int_part;
+    (void) twelfths;
+    *(uint64_t *) context += (uint64_t) length;
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Filter of the numerals of every kind with integer part within a range of
+ * 10 values starting from a short value, about 240 numerals.
+ */
+static void _num_bench_range_filter(struct numerus_enum_filter *filter,
+                                    size_t first) {
+    numerus_enum_filter_init(filter, NUMERUS_ENUM_ALL);
+    filter->min_int_part = _num_bench_short_values[first % _NUM_BENCH_INPUTS];
+    filter->max_int_part = filter->min_int_part + 9;
+}
+
+
+static uint64_t _num_bench_enumerate_range(size_t first, size_t count) {
+    struct numerus_enum_filter filter;
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        _num_bench_range_filter(&filter, i);
+        sum += numerus_enumerate(&filter, NUMERUS_ENUM_BY_VALUE,
+                                 _num_bench_sum_lengths, &sum);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_enumerate_into_range(size_t first, size_t count) {
+    struct numerus_enum_filter filter;
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        _num_bench_range_filter(&filter, i);
+        sum += numerus_enumerate_into(&filter, NUMERUS_ENUM_BY_VALUE,
+                                      _num_bench_batch_romans,
+                                      sizeof(_num_bench_batch_romans), NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_to_parts_short(size_t first, size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_roman_to_int_part_and_twelfths(
+                _num_bench_short_romans[i % _NUM_BENCH_INPUTS], &twelfths,
+                NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_to_parts_long(size_t first, size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_roman_to_int_part_and_twelfths(
+                _num_bench_long_romans[i % _NUM_BENCH_INPUTS], &twelfths,
+                NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_to_parts_float(size_t first, size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_roman_to_int_part_and_twelfths(
+                _num_bench_float_romans[i % _NUM_BENCH_INPUTS], &twelfths,
+                NULL);
+        sum += (uint64_t) twelfths;
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_to_parts_production(size_t first,
+                                                    size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_roman_to_int_part_and_twelfths(
+                _num_bench_production_romans[i % _NUM_BENCH_INPUTS],
+                &twelfths, &errcode);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_to_double_float(size_t first, size_t count) {
+    double sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += numerus_roman_to_double(
+                _num_bench_float_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return (uint64_t) sum;
+}
+
+
+static uint64_t _num_bench_roman_to_int_long(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_roman_to_int(
+                _num_bench_long_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_to_short_int_short(size_t first,
+                                                    size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_roman_to_short_int(
+                _num_bench_short_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_inline_roman_to_short_int_short(size_t first,
+                                                           size_t count) {
+    uint64_t sum = 0;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_inline_roman_to_short_int(
+                _num_bench_short_romans[i % _NUM_BENCH_INPUTS], &errcode);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_roman_to_parts_batch_mixed(size_t first,
+                                                      size_t count) {
+    first %= _NUM_BENCH_INPUTS;
+    if (first + count > _NUM_BENCH_INPUTS) {
+        first = 0;
+    }
+    return numerus_roman_to_int_part_and_twelfths_batch(
+            _num_bench_mixed_romans[first], _NUM_BENCH_ROMAN_SIZE, count,
+            _num_bench_batch_int_parts, _num_bench_batch_twelfths,
+            _num_bench_batch_errcodes);
+}
+
+
+static uint64_t _num_bench_roman_to_parts_batch_production(size_t first,
+                                                           size_t count) {
+    first %= _NUM_BENCH_INPUTS;
+    if (first + count > _NUM_BENCH_INPUTS) {
+        first = 0;
+    }
+    return numerus_roman_to_int_part_and_twelfths_batch(
+            _num_bench_production_romans[first], _NUM_BENCH_ROMAN_SIZE, count,
+            _num_bench_batch_int_parts, _num_bench_batch_twelfths,
+            _num_bench_batch_errcodes);
+}
+
+
+static uint64_t _num_bench_ext_roman_to_parts_long(size_t first,
+                                                   size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_ext_roman_to_int_part_and_twelfths(
+                _num_bench_long_romans[i % _NUM_BENCH_INPUTS], &twelfths,
+                NULL);
+    }
+    return sum;
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
+static uint64_t _num_bench_table_to_roman_into_mixed(size_t first,
+                                                     size_t count) {
+    uint64_t sum = 0;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_table_int_with_twelfth_to_roman_into(
+                _num_bench_table,
+                _num_bench_mixed_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_mixed_twelfths[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, &errcode);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_table_roman_to_parts_mixed(size_t first,
+                                                      size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_table_roman_to_int_part_and_twelfths(
+                _num_bench_table, _num_bench_mixed_romans[i % _NUM_BENCH_INPUTS],
+                &twelfths, &errcode);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_table_roman_to_parts_production(size_t first,
+                                                           size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_table_roman_to_int_part_and_twelfths(
+                _num_bench_table,
+                _num_bench_production_romans[i % _NUM_BENCH_INPUTS],
+                &twelfths, &errcode);
+    }
+    return sum;
+}
+#endif
+
+
+static uint64_t _num_bench_is_zero_mixed(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_is_zero(
+                _num_bench_mixed_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_is_long_numeral_mixed(size_t first,
+                                                 size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_is_long_numeral(
+                _num_bench_mixed_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_is_float_numeral_mixed(size_t first,
+                                                  size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_is_float_numeral(
+                _num_bench_mixed_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_sign_mixed(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_sign(
+                _num_bench_mixed_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_count_roman_chars_mixed(size_t first,
+                                                   size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_count_roman_chars(
+                _num_bench_mixed_romans[i % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_compare_value_mixed(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_compare_value(
+                _num_bench_mixed_romans[i % _NUM_BENCH_INPUTS],
+                _num_bench_mixed_romans[(i + 1) % _NUM_BENCH_INPUTS], NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_parts_to_double_float(size_t first,
+                                                 size_t count) {
+    double sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += numerus_parts_to_double(
+                _num_bench_float_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_float_twelfths[i % _NUM_BENCH_INPUTS]);
+    }
+    return (uint64_t) sum;
+}
+
+
+static uint64_t _num_bench_double_to_parts_float(size_t first,
+                                                 size_t count) {
+    uint64_t sum = 0;
+    short twelfths;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_double_to_parts(
+                _num_bench_float_doubles[i % _NUM_BENCH_INPUTS], &twelfths);
+        sum += (uint64_t) twelfths;
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_shorten_and_same_sign_to_parts_mixed(
+        size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        /* Twelfths with the sign opposite to the one of the integer part */
+        long int_part = _num_bench_mixed_int_parts[i % _NUM_BENCH_INPUTS];
+        short twelfths = (short) (-_num_bench_mixed_twelfths[
+                i % _NUM_BENCH_INPUTS] - 12);
+        numerus_shorten_and_same_sign_to_parts(&int_part, &twelfths);
+        sum += (uint64_t) int_part + (uint64_t) twelfths;
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_overline_long_numerals_into_long(size_t first,
+                                                            size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_overline_long_numerals_into(
+                _num_bench_long_romans[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_pretty_value_as_double_into_float(size_t first,
+                                                             size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_pretty_value_as_double_into(
+                _num_bench_float_doubles[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_pretty_value_as_parts_into_float(size_t first,
+                                                            size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_pretty_value_as_parts_into(
+                _num_bench_float_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_float_twelfths[i % _NUM_BENCH_INPUTS],
+                _num_bench_roman);
+    }
+    return sum;
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
+static uint64_t _num_bench_overline_long_numerals_long(size_t first,
+                                                       size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        char *pretty_roman = numerus_overline_long_numerals(
+                _num_bench_long_romans[i % _NUM_BENCH_INPUTS], NULL);
+        sum += (uint64_t) pretty_roman[0];
+        free(pretty_roman);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_create_pretty_value_as_double_float(size_t first,
+                                                               size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        char *pretty_value = numerus_create_pretty_value_as_double(
+                _num_bench_float_doubles[i % _NUM_BENCH_INPUTS]);
+        sum += (uint64_t) pretty_value[0];
+        free(pretty_value);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_create_pretty_value_as_parts_float(size_t first,
+                                                              size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        char *pretty_value = numerus_create_pretty_value_as_parts(
+                _num_bench_float_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_float_twelfths[i % _NUM_BENCH_INPUTS]);
+        sum += (uint64_t) pretty_value[0];
+        free(pretty_value);
+    }
+    return sum;
+}
+#endif
+
+
+static uint64_t _num_bench_explain_error_codes(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_explain_error(
+                _num_bench_error_codes[i % _NUM_BENCH_INPUTS])[0];
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_format_epoch_dates(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_format_epoch(
+                _num_bench_epochs[i % _NUM_BENCH_INPUTS], "%Y.%m.%d %H:%M:%S",
+                _num_bench_roman, _NUM_BENCH_ROMAN_SIZE, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_format_date_dates(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_format_date(
+                &_num_bench_dates[i % _NUM_BENCH_INPUTS], "%Y.%m.%d %H:%M:%S",
+                _num_bench_roman, _NUM_BENCH_ROMAN_SIZE, NULL);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_prefix_value_range_prefixes(size_t first,
+                                                       size_t count) {
+    uint64_t sum = 0;
+    double min_value;
+    double max_value;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_prefix_value_range(
+                _num_bench_prefixes[i % _NUM_BENCH_INPUTS], &min_value,
+                &max_value);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_complete_prefixes(size_t first, size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += numerus_complete(_num_bench_prefixes[i % _NUM_BENCH_INPUTS],
+                                _num_bench_completions, 10);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_suggest_typos(size_t first, size_t count) {
+    uint64_t sum = 0;
+    int errcode;
+    for (size_t i = first; i < first + count; i++) {
+        sum += numerus_suggest(_num_bench_typos[i % _NUM_BENCH_INPUTS], 2,
+                               _num_bench_suggestions, 4, &errcode);
+    }
+    return sum;
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
+static uint64_t _num_bench_pack_writer_append_mixed(size_t first,
+                                                    size_t count) {
+    uint64_t sum = 0;
+    for (size_t i = first; i < first + count; i++) {
+        sum += (uint64_t) numerus_pack_writer_append(
+                _num_bench_pack_writer,
+                _num_bench_mixed_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_mixed_twelfths[i % _NUM_BENCH_INPUTS]);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_pack_decode_block_mixed(size_t first,
+                                                   size_t count) {
+    uint64_t sum = 0;
+    (void) first;
+    for (size_t i = 0; i < count; i++) {
+        sum += numerus_pack_decode_block(_num_bench_pack, 0,
+                                         _num_bench_batch_int_parts,
+                                         _num_bench_batch_twelfths);
+    }
+    return sum;
+}
+
+
+static uint64_t _num_bench_pack_decode_block_romans_mixed(size_t first,
+                                                          size_t count) {
+    uint64_t sum = 0;
+    (void) first;
+    for (size_t i = 0; i < count; i++) {
+        sum += numerus_pack_decode_block_romans(_num_bench_pack, 0,
+                                                _num_bench_batch_romans, 37,
+                                                _num_bench_batch_lengths);
+    }
+    return sum;
+}
+
+
+/**
+ * @internal
+ * Opens the writer of the pack benchmarks and writes and opens the packed
+ * file of the mixed values they decode, a single block.
+ *
+ * @returns int NUMERUS_OK or the error of the pack functions.
+ */
+static int _num_bench_open_packs(void) {
+    const char *tmpdir = getenv("TMPDIR");
+    int errcode;
+    tmpdir = tmpdir == NULL ? "/tmp" : tmpdir;
+    snprintf(_num_bench_pack_writer_path, sizeof(_num_bench_pack_writer_path),
+             "%s/numerus_bench_writer.pack", tmpdir);
+    snprintf(_num_bench_pack_path, sizeof(_num_bench_pack_path),
+             "%s/numerus_bench.pack", tmpdir);
+    struct numerus_pack_writer *writer = numerus_pack_writer_open(
+            _num_bench_pack_path, &errcode);
+    if (writer == NULL) {
+        return errcode;
+    }
+    for (size_t i = 0; i < NUMERUS_PACK_BLOCK_VALUES; i++) {
+        numerus_pack_writer_append(
+                writer, _num_bench_mixed_int_parts[i % _NUM_BENCH_INPUTS],
+                _num_bench_mixed_twelfths[i % _NUM_BENCH_INPUTS]);
+    }
+    errcode = numerus_pack_writer_close(writer);
+    if (errcode != NUMERUS_OK) {
+        return errcode;
+    }
+    _num_bench_pack = numerus_pack_open(_num_bench_pack_path, &errcode);
+    if (_num_bench_pack == NULL) {
+        return errcode;
+    }
+    _num_bench_pack_writer = numerus_pack_writer_open(
+            _num_bench_pack_writer_path, &errcode);
+    return errcode;
+}
+
+
+/**
+ * @internal
+ * Closes and removes the packed files of the pack benchmarks.
+ */
+static void _num_bench_close_packs(void) {
+    if (_num_bench_pack_writer != NULL) {
+        numerus_pack_writer_close(_num_bench_pack_writer);
+        remove(_num_bench_pack_writer_path);
+    }
+    if (_num_bench_pack != NULL) {
+        numerus_pack_close(_num_bench_pack);
+        remove(_num_bench_pack_path);
+    }
+}
+#endif
+
+
+/**
+ * @internal
+ * All the benchmarks, in the order they run and are written.
+ */
+static const struct _num_bench _NUM_BENCHES[] = {
+    /* Encoding */
+    {"numerus_int_to_roman_into", "short", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_int_to_roman_into_short},
+    {"numerus_int_to_roman_into", "long", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_int_to_roman_into_long},
+    {"numerus_int_with_twelfth_to_roman_into", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_int_with_twelfth_to_roman_into_float},
+    {"numerus_double_to_roman_into", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_double_to_roman_into_float},
+    {"numerus_int_with_twelfth_to_roman_length", "mixed", _NUM_BENCH_LIBRARY,
+     64, _num_bench_roman_length_mixed},
+    {"numerus_short_int_to_roman_into", "short", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_short_int_to_roman_into_short},
+#ifndef NUMERUS_NO_MALLOC
+    {"numerus_int_with_twelfth_to_roman", "mixed", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_int_with_twelfth_to_roman_mixed},
+    {"numerus_int_to_roman", "long", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_int_to_roman_long},
+    {"numerus_double_to_roman", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_double_to_roman_float},
+#endif
+    {"numerus_int_with_twelfth_to_roman_batch", "mixed", _NUM_BENCH_LIBRARY,
+     64, _num_bench_int_with_twelfth_to_roman_batch_mixed},
+    {"numerus_inline_int_to_roman_into", "short", _NUM_BENCH_INLINE, 64,
+     _num_bench_inline_to_roman_into_short},
+    {"numerus_inline_int_to_roman_into", "long", _NUM_BENCH_INLINE, 64,
+     _num_bench_inline_to_roman_into_long},
+    {"numerus_inline_int_with_twelfth_to_roman_into", "float",
+     _NUM_BENCH_INLINE, 64, _num_bench_inline_to_roman_into_float},
+#ifndef NUMERUS_NO_MALLOC
+    {"numerus_table_int_with_twelfth_to_roman_into", "mixed",
+     _NUM_BENCH_TABLE, 64, _num_bench_table_to_roman_into_mixed},
+#endif
+    {"numerus_ext_int_to_roman_into", "long", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_ext_int_to_roman_into_long},
+    {"numerus_iter_next", "sequence", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_iter_next_sequence},
+    {"numerus_iter_batch", "sequence", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_iter_batch_sequence},
+    /* Enumeration of ranges of numerals, one call per sample */
+    {"numerus_enumerate", "range", _NUM_BENCH_LIBRARY, 1,
+     _num_bench_enumerate_range},
+    {"numerus_enumerate_into", "range", _NUM_BENCH_LIBRARY, 1,
+     _num_bench_enumerate_into_range},
+    /* Decoding */
+    {"numerus_roman_to_int_part_and_twelfths", "short", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_roman_to_parts_short},
+    {"numerus_roman_to_int_part_and_twelfths", "long", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_roman_to_parts_long},
+    {"numerus_roman_to_int_part_and_twelfths", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_roman_to_parts_float},
+    {"numerus_roman_to_int_part_and_twelfths", "production",
+     _NUM_BENCH_LIBRARY, 64, _num_bench_roman_to_parts_production},
+    {"numerus_roman_to_double", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_roman_to_double_float},
+    {"numerus_roman_to_int", "long", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_roman_to_int_long},
+    {"numerus_roman_to_short_int", "short", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_roman_to_short_int_short},
+    {"numerus_inline_roman_to_short_int", "short", _NUM_BENCH_INLINE, 64,
+     _num_bench_inline_roman_to_short_int_short},
+    {"numerus_roman_to_int_part_and_twelfths_batch", "mixed", _NUM_BENCH_SIMD,
+     64, _num_bench_roman_to_parts_batch_mixed},
+    {"numerus_roman_to_int_part_and_twelfths_batch", "production",
+     _NUM_BENCH_SIMD, 64, _num_bench_roman_to_parts_batch_production},
+#ifndef NUMERUS_NO_MALLOC
+    {"numerus_table_roman_to_int_part_and_twelfths", "mixed",
+     _NUM_BENCH_TABLE, 64, _num_bench_table_roman_to_parts_mixed},
+    {"numerus_table_roman_to_int_part_and_twelfths", "production",
+     _NUM_BENCH_TABLE, 64, _num_bench_table_roman_to_parts_production},
+#endif
+    {"numerus_ext_roman_to_int_part_and_twelfths", "long", _NUM_BENCH_LIBRARY,
+     64, _num_bench_ext_roman_to_parts_long},
+    /* Analysis */
+    {"numerus_is_zero", "mixed", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_is_zero_mixed},
+    {"numerus_is_long_numeral", "mixed", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_is_long_numeral_mixed},
+    {"numerus_is_float_numeral", "mixed", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_is_float_numeral_mixed},
+    {"numerus_sign", "mixed", _NUM_BENCH_LIBRARY, 64, _num_bench_sign_mixed},
+    {"numerus_count_roman_chars", "mixed", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_count_roman_chars_mixed},
+    {"numerus_compare_value", "mixed", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_compare_value_mixed},
+    {"numerus_parts_to_double", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_parts_to_double_float},
+    {"numerus_double_to_parts", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_double_to_parts_float},
+    {"numerus_shorten_and_same_sign_to_parts", "mixed", _NUM_BENCH_LIBRARY,
+     64, _num_bench_shorten_and_same_sign_to_parts_mixed},
+    /* Pretty printing */
+    {"numerus_overline_long_numerals_into", "long", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_overline_long_numerals_into_long},
+    {"numerus_pretty_value_as_double_into", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_pretty_value_as_double_into_float},
+    {"numerus_pretty_value_as_parts_into", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_pretty_value_as_parts_into_float},
+#ifndef NUMERUS_NO_MALLOC
+    {"numerus_overline_long_numerals", "long", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_overline_long_numerals_long},
+    {"numerus_create_pretty_value_as_double", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_create_pretty_value_as_double_float},
+    {"numerus_create_pretty_value_as_parts", "float", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_create_pretty_value_as_parts_float},
+#endif
+    {"numerus_explain_error", "error codes", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_explain_error_codes},
+    {"numerus_format_epoch", "dates", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_format_epoch_dates},
+    {"numerus_format_date", "dates", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_format_date_dates},
+    {"numerus_prefix_value_range", "prefixes", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_prefix_value_range_prefixes},
+    /* Search in the grammar, one call per sample */
+    {"numerus_complete", "prefixes", _NUM_BENCH_LIBRARY, 1,
+     _num_bench_complete_prefixes},
+    {"numerus_suggest", "typos", _NUM_BENCH_LIBRARY, 1,
+     _num_bench_suggest_typos},
+#ifndef NUMERUS_NO_MALLOC
+    /* Packed files, decoding a whole block per call */
+    {"numerus_pack_writer_append", "mixed", _NUM_BENCH_LIBRARY, 64,
+     _num_bench_pack_writer_append_mixed},
+    {"numerus_pack_decode_block", "mixed", _NUM_BENCH_LIBRARY, 1,
+     _num_bench_pack_decode_block_mixed},
+    {"numerus_pack_decode_block_romans", "mixed", _NUM_BENCH_LIBRARY, 1,
+     _num_bench_pack_decode_block_romans_mixed},
+#endif
+};
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   HARDWARE COUNTERS   }-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * @internal
+ * File descriptors of the counters, -1 for the ones the kernel or the CPU
+ * doesn't give, and why the whole group is missing, NULL if it's not.
+ */
+static int _num_bench_counter_fds[_NUM_BENCH_COUNTERS] = {-1, -1, -1, -1};
+static const char *_num_bench_counters_missing = "not enabled";
+
+
+/**
+ * @internal
+ * Calls to malloc(), calloc() and realloc() of the benchmark program,
+ * counted by their wrappers when linked with `--wrap`, as CMakeLists.txt
+ * does on Linux.
+ */
+static uint64_t _num_bench_allocations = 0;
+
+
+#ifdef NUMERUS_BENCH_WRAP_MALLOC
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+
+void *__wrap_malloc(size_t size) {
+    _num_bench_allocations++;
+    return __real_malloc(size);
+}
+
+
+void *__wrap_calloc(size_t count, size_t size) {
+    _num_bench_allocations++;
+    return __real_calloc(count, size);
+}
+
+
+void *__wrap_realloc(void *pointer, size_t size) {
+    _num_bench_allocations++;
+    return __real_realloc(pointer, size);
+}
+#endif
+
+
+#if _NUM_BENCH_PERF
+/**
+ * @internal
+ * Opens a counter of the user space of this thread, disabled, in the group
+ * of the leader or as leader if it's -1.
+ */
+static int _num_bench_open_counter(uint32_t type, uint64_t config,
+                                   int leader) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = leader == -1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+}
+#endif
+
+
+/**
+ * @internal
+ * Opens the group of the counters, leaving them all closed with the reason
+ * in _num_bench_counters_missing if the cycles can't be counted, e.g. with
+ * a restrictive `/proc/sys/kernel/perf_event_paranoid` or in a container.
+ */
+static void _num_bench_open_counters(void) {
+#if _NUM_BENCH_PERF
+    int leader = _num_bench_open_counter(PERF_TYPE_HARDWARE,
+                                         PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (leader < 0) {
+        _num_bench_counters_missing = strerror(errno);
+        return;
+    }
+    _num_bench_counter_fds[0] = leader;
+    _num_bench_counter_fds[1] = _num_bench_open_counter(
+            PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, leader);
+    _num_bench_counter_fds[2] = _num_bench_open_counter(
+            PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, leader);
+    _num_bench_counter_fds[3] = _num_bench_open_counter(
+            PERF_TYPE_HW_CACHE,
+            PERF_COUNT_HW_CACHE_L1D
+            | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16), leader);
+    _num_bench_counters_missing = NULL;
+#else
+    _num_bench_counters_missing = "not supported on this platform";
+#endif
+}
+
+
+/**
+ * @internal
+ * Closes the counters opened by _num_bench_open_counters().
+ */
+static void _num_bench_close_counters(void) {
+#if _NUM_BENCH_PERF
+    for (int i = _NUM_BENCH_COUNTERS - 1; i >= 0; i--) {
+        if (_num_bench_counter_fds[i] >= 0) {
+            close(_num_bench_counter_fds[i]);
+        }
+        _num_bench_counter_fds[i] = -1;
+    }
+#endif
+}
+
+
+/**
+ * @internal
+ * Starts counting from zero with all the counters of the group.
+ */
+static void _num_bench_start_counters(void) {
+#if _NUM_BENCH_PERF
+    if (_num_bench_counters_missing == NULL) {
+        ioctl(_num_bench_counter_fds[0], PERF_EVENT_IOC_RESET,
+              PERF_IOC_FLAG_GROUP);
+        ioctl(_num_bench_counter_fds[0], PERF_EVENT_IOC_ENABLE,
+              PERF_IOC_FLAG_GROUP);
+    }
+#endif
+}
+
+
+/**
+ * @internal
+ * Stops the counters and reads them, UINT64_MAX for the missing ones.
+ */
+static void _num_bench_stop_counters(uint64_t *counts) {
+    for (int i = 0; i < _NUM_BENCH_COUNTERS; i++) {
+        counts[i] = UINT64_MAX;
+    }
+#if _NUM_BENCH_PERF
+    if (_num_bench_counters_missing == NULL) {
+        ioctl(_num_bench_counter_fds[0], PERF_EVENT_IOC_DISABLE,
+              PERF_IOC_FLAG_GROUP);
+        for (int i = 0; i < _NUM_BENCH_COUNTERS; i++) {
+            uint64_t count;
+            if (_num_bench_counter_fds[i] >= 0
+                && read(_num_bench_counter_fds[i], &count, sizeof(count))
+                   == (ssize_t) sizeof(count)) {
+                counts[i] = count;
+            }
+        }
+    }
+#endif
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-+-{   MEASUREMENT   }-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * @internal
+ * Sink of the checksums of the benchmarks.
+ */
+static volatile uint64_t _num_bench_sink;
+
+
+/**
+ * @internal
+ * Nanoseconds samples of the benchmark being run.
+ */
+static double _num_bench_samples[_NUM_BENCH_MAX_SAMPLES];
+
+
+/**
+ * @internal
+ * Current time in nanoseconds from an arbitrary start.
+ */
+static double _num_bench_now(void) {
+#if _NUM_BENCH_MONOTONIC
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec * 1e9 + (double) now.tv_nsec;
+#else
+    return (double) clock() * (1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+
+/**
+ * @internal
+ * Compares two doubles for qsort().
+ */
+static int _num_bench_compare_doubles(const void *a, const void *b) {
+    double x = *(const double *) a;
+    double y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+
+/**
+ * @internal
+ * Value of the sorted samples at a percentile, by the nearest-rank method.
+ */
+static double _num_bench_percentile(const double *sorted, size_t count,
+                                    double percentile) {
+    size_t rank = (size_t) (percentile / 100.0 * (double) count + 0.999999);
+    return sorted[rank == 0 ? 0 : rank - 1];
+}
+
+
+/**
+ * @internal
+ * Median time of reading the clock twice, subtracted from each sample.
+ */
+static double _num_bench_timer_overhead(void) {
+    for (size_t i = 0; i < _NUM_BENCH_SAMPLES_PER_PASS; i++) {
+        double start = _num_bench_now();
+        _num_bench_samples[i] = _num_bench_now() - start;
+    }
+    qsort(_num_bench_samples, _NUM_BENCH_SAMPLES_PER_PASS, sizeof(double),
+          _num_bench_compare_doubles);
+    return _num_bench_percentile(_num_bench_samples,
+                                 _NUM_BENCH_SAMPLES_PER_PASS, 50);
+}
+
+
+/**
+ * @internal
+ * Mean length of the numerals of an input of the benchmarks, 0 for the
+ * inputs which are not numerals.
+ */
+static double _num_bench_mean_chars(const char *input) {
+    char (*romans)[_NUM_BENCH_ROMAN_SIZE] = NULL;
+    if (strcmp(input, "short") == 0) {
+        romans = _num_bench_short_romans;
+    } else if (strcmp(input, "long") == 0) {
+        romans = _num_bench_long_romans;
+    } else if (strcmp(input, "float") == 0) {
+        romans = _num_bench_float_romans;
+    } else if (strcmp(input, "mixed") == 0) {
+        romans = _num_bench_mixed_romans;
+    } else if (strcmp(input, "typos") == 0) {
+        romans = _num_bench_typos;
+    } else {
+        return 0;
+    }
+    size_t chars = 0;
+    for (size_t i = 0; i < _NUM_BENCH_INPUTS; i++) {
+        chars += strlen(romans[i]);
+    }
+    return (double) chars / _NUM_BENCH_INPUTS;
+}
+
+
+/**
+ * @internal
+ * Runs a benchmark again on the same inputs, untimed, counting the events
+ * of the hardware and the allocations, and writes them per call as JSON.
+ *
+ * The branch misses are also given per char of the numerals of the input,
+ * read by the parsers or written by the encoders.
+ */
+static void _num_bench_count(FILE *output, const struct _num_bench *bench,
+                             size_t repetitions) {
+    size_t calls = bench->calls_per_sample;
+    size_t next_input = 0;
+    uint64_t counts[_NUM_BENCH_COUNTERS];
+    uint64_t sum = 0;
+    uint64_t allocations = _num_bench_allocations;
+    _num_bench_start_counters();
+    for (size_t i = 0; i < repetitions * _NUM_BENCH_SAMPLES_PER_PASS; i++) {
+        sum += bench->run(next_input, calls);
+        next_input = (next_input + calls) % _NUM_BENCH_INPUTS;
+    }
+    _num_bench_stop_counters(counts);
+    _num_bench_sink += sum;
+    double total_calls = (double) (repetitions * _NUM_BENCH_SAMPLES_PER_PASS
+                                   * calls);
+#ifdef NUMERUS_BENCH_WRAP_MALLOC
+    fprintf(output, ", \"allocations\": %.2f",
+            (double) (_num_bench_allocations - allocations) / total_calls);
+#else
+    (void) allocations;
+    fprintf(output, ", \"allocations\": null");
+#endif
+    if (_num_bench_counters_missing != NULL) {
+        fprintf(output, ", \"counters\": null");
+        return;
+    }
+    fprintf(output, ", \"counters\": {");
+    for (int i = 0; i < _NUM_BENCH_COUNTERS; i++) {
+        fprintf(output, i == 0 ? "\"%s\": " : ", \"%s\": ",
+                _NUM_BENCH_COUNTER_NAMES[i]);
+        if (counts[i] == UINT64_MAX) {
+            fprintf(output, "null");
+        } else {
+            fprintf(output, "%.2f", (double) counts[i] / total_calls);
+        }
+    }
+    double chars = _num_bench_mean_chars(bench->input);
+    if (chars > 0 && counts[2] != UINT64_MAX) {
+        fprintf(output, ", \"branch_misses_per_char\": %.4f",
+                (double) counts[2] / total_calls / chars);
+    }
+    if (counts[0] != UINT64_MAX && counts[1] != UINT64_MAX && counts[0] > 0) {
+        fprintf(output, ", \"instructions_per_cycle\": %.2f",
+                (double) counts[1] / (double) counts[0]);
+    }
+    fprintf(output, "}");
+}
+
+
+/**
+ * @internal
+ * Runs a benchmark and writes its results as a JSON object.
+ */
+static void _num_bench_run(FILE *output, const struct _num_bench *bench,
+                           const char *backend, size_t repetitions,
+                           double timer_overhead, int first) {
+    size_t calls = bench->calls_per_sample;
+    size_t sample_count = 0;
+    size_t next_input = 0;
+    uint64_t sum = 0;
+    for (size_t pass = 0; pass < _NUM_BENCH_WARMUP_PASSES + repetitions;
+         pass++) {
+        for (size_t i = 0; i < _NUM_BENCH_SAMPLES_PER_PASS; i++) {
+            double start = _num_bench_now();
+            sum += bench->run(next_input, calls);
+            double elapsed = _num_bench_now() - start - timer_overhead;
+            next_input = (next_input + calls) % _NUM_BENCH_INPUTS;
+            if (pass >= _NUM_BENCH_WARMUP_PASSES) {
+                _num_bench_samples[sample_count++] =
+                        (elapsed > 0 ? elapsed : 0) / (double) calls;
+            }
+        }
+    }
+    _num_bench_sink += sum;
+    double total = 0;
+    for (size_t i = 0; i < sample_count; i++) {
+        total += _num_bench_samples[i];
+    }
+    qsort(_num_bench_samples, sample_count, sizeof(double),
+          _num_bench_compare_doubles);
+    fprintf(output,
+            "%s\n    {\"function\": \"%s\", \"input\": \"%s\", "
+            "\"backend\": \"%s\", \"calls_per_sample\": %zu, "
+            "\"samples\": %zu, \"median_ns\": %.2f, \"p99_ns\": %.2f, "
+            "\"mean_ns\": %.2f, \"min_ns\": %.2f",
+            first ? "" : ",", bench->function, bench->input, backend, calls,
+            sample_count,
+            _num_bench_percentile(_num_bench_samples, sample_count, 50),
+            _num_bench_percentile(_num_bench_samples, sample_count, 99),
+            total / (double) sample_count, _num_bench_samples[0]);
+    _num_bench_count(output, bench, repetitions);
+    fprintf(output, "}");
+    fflush(output);
+}
+
+
+/**
+ * @internal
+ * Prints how to call the benchmarks.
+ */
+static int _num_bench_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [--repetitions N] [--seed N] [--filter TEXT]\n"
+            "       [--table path/to/numerus.table] "
+            "[--output path/to/results.json]\n"
+            "       [--no-counters]\n",
+            program);
+    return 1;
+}
+
+
+int main(int argc, char **args) {
+    size_t repetitions = _NUM_BENCH_DEFAULT_REPETITIONS;
+    uint64_t seed = _NUM_BENCH_DEFAULT_SEED;
+    const char *filter = "";
+    const char *table_path = NULL;
+    const char *output_path = NULL;
+    bool counters = true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(args[i], "--no-counters") == 0) {
+            counters = false;
+        } else if (i + 1 == argc) {
+            return _num_bench_usage(args[0]);
+        } else if (strcmp(args[i], "--repetitions") == 0) {
+            repetitions = strtoul(args[++i], NULL, 10);
+        } else if (strcmp(args[i], "--seed") == 0) {
+            seed = strtoull(args[++i], NULL, 10);
+        } else if (strcmp(args[i], "--filter") == 0) {
+            filter = args[++i];
+        } else if (strcmp(args[i], "--table") == 0) {
+            table_path = args[++i];
+        } else if (strcmp(args[i], "--output") == 0) {
+            output_path = args[++i];
+        } else {
+            return _num_bench_usage(args[0]);
+        }
+    }
+    if (repetitions == 0 || repetitions > _NUM_BENCH_MAX_REPETITIONS) {
+        fprintf(stderr, "The repetitions must be within [1, %d]\n",
+                _NUM_BENCH_MAX_REPETITIONS);
+        return 1;
+    }
+#ifndef NUMERUS_NO_MALLOC
+    if (table_path != NULL) {
+        int errcode;
+        _num_bench_table = numerus_open_table_file(table_path, &errcode);
+        if (_num_bench_table == NULL) {
+            fprintf(stderr, "%s: %s\n", table_path,
+                    numerus_explain_error(errcode));
+            return 1;
+        }
+    }
+#else
+    if (table_path != NULL) {
+        fprintf(stderr, "No table file without malloc()\n");
+        return 1;
+    }
+#endif
+    FILE *output = output_path == NULL ? stdout : fopen(output_path, "w");
+    if (output == NULL) {
+        perror(output_path);
+        return 1;
+    }
+    _num_bench_generate_inputs(seed);
+#ifndef NUMERUS_NO_MALLOC
+    int pack_errcode = _num_bench_open_packs();
+    if (pack_errcode != NUMERUS_OK) {
+        fprintf(stderr, "%s: %s\n", _num_bench_pack_path,
+                numerus_explain_error(pack_errcode));
+        _num_bench_close_packs();
+        return 1;
+    }
+#endif
+    int best_level = numerus_simd_level();
+    double timer_overhead = _num_bench_timer_overhead();
+    if (counters) {
+        _num_bench_open_counters();
+        if (_num_bench_counters_missing != NULL) {
+            fprintf(stderr, "No hardware counters, timing only: %s\n",
+                    _num_bench_counters_missing);
+        }
+    }
+    fprintf(output,
+            "{\n  \"seed\": %llu,\n  \"repetitions\": %zu,\n"
+            "  \"warmup_passes\": %d,\n  \"samples_per_pass\": %d,\n"
+            "  \"timer_overhead_ns\": %.2f,\n  \"simd_level\": \"%s\",\n",
+            (unsigned long long) seed, repetitions, _NUM_BENCH_WARMUP_PASSES,
+            _NUM_BENCH_SAMPLES_PER_PASS, timer_overhead,
+            _NUM_BENCH_SIMD_NAMES[best_level]);
+    if (_num_bench_counters_missing == NULL) {
+        fprintf(output, "  \"counters\": \"perf_event_open\",\n");
+    } else {
+        fprintf(output, "  \"counters\": null,\n"
+                        "  \"counters_missing\": \"%s\",\n",
+                _num_bench_counters_missing);
+    }
+#if defined(__VERSION__)
+    fprintf(output, "  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    fprintf(output, "  \"benchmarks\": [");
+    int first = 1;
+    for (size_t i = 0; i < sizeof(_NUM_BENCHES) / sizeof(_NUM_BENCHES[0]);
+         i++) {
+        const struct _num_bench *bench = &_NUM_BENCHES[i];
+        if (strstr(bench->function, filter) == NULL) {
+            continue;
+        }
+        switch (bench->backend) {
+            case _NUM_BENCH_LIBRARY:
+                _num_bench_run(output, bench, "library", repetitions,
+                               timer_overhead, first);
+                break;
+            case _NUM_BENCH_INLINE:
+                _num_bench_run(output, bench, "inline", repetitions,
+                               timer_overhead, first);
+                break;
+            case _NUM_BENCH_TABLE:
+#ifndef NUMERUS_NO_MALLOC
+                if (_num_bench_table == NULL) {
+                    continue;
+                }
+                _num_bench_run(output, bench, "table", repetitions,
+                               timer_overhead, first);
+#endif
+                break;
+            case _NUM_BENCH_SIMD:
+                for (int level = NUMERUS_SIMD_SCALAR; level <= best_level;
+                     level++) {
+                    numerus_set_simd_level(level);
+                    _num_bench_run(output, bench, _NUM_BENCH_SIMD_NAMES[level],
+                                   repetitions, timer_overhead, first);
+                    first = 0;
+                }
+                numerus_set_simd_level(best_level);
+                break;
+        }
+        first = 0;
+    }
+    fprintf(output, "\n  ]\n}\n");
+    _num_bench_close_counters();
+#ifndef NUMERUS_NO_MALLOC
+    numerus_close_table_file(_num_bench_table);
+    _num_bench_close_packs();
+#endif
+    if (output != stdout && fclose(output) != 0) {
+        perror(output_path);
+        return 1;
+    }
+    return 0;
+}
@@ -16,11 +16,19 @@
  * they were written withing the command line interface.
  */
 
+#define _POSIX_C_SOURCE 200809L  /* For `getline()`, `sysconf()` */
+
 #include <stdio.h>   /* For `printf()` */
 #include <stdlib.h>  /* For `malloc()`, `free()`, `strtod()` */
 #include <ctype.h>   /* For `isspace()`, `tolower()` */
 #include <string.h>  /* For `strcmp()` */
 #include "numerus.h"
+#ifndef NUMERUS_NO_MALLOC
+#include <pthread.h> /* For the threads of the `dump` command */
+#include <stdbool.h> /* To use booleans `true` and `false` */
+#include <sys/types.h> /* For `ssize_t` */
+#include <unistd.h>  /* For `sysconf()` */
+#endif
 
 /**
  * @internal
@@ -35,6 +43,37 @@
  */
 #define NUMERUS_STOP_REPL 0
 
+
+/**
+ * @internal
+ * Size of the static line buffer of the CLI when compiled with
+ * NUMERUS_NO_MALLOC. Longer lines are discarded.
+ */
+#define NUMERUS_CLI_LINE_SIZE 128
+
+
+/**
+ * @internal
+ * Number of ranges of integer parts the `dump` command splits the numerals
+ * of each length in, one unit of work of its threads each.
+ */
+#define NUMERUS_CLI_DUMP_RANGES 64
+
+
+/**
+ * @internal
+ * Max number of threads of the `dump` command.
+ */
+#define NUMERUS_CLI_DUMP_MAX_THREADS 64
+
+
+/**
+ * @internal
+ * Size of the slots of the arena of lines the `pack` command parses in
+ * batches. Longer lines can't be numerals and are parsed alone.
+ */
+#define NUMERUS_CLI_PACK_SLOT 64
+
 static const char *PROMPT_TEXT = "numerus> ";
 static const char *WELCOME_TEXT = ""
 "+-----------------+\n"
@@ -62,8 +101,21 @@ static const char *HELP_TEXT = ""
 "              and the pretty printing of values as integer and fractional part\n"
 "?, help       shows this help text\n"
 "info, about   shows version, credits, licence, repository of Numerus\n"
+"dump          writes every roman numeral, one per line, in order of value;\n"
+"              `dump:` followed by a comma separated list of short, long,\n"
+"              float, positive, negative selects the kinds and `length`\n"
+"              groups them by length, e.g. `dump:short,negative,length`\n"
 "exit, quit    ends this shell\n\n"
 ""
+"From the command line only, `-` standing for stdin or stdout:\n\n"
+""
+"pack <text file> <packed file>\n"
+"              packs the roman numerals of a text file, one per line, into\n"
+"              a compact packed file of their values\n"
+"unpack <packed file> <text file>\n"
+"              writes the values of a packed file as roman numerals, one\n"
+"              per line\n\n"
+""
 "We also have: moo, ping, ave.\n";
 static const char *QUIT_TEXT = "Vale!\n";
 static const char *ASCII_TEXT = ""
@@ -77,6 +129,8 @@ static const char *UNKNOWN_COMMAND_TEXT = "Unknown command or wrong roman numera
 static const char *PRETTY_ON_TEXT = "Pretty printing is enabled.\n";
 static const char *PRETTY_OFF_TEXT = "Pretty printing is disabled.\n";
 static int pretty_printing = 0;
+/* Error of the last failed command, returned when given as arguments */
+static int command_errcode = 0;
 
 
 /**
@@ -156,42 +210,38 @@ static short _num_string_is_double_zero(char *zero_as_string) {
  */
 void _num_convert_to_other_form_and_print(char *string) {
     double value;
-    char *roman;
+    char roman[NUMERUS_MAX_LENGTH];
     int errcode;
     /* This check is necessary because strtod() returns 0 in case of errors
      * AND in case finds an actual zero. Duh! */
     if (_num_string_is_double_zero(string)) {
-        printf("%s\n", roman = numerus_double_to_roman(0, NULL));
-        free(roman);
+        numerus_double_to_roman_into(0, roman, NULL);
+        printf("%s\n", roman);
         return;
     }
     value = strtod(string, NULL);
     if (value != 0) {
         /* The string is a double */
-        roman = numerus_double_to_roman(value, &errcode);
+        numerus_double_to_roman_into(value, roman, &errcode);
         if (errcode != NUMERUS_OK) {
             printf("%s\n", numerus_explain_error(errcode));
-            if (errcode != NUMERUS_ERROR_MALLOC_FAIL) {
-                free(roman);
-            }
             return;
         }
         /* Successful conversion */
         if (pretty_printing == 1) {
             /* Enabled pretty printing */
-            char *roman_pretty = numerus_overline_long_numerals(roman, &errcode);
+            char roman_pretty[NUMERUS_MAX_OVERLINED_LENGTH];
+            numerus_overline_long_numerals_into(roman, roman_pretty, &errcode);
             if (errcode != NUMERUS_OK) {
                 printf("%s\n", numerus_explain_error(errcode));
             } else {
                 /* Successful transformed into pretty format */
                 printf("%s\n", roman_pretty);
-                free(roman_pretty);
             }
         } else {
             /* Disabled pretty printing, just print the roman numeral */
             printf("%s\n", roman);
         }
-        free(roman);
         return;
     }
     /* The string is not a double, trying as a roman numeral */
@@ -200,14 +250,9 @@ void _num_convert_to_other_form_and_print(char *string) {
         /* The string is a roman numeral */
         if (pretty_printing == 1) {
             /* Pretty printing enabled */
-            char *pretty_value = numerus_create_pretty_value_as_double(value);
-            if (pretty_value == NULL) {
-                printf("%s\n", numerus_explain_error(NUMERUS_ERROR_MALLOC_FAIL));
-            } else {
-                /* Successful transformed into pretty format */
-                printf("%s\n", pretty_value);
-                free(pretty_value);
-            }
+            char pretty_value[NUMERUS_MAX_PRETTY_VALUE_LENGTH];
+            numerus_pretty_value_as_double_into(value, pretty_value);
+            printf("%s\n", pretty_value);
         } else {
             /* Pretty printing disabled, just print the value */
             printf("%f\n", value);
@@ -219,6 +264,446 @@ void _num_convert_to_other_form_and_print(char *string) {
 }
 
 
+#ifndef NUMERUS_NO_MALLOC
+/**
+ * @internal
+ * One unit of work of the `dump` command: the numerals of some lengths and
+ * of a range of integer parts, written by a thread into its own buffer.
+ */
+struct _num_dump_unit {
+    struct numerus_enum_filter filter;
+    char *text;
+    size_t size;
+    size_t capacity;
+    short failed;
+    short done;
+};
+
+
+/**
+ * @internal
+ * State shared by the threads of the `dump` command. The units are taken in
+ * order by the threads and written in order by the main thread, with at most
+ * `window` units buffered at once.
+ */
+struct _num_dump {
+    struct _num_dump_unit *units;
+    size_t unit_count;
+    size_t next_unit;
+    size_t written_units;
+    size_t window;
+    int order;
+    pthread_mutex_t mutex;
+    pthread_cond_t changed;
+};
+
+
+/**
+ * @internal
+ * Enumeration callback of the `dump` command: appends the numeral and a
+ * newline to the buffer of the unit.
+ */
+static int _num_dump_append(const char *roman, short length, long int_part,
+                            short twelfths, void *context) {
+    struct _num_dump_unit *unit = context;
+    (void) int_part;
+    (void) twelfths;
+    if (unit->size + length + 1 > unit->capacity) {
+        size_t capacity = unit->capacity * 2 + NUMERUS_MAX_LENGTH;
+        char *text = realloc(unit->text, capacity);
+        if (text == NULL) {
+            unit->failed = 1;
+            return 1;
+        }
+        unit->text = text;
+        unit->capacity = capacity;
+    }
+    memcpy(unit->text + unit->size, roman, (size_t) length);
+    unit->size += length;
+    unit->text[unit->size++] = '\n';
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Thread of the `dump` command: enumerates the next units into their buffers
+ * until none is left.
+ */
+static void *_num_dump_thread(void *context) {
+    struct _num_dump *dump = context;
+    pthread_mutex_lock(&dump->mutex);
+    while (dump->next_unit < dump->unit_count) {
+        if (dump->next_unit >= dump->written_units + dump->window) {
+            pthread_cond_wait(&dump->changed, &dump->mutex);
+            continue;
+        }
+        struct _num_dump_unit *unit = &dump->units[dump->next_unit++];
+        pthread_mutex_unlock(&dump->mutex);
+        numerus_enumerate(&unit->filter, dump->order, _num_dump_append, unit);
+        pthread_mutex_lock(&dump->mutex);
+        unit->done = 1;
+        pthread_cond_broadcast(&dump->changed);
+    }
+    pthread_mutex_unlock(&dump->mutex);
+    return NULL;
+}
+
+
+/**
+ * @internal
+ * Parses the options of the `dump` command, after the colon.
+ *
+ * @returns int 0 on success, 1 on unknown options.
+ */
+static int _num_dump_parse_options(char *options, int *kinds, int *order) {
+    int signs = 0;
+    *kinds = 0;
+    *order = NUMERUS_ENUM_BY_VALUE;
+    while (options != NULL && *options != '\0') {
+        char *next = strchr(options, ',');
+        if (next != NULL) {
+            *(next++) = '\0';
+        }
+        if (strcmp(options, "short") == 0) {
+            *kinds |= NUMERUS_ENUM_SHORT;
+        } else if (strcmp(options, "long") == 0) {
+            *kinds |= NUMERUS_ENUM_LONG;
+        } else if (strcmp(options, "float") == 0) {
+            *kinds |= NUMERUS_ENUM_FLOAT;
+        } else if (strcmp(options, "positive") == 0) {
+            signs |= NUMERUS_ENUM_POSITIVE;
+        } else if (strcmp(options, "negative") == 0) {
+            signs |= NUMERUS_ENUM_NEGATIVE;
+        } else if (strcmp(options, "length") == 0) {
+            *order = NUMERUS_ENUM_BY_LENGTH;
+        } else {
+            return 1;
+        }
+        options = next;
+    }
+    if (*kinds == 0) {
+        *kinds = NUMERUS_ENUM_SHORT | NUMERUS_ENUM_LONG | NUMERUS_ENUM_FLOAT;
+    }
+    if (signs == 0) {
+        signs = NUMERUS_ENUM_POSITIVE | NUMERUS_ENUM_NEGATIVE;
+    }
+    *kinds |= signs;
+    return 0;
+}
+
+
+/**
+ * Writes every roman numeral of the kinds selected by the options to stdout,
+ * one per line, listed with numerus_enumerate() by as many threads as the
+ * online CPUs.
+ *
+ * The numerals are split in units of work: one per range of integer parts
+ * in order of value, one per range of integer parts per length in order of
+ * length. Each thread fills the buffer of a unit, the main thread writes the
+ * buffers in order. Errors go to stderr, not to mix with the numerals, and
+ * stop the dump, as a failed write of stdout.
+ *
+ * @param *options comma separated options after `dump:` or NULL.
+ * @returns int NUMERUS_OK or the error code.
+ */
+static int _num_dump(char *options) {
+    struct _num_dump dump;
+    int kinds;
+    if (_num_dump_parse_options(options, &kinds, &dump.order) != 0) {
+        fprintf(stderr, "%s -> %s\n", UNKNOWN_COMMAND_TEXT, options);
+        return NUMERUS_ERROR_GENERIC;
+    }
+    short lengths = dump.order == NUMERUS_ENUM_BY_LENGTH
+                    ? (short) (NUMERUS_MAX_LENGTH - 1) : 1;
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = threads < 1 ? 1 : threads;
+    threads = threads > NUMERUS_CLI_DUMP_MAX_THREADS
+              ? NUMERUS_CLI_DUMP_MAX_THREADS : threads;
+    dump.unit_count = (size_t) lengths * NUMERUS_CLI_DUMP_RANGES;
+    dump.units = calloc(dump.unit_count, sizeof(struct _num_dump_unit));
+    if (dump.units == NULL) {
+        fprintf(stderr, "%s\n",
+                numerus_explain_error(NUMERUS_ERROR_MALLOC_FAIL));
+        return NUMERUS_ERROR_MALLOC_FAIL;
+    }
+    long range_size = (2 * NUMERUS_MAX_LONG_NONFLOAT_VALUE + 1)
+                      / NUMERUS_CLI_DUMP_RANGES + 1;
+    for (size_t i = 0; i < dump.unit_count; i++) {
+        struct numerus_enum_filter *filter = &dump.units[i].filter;
+        long range = (long) (i % NUMERUS_CLI_DUMP_RANGES);
+        numerus_enum_filter_init(filter, kinds);
+        if (dump.order == NUMERUS_ENUM_BY_LENGTH) {
+            filter->min_length = (short) (i / NUMERUS_CLI_DUMP_RANGES + 1);
+            filter->max_length = filter->min_length;
+        }
+        filter->min_int_part = NUMERUS_MIN_LONG_NONFLOAT_VALUE
+                               + range * range_size;
+        filter->max_int_part = filter->min_int_part + range_size - 1;
+    }
+    dump.next_unit = 0;
+    dump.written_units = 0;
+    dump.window = 4 * (size_t) threads;
+    pthread_mutex_init(&dump.mutex, NULL);
+    pthread_cond_init(&dump.changed, NULL);
+    pthread_t thread_ids[NUMERUS_CLI_DUMP_MAX_THREADS];
+    long started = 0;
+    while (started < threads && pthread_create(
+            &thread_ids[started], NULL, _num_dump_thread, &dump) == 0) {
+        started++;
+    }
+    int errcode = NUMERUS_OK;
+    for (size_t i = 0; i < dump.unit_count && errcode == NUMERUS_OK; i++) {
+        struct _num_dump_unit *unit = &dump.units[i];
+        if (started == 0) {
+            /* No threads available: list each unit here before writing it */
+            numerus_enumerate(&unit->filter, dump.order, _num_dump_append,
+                              unit);
+            unit->done = 1;
+        }
+        pthread_mutex_lock(&dump.mutex);
+        while (!unit->done) {
+            pthread_cond_wait(&dump.changed, &dump.mutex);
+        }
+        pthread_mutex_unlock(&dump.mutex);
+        if (unit->failed) {
+            errcode = NUMERUS_ERROR_MALLOC_FAIL;
+            fprintf(stderr, "%s\n", numerus_explain_error(errcode));
+        } else if (fwrite(unit->text, 1, unit->size, stdout) != unit->size
+                   || ferror(stdout)) {
+            errcode = NUMERUS_ERROR_GENERIC;
+            perror("stdout");
+        }
+        free(unit->text);
+        unit->text = NULL;
+        pthread_mutex_lock(&dump.mutex);
+        dump.written_units++;
+        if (errcode != NUMERUS_OK) {
+            /* No more units for the threads: they stop after their own */
+            dump.next_unit = dump.unit_count;
+        }
+        pthread_cond_broadcast(&dump.changed);
+        pthread_mutex_unlock(&dump.mutex);
+    }
+    for (long i = 0; i < started; i++) {
+        pthread_join(thread_ids[i], NULL);
+    }
+    for (size_t i = 0; i < dump.unit_count; i++) {
+        free(dump.units[i].text);  /* Left by a stopped dump */
+    }
+    pthread_cond_destroy(&dump.changed);
+    pthread_mutex_destroy(&dump.mutex);
+    free(dump.units);
+    if (fflush(stdout) != 0 && errcode == NUMERUS_OK) {
+        errcode = NUMERUS_ERROR_GENERIC;
+        perror("stdout");
+    }
+    return errcode;
+}
+
+
+/**
+ * @internal
+ * Parses a batch of lines stored in the slots of an arena and appends their
+ * values to a packed file, up to the first line which is not a valid numeral,
+ * reporting its number and the error on stderr.
+ *
+ * @param *failed_line where to store the number of the reported line.
+ * @returns int NUMERUS_OK or the error code.
+ */
+static int _num_pack_lines(struct numerus_pack_writer *writer, char *slots,
+                           size_t count, size_t first_line, long *int_parts,
+                           short *twelfths, int *errcodes,
+                           size_t *failed_line) {
+    numerus_roman_to_int_part_and_twelfths_batch(
+            slots, NUMERUS_CLI_PACK_SLOT, count, int_parts, twelfths,
+            errcodes);
+    for (size_t i = 0; i < count; i++) {
+        if (errcodes[i] != NUMERUS_OK) {
+            *failed_line = first_line + i;
+            fprintf(stderr, "Line %zu: %s\n", *failed_line,
+                    numerus_explain_error(errcodes[i]));
+            return errcodes[i];
+        }
+        int errcode = numerus_pack_writer_append(writer, int_parts[i],
+                                                 twelfths[i]);
+        if (errcode != NUMERUS_OK) {
+            return errcode;
+        }
+    }
+    return NUMERUS_OK;
+}
+
+
+/**
+ * Packs the roman numerals of a text file, one per line, into a packed file.
+ *
+ * The lines are parsed in batches of NUMERUS_PACK_BLOCK_VALUES with
+ * numerus_roman_to_int_part_and_twelfths_batch(). Stops at the first line
+ * which is not a valid numeral, reporting its number and the error on
+ * stderr, leaving an incomplete packed file.
+ *
+ * @param *text_path path of the text file or "-" for stdin.
+ * @param *pack_path path of the packed file to write.
+ * @returns int NUMERUS_OK or the error code.
+ */
+static int _num_pack(const char *text_path, const char *pack_path) {
+    int errcode;
+    bool from_stdin = strcmp(text_path, "-") == 0;
+    FILE *text = from_stdin ? stdin : fopen(text_path, "r");
+    if (text == NULL) {
+        perror(text_path);
+        return NUMERUS_ERROR_GENERIC;
+    }
+    struct numerus_pack_writer *writer = numerus_pack_writer_open(pack_path,
+                                                                  &errcode);
+    char *slots = calloc(NUMERUS_PACK_BLOCK_VALUES, NUMERUS_CLI_PACK_SLOT);
+    long *int_parts = malloc(NUMERUS_PACK_BLOCK_VALUES * sizeof(long));
+    short *twelfths = malloc(NUMERUS_PACK_BLOCK_VALUES * sizeof(short));
+    int *errcodes = malloc(NUMERUS_PACK_BLOCK_VALUES * sizeof(int));
+    if (writer != NULL && (slots == NULL || int_parts == NULL
+                           || twelfths == NULL || errcodes == NULL)) {
+        errcode = NUMERUS_ERROR_MALLOC_FAIL;
+    }
+    char *line = NULL;
+    size_t line_size = 0;
+    ssize_t length;
+    size_t line_number = 0;
+    size_t failed_line = 0;
+    size_t count = 0;
+    while (writer != NULL && errcode == NUMERUS_OK
+           && (length = getline(&line, &line_size, text)) != -1) {
+        line_number++;
+        while (length > 0
+               && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+            line[--length] = '\0';
+        }
+        bool too_long = length >= NUMERUS_CLI_PACK_SLOT;
+        if (!too_long) {
+            memcpy(slots + count * NUMERUS_CLI_PACK_SLOT, line,
+                   (size_t) length + 1);
+            count++;
+        }
+        if (too_long || count == NUMERUS_PACK_BLOCK_VALUES) {
+            errcode = _num_pack_lines(writer, slots, count,
+                                      line_number + !too_long - count,
+                                      int_parts, twelfths, errcodes,
+                                      &failed_line);
+            count = 0;
+        }
+        if (errcode == NUMERUS_OK && too_long) {
+            /* Parsed alone, just to report the same error as the parser */
+            short line_twelfths;
+            long int_part = numerus_roman_to_int_part_and_twelfths(
+                    line, &line_twelfths, &errcode);
+            if (errcode == NUMERUS_OK) {
+                errcode = numerus_pack_writer_append(writer, int_part,
+                                                     line_twelfths);
+            } else {
+                failed_line = line_number;
+                fprintf(stderr, "Line %zu: %s\n", failed_line,
+                        numerus_explain_error(errcode));
+            }
+        }
+    }
+    if (writer != NULL && errcode == NUMERUS_OK && count > 0) {
+        errcode = _num_pack_lines(writer, slots, count,
+                                  line_number + 1 - count, int_parts,
+                                  twelfths, errcodes, &failed_line);
+    }
+    free(line);
+    free(slots);
+    free(int_parts);
+    free(twelfths);
+    free(errcodes);
+    if (writer != NULL) {
+        int close_errcode = numerus_pack_writer_close(writer);
+        errcode = errcode == NUMERUS_OK ? close_errcode : errcode;
+    }
+    if (!from_stdin) {
+        fclose(text);
+    }
+    if (errcode != NUMERUS_OK && failed_line == 0) {
+        fprintf(stderr, "%s: %s\n", pack_path, numerus_explain_error(errcode));
+    }
+    return errcode;
+}
+
+
+/**
+ * Writes the values of a packed file as roman numerals, one per line.
+ *
+ * Each block is decoded into an arena of numerals, joined into lines and
+ * written with one call.
+ *
+ * @param *pack_path path of the packed file.
+ * @param *text_path path of the text file to write or "-" for stdout.
+ * @returns int NUMERUS_OK or the error code.
+ */
+static int _num_unpack(const char *pack_path, const char *text_path) {
+    int errcode;
+    struct numerus_pack *pack = numerus_pack_open(pack_path, &errcode);
+    if (pack == NULL) {
+        fprintf(stderr, "%s: %s\n", pack_path, numerus_explain_error(errcode));
+        return errcode;
+    }
+    bool to_stdout = strcmp(text_path, "-") == 0;
+    FILE *text = to_stdout ? stdout : fopen(text_path, "w");
+    char *romans = malloc(NUMERUS_PACK_BLOCK_VALUES * NUMERUS_MAX_LENGTH);
+    char *lines = malloc(NUMERUS_PACK_BLOCK_VALUES * NUMERUS_MAX_LENGTH);
+    short *lengths = malloc(NUMERUS_PACK_BLOCK_VALUES * sizeof(short));
+    if (text == NULL) {
+        perror(text_path);
+        errcode = NUMERUS_ERROR_GENERIC;
+    } else if (romans == NULL || lines == NULL || lengths == NULL) {
+        errcode = NUMERUS_ERROR_MALLOC_FAIL;
+        fprintf(stderr, "%s\n", numerus_explain_error(errcode));
+    }
+    for (size_t block = 0; errcode == NUMERUS_OK
+                           && block < numerus_pack_block_count(pack); block++) {
+        size_t count = numerus_pack_decode_block_romans(
+                pack, block, romans, NUMERUS_MAX_LENGTH, lengths);
+        if (count == 0) {
+            /* Value outside the range of its block in a corrupted file */
+            errcode = NUMERUS_ERROR_PACK_FILE;
+            fprintf(stderr, "%s: %s\n", pack_path,
+                    numerus_explain_error(errcode));
+            break;
+        }
+        char *end = lines;
+        for (size_t i = 0; i < count && errcode == NUMERUS_OK; i++) {
+            if (lengths[i] < 0) {
+                /* Value outside the conversion range in a corrupted file */
+                errcode = NUMERUS_ERROR_PACK_FILE;
+                fprintf(stderr, "%s: %s\n", pack_path,
+                        numerus_explain_error(errcode));
+                break;
+            }
+            memcpy(end, romans + i * NUMERUS_MAX_LENGTH, (size_t) lengths[i]);
+            end += lengths[i];
+            *(end++) = '\n';
+        }
+        if (errcode == NUMERUS_OK
+            && fwrite(lines, 1, (size_t) (end - lines), text)
+               != (size_t) (end - lines)) {
+            perror(text_path);
+            errcode = NUMERUS_ERROR_GENERIC;
+        }
+    }
+    if (text != NULL && !to_stdout && fclose(text) != 0
+        && errcode == NUMERUS_OK) {
+        perror(text_path);
+        errcode = NUMERUS_ERROR_GENERIC;
+    }
+    free(romans);
+    free(lines);
+    free(lengths);
+    numerus_pack_close(pack);
+    return errcode;
+}
+#endif /* NUMERUS_NO_MALLOC */
+
+
 /**
  * Parses the already cleaned command and reacts accordingly.
  *
@@ -254,6 +739,16 @@ static int _num_parse_command(char *command) {
     } else if (strcmp(command, "ping") == 0) {
         printf("%s", PING_TEXT);
         return NUMERUS_PROMPT_AGAIN;
+#ifndef NUMERUS_NO_MALLOC
+    } else if (strcmp(command, "dump") == 0) {
+        int errcode = _num_dump(NULL);
+        command_errcode = errcode == NUMERUS_OK ? command_errcode : errcode;
+        return NUMERUS_PROMPT_AGAIN;
+    } else if (strncmp(command, "dump:", 5) == 0) {
+        int errcode = _num_dump(command + 5);
+        command_errcode = errcode == NUMERUS_OK ? command_errcode : errcode;
+        return NUMERUS_PROMPT_AGAIN;
+#endif
     } else if (strcmp(command, "exit") == 0 || strcmp(command, "quit") == 0) {
         printf("%s", QUIT_TEXT);
         return NUMERUS_STOP_REPL;
@@ -279,11 +774,24 @@ static int _num_parse_command(char *command) {
  * @param argc int number of main arguments. Set to 0 to disable parsing of
  * main arguments.
  * @param args array of main arguments to be parsed as commands.
- * @returns int status code: 0 if everything went ok or a NUMERUS_ERROR_*
- * otherwise.
+ * @returns int status code: 0 if everything went ok or the NUMERUS_ERROR_*
+ * of the last failed `dump`, `pack` or `unpack` otherwise.
  */
 int numerus_cli(int argc, char **args) {
     char *command;
+#ifndef NUMERUS_NO_MALLOC
+    /* Subcommands with arguments, not available in the shell */
+    if (argc == 4 && (strcmp(args[1], "pack") == 0
+                      || strcmp(args[1], "unpack") == 0)) {
+        int errcode = strcmp(args[1], "pack") == 0
+                      ? _num_pack(args[2], args[3])
+                      : _num_unpack(args[2], args[3]);
+        return errcode == NUMERUS_OK ? 0 : errcode;
+    }
+#endif
+#ifdef NUMERUS_NO_MALLOC
+    static char line[NUMERUS_CLI_LINE_SIZE];
+#else
     /* line_buffer_size = 50 enough for every command,
      * gets reallocated by getline() if not enough */
     size_t line_buffer_size = 50;
@@ -292,6 +800,7 @@ int numerus_cli(int argc, char **args) {
         numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
         return NUMERUS_ERROR_MALLOC_FAIL;
     }
+#endif
     if (argc > 1) {
         /* Parse main arguments and exit */
         args++;
@@ -309,14 +818,31 @@ int numerus_cli(int argc, char **args) {
         int command_result = NUMERUS_PROMPT_AGAIN;
         while (command_result == NUMERUS_PROMPT_AGAIN) {
             printf("%s", PROMPT_TEXT);
+#ifdef NUMERUS_NO_MALLOC
+            if (fgets(line, NUMERUS_CLI_LINE_SIZE, stdin) == NULL) {
+                break;
+            } else if (strchr(line, '\n') == NULL && !feof(stdin)) {
+                /* Line longer than the buffer: skip the rest of it */
+                int skipped;
+                do {
+                    skipped = getchar();
+                } while (skipped != '\n' && skipped != EOF);
+                printf("%s\n", numerus_explain_error(
+                        NUMERUS_ERROR_TOO_LONG_NUMERAL));
+            }
+#else
             if (getline(&line, &line_buffer_size, stdin) == -1) {
                 break;
-            } else {
+            }
+#endif
+            else {
                 command = _num_get_first_word_trimmed_lowercased(line);
                 command_result = _num_parse_command(command);
             }
         }
     }
+#ifndef NUMERUS_NO_MALLOC
     free(line);
-    return 0;
+#endif
+    return command_errcode;
 }
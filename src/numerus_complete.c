@@ -0,0 +1,332 @@
+/**
+ * @file numerus_complete.c
+ * @brief Numerus completion of prefixes of roman numerals.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the functions listing the valid numerals starting with
+ * a prefix, as an input field autocompleting numerals does, and the range of
+ * values they have.
+ *
+ * Both work on the minimal automaton of the numerals built at build time by
+ * numerus_tables_gen.c from the same dictionary of the parser: a few dozen
+ * states and a few hundred edges, around 3 KiB, each edge weighted with
+ * the value its char adds to the numeral. Each state knows the min and the
+ * max value of the rest of the numerals from it, so the range of a prefix
+ * is a walk of the prefix, and the completions are found in order of value
+ * one at a time, each the smallest one greater than the previous, trying
+ * the most promising edges first and skipping the ones whose range of
+ * values can't contain it.
+ *
+ * The automaton covers the numerals without sign except NUMERUS_ZERO: the
+ * sign is walked apart, negating the values, and NUMERUS_ZERO is handled on
+ * its own.
+ */
+
+#include <string.h>   /* For `memcpy()`, `strlen()`, `strncmp()` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include "numerus_internal.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+
+/**
+ * @internal
+ * Max number of chars of a numeral without sign.
+ */
+#define _NUM_COMPLETE_MAX_DEPTH 36
+
+
+/**
+ * @internal
+ * Max number of edges of a state of the automaton: one per char.
+ */
+#define _NUM_COMPLETE_MAX_EDGES 16
+
+
+/**
+ * @internal
+ * Prefix of a numeral walked on the automaton.
+ */
+struct _num_complete_prefix {
+    bool negative;
+    bool matches_zero;  /* The prefix is a prefix of NUMERUS_ZERO */
+    short state;        /* -1 if no numeral without sign starts with it */
+    long value;         /* Sum of the weights of the prefix, in twelfths */
+    short length;       /* Of the uppercase prefix without sign */
+    char chars[_NUM_COMPLETE_MAX_DEPTH + 1];
+};
+
+
+/**
+ * @internal
+ * Search of the next completion of a prefix: the numeral with the smallest
+ * (or largest) value strictly between `lower` and `upper`.
+ */
+struct _num_complete_search {
+    bool ascending;
+    long lower;
+    long upper;
+    bool found;
+    long best_value;
+    short best_length;
+    char best[_NUM_COMPLETE_MAX_DEPTH + 1];
+    char path[_NUM_COMPLETE_MAX_DEPTH + 1];
+};
+
+
+/**
+ * @internal
+ * Walks a prefix on the automaton from its root, after the optional minus
+ * sign, accepting lowercase chars too.
+ *
+ * @returns true if the prefix is not too long to be a prefix of a numeral.
+ */
+static bool _num_complete_walk_prefix(const char *prefix,
+                                      struct _num_complete_prefix *walked) {
+    walked->negative = *prefix == '-';
+    if (walked->negative) {
+        prefix++;
+    }
+    size_t length = strlen(prefix);
+    if (length > _NUM_COMPLETE_MAX_DEPTH) {
+        return false;
+    }
+    walked->length = (short) length;
+    walked->state = 0;
+    walked->value = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = prefix[i];
+        if (c >= 'a' && c <= 'z') {
+            c = (char) (c - 'a' + 'A');
+        }
+        walked->chars[i] = c;
+        int next = -1;
+        if (walked->state >= 0) {
+            for (int edge = _NUM_DAWG_FIRST_EDGES[walked->state];
+                 edge < _NUM_DAWG_FIRST_EDGES[walked->state + 1]; edge++) {
+                if (_NUM_DAWG_EDGE_CHARS[edge] == c) {
+                    next = _NUM_DAWG_EDGE_TARGETS[edge];
+                    walked->value += _NUM_DAWG_EDGE_WEIGHTS[edge];
+                    break;
+                }
+            }
+        }
+        walked->state = (short) next;
+    }
+    walked->chars[length] = '\0';
+    walked->matches_zero = !walked->negative
+                           && strncmp(walked->chars, NUMERUS_ZERO, length) == 0;
+    return true;
+}
+
+
+/**
+ * @internal
+ * Searches the completion from a state with the smallest value greater than
+ * `lower` (or the largest smaller than `upper`, descending), writing its
+ * chars after the state in the search.
+ */
+static void _num_complete_search(struct _num_complete_search *search,
+                                 int state, long value, short depth) {
+    if (_NUM_DAWG_ACCEPTING[state] && value > search->lower
+        && value < search->upper
+        && (!search->found || (search->ascending ? value < search->best_value
+                                                 : value > search->best_value))) {
+        search->found = true;
+        search->best_value = value;
+        search->best_length = depth;
+        memcpy(search->best, search->path, (size_t) depth);
+    }
+    /* Edges sorted by their most promising value, tried in that order */
+    int edges[_NUM_COMPLETE_MAX_EDGES];
+    long bounds[_NUM_COMPLETE_MAX_EDGES];
+    int edge_count = 0;
+    for (int edge = _NUM_DAWG_FIRST_EDGES[state];
+         edge < _NUM_DAWG_FIRST_EDGES[state + 1]; edge++) {
+        int target = _NUM_DAWG_EDGE_TARGETS[edge];
+        long edge_value = value + _NUM_DAWG_EDGE_WEIGHTS[edge];
+        long min_value = edge_value + _NUM_DAWG_MIN_VALUES[target];
+        long max_value = edge_value + _NUM_DAWG_MAX_VALUES[target];
+        if (max_value <= search->lower || min_value >= search->upper) {
+            continue;
+        }
+        long bound = search->ascending ? min_value : -max_value;
+        int i = edge_count++;
+        while (i > 0 && bounds[i - 1] > bound) {
+            edges[i] = edges[i - 1];
+            bounds[i] = bounds[i - 1];
+            i--;
+        }
+        edges[i] = edge;
+        bounds[i] = bound;
+    }
+    for (int i = 0; i < edge_count; i++) {
+        /* Stops at the first edge with no value better than the best one */
+        if (search->found && bounds[i] >= (search->ascending
+                                           ? search->best_value
+                                           : -search->best_value)) {
+            break;
+        }
+        search->path[depth] = _NUM_DAWG_EDGE_CHARS[edges[i]];
+        _num_complete_search(search, _NUM_DAWG_EDGE_TARGETS[edges[i]],
+                             value + _NUM_DAWG_EDGE_WEIGHTS[edges[i]],
+                             (short) (depth + 1));
+    }
+}
+
+
+/**
+ * @internal
+ * Writes a completion made of sign, prefix and rest into a slot.
+ */
+static void _num_complete_write(char *completion,
+                                const struct _num_complete_prefix *walked,
+                                const char *rest, short rest_length) {
+    if (walked->negative) {
+        *(completion++) = '-';
+    }
+    memcpy(completion, walked->chars, (size_t) walked->length);
+    completion += walked->length;
+    memcpy(completion, rest, (size_t) rest_length);
+    completion[rest_length] = '\0';
+}
+
+
+/**
+ * @internal
+ * Writes the completions of a walked prefix with one sign, in order of
+ * value, into the free slots.
+ *
+ * @returns size_t number of completions written.
+ */
+static size_t _num_complete_sign(const struct _num_complete_prefix *walked,
+                                 char *completions, size_t n) {
+    size_t written = 0;
+    if (walked->matches_zero && written < n) {
+        /* NUMERUS_ZERO is the smallest numeral without minus */
+        size_t zero_length = strlen(NUMERUS_ZERO);
+        memcpy(completions, NUMERUS_ZERO, zero_length + 1);
+        written++;
+    }
+    if (walked->state < 0) {
+        return written;
+    }
+    struct _num_complete_search search;
+    /* The values of negative numerals decrease as the ones without sign grow */
+    search.ascending = !walked->negative;
+    search.lower = -1;
+    search.upper = NUMERUS_MAX_LONG_NONFLOAT_VALUE * 12 + 12;
+    while (written < n) {
+        search.found = false;
+        _num_complete_search(&search, walked->state, walked->value, 0);
+        if (!search.found) {
+            break;
+        }
+        _num_complete_write(completions + written * NUMERUS_MAX_LENGTH,
+                            walked, search.best, search.best_length);
+        written++;
+        if (search.ascending) {
+            search.lower = search.best_value;
+        } else {
+            search.upper = search.best_value;
+        }
+    }
+    return written;
+}
+
+
+/**
+ * Lists the valid roman numerals starting with a prefix, in ascending order
+ * of value, as an input field autocompleting numerals would show them.
+ *
+ * The prefix may be in lowercase, the numerals are written in uppercase, as
+ * numerus_int_with_twelfth_to_roman() writes them. An empty prefix lists the
+ * numerals from the most negative one, a prefix of "-" only the negative
+ * ones. A prefix which is already a valid numeral lists itself among the
+ * others.
+ *
+ * Each completion costs a search on the minimal automaton of the numerals
+ * skipping the branches whose values can't be the next one, usually under a
+ * microsecond, without heap allocations and without touching
+ * numerus_error_code, so different threads may complete different prefixes
+ * at the same time.
+ *
+ * @param *prefix null-terminated prefix of the numerals.
+ * @param *completions arena of `n` slots of NUMERUS_MAX_LENGTH chars where to
+ * write the null-terminated numerals, the i-th at
+ * `completions + i * NUMERUS_MAX_LENGTH`.
+ * @param n max number of numerals to write.
+ * @returns size_t number of numerals written, 0 if no numeral starts with the
+ * prefix.
+ */
+size_t numerus_complete(const char *prefix, char *completions, size_t n) {
+    struct _num_complete_prefix walked;
+    size_t written = 0;
+    if (!_num_complete_walk_prefix(prefix, &walked)) {
+        return 0;
+    }
+    if (*prefix == '\0') {
+        /* Negative numerals first, then the others */
+        walked.negative = true;
+        walked.matches_zero = false;
+        written = _num_complete_sign(&walked, completions, n);
+        walked.negative = false;
+        walked.matches_zero = true;
+    }
+    return written + _num_complete_sign(
+            &walked, completions + written * NUMERUS_MAX_LENGTH, n - written);
+}
+
+
+/**
+ * Finds the min and the max value of the valid roman numerals starting with
+ * a prefix.
+ *
+ * The prefix may be in lowercase. An empty prefix gives the whole range of
+ * values, a prefix of "-" the negative values.
+ *
+ * Like numerus_complete(), it's a walk of the prefix on the minimal automaton
+ * of the numerals and doesn't touch numerus_error_code.
+ *
+ * @param *prefix null-terminated prefix of the numerals.
+ * @param *min_value where to store the smallest value of the numerals starting
+ * with the prefix, in the format of numerus_parts_to_double().
+ * @param *max_value where to store the largest value of the numerals starting
+ * with the prefix.
+ * @returns short 1 if some numeral starts with the prefix, 0 otherwise,
+ * leaving the values untouched.
+ */
+short numerus_prefix_value_range(const char *prefix, double *min_value,
+                                 double *max_value) {
+    struct _num_complete_prefix walked;
+    long min_twelfths;
+    long max_twelfths;
+    if (!_num_complete_walk_prefix(prefix, &walked)
+        || (walked.state < 0 && !walked.matches_zero)) {
+        return 0;
+    }
+    if (walked.state < 0) {
+        min_twelfths = 0;
+        max_twelfths = 0;
+    } else {
+        min_twelfths = walked.value + _NUM_DAWG_MIN_VALUES[walked.state];
+        max_twelfths = walked.value + _NUM_DAWG_MAX_VALUES[walked.state];
+        if (walked.matches_zero) {
+            min_twelfths = 0;
+        }
+    }
+    if (*prefix == '\0') {
+        min_twelfths = -max_twelfths;
+    } else if (walked.negative) {
+        long negated_min = -max_twelfths;
+        max_twelfths = -min_twelfths;
+        min_twelfths = negated_min;
+    }
+    *min_value = numerus_parts_to_double(min_twelfths / 12,
+                                         (short) (min_twelfths % 12));
+    *max_value = numerus_parts_to_double(max_twelfths / 12,
+                                         (short) (max_twelfths % 12));
+    return 1;
+}
@@ -12,11 +12,17 @@
  * on the numerals or to convert some values in other formats.
  */
 
-#include <ctype.h>    /* For `isspace()` */
+#include <ctype.h>    /* For `isspace()`, `toupper()` */
 #include <stdlib.h>   /* For `malloc()` */
-#include <string.h>   /* For `strlen()`, `strncasecmp()`, `strcpy()` */
+#include <string.h>   /* For `strlen()`, `strncasecmp()`, `strcpy()`, `memcpy()` */
 #include <stdbool.h>  /* To use booleans `true` and `false` */
 #include "numerus_internal.h"
+#include "numerus_dictionary.h"
+/* numerus_tables_gen.c is linked with this file built with
+ * NUMERUS_TABLES_BOOTSTRAP, before the tables exist, to check them */
+#ifndef NUMERUS_TABLES_BOOTSTRAP
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+#endif
 
 
 
@@ -76,6 +82,22 @@ const double NUMERUS_MAX_NONLONG_FLOAT_VALUE = 3999 + 11.5 / 12.0;
 const double NUMERUS_MIN_NONLONG_FLOAT_VALUE = -NUMERUS_MAX_NONLONG_FLOAT_VALUE;
 
 
+/**
+ * The maximum value a roman numeral without underscores and without decimals
+ * may have, the upper limit of the short numeral conversions.
+ */
+const short NUMERUS_MAX_SHORT_VALUE = 3999;
+
+
+/**
+ * The minimum value a roman numeral without underscores and without decimals
+ * may have.
+ *
+ * It's the opposite of NUMERUS_MAX_SHORT_VALUE.
+ */
+const short NUMERUS_MIN_SHORT_VALUE = -3999;
+
+
 /**
  * The roman numeral of value 0 (zero).
  *
@@ -93,58 +115,40 @@ const char *NUMERUS_ZERO = "NULLA";
 const short int NUMERUS_MAX_LENGTH = 37;
 
 
-
-/*  -+-+-+-+-+-+-+-+-{   VARIABLES and DATA STRUCTURES   }-+-+-+-+-+-+-+-+-  */
+/**
+ * The maximum length the overlined version of a roman numeral written by
+ * numerus_overline_long_numerals_into() may have, including '\0'.
+ *
+ * Two lines of at most NUMERUS_MAX_LENGTH + 1 roman chars each, the '\n'
+ * between them and the '\0'.
+ */
+const short int NUMERUS_MAX_OVERLINED_LENGTH = 2 * (37 + 1) + 2;
 
 
 /**
- * The global error code variable to store any errors during conversions.
+ * The maximum length a pretty-printed value written by
+ * numerus_pretty_value_as_parts_into() may have, including '\0'.
  *
- * It may contain any of the NUMERUS_ERROR_* error codes or NUMERUS_OK.
+ * The value `"-9223372036854775808, -11/12"` + `\0` is a string long
+ * 28+1 = 29 chars.
  */
-int numerus_error_code = NUMERUS_OK;
+const short int NUMERUS_MAX_PRETTY_VALUE_LENGTH = 29;
+
+
+
+/*  -+-+-+-+-+-+-+-+-{   VARIABLES and DATA STRUCTURES   }-+-+-+-+-+-+-+-+-  */
 
 
 /**
- * @internal
- * Struct containing a basic roman char, its integer value and the maximum
- * consecutive repetitions of it that a roman numeral may have.
+ * The global error code variable to store any errors during conversions.
  *
- * It's used to create the _NUM_DICTIONARY dictionary which in turn is used by
- * conversion functions.
+ * It may contain any of the NUMERUS_ERROR_* error codes or NUMERUS_OK.
+ * Each thread has its own, with the compilers supporting thread-local
+ * variables, so threads converting at once don't race on it.
  */
-struct _num_dictionary_char {
-    const int value;
-    const char *characters;
-    const short max_repetitions;
-};
+NUMERUS_THREAD_LOCAL int numerus_error_code = NUMERUS_OK;
 
 
-/**
- * Dictionary of a priori known roman chars, their values and repetitions used
- * by conversion functions.
- *
- * The last value is a terminator, to be used by conversion functions to
- * understand that the array has been parsed.
- */
-static const struct _num_dictionary_char _NUM_DICTIONARY[] = {
-    { 1000, "M" ,  3 }, // index: 0
-    {  900, "CM",  1 }, // index: 1
-    {  500, "D" ,  1 }, // index: 2
-    {  400, "CD",  1 }, // index: 3
-    {  100, "C" ,  3 }, // index: 4
-    {   90, "XC",  1 }, // index: 5
-    {   50, "L" ,  1 }, // index: 6
-    {   40, "XL",  1 }, // index: 7
-    {   10, "X" ,  3 }, // index: 8
-    {    9, "IX",  1 }, // index: 9
-    {    5, "V" ,  1 }, // index: 10
-    {    4, "IV",  1 }, // index: 11
-    {    1, "I" ,  3 }, // index: 12
-    {    6, "S" ,  1 }, // index: 13
-    {    1, "." ,  5 }, // index: 14
-    {    0, NULL,  0 }  // index: 15
-};
 
 
 /**
@@ -511,60 +515,23 @@ long numerus_roman_to_int(char *roman, int *errcode) {
 
 
 /**
- * Converts a roman numeral to its value expressed as pair of its integer part
- * and number of twelfths.
+ * Parses a roman numeral already checked for illegal characters and length by
+ * _num_count_roman_chars(), without touching numerus_error_code.
  *
- * Accepts many variations of roman numerals:
- *
- * - it's case INsensitive
- * - accepts negative roman numerals (with leading minus '-')
- * - accepts long roman numerals (with character between underscores to denote
- *   the part that has a value multiplied by 1000)
- * - accepts decimal value of the roman numerals, those are twelfths (with
- *   the characters 'S' and dot '.')
- * - all combinations of the above
- *
- * The parsing status of the roman numeral (any kind of wrong syntax)
- * is stored in the errcode passed as parameter, which can be NULL to ignore
- * the error, although it's not recommended. If the the error code is different
- * than NUMERUS_OK, an error occurred during the conversion and the returned
- * value is outside the possible range of values of roman numerals.
- * The error code may help find the specific error.
- *
- * The number of twelfths is stored in the passed parameter, while the integer
- * part is returned directly.
- *
- * @param *roman string with a roman numeral
+ * @param *roman string with a roman numeral, with legal characters only.
+ * @param *twelfths number of twelfths from 0 to 11. Can NOT be NULL.
  * @param *errcode int where to store the conversion status: NUMERUS_OK or any
- * other error. Can be NULL to ignore the error (NOT recommended).
- * @param *twelfths number of twelfths from 0 to 11. NULL is interpreted as 0
- * twelfths.
+ * other error. Can NOT be NULL.
  * @returns long as the integer part of the value of the roman numeral or a
  * value outside the the possible range of values when an error occurs.
  */
-long numerus_roman_to_int_part_and_twelfths(char *roman, short *twelfths,
-                                            int *errcode) {
+long _num_parse_checked_numeral(char *roman, short *twelfths, int *errcode) {
     /* Prepare variables */
     long int_part;
     int response_code;
-    short zero_twelfths = 0;
-    if (twelfths == NULL) {
-        twelfths = &zero_twelfths;
-    }
-    if (errcode == NULL) {
-        errcode = &numerus_error_code;
-    }
     struct _num_numeral_parser_data parser_data;
     _num_init_parser_data(&parser_data, roman);
 
-    /* Check for illegal symbols or length */
-    numerus_count_roman_chars(roman, &response_code);
-    if (response_code != NUMERUS_OK) {
-        numerus_error_code = response_code;
-        *errcode = response_code;
-        return NUMERUS_MAX_LONG_NONFLOAT_VALUE + 10;
-    }
-
     /* Skip initial whitespace */
     while (isspace(*roman)) {
         roman++;
@@ -574,7 +541,6 @@ long numerus_roman_to_int_part_and_twelfths(char *roman, short *twelfths,
     if (_num_is_zero(roman)) {
         int_part = 0;
         *twelfths = 0;
-        numerus_error_code = NUMERUS_OK;
         *errcode = NUMERUS_OK;
         return int_part;
     }
@@ -591,7 +557,6 @@ long numerus_roman_to_int_part_and_twelfths(char *roman, short *twelfths,
     if (parser_data.numeral_is_long) {
         response_code = _num_parse_part_in_underscores(&parser_data);
         if (response_code != NUMERUS_OK) {
-            numerus_error_code = response_code;
             *errcode = response_code;
             return NUMERUS_MAX_LONG_NONFLOAT_VALUE + 10;
         }
@@ -602,24 +567,95 @@ long numerus_roman_to_int_part_and_twelfths(char *roman, short *twelfths,
     }
     response_code = _num_parse_part_after_underscores(&parser_data);
     if (response_code != NUMERUS_OK) {
-        numerus_error_code = response_code;
         *errcode = response_code;
         return NUMERUS_MAX_LONG_NONFLOAT_VALUE + 10;
     }
     response_code = _num_parse_decimal_part(&parser_data);
     if (response_code != NUMERUS_OK) {
-        numerus_error_code = response_code;
         *errcode = response_code;
         return NUMERUS_MAX_LONG_NONFLOAT_VALUE + 10;
     }
     int_part = parser_data.numeral_sign * parser_data.int_part;
     *twelfths = parser_data.numeral_sign * parser_data.twelfths;
-    numerus_error_code = NUMERUS_OK;
     *errcode = NUMERUS_OK;
     return int_part;
 }
 
 
+/**
+ * Converts a roman numeral to its value expressed as pair of its integer part
+ * and number of twelfths, like numerus_roman_to_int_part_and_twelfths(),
+ * without touching numerus_error_code.
+ *
+ * Being re-entrant, it's the one used by the batch conversions, which may run
+ * on multiple threads at once.
+ *
+ * @param *roman string with a roman numeral
+ * @param *twelfths number of twelfths from 0 to 11. Can NOT be NULL.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can NOT be NULL.
+ * @returns long as the integer part of the value of the roman numeral or a
+ * value outside the the possible range of values when an error occurs.
+ */
+static long _num_roman_to_int_part_and_twelfths(char *roman, short *twelfths,
+                                                int *errcode) {
+    /* Check for illegal symbols or length */
+    _num_count_roman_chars(roman, errcode);
+    if (*errcode != NUMERUS_OK) {
+        return NUMERUS_MAX_LONG_NONFLOAT_VALUE + 10;
+    }
+    return _num_parse_checked_numeral(roman, twelfths, errcode);
+}
+
+
+/**
+ * Converts a roman numeral to its value expressed as pair of its integer part
+ * and number of twelfths.
+ *
+ * Accepts many variations of roman numerals:
+ *
+ * - it's case INsensitive
+ * - accepts negative roman numerals (with leading minus '-')
+ * - accepts long roman numerals (with character between underscores to denote
+ *   the part that has a value multiplied by 1000)
+ * - accepts decimal value of the roman numerals, those are twelfths (with
+ *   the characters 'S' and dot '.')
+ * - all combinations of the above
+ *
+ * The parsing status of the roman numeral (any kind of wrong syntax)
+ * is stored in the errcode passed as parameter, which can be NULL to ignore
+ * the error, although it's not recommended. If the the error code is different
+ * than NUMERUS_OK, an error occurred during the conversion and the returned
+ * value is outside the possible range of values of roman numerals.
+ * The error code may help find the specific error.
+ *
+ * The number of twelfths is stored in the passed parameter, while the integer
+ * part is returned directly.
+ *
+ * @param *roman string with a roman numeral
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @param *twelfths number of twelfths from 0 to 11. NULL is interpreted as 0
+ * twelfths.
+ * @returns long as the integer part of the value of the roman numeral or a
+ * value outside the the possible range of values when an error occurs.
+ */
+long numerus_roman_to_int_part_and_twelfths(char *roman, short *twelfths,
+                                            int *errcode) {
+    short zero_twelfths = 0;
+    if (twelfths == NULL) {
+        twelfths = &zero_twelfths;
+    }
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    long int_part = _num_roman_to_int_part_and_twelfths(roman, twelfths,
+                                                        errcode);
+    numerus_error_code = *errcode;
+    return int_part;
+}
+
+
 
 /*  -+-+-+-+-+-+-+-+-+-{   CONVERSION VALUE -> ROMAN   }-+-+-+-+-+-+-+-+-+-  */
 
@@ -652,7 +688,7 @@ static char *_num_copy_char_from_dictionary(const char *source,
  *
  * Appends the generated numeral to the passed position in the roman string,
  * already allocated. Starts comparing the values with the specified dictionary
- * char.
+ * char. Shared with numerus_tables_gen.c, which checks the tables against it.
  *
  * @param value long to be converted to a roman numeral
  * @param *roman string where to add the generated roman numral
@@ -660,8 +696,8 @@ static char *_num_copy_char_from_dictionary(const char *source,
  * starting dictionary entry to compare the characters with
  * @returns position after the inserted string
  */
-static char *_num_value_part_to_roman(long value, char *roman,
-                                      int dictionary_start_char) {
+char *_num_value_part_to_roman(long value, char *roman,
+                               int dictionary_start_char) {
 
     const struct _num_dictionary_char *current_dictionary_char
             = &_NUM_DICTIONARY[dictionary_start_char];
@@ -677,6 +713,31 @@ static char *_num_value_part_to_roman(long value, char *roman,
 }
 
 
+/**
+ * Computes the number of chars _num_value_part_to_roman() would write for
+ * the same value and starting dictionary char, without writing them.
+ *
+ * @param value long to be converted to a roman numeral
+ * @param dictionary_start_char int index of the dictionary to specify the
+ * starting dictionary entry to compare the characters with
+ * @returns short number of chars of the part of the roman numeral
+ */
+static short _num_value_part_length(long value, int dictionary_start_char) {
+    const struct _num_dictionary_char *current_dictionary_char
+            = &_NUM_DICTIONARY[dictionary_start_char];
+    short length = 0;
+    while (value > 0) {
+        while (value >= current_dictionary_char->value) {
+            length += (short) strlen(current_dictionary_char->characters);
+            value -= current_dictionary_char->value;
+        }
+        current_dictionary_char++;
+    }
+    return length;
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
 /**
  * Converts a long integer value to a roman numeral with its value.
  *
@@ -728,64 +789,102 @@ char *numerus_double_to_roman(double double_value, int *errcode) {
     long int_part = numerus_double_to_parts(double_value, &twelfths);
     return numerus_int_with_twelfth_to_roman(int_part, twelfths, errcode);
 }
+#endif /* NUMERUS_NO_MALLOC */
 
 
 /**
- * Converts an integer value and a number of twelfths to a roman numeral with
- * their sum as value.
+ * Converts a long integer value to a roman numeral with its value, written into
+ * a buffer provided by the caller.
  *
- * Accepts any pair of integer value and twelfths so that their sum is within
- * [NUMERUS_MAX_VALUE, NUMERUS_MIN_VALUE].
+ * Accepts any long within
+ * [NUMERUS_MAX_LONG_NONFLOAT_VALUE, NUMERUS_MIN_LONG_NONFLOAT_VALUE].
  *
- * Remember to free() the roman numeral when it's not useful anymore.
+ * Performs no allocation: the buffer must have room for at least
+ * NUMERUS_MAX_LENGTH chars, including the '\0'.
  *
- * The conversion status is stored in the errcode passed as parameter, which
- * can be NULL to ignore the error, although it's not recommended. If the the
- * error code is different than NUMERUS_OK, an error occurred during the
- * conversion and the returned string is NULL. The error code may help find the
- * specific error.
+ * @param int_value long integer to be converted to roman numeral.
+ * @param *roman buffer of at least NUMERUS_MAX_LENGTH chars where to write the
+ * null-terminated roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the written roman numeral, excluding '\0', or -1
+ * when an error occurs.
+ * @see numerus_int_with_twelfth_to_roman_into()
+ */
+short numerus_int_to_roman_into(long int_value, char *roman, int *errcode) {
+    return numerus_int_with_twelfth_to_roman_into(int_value, 0, roman, errcode);
+}
+
+
+/**
+ * Converts a double value to a roman numeral with its value, written into
+ * a buffer provided by the caller.
+ *
+ * Accepts any long within [NUMERUS_MAX_VALUE, NUMERUS_MIN_VALUE]. The decimal
+ * part of the value is also converted.
+ *
+ * Performs no allocation: the buffer must have room for at least
+ * NUMERUS_MAX_LENGTH chars, including the '\0'.
+ *
+ * @param double_value double precision floating point value to be converted to
+ * roman numeral.
+ * @param *roman buffer of at least NUMERUS_MAX_LENGTH chars where to write the
+ * null-terminated roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the written roman numeral, excluding '\0', or -1
+ * when an error occurs.
+ * @see numerus_int_with_twelfth_to_roman_into()
+ */
+short numerus_double_to_roman_into(double double_value, char *roman,
+                                   int *errcode) {
+    short twelfths;
+    long int_part = numerus_double_to_parts(double_value, &twelfths);
+    return numerus_int_with_twelfth_to_roman_into(int_part, twelfths, roman,
+                                                  errcode);
+}
+
+
+/**
+ * Converts an integer value and a number of twelfths to a roman numeral
+ * written into a buffer, like numerus_int_with_twelfth_to_roman_into(),
+ * without touching numerus_error_code.
+ *
+ * Being re-entrant, it's the one used by the batch conversions, which may run
+ * on multiple threads at once.
  *
  * @param int_part long integer part of a value to be added to the twelfths
  * and converted to roman numeral.
  * @param twelfths short integer as number of twelfths (1/12) to be added to the
  * integer part and converted to roman numeral.
+ * @param *roman buffer of at least NUMERUS_MAX_LENGTH chars where to write the
+ * null-terminated roman numeral.
  * @param *errcode int where to store the conversion status: NUMERUS_OK or any
- * other error. Can be NULL to ignore the error (NOT recommended).
- * @returns char* a string containing the roman numeral or NULL when an error
- * occurs.
+ * other error. Can NOT be NULL.
+ * @returns short length of the written roman numeral, excluding '\0', or -1
+ * when an error occurs.
  */
-char *numerus_int_with_twelfth_to_roman(long int_part, short twelfths,
-                                        int *errcode) {
+static short _num_int_with_twelfth_to_roman_into(long int_part,
+                                                short twelfths, char *roman,
+                                                int *errcode) {
 
     /* Prepare variables */
     numerus_shorten_and_same_sign_to_parts(&int_part, &twelfths);
     double double_value = numerus_parts_to_double(int_part, twelfths);
-    if (errcode == NULL) {
-        errcode = &numerus_error_code;
-    }
+    char *roman_numeral = roman;
 
     /* Out of range check */
     if (double_value < NUMERUS_MIN_VALUE || double_value > NUMERUS_MAX_VALUE) {
-        numerus_error_code = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        *roman = '\0';
         *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
-        return NULL;
+        return -1;
     }
 
-    /* Create pointer to the building buffer */
-    char building_buffer[NUMERUS_MAX_LENGTH];
-    char *roman_numeral = building_buffer;
-
     /* Save sign or return NUMERUS_ZERO for 0 */
     if (int_part == 0 && twelfths == 0) {
-        /* Return writable copy of NUMERUS_ZERO on the heap */
-        char *zero_string = malloc(strlen(NUMERUS_ZERO) + 1);
-        if (zero_string == NULL) {
-            numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
-            *errcode = NUMERUS_ERROR_MALLOC_FAIL;
-            return NULL;
-        }
-        strcpy(zero_string, NUMERUS_ZERO);
-        return zero_string;
+        strcpy(roman, NUMERUS_ZERO);
+        *errcode = NUMERUS_OK;
+        return (short) strlen(NUMERUS_ZERO);
     } else if (int_part < 0 || (int_part == 0 && twelfths < 0)) {
         int_part = ABS(int_part);
         twelfths = ABS(twelfths);
@@ -809,18 +908,607 @@ char *numerus_int_with_twelfth_to_roman(long int_part, short twelfths,
     }
     /* Decimal part, starting with "S" char */
     roman_numeral = _num_value_part_to_roman(twelfths, roman_numeral, 13);
-    *(roman_numeral++) = '\0';
+    *roman_numeral = '\0';
+    *errcode = NUMERUS_OK;
+    return (short) (roman_numeral - roman);
+}
+
+
+/**
+ * Converts an integer value and a number of twelfths to a roman numeral with
+ * their sum as value, written into a buffer provided by the caller.
+ *
+ * Accepts any pair of integer value and twelfths so that their sum is within
+ * [NUMERUS_MAX_VALUE, NUMERUS_MIN_VALUE].
+ *
+ * Performs no allocation: the buffer must have room for at least
+ * NUMERUS_MAX_LENGTH chars, including the '\0'. This is the conversion all
+ * other value to roman numeral conversions are built on.
+ *
+ * The conversion status is stored in the errcode passed as parameter, which
+ * can be NULL to ignore the error, although it's not recommended. If the the
+ * error code is different than NUMERUS_OK, an error occurred during the
+ * conversion and the buffer contains an empty string. The error code may help
+ * find the specific error.
+ *
+ * @param int_part long integer part of a value to be added to the twelfths
+ * and converted to roman numeral.
+ * @param twelfths short integer as number of twelfths (1/12) to be added to the
+ * integer part and converted to roman numeral.
+ * @param *roman buffer of at least NUMERUS_MAX_LENGTH chars where to write the
+ * null-terminated roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the written roman numeral, excluding '\0', or -1
+ * when an error occurs.
+ */
+short numerus_int_with_twelfth_to_roman_into(long int_part, short twelfths,
+                                             char *roman, int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    short length = _num_int_with_twelfth_to_roman_into(int_part, twelfths,
+                                                       roman, errcode);
+    numerus_error_code = *errcode;
+    return length;
+}
+
 
-    /* Copy out of the buffer and return it on the heap */
-    char *returnable_roman_string =
-            malloc(roman_numeral - building_buffer);
+#ifndef NUMERUS_NO_MALLOC
+/**
+ * Converts an integer value and a number of twelfths to a roman numeral with
+ * their sum as value.
+ *
+ * Accepts any pair of integer value and twelfths so that their sum is within
+ * [NUMERUS_MAX_VALUE, NUMERUS_MIN_VALUE].
+ *
+ * Remember to free() the roman numeral when it's not useful anymore. To avoid
+ * the allocation, use numerus_int_with_twelfth_to_roman_into().
+ *
+ * The conversion status is stored in the errcode passed as parameter, which
+ * can be NULL to ignore the error, although it's not recommended. If the the
+ * error code is different than NUMERUS_OK, an error occurred during the
+ * conversion and the returned string is NULL. The error code may help find the
+ * specific error.
+ *
+ * @param int_part long integer part of a value to be added to the twelfths
+ * and converted to roman numeral.
+ * @param twelfths short integer as number of twelfths (1/12) to be added to the
+ * integer part and converted to roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns char* a string containing the roman numeral or NULL when an error
+ * occurs.
+ */
+char *numerus_int_with_twelfth_to_roman(long int_part, short twelfths,
+                                        int *errcode) {
+    return numerus_int_with_twelfth_to_roman_using(int_part, twelfths, NULL,
+                                                   errcode);
+}
+#endif /* NUMERUS_NO_MALLOC */
+
+
+/**
+ * Converts an integer value and a number of twelfths to a roman numeral with
+ * their sum as value, allocated with the passed allocator.
+ *
+ * Works like numerus_int_with_twelfth_to_roman() but obtains the memory for
+ * the numeral, exactly its length plus the '\0', from the allocate hook
+ * instead of malloc(). Releasing it is up to the owner of the allocator: with
+ * an arena or a pool all numerals of a request can be released at once,
+ * without one free() each.
+ *
+ * The conversion status is stored in the errcode passed as parameter, which
+ * can be NULL to ignore the error, although it's not recommended. If the the
+ * error code is different than NUMERUS_OK, an error occurred during the
+ * conversion and the returned string is NULL. If the allocate hook returns
+ * NULL, the error code is NUMERUS_ERROR_MALLOC_FAIL.
+ *
+ * @param int_part long integer part of a value to be added to the twelfths
+ * and converted to roman numeral.
+ * @param twelfths short integer as number of twelfths (1/12) to be added to the
+ * integer part and converted to roman numeral.
+ * @param *allocator hooks to allocate the numeral with. NULL is interpreted
+ * as malloc(), or as an allocator always failing when compiled with
+ * NUMERUS_NO_MALLOC.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns char* a string containing the roman numeral or NULL when an error
+ * occurs.
+ */
+char *numerus_int_with_twelfth_to_roman_using(
+        long int_part, short twelfths,
+        const struct numerus_allocator *allocator, int *errcode) {
+
+    /* Build the numeral in a buffer on the stack */
+    char building_buffer[NUMERUS_MAX_LENGTH];
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    short length = numerus_int_with_twelfth_to_roman_into(
+            int_part, twelfths, building_buffer, errcode);
+    if (*errcode != NUMERUS_OK) {
+        return NULL;
+    }
+
+    /* Copy out of the buffer into the allocated memory */
+    char *returnable_roman_string;
+    if (allocator == NULL) {
+#ifdef NUMERUS_NO_MALLOC
+        returnable_roman_string = NULL;
+#else
+        returnable_roman_string = malloc(length + 1);
+#endif
+    } else {
+        returnable_roman_string = allocator->allocate(
+                (size_t) length + 1, allocator->context);
+    }
     if (returnable_roman_string == NULL) {
         numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
         *errcode = NUMERUS_ERROR_MALLOC_FAIL;
         return NULL;
     }
-    strcpy(returnable_roman_string, building_buffer);
+    memcpy(returnable_roman_string, building_buffer, (size_t) length + 1);
+    return returnable_roman_string;
+}
+
+
+
+/**
+ * Computes the length of the roman numeral of an integer value and a number
+ * of twelfths, like numerus_int_with_twelfth_to_roman_length(), without
+ * touching numerus_error_code.
+ *
+ * @param int_part long integer part of the value.
+ * @param twelfths short integer as number of twelfths (1/12) of the value.
+ * @param *errcode int where to store the status: NUMERUS_OK or any other
+ * error. Can NOT be NULL.
+ * @returns short length of the roman numeral, excluding '\0', or -1 when an
+ * error occurs.
+ */
+static short _num_int_with_twelfth_to_roman_length(long int_part,
+                                                   short twelfths,
+                                                   int *errcode) {
+    numerus_shorten_and_same_sign_to_parts(&int_part, &twelfths);
+    double double_value = numerus_parts_to_double(int_part, twelfths);
+    short length = 0;
+    if (double_value < NUMERUS_MIN_VALUE || double_value > NUMERUS_MAX_VALUE) {
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return -1;
+    }
+    *errcode = NUMERUS_OK;
+    if (int_part == 0 && twelfths == 0) {
+        return (short) strlen(NUMERUS_ZERO);
+    } else if (int_part < 0 || (int_part == 0 && twelfths < 0)) {
+        int_part = ABS(int_part);
+        twelfths = ABS(twelfths);
+        double_value = ABS(double_value);
+        length++; /* Minus */
+    }
+    if (double_value > NUMERUS_MAX_NONLONG_FLOAT_VALUE) {
+        length += 2; /* Underscores */
+        length += _num_value_part_length(int_part / 1000, 0);
+        length += _num_value_part_length(int_part % 1000, 1);
+    } else {
+        length += _num_value_part_length(int_part, 0);
+    }
+    return length + _num_value_part_length(twelfths, 13);
+}
+
+
+/**
+ * Computes the length of the roman numeral an integer value and a number of
+ * twelfths would be converted to, without converting them.
+ *
+ * The result is exactly the value numerus_int_with_twelfth_to_roman_into()
+ * would return, so it can be used to size a buffer or an arena holding many
+ * numerals packed one after the other.
+ *
+ * The status is stored in the errcode passed as parameter, which can be NULL
+ * to ignore the error, although it's not recommended. If the error code is
+ * different than NUMERUS_OK, the value is out of range and the returned
+ * length is negative.
+ *
+ * @param int_part long integer part of the value.
+ * @param twelfths short integer as number of twelfths (1/12) of the value.
+ * @param *errcode int where to store the status: NUMERUS_OK or any other
+ * error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the roman numeral, excluding '\0', or -1 when an
+ * error occurs.
+ */
+short numerus_int_with_twelfth_to_roman_length(long int_part, short twelfths,
+                                               int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    short length = _num_int_with_twelfth_to_roman_length(int_part, twelfths,
+                                                         errcode);
+    numerus_error_code = *errcode;
+    return length;
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   BATCH CONVERSIONS   }-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Converts a block of values, each as integer part and number of twelfths, to
+ * roman numerals written into an arena of fixed-size slots.
+ *
+ * The i-th numeral is written null-terminated at `romans + i * stride`. The
+ * stride must be at least NUMERUS_MAX_LENGTH. Values that can't be converted
+ * result in an empty string in their slot and in their error code.
+ *
+ * Converting whole blocks amortizes the call overhead and lets the caller
+ * keep the numerals in one contiguous arena instead of one heap string each.
+ *
+ * Does not touch numerus_error_code, so different threads may convert
+ * different blocks at the same time.
+ *
+ * @param *int_parts array of `count` integer parts.
+ * @param *twelfths array of `count` numbers of twelfths. NULL is interpreted
+ * as 0 twelfths for every value.
+ * @param count number of values to convert.
+ * @param *romans arena of at least `count * stride` chars.
+ * @param stride distance in chars between two consecutive numerals in the
+ * arena, at least NUMERUS_MAX_LENGTH.
+ * @param *errcodes array of `count` ints where to store the conversion status
+ * of each value. Can be NULL to ignore the errors (NOT recommended).
+ * @returns size_t number of values converted successfully.
+ */
+size_t numerus_int_with_twelfth_to_roman_batch(const long *int_parts,
+                                               const short *twelfths,
+                                               size_t count, char *romans,
+                                               size_t stride, int *errcodes) {
+    size_t converted = 0;
+    int errcode;
+    for (size_t i = 0; i < count; i++) {
+        _num_int_with_twelfth_to_roman_into(
+                int_parts[i], (short) (twelfths == NULL ? 0 : twelfths[i]),
+                romans + i * stride, &errcode);
+        if (errcodes != NULL) {
+            errcodes[i] = errcode;
+        }
+        if (errcode == NUMERUS_OK) {
+            converted++;
+        }
+    }
+    return converted;
+}
+
+
+#ifndef NUMERUS_TABLES_BOOTSTRAP
+/* Uses the SIMD kernels of numerus_simd.c, built on the generated tables */
+/**
+ * Converts a block of roman numerals, stored in an arena of fixed-size slots,
+ * to their values as integer part and number of twelfths.
+ *
+ * The i-th numeral is read null-terminated from `romans + i * stride`.
+ * Numerals that can't be converted result in a value outside the possible
+ * range of values and in their error code, like
+ * numerus_roman_to_int_part_and_twelfths().
+ *
+ * Each slot is decoded with the SIMD kernel chosen at runtime for the CPU
+ * (see numerus_simd_level()), which may read the whole slot, also after the
+ * '\0' of its numeral.
+ *
+ * Does not touch numerus_error_code, so different threads may convert
+ * different blocks at the same time.
+ *
+ * @param *romans arena of at least `count * stride` chars.
+ * @param stride distance in chars between two consecutive numerals in the
+ * arena.
+ * @param count number of numerals to convert.
+ * @param *int_parts array of `count` longs where to store the integer parts.
+ * @param *twelfths array of `count` shorts where to store the numbers of
+ * twelfths. Can be NULL to ignore them.
+ * @param *errcodes array of `count` ints where to store the conversion status
+ * of each numeral. Can be NULL to ignore the errors (NOT recommended).
+ * @returns size_t number of numerals converted successfully.
+ */
+size_t numerus_roman_to_int_part_and_twelfths_batch(char *romans, size_t stride,
+                                                    size_t count,
+                                                    long *int_parts,
+                                                    short *twelfths,
+                                                    int *errcodes) {
+    size_t converted = 0;
+    int errcode;
+    short ignored_twelfths;
+    for (size_t i = 0; i < count; i++) {
+        /* Decode with the SIMD kernel, reading the whole slot */
+        int_parts[i] = _num_decode_roman_slot(
+                romans + i * stride, stride,
+                twelfths == NULL ? &ignored_twelfths : &twelfths[i],
+                &errcode);
+        if (errcodes != NULL) {
+            errcodes[i] = errcode;
+        }
+        if (errcode == NUMERUS_OK) {
+            converted++;
+        }
+    }
+    return converted;
+}
+#endif /* NUMERUS_TABLES_BOOTSTRAP */
+
+
+/**
+ * Computes the lengths of the roman numerals of a block of values, each as
+ * integer part and number of twelfths, without converting them.
+ *
+ * Meant as pre-pass of numerus_int_with_twelfth_to_roman_batch_packed(): the
+ * running sum of the lengths, plus one '\0' each, gives the exact size of an
+ * arena holding all numerals packed and the offset of each of them.
+ * Values out of range get length 0 and their error code.
+ *
+ * Does not touch numerus_error_code, so different threads may process
+ * different blocks at the same time.
+ *
+ * @param *int_parts array of `count` integer parts.
+ * @param *twelfths array of `count` numbers of twelfths. NULL is interpreted
+ * as 0 twelfths for every value.
+ * @param count number of values.
+ * @param *lengths array of `count` size_t where to store the length of each
+ * numeral, excluding '\0'.
+ * @param *errcodes array of `count` ints where to store the status of each
+ * value. Can be NULL to ignore the errors (NOT recommended).
+ * @returns size_t number of values in range.
+ */
+size_t numerus_int_with_twelfth_to_roman_batch_lengths(const long *int_parts,
+                                                       const short *twelfths,
+                                                       size_t count,
+                                                       size_t *lengths,
+                                                       int *errcodes) {
+    size_t in_range = 0;
+    int errcode;
+    for (size_t i = 0; i < count; i++) {
+        short length = _num_int_with_twelfth_to_roman_length(
+                int_parts[i], (short) (twelfths == NULL ? 0 : twelfths[i]),
+                &errcode);
+        lengths[i] = errcode == NUMERUS_OK ? (size_t) length : 0;
+        if (errcodes != NULL) {
+            errcodes[i] = errcode;
+        }
+        if (errcode == NUMERUS_OK) {
+            in_range++;
+        }
+    }
+    return in_range;
+}
+
+
+/**
+ * Converts a block of values, each as integer part and number of twelfths, to
+ * roman numerals packed one after the other into an arena.
+ *
+ * The i-th numeral is written null-terminated at `romans + offsets[i]`, so
+ * unlike numerus_int_with_twelfth_to_roman_batch() no slot space is wasted.
+ * The offsets are usually the running sum of the lengths computed by
+ * numerus_int_with_twelfth_to_roman_batch_lengths(), plus one '\0' each.
+ * Values that can't be converted result in an empty string and in their
+ * error code.
+ *
+ * Does not touch numerus_error_code, so different threads may convert
+ * different blocks into different parts of the same arena at the same time.
+ *
+ * @param *int_parts array of `count` integer parts.
+ * @param *twelfths array of `count` numbers of twelfths. NULL is interpreted
+ * as 0 twelfths for every value.
+ * @param count number of values to convert.
+ * @param *romans arena where to write the numerals.
+ * @param *offsets array of `count` positions in the arena where to write
+ * each numeral, each with room for its length plus the '\0'.
+ * @param *errcodes array of `count` ints where to store the conversion status
+ * of each value. Can be NULL to ignore the errors (NOT recommended).
+ * @returns size_t number of values converted successfully.
+ */
+size_t numerus_int_with_twelfth_to_roman_batch_packed(const long *int_parts,
+                                                      const short *twelfths,
+                                                      size_t count,
+                                                      char *romans,
+                                                      const size_t *offsets,
+                                                      int *errcodes) {
+    size_t converted = 0;
+    int errcode;
+    for (size_t i = 0; i < count; i++) {
+        _num_int_with_twelfth_to_roman_into(
+                int_parts[i], (short) (twelfths == NULL ? 0 : twelfths[i]),
+                romans + offsets[i], &errcode);
+        if (errcodes != NULL) {
+            errcodes[i] = errcode;
+        }
+        if (errcode == NUMERUS_OK) {
+            converted++;
+        }
+    }
+    return converted;
+}
+
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-{   SHORT NUMERAL CONVERSIONS   }-+-+-+-+-+-+-+-+-+-  */
+
+
+#ifndef NUMERUS_TABLES_BOOTSTRAP
+/* Uses the generated tables */
+/**
+ * Converts an integer value within
+ * [NUMERUS_MIN_SHORT_VALUE, NUMERUS_MAX_SHORT_VALUE] to a roman numeral,
+ * written into a buffer provided by the caller.
+ *
+ * Does only the work this domain needs: no twelfths to normalize, no
+ * floating point limits, no long numerals, just one lookup per digit in the
+ * tables generated at build time.
+ * The numeral is the same numerus_int_to_roman_into() would write.
+ *
+ * The conversion status is stored in the errcode passed as parameter, which
+ * can be NULL to ignore the error, although it's not recommended. Values
+ * outside the domain result in NUMERUS_ERROR_VALUE_OUT_OF_RANGE and an empty
+ * string in the buffer.
+ *
+ * @param value integer to be converted to roman numeral, taken as long so
+ * that wider values are refused instead of being truncated.
+ * @param *roman buffer of at least NUMERUS_MAX_LENGTH chars where to write the
+ * null-terminated roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the written roman numeral, excluding '\0', or -1
+ * when an error occurs.
+ */
+short numerus_short_int_to_roman_into(long value, char *roman, int *errcode) {
+    char *roman_numeral = roman;
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    if (value < NUMERUS_MIN_SHORT_VALUE || value > NUMERUS_MAX_SHORT_VALUE) {
+        *roman = '\0';
+        numerus_error_code = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return -1;
+    }
     numerus_error_code = NUMERUS_OK;
     *errcode = NUMERUS_OK;
-    return returnable_roman_string;
+    if (value == 0) {
+        strcpy(roman, NUMERUS_ZERO);
+        return (short) strlen(NUMERUS_ZERO);
+    } else if (value < 0) {
+        value = -value;
+        *(roman_numeral++) = '-';
+    }
+    short divisor = 1000;
+    for (int decade = 0; decade < 4; decade++) {
+        roman_numeral = _num_append_short_digit(roman_numeral, decade,
+                                                value / divisor);
+        value %= divisor;
+        divisor /= 10;
+    }
+    *roman_numeral = '\0';
+    return (short) (roman_numeral - roman);
+}
+#endif /* NUMERUS_TABLES_BOOTSTRAP */
+
+
+/**
+ * Parses the digit of one decade of a canonical roman numeral, written with
+ * the chars for one, five and ten units of that decade.
+ *
+ * Accepts only (one ten)|(one five)|(five? one{0,3}), case INsensitive.
+ * Shared with the extended range parser of numerus_ext.c.
+ *
+ * @param *roman position in the numeral where the decade starts.
+ * @param *digit where to store the value of the digit, 0 to 9.
+ * @returns position in the numeral after the decade.
+ */
+char *_num_parse_short_digit(char *roman, char one, char five, char ten,
+                             short *digit) {
+    *digit = 0;
+    if (toupper(*roman) == one && toupper(roman[1]) == ten) {
+        *digit = 9;
+        return roman + 2;
+    }
+    if (toupper(*roman) == one && toupper(roman[1]) == five) {
+        *digit = 4;
+        return roman + 2;
+    }
+    if (toupper(*roman) == five) {
+        *digit = 5;
+        roman++;
+    }
+    for (int repetitions = 0; repetitions < 3; repetitions++) {
+        if (toupper(*roman) != one) {
+            break;
+        }
+        (*digit)++;
+        roman++;
+    }
+    return roman;
+}
+
+
+/**
+ * Parses a canonical roman numeral without underscores and without decimals,
+ * with no leading or trailing whitespace.
+ *
+ * It's the fast path of numerus_roman_to_short_int(): anything else is
+ * rejected and left to the general parser, which knows the exact error.
+ *
+ * @param *roman string with a roman numeral.
+ * @param *value where to store the value of the numeral.
+ * @returns bool true if the numeral has been parsed, false if it's not a
+ * canonical short numeral.
+ */
+static bool _num_parse_short_numeral(char *roman, short *value) {
+    short sign = 1;
+    short digit;
+    if (roman == NULL) {
+        return false;
+    }
+    if (*roman == '-') {
+        sign = -1;
+        roman++;
+    }
+    char *start = roman;
+    *value = 0;
+    while (toupper(*roman) == 'M' && *value < 3000) {
+        *value += 1000;
+        roman++;
+    }
+    roman = _num_parse_short_digit(roman, 'C', 'D', 'M', &digit);
+    *value += digit * 100;
+    roman = _num_parse_short_digit(roman, 'X', 'L', 'C', &digit);
+    *value += digit * 10;
+    roman = _num_parse_short_digit(roman, 'I', 'V', 'X', &digit);
+    *value += digit;
+    *value *= sign;
+    return *roman == '\0' && roman != start;
+}
+
+
+/**
+ * Converts a roman numeral without underscores and without decimals to its
+ * integer value within [NUMERUS_MIN_SHORT_VALUE, NUMERUS_MAX_SHORT_VALUE].
+ *
+ * Canonical numerals are parsed with one pass per decade, without the
+ * dictionary walk of numerus_roman_to_int(). Anything else is parsed by the
+ * general parser, so the accepted numerals and the syntax error codes are
+ * exactly the ones of numerus_roman_to_int_part_and_twelfths(); numerals of
+ * values outside the domain (long ones or with twelfths) result in
+ * NUMERUS_ERROR_VALUE_OUT_OF_RANGE.
+ *
+ * The parsing status of the roman numeral is stored in the errcode passed as
+ * parameter, which can be NULL to ignore the error, although it's not
+ * recommended. If the the error code is different than NUMERUS_OK, the
+ * returned value is outside the domain.
+ *
+ * @param *roman string with a roman numeral
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short value of the roman numeral or a value outside the domain
+ * when an error occurs.
+ */
+short numerus_roman_to_short_int(char *roman, int *errcode) {
+    short value;
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    if (_num_parse_short_numeral(roman, &value)) {
+        numerus_error_code = NUMERUS_OK;
+        *errcode = NUMERUS_OK;
+        return value;
+    }
+    short twelfths;
+    long int_part = _num_roman_to_int_part_and_twelfths(roman, &twelfths,
+                                                        errcode);
+    if (*errcode == NUMERUS_OK && (twelfths != 0
+                                   || int_part > NUMERUS_MAX_SHORT_VALUE
+                                   || int_part < NUMERUS_MIN_SHORT_VALUE)) {
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+    }
+    numerus_error_code = *errcode;
+    if (*errcode != NUMERUS_OK) {
+        return NUMERUS_MAX_SHORT_VALUE + 10;
+    }
+    return (short) int_part;
 }
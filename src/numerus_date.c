@@ -0,0 +1,291 @@
+/**
+ * @file numerus_date.c
+ * @brief Numerus formatter of dates and times with roman numerals.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the formatter writing dates and times like
+ * "MMXVI.X.XVI" for log lines, documents and copyright notices.
+ *
+ * Formatting a date costs a few copies: the numerals of months, days, hours,
+ * minutes and seconds are interned in the tables generated at build time
+ * and the numeral of the year is kept from the previous call, per thread,
+ * so it's converted again only when the year changes.
+ */
+
+#include <string.h>   /* For `memcpy()`, `strlen()` */
+#include <limits.h>   /* For `SHRT_MAX` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include <time.h>     /* For `struct tm` */
+#include "numerus_internal.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+
+/**
+ * @internal
+ * Seconds in a day and days in an era of 400 years of the proleptic
+ * Gregorian calendar.
+ */
+#define _NUM_DATE_DAY_SECONDS 86400
+#define _NUM_DATE_ERA_DAYS 146097
+
+
+/**
+ * @internal
+ * Size of the buffers of the numeral of the year, NUMERUS_MAX_LENGTH chars.
+ */
+#define _NUM_DATE_YEAR_SIZE 37
+
+
+/**
+ * @internal
+ * The year is cached per thread where the compiler has thread-local storage,
+ * and converted at every call otherwise.
+ */
+#if defined(__GNUC__)
+#define _NUM_DATE_YEAR_CACHE 1
+#else
+#define _NUM_DATE_YEAR_CACHE 0
+#endif
+
+
+#if _NUM_DATE_YEAR_CACHE
+/**
+ * @internal
+ * Year formatted by the last call on this thread, its numeral and the
+ * length of the numeral, -1 before the first call.
+ */
+static __thread long _num_date_cached_year = 0;
+static __thread char _num_date_cached_numeral[_NUM_DATE_YEAR_SIZE];
+static __thread short _num_date_cached_length = -1;
+#endif
+
+
+/**
+ * @internal
+ * Gives the numeral of a year, from the cache if it's the year of the last
+ * call on this thread.
+ *
+ * @param year value of the year, already checked to be in range.
+ * @param *buffer buffer of at least NUMERUS_MAX_LENGTH chars, used when the
+ * numeral is not cached.
+ * @param **numeral where to store the pointer to the numeral.
+ * @returns short length of the numeral.
+ */
+static short _num_date_year_numeral(long year, char *buffer,
+                                    const char **numeral) {
+#if _NUM_DATE_YEAR_CACHE
+    (void) buffer;
+    if (_num_date_cached_length < 0 || year != _num_date_cached_year) {
+        int errcode;
+        _num_date_cached_length = numerus_int_with_twelfth_to_roman_into(
+                year, 0, _num_date_cached_numeral, &errcode);
+        _num_date_cached_year = year;
+    }
+    *numeral = _num_date_cached_numeral;
+    return _num_date_cached_length;
+#else
+    int errcode;
+    *numeral = buffer;
+    return numerus_int_with_twelfth_to_roman_into(year, 0, buffer, &errcode);
+#endif
+}
+
+
+/**
+ * @internal
+ * Checks that a component of a date is in its range, which must lie within
+ * the interned numerals of _NUM_DATE_COMPONENTS.
+ */
+static bool _num_date_component_in_range(int value, int min, int max) {
+    return value >= min && value <= max;
+}
+
+
+/**
+ * @internal
+ * Formats the components of a date already split into fields.
+ *
+ * @returns short length of the formatted date or -1 in case of error.
+ */
+static short _num_format_date_fields(long year, int month, int day, int hour,
+                                     int minute, int second,
+                                     const char *pattern, char *formatted,
+                                     size_t size, int *errcode) {
+    char year_buffer[_NUM_DATE_YEAR_SIZE];
+    char *out = formatted;
+    if (size > (size_t) SHRT_MAX + 1) {
+        size = (size_t) SHRT_MAX + 1;
+    }
+    if (size == 0) {
+        *errcode = NUMERUS_ERROR_DATE_FORMAT;
+        return -1;
+    }
+    if (year > NUMERUS_MAX_LONG_NONFLOAT_VALUE
+        || year < NUMERUS_MIN_LONG_NONFLOAT_VALUE
+        || !_num_date_component_in_range(month, 1, 12)
+        || !_num_date_component_in_range(day, 1, 31)
+        || !_num_date_component_in_range(hour, 0, 23)
+        || !_num_date_component_in_range(minute, 0, 59)
+        || !_num_date_component_in_range(second, 0, 60)) {
+        *formatted = '\0';
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return -1;
+    }
+    /* One char is always left for the '\0' */
+    const char *end = formatted + size - 1;
+    while (*pattern != '\0') {
+        const char *piece;
+        size_t piece_length;
+        int component = -1;
+        if (*pattern != '%') {
+            piece = pattern;
+            piece_length = 1;
+        } else {
+            pattern++;
+            switch (*pattern) {
+                case 'Y':
+                    piece_length = (size_t) _num_date_year_numeral(
+                            year, year_buffer, &piece);
+                    break;
+                case 'm': component = month; break;
+                case 'd': component = day; break;
+                case 'H': component = hour; break;
+                case 'M': component = minute; break;
+                case 'S': component = second; break;
+                case '%':
+                    piece = pattern;
+                    piece_length = 1;
+                    break;
+                default:
+                    *formatted = '\0';
+                    *errcode = NUMERUS_ERROR_DATE_FORMAT;
+                    return -1;
+            }
+            if (component == 0) {
+                piece = NUMERUS_ZERO;
+                piece_length = strlen(NUMERUS_ZERO);
+            } else if (component > 0) {
+                piece = _NUM_DATE_COMPONENTS[component];
+                piece_length = _NUM_DATE_COMPONENT_LENGTHS[component];
+            }
+        }
+        if (piece_length > (size_t) (end - out)) {
+            *formatted = '\0';
+            *errcode = NUMERUS_ERROR_DATE_FORMAT;
+            return -1;
+        }
+        memcpy(out, piece, piece_length);
+        out += piece_length;
+        pattern++;
+    }
+    *out = '\0';
+    *errcode = NUMERUS_OK;
+    return (short) (out - formatted);
+}
+
+
+/**
+ * Formats a date and time with roman numerals following a pattern, like a
+ * small strftime().
+ *
+ * The pattern is copied into the buffer replacing the conversion
+ * specifications with the numerals of the components of the date:
+ *
+ * - `%Y` the year, `tm_year + 1900`, as long numeral beyond 3999;
+ * - `%m` the month, 1-12;
+ * - `%d` the day of the month, 1-31;
+ * - `%H` the hour, 0-23;
+ * - `%M` the minutes, 0-59;
+ * - `%S` the seconds, 0-60 for leap seconds;
+ * - `%%` a literal `%`.
+ *
+ * Components equal to zero are written as NUMERUS_ZERO, so the pattern
+ * "%Y.%m.%d %H:%M" gives "MMXVI.X.XVI NULLA:XV".
+ *
+ * The other fields of the `struct tm` are ignored and the components are not
+ * normalised: it's up to the caller to pass a valid date, e.g. from
+ * gmtime() or localtime().
+ *
+ * @param *date the date to format.
+ * @param *pattern null-terminated pattern of the formatted date.
+ * @param *formatted buffer where to write the null-terminated formatted date.
+ * @param size size of the buffer in chars, including the '\0'.
+ * @param *errcode int where to store the status: NUMERUS_OK,
+ * NUMERUS_ERROR_VALUE_OUT_OF_RANGE if a component is outside its range or
+ * NUMERUS_ERROR_DATE_FORMAT if the pattern has an unknown conversion or the
+ * formatted date doesn't fit in the buffer.
+ * Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the formatted date, excluding '\0', or -1 in case
+ * of error, with an empty string in the buffer if it's not empty.
+ */
+short numerus_format_date(const struct tm *date, const char *pattern,
+                          char *formatted, size_t size, int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    short length = _num_format_date_fields(
+            (long) date->tm_year + 1900, date->tm_mon + 1, date->tm_mday,
+            date->tm_hour, date->tm_min, date->tm_sec, pattern, formatted,
+            size, errcode);
+    numerus_error_code = *errcode;
+    return length;
+}
+
+
+/**
+ * Formats a timestamp in seconds since the Unix epoch, in UTC, with roman
+ * numerals following a pattern as numerus_format_date() does.
+ *
+ * The timestamp is split into date and time with the proleptic Gregorian
+ * calendar without gmtime(), so it works the same on any platform, for any
+ * timestamp and without leap seconds.
+ *
+ * @param epoch_seconds seconds since 1970-01-01 00:00:00 UTC, negative before.
+ * @param *pattern null-terminated pattern of the formatted date.
+ * @param *formatted buffer where to write the null-terminated formatted date.
+ * @param size size of the buffer in chars, including the '\0'.
+ * @param *errcode int where to store the status as numerus_format_date().
+ * Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the formatted date, excluding '\0', or -1 in case
+ * of error.
+ */
+short numerus_format_epoch(int64_t epoch_seconds, const char *pattern,
+                           char *formatted, size_t size, int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    int64_t days = epoch_seconds / _NUM_DATE_DAY_SECONDS;
+    int64_t seconds = epoch_seconds % _NUM_DATE_DAY_SECONDS;
+    if (seconds < 0) {
+        seconds += _NUM_DATE_DAY_SECONDS;
+        days--;
+    }
+    /* Days to civil date, counting eras of 400 years from 0000-03-01 */
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - _NUM_DATE_ERA_DAYS + 1)
+                  / _NUM_DATE_ERA_DAYS;
+    int64_t day_of_era = days - era * _NUM_DATE_ERA_DAYS;
+    int64_t year_of_era = (day_of_era - day_of_era / 1460
+                           + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4
+                                        - year_of_era / 100);
+    int64_t month_from_march = (5 * day_of_year + 2) / 153;
+    int day = (int) (day_of_year - (153 * month_from_march + 2) / 5 + 1);
+    int month = (int) (month_from_march < 10 ? month_from_march + 3
+                                             : month_from_march - 9);
+    int64_t year = year_of_era + era * 400 + (month <= 2);
+    if (year > NUMERUS_MAX_LONG_NONFLOAT_VALUE
+        || year < NUMERUS_MIN_LONG_NONFLOAT_VALUE) {
+        /* Also keeps the year within a long on 32 bit platforms */
+        year = NUMERUS_MAX_LONG_NONFLOAT_VALUE + 1L;
+    }
+    short length = _num_format_date_fields(
+            (long) year, month, day, (int) (seconds / 3600),
+            (int) (seconds / 60 % 60), (int) (seconds % 60), pattern,
+            formatted, size, errcode);
+    numerus_error_code = *errcode;
+    return length;
+}
@@ -0,0 +1,61 @@
+/**
+ * @file numerus_dictionary.h
+ * @brief Numerus dictionary of roman chars
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This header contains the dictionary the conversions are built on. It's the
+ * single source of truth of the roman chars: it's included by the conversion
+ * functions in numerus_core.c and by the generator of the lookup tables,
+ * numerus_tables_gen.c, which runs at build time.
+ */
+
+#ifndef NUMERUS_DICTIONARY_H
+#define NUMERUS_DICTIONARY_H
+
+
+/**
+ * @internal
+ * Struct containing a basic roman char, its integer value and the maximum
+ * consecutive repetitions of it that a roman numeral may have.
+ *
+ * It's used to create the _NUM_DICTIONARY dictionary which in turn is used by
+ * conversion functions.
+ */
+struct _num_dictionary_char {
+    const int value;
+    const char *characters;
+    const short max_repetitions;
+};
+
+
+/**
+ * Dictionary of a priori known roman chars, their values and repetitions used
+ * by conversion functions.
+ *
+ * The last value is a terminator, to be used by conversion functions to
+ * understand that the array has been parsed.
+ */
+static const struct _num_dictionary_char _NUM_DICTIONARY[] = {
+    { 1000, "M" ,  3 }, // index: 0
+    {  900, "CM",  1 }, // index: 1
+    {  500, "D" ,  1 }, // index: 2
+    {  400, "CD",  1 }, // index: 3
+    {  100, "C" ,  3 }, // index: 4
+    {   90, "XC",  1 }, // index: 5
+    {   50, "L" ,  1 }, // index: 6
+    {   40, "XL",  1 }, // index: 7
+    {   10, "X" ,  3 }, // index: 8
+    {    9, "IX",  1 }, // index: 9
+    {    5, "V" ,  1 }, // index: 10
+    {    4, "IV",  1 }, // index: 11
+    {    1, "I" ,  3 }, // index: 12
+    {    6, "S" ,  1 }, // index: 13
+    {    1, "." ,  5 }, // index: 14
+    {    0, NULL,  0 }  // index: 15
+};
+
+
+#endif /* NUMERUS_DICTIONARY_H */
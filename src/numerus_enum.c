@@ -0,0 +1,362 @@
+/**
+ * @file numerus_enum.c
+ * @brief Numerus enumeration of all the roman numerals of the language.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the functions listing every valid roman numeral, or the
+ * ones of some kinds, lengths or integer parts, for test corpora and exports.
+ *
+ * Instead of converting each value, the enumeration walks the grammar of the
+ * numerals depth-first: the sign, the underscores of long numerals, one digit
+ * of each decade from the generated tables and the twelfths. Walking the
+ * digits in ascending order visits the numerals in ascending order of value,
+ * so the same walk gives both orders: by value in one pass, by length in one
+ * pass per length. Subtrees whose values or lengths can't pass the filter
+ * are skipped as a whole.
+ */
+
+#include <string.h>   /* For `memcpy()`, `strlen()` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include "numerus_internal.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+
+/**
+ * @internal
+ * Max number of digit groups of a numeral: 4 between the underscores and 3
+ * after them.
+ */
+#define _NUM_ENUM_MAX_GROUPS 7
+
+
+/**
+ * @internal
+ * State of a walk of the grammar for one sign and one kind of integer part.
+ */
+struct _num_enum_walk {
+    numerus_enum_callback callback;
+    void *context;
+    int kinds;
+    bool negative;
+    bool long_numeral;
+    short min_length;
+    short max_length;
+    long min_magnitude;
+    long max_magnitude;
+    int groups;
+    int decades[_NUM_ENUM_MAX_GROUPS];
+    long weights[_NUM_ENUM_MAX_GROUPS];
+    /* Max length of the rest of the numeral after each group */
+    short max_rest_lengths[_NUM_ENUM_MAX_GROUPS + 1];
+    short digit_lengths[4][10];
+    char roman[64];
+    size_t count;
+    bool stopped;
+};
+
+
+/**
+ * Initialises a filter letting through the numerals of the given kinds,
+ * with any length and any integer part.
+ *
+ * @param *filter filter to initialise.
+ * @param kinds bitwise OR of the NUMERUS_ENUM_* kinds of numerals to list.
+ */
+void numerus_enum_filter_init(struct numerus_enum_filter *filter, int kinds) {
+    filter->kinds = kinds;
+    filter->min_length = 1;
+    filter->max_length = (short) (NUMERUS_MAX_LENGTH - 1);
+    filter->min_int_part = NUMERUS_MIN_LONG_NONFLOAT_VALUE;
+    filter->max_int_part = NUMERUS_MAX_LONG_NONFLOAT_VALUE;
+}
+
+
+/**
+ * @internal
+ * Passes the complete numeral in the walk to the callback.
+ */
+static void _num_enum_emit(struct _num_enum_walk *walk, char *end,
+                           long magnitude, short twelfths) {
+    short length = (short) (end - walk->roman);
+    if (length < walk->min_length || length > walk->max_length) {
+        return;
+    }
+    *end = '\0';
+    walk->count++;
+    if (walk->callback != NULL
+        && walk->callback(walk->roman, length,
+                          walk->negative ? -magnitude : magnitude,
+                          (short) (walk->negative ? -twelfths : twelfths),
+                          walk->context) != 0) {
+        walk->stopped = true;
+    }
+}
+
+
+/**
+ * @internal
+ * Walks the twelfths after the complete integer part, in the order of value.
+ */
+static void _num_enum_twelfths(struct _num_enum_walk *walk, char *position,
+                               long magnitude) {
+    int int_kind = walk->long_numeral ? NUMERUS_ENUM_LONG : NUMERUS_ENUM_SHORT;
+    for (int i = 0; i < 12 && !walk->stopped; i++) {
+        short twelfths = (short) (walk->negative ? 11 - i : i);
+        if ((twelfths == 0 && !(walk->kinds & int_kind))
+            || (twelfths > 0 && !(walk->kinds & NUMERUS_ENUM_FLOAT))
+            || (twelfths == 0 && magnitude == 0)) {
+            /* Zero is not walked: NUMERUS_ZERO is listed on its own */
+            continue;
+        }
+        _num_enum_emit(walk, _num_append_twelfths(position, twelfths),
+                       magnitude, twelfths);
+    }
+}
+
+
+/**
+ * @internal
+ * Walks the digits of one group and, recursively, the following groups,
+ * skipping the digits whose subtree has no value or length passing the
+ * filter.
+ */
+static void _num_enum_group(struct _num_enum_walk *walk, int group,
+                            char *position, long magnitude) {
+    if (group == walk->groups) {
+        _num_enum_twelfths(walk, position, magnitude);
+        return;
+    }
+    if (walk->long_numeral && group == 4) {
+        *(position++) = '_';
+    }
+    int decade = walk->decades[group];
+    int max_digit = decade == 0 ? 3 : 9;
+    short length = (short) (position - walk->roman);
+    for (int i = 0; i <= max_digit && !walk->stopped; i++) {
+        int digit = walk->negative ? max_digit - i : i;
+        long first = magnitude + digit * walk->weights[group];
+        long last = first + walk->weights[group] - 1;
+        short digit_length = walk->digit_lengths[decade][digit];
+        if (first > walk->max_magnitude || last < walk->min_magnitude
+            || length + digit_length > walk->max_length
+            || length + digit_length + walk->max_rest_lengths[group + 1]
+               < walk->min_length) {
+            continue;
+        }
+        _num_enum_group(walk, group + 1,
+                        _num_append_short_digit(position, decade, digit),
+                        first);
+    }
+}
+
+
+/**
+ * @internal
+ * Walks the numerals with one sign and one kind of integer part, short or
+ * long, whose magnitude of the integer part is within the given range.
+ */
+static void _num_enum_walk_kind(struct _num_enum_walk *walk, bool long_numeral,
+                                long min_magnitude, long max_magnitude) {
+    char *position = walk->roman;
+    walk->long_numeral = long_numeral;
+    if (long_numeral) {
+        walk->min_magnitude = min_magnitude > NUMERUS_MAX_SHORT_VALUE
+                              ? min_magnitude : NUMERUS_MAX_SHORT_VALUE + 1;
+        walk->max_magnitude = max_magnitude;
+        walk->groups = 7;
+    } else {
+        walk->min_magnitude = min_magnitude;
+        walk->max_magnitude = max_magnitude < NUMERUS_MAX_SHORT_VALUE
+                              ? max_magnitude : NUMERUS_MAX_SHORT_VALUE;
+        walk->groups = 4;
+    }
+    if (walk->min_magnitude > walk->max_magnitude
+        || !(walk->kinds & (NUMERUS_ENUM_FLOAT
+                            | (long_numeral ? NUMERUS_ENUM_LONG
+                                            : NUMERUS_ENUM_SHORT)))) {
+        return;
+    }
+    long weight = long_numeral ? 1000000 : 1000;
+    short max_rest_length = 6; /* "S....." */
+    for (int group = 0; group < walk->groups; group++) {
+        walk->decades[group] = group < 4 ? group : group - 3;
+        walk->weights[group] = weight;
+        weight /= 10;
+    }
+    walk->max_rest_lengths[walk->groups] = max_rest_length;
+    for (int group = walk->groups - 1; group >= 0; group--) {
+        short max_digit_length = 0;
+        for (int digit = 0; digit < 10; digit++) {
+            short digit_length = walk->digit_lengths[walk->decades[group]][digit];
+            if (digit_length > max_digit_length) {
+                max_digit_length = digit_length;
+            }
+        }
+        max_rest_length += max_digit_length + (long_numeral && group == 4);
+        walk->max_rest_lengths[group] = max_rest_length;
+    }
+    if (walk->negative) {
+        *(position++) = '-';
+    }
+    if (long_numeral) {
+        *(position++) = '_';
+    }
+    _num_enum_group(walk, 0, position, 0);
+}
+
+
+/**
+ * @internal
+ * Walks all numerals passing the filter with lengths within the given range,
+ * in the order of value.
+ */
+static void _num_enum_walk_lengths(struct _num_enum_walk *walk,
+                                   const struct numerus_enum_filter *filter,
+                                   short min_length, short max_length) {
+    walk->min_length = min_length;
+    walk->max_length = max_length;
+    /* Negative numerals, from the most negative one */
+    if ((filter->kinds & NUMERUS_ENUM_NEGATIVE) && filter->min_int_part <= 0
+        && !walk->stopped) {
+        walk->negative = true;
+        long min_magnitude = filter->max_int_part < 0
+                             ? -filter->max_int_part : 0;
+        _num_enum_walk_kind(walk, true, min_magnitude, -filter->min_int_part);
+        _num_enum_walk_kind(walk, false, min_magnitude, -filter->min_int_part);
+    }
+    /* Zero, then positive numerals */
+    if ((filter->kinds & NUMERUS_ENUM_POSITIVE) && filter->max_int_part >= 0
+        && !walk->stopped) {
+        walk->negative = false;
+        if ((filter->kinds & NUMERUS_ENUM_SHORT) && filter->min_int_part <= 0) {
+            size_t zero_length = strlen(NUMERUS_ZERO);
+            memcpy(walk->roman, NUMERUS_ZERO, zero_length);
+            _num_enum_emit(walk, walk->roman + zero_length, 0, 0);
+        }
+        long min_magnitude = filter->min_int_part > 0
+                             ? filter->min_int_part : 0;
+        _num_enum_walk_kind(walk, false, min_magnitude, filter->max_int_part);
+        _num_enum_walk_kind(walk, true, min_magnitude, filter->max_int_part);
+    }
+}
+
+
+/**
+ * Lists all the valid roman numerals passing a filter, passing each one to a
+ * callback, in ascending order of value or grouped by length.
+ *
+ * The numerals are the canonical ones numerus_int_with_twelfth_to_roman()
+ * writes, uppercase. The kinds of the filter select them:
+ *
+ * - NUMERUS_ENUM_SHORT: integers without underscores, NUMERUS_ZERO included;
+ * - NUMERUS_ENUM_LONG: integers with underscores;
+ * - NUMERUS_ENUM_FLOAT: numerals with twelfths, with or without underscores;
+ * - NUMERUS_ENUM_POSITIVE and NUMERUS_ENUM_NEGATIVE: the signs to list, zero
+ *   counting as positive.
+ *
+ * With NUMERUS_ENUM_BY_VALUE the numerals come in ascending order of value,
+ * with NUMERUS_ENUM_BY_LENGTH in ascending order of length and of value
+ * within the same length.
+ *
+ * Does not touch numerus_error_code, so different threads may list different
+ * parts of the language at the same time, e.g. different ranges of integer
+ * parts or different lengths.
+ *
+ * @param *filter kinds, lengths and integer parts of the numerals to list.
+ * @param order NUMERUS_ENUM_BY_VALUE or NUMERUS_ENUM_BY_LENGTH.
+ * @param callback function called with each numeral, its length, integer part
+ * and twelfths and the context; returning non-zero stops the enumeration.
+ * Can be NULL to just count the numerals.
+ * @param *context pointer passed to each call of the callback.
+ * @returns size_t number of numerals passed to the callback.
+ */
+size_t numerus_enumerate(const struct numerus_enum_filter *filter, int order,
+                         numerus_enum_callback callback, void *context) {
+    struct _num_enum_walk walk;
+    walk.callback = callback;
+    walk.context = context;
+    walk.kinds = filter->kinds;
+    walk.count = 0;
+    walk.stopped = false;
+    for (int decade = 0; decade < 4; decade++) {
+        for (int digit = 0; digit < 10; digit++) {
+            walk.digit_lengths[decade][digit] = (short) (
+                    _num_append_short_digit(walk.roman, decade, digit)
+                    - walk.roman);
+        }
+    }
+    if (order == NUMERUS_ENUM_BY_LENGTH) {
+        for (short length = filter->min_length;
+             length <= filter->max_length && !walk.stopped; length++) {
+            _num_enum_walk_lengths(&walk, filter, length, length);
+        }
+    } else {
+        _num_enum_walk_lengths(&walk, filter, filter->min_length,
+                               filter->max_length);
+    }
+    return walk.count;
+}
+
+
+/**
+ * @internal
+ * Arena filled by numerus_enumerate_into().
+ */
+struct _num_enum_arena {
+    char *romans;
+    size_t capacity;
+    size_t used;
+    size_t written;
+};
+
+
+/**
+ * @internal
+ * Callback of numerus_enumerate_into(): appends the numeral to the arena.
+ */
+static int _num_enum_append_to_arena(const char *roman, short length,
+                                     long int_part, short twelfths,
+                                     void *context) {
+    struct _num_enum_arena *arena = context;
+    (void) int_part;
+    (void) twelfths;
+    if (arena->used + length + 1 > arena->capacity) {
+        return 1;
+    }
+    memcpy(arena->romans + arena->used, roman, (size_t) length + 1);
+    arena->used += length + 1;
+    arena->written++;
+    return 0;
+}
+
+
+/**
+ * Lists the valid roman numerals passing a filter into an arena, packed one
+ * after the other, each null-terminated, in ascending order of value or
+ * grouped by length as numerus_enumerate() does.
+ *
+ * Stops at the first numeral that doesn't fit: numerus_enumerate() with a
+ * NULL callback counts the numerals to size the arena, which needs for each
+ * one its length plus one '\0'.
+ *
+ * @param *filter kinds, lengths and integer parts of the numerals to list.
+ * @param order NUMERUS_ENUM_BY_VALUE or NUMERUS_ENUM_BY_LENGTH.
+ * @param *romans arena where to write the numerals.
+ * @param capacity size of the arena in chars.
+ * @param *used where to store the number of chars written in the arena. Can
+ * be NULL.
+ * @returns size_t number of numerals written in the arena.
+ */
+size_t numerus_enumerate_into(const struct numerus_enum_filter *filter,
+                              int order, char *romans, size_t capacity,
+                              size_t *used) {
+    struct _num_enum_arena arena = {romans, capacity, 0, 0};
+    numerus_enumerate(filter, order, _num_enum_append_to_arena, &arena);
+    if (used != NULL) {
+        *used = arena.used;
+    }
+    return arena.written;
+}
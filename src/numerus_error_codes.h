@@ -166,3 +166,40 @@
  * Remove the whitespace characters from inside the string and trim it.
  */
 #define NUMERUS_ERROR_WHITESPACE_CHARACTER 115
+
+
+/**
+ * The table file can't be opened or mapped in memory, or it's not a table
+ * file written by numerus_write_table_file() on this kind of machine.
+ *
+ * Write it again with the `numerus_mktable` tool. The conversions taking a
+ * table work without it, just slower.
+ */
+#define NUMERUS_ERROR_TABLE_FILE 116
+
+
+/**
+ * The pattern of numerus_format_date() contains an unknown conversion
+ * specification or the formatted date doesn't fit in the buffer.
+ *
+ * The known conversions are `%Y`, `%m`, `%d`, `%H`, `%M`, `%S` and `%%`.
+ */
+#define NUMERUS_ERROR_DATE_FORMAT 117
+
+
+/**
+ * The packed file can't be written, opened or mapped or is not a valid
+ * packed file.
+ *
+ * Returned by the functions of the packed files, numerus_pack_*().
+ */
+#define NUMERUS_ERROR_PACK_FILE 118
+
+
+/**
+ * The workload configuration has weights or rates out of their range or
+ * rates of errors the parsers never give, or its files can't be written.
+ *
+ * Returned by the functions of the workloads, numerus_workload_*().
+ */
+#define NUMERUS_ERROR_WORKLOAD 119
@@ -0,0 +1,504 @@
+/**
+ * @file numerus_ext.c
+ * @brief Numerus conversions of the extended range with nested overlines.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the conversions of 64-bit values beyond
+ * NUMERUS_MAX_LONG_NONFLOAT_VALUE, up to NUMERUS_EXT_MAX_VALUE, with
+ * separate entry points so the conversions of the normal range are not
+ * slowed down by any of it.
+ *
+ * The value is split in groups of three digits, the thousands, millions and
+ * billions, each multiplying by 1000 the value of the one after it. A group
+ * of level `k` is overlined `k` times, written between `k` underscores on
+ * each side, and empty groups are left out:
+ *
+ * <pre>
+ *         _IV_ =             4000
+ *  _MMMCMXCIX_ =        3 999 000
+ *       __IV__ =        4 000 000
+ *   __IV___I_I =        4 001 001
+ *  ___MCMLII___ = 1 952 000 000 000
+ * </pre>
+ *
+ * The top group, the first one, goes up to 3999 like the numeral before the
+ * underscores of long numerals, the others up to 999, without M. With one
+ * level the numerals are the long numerals of the normal range, so up to
+ * NUMERUS_MAX_LONG_NONFLOAT_VALUE both ranges write and read the same
+ * numerals. In the styled output each level of overline is a Unicode
+ * combining overline: U+0305 for one level, the double overline U+033F for
+ * two, both for three.
+ *
+ * Each group is encoded with the digit tables generated at build time and
+ * parsed one decade at a time, like the short numerals.
+ */
+
+#include <ctype.h>    /* For `isspace()`, `toupper()` */
+#include <string.h>   /* For `strchr()`, `strcpy()`, `strlen()`, `strstr()` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include "numerus_internal.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+
+/**
+ * Max number of levels of overline of the extended range.
+ */
+const short NUMERUS_EXT_MAX_LEVELS = 3;
+
+
+/**
+ * Biggest integer part of the extended range:
+ * `___MMMCMXCIX_____CMXCIX___CMXCIX_CMXCIX`.
+ */
+const int64_t NUMERUS_EXT_MAX_VALUE = INT64_C(3999999999999);
+
+
+/**
+ * Smallest integer part of the extended range.
+ */
+const int64_t NUMERUS_EXT_MIN_VALUE = -INT64_C(3999999999999);
+
+
+/**
+ * Max length of a numeral of the extended range, '\0' included, as
+ * numerus_ext_max_length() computes it for NUMERUS_EXT_MAX_LEVELS.
+ */
+const short NUMERUS_EXT_MAX_LENGTH = 71;
+
+
+/**
+ * Max size in bytes of a numeral of the extended range styled with Unicode
+ * overlines, '\0' included: each char can carry two combining marks of two
+ * bytes each.
+ */
+const short NUMERUS_EXT_MAX_STYLED_LENGTH = 5 * 70 + 1;
+
+
+/**
+ * @internal
+ * Powers of 1000: the multiplier of the groups of each level.
+ */
+static const int64_t _NUM_EXT_LEVEL_MULTIPLIERS[] = {
+        INT64_C(1), INT64_C(1000), INT64_C(1000000), INT64_C(1000000000),
+        INT64_C(1000000000000)
+};
+
+
+/**
+ * @internal
+ * UTF-8 combining marks of the levels of overline in the styled output.
+ */
+static const char *const _NUM_EXT_OVERLINES[] = {
+        "", "\xCC\x85", "\xCC\xBF", "\xCC\xBF\xCC\x85"
+};
+
+
+/**
+ * Computes the max length of a roman numeral, '\0' included, with up to the
+ * given levels of overline: a minus, the top group up to MMMDCCCLXXXVIII and
+ * its underscores, the other groups up to DCCCLXXXVIII and theirs and the
+ * twelfths up to S.....
+ *
+ * With one level it's NUMERUS_MAX_LENGTH, with NUMERUS_EXT_MAX_LEVELS it's
+ * NUMERUS_EXT_MAX_LENGTH.
+ *
+ * @param levels levels of overline, within [0, NUMERUS_EXT_MAX_LEVELS].
+ * @returns short max length of the numeral, '\0' included, or -1 if the
+ * levels are out of range.
+ */
+short numerus_ext_max_length(short levels) {
+    if (levels < 0 || levels > NUMERUS_EXT_MAX_LEVELS) {
+        return -1;
+    }
+    short length = 1 + 15 + 2 * levels + 6 + 1;
+    for (short level = 0; level < levels; level++) {
+        length += 12 + 2 * level;
+    }
+    return length;
+}
+
+
+/**
+ * @internal
+ * Writes the digits of a group, from the given decade: 0 for the top group,
+ * which can have thousands, 1 for the others.
+ *
+ * @returns position after the written chars.
+ */
+static char *_num_ext_write_group(char *roman, int64_t group, int first_decade) {
+    int divisor = 1000;
+    for (int decade = 0; decade < 4; decade++) {
+        if (decade >= first_decade) {
+            roman = _num_append_short_digit(roman, decade,
+                                            (int) (group / divisor));
+        }
+        group %= divisor;
+        divisor /= 10;
+    }
+    return roman;
+}
+
+
+/**
+ * @internal
+ * Writes `count` underscores.
+ *
+ * @returns position after the written chars.
+ */
+static char *_num_ext_write_underscores(char *roman, int count) {
+    while (count-- > 0) {
+        *(roman++) = '_';
+    }
+    return roman;
+}
+
+
+/**
+ * Converts a 64-bit integer value and a number of twelfths to a roman
+ * numeral of the extended range with their sum as value, written into a
+ * buffer provided by the caller.
+ *
+ * Within [NUMERUS_MIN_LONG_NONFLOAT_VALUE, NUMERUS_MAX_LONG_NONFLOAT_VALUE]
+ * the numeral is the one numerus_int_with_twelfth_to_roman_into() writes.
+ *
+ * The conversion status is stored in the errcode passed as parameter, which
+ * can be NULL to ignore the error, although it's not recommended. Values
+ * outside [NUMERUS_EXT_MIN_VALUE, NUMERUS_EXT_MAX_VALUE] result in
+ * NUMERUS_ERROR_VALUE_OUT_OF_RANGE and an empty string in the buffer.
+ *
+ * @param int_part integer part of the value.
+ * @param twelfths number of twelfths, added to the integer part.
+ * @param *roman buffer of at least NUMERUS_EXT_MAX_LENGTH chars where to
+ * write the null-terminated roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the written roman numeral, excluding '\0', or -1
+ * when an error occurs.
+ */
+short numerus_ext_int_with_twelfth_to_roman_into(int64_t int_part,
+                                                 short twelfths, char *roman,
+                                                 int *errcode) {
+    char *roman_numeral = roman;
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    /* Shorten the twelfths and give them the sign of the integer part */
+    int_part += twelfths / 12;
+    twelfths = (short) (twelfths % 12);
+    if (int_part > 0 && twelfths < 0) {
+        int_part -= 1;
+        twelfths += 12;
+    } else if (int_part < 0 && twelfths > 0) {
+        int_part += 1;
+        twelfths -= 12;
+    }
+    if (int_part > NUMERUS_EXT_MAX_VALUE || int_part < NUMERUS_EXT_MIN_VALUE) {
+        *roman = '\0';
+        numerus_error_code = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return -1;
+    }
+    numerus_error_code = NUMERUS_OK;
+    *errcode = NUMERUS_OK;
+    if (int_part == 0 && twelfths == 0) {
+        strcpy(roman, NUMERUS_ZERO);
+        return (short) strlen(NUMERUS_ZERO);
+    } else if (int_part < 0 || twelfths < 0) {
+        int_part = -int_part;
+        twelfths = (short) -twelfths;
+        *(roman_numeral++) = '-';
+    }
+
+    /* Top group, the only one that can have thousands */
+    int levels = 0;
+    while (int_part >= 4000 * _NUM_EXT_LEVEL_MULTIPLIERS[levels]) {
+        levels++;
+    }
+    roman_numeral = _num_ext_write_underscores(roman_numeral, levels);
+    roman_numeral = _num_ext_write_group(
+            roman_numeral, int_part / _NUM_EXT_LEVEL_MULTIPLIERS[levels], 0);
+    roman_numeral = _num_ext_write_underscores(roman_numeral, levels);
+
+    /* Lower groups, without the empty ones */
+    for (int level = levels - 1; level >= 0; level--) {
+        int64_t group = int_part / _NUM_EXT_LEVEL_MULTIPLIERS[level] % 1000;
+        if (group != 0) {
+            roman_numeral = _num_ext_write_underscores(roman_numeral, level);
+            roman_numeral = _num_ext_write_group(roman_numeral, group, 1);
+            roman_numeral = _num_ext_write_underscores(roman_numeral, level);
+        }
+    }
+    roman_numeral = _num_append_twelfths(roman_numeral, twelfths);
+    *roman_numeral = '\0';
+    return (short) (roman_numeral - roman);
+}
+
+
+/**
+ * Converts a 64-bit integer value to a roman numeral of the extended range,
+ * written into a buffer provided by the caller.
+ *
+ * @see numerus_ext_int_with_twelfth_to_roman_into()
+ */
+short numerus_ext_int_to_roman_into(int64_t int_value, char *roman,
+                                    int *errcode) {
+    return numerus_ext_int_with_twelfth_to_roman_into(int_value, 0, roman,
+                                                      errcode);
+}
+
+
+/**
+ * @internal
+ * Checks the chars of a numeral of the extended range.
+ *
+ * @returns int NUMERUS_OK or the error code of the first wrong char.
+ */
+static int _num_ext_check_chars(const char *roman) {
+    const char *position = roman;
+    if (*position == '\0') {
+        return NUMERUS_ERROR_EMPTY_ROMAN;
+    }
+    while (*position != '\0') {
+        if (position - roman >= NUMERUS_EXT_MAX_LENGTH - 1) {
+            return NUMERUS_ERROR_TOO_LONG_NUMERAL;
+        } else if (*position == '-' && position != roman) {
+            return NUMERUS_ERROR_ILLEGAL_MINUS;
+        } else if (isspace(*position)) {
+            return NUMERUS_ERROR_WHITESPACE_CHARACTER;
+        } else if (strchr("IVXLCDMS._-", toupper(*position)) == NULL) {
+            return NUMERUS_ERROR_ILLEGAL_CHARACTER;
+        }
+        position++;
+    }
+    return NUMERUS_OK;
+}
+
+
+/**
+ * @internal
+ * Parses the digits of one group: the top one can have thousands, the
+ * others can't.
+ *
+ * @returns position after the group or NULL with the error code set.
+ */
+static char *_num_ext_parse_group(char *roman, bool top, int64_t *group,
+                                  int *errcode) {
+    short digit;
+    *group = 0;
+    while (toupper(*roman) == 'M' && *group < 3000) {
+        if (!top) {
+            *errcode = NUMERUS_ERROR_M_IN_SHORT_PART;
+            return NULL;
+        }
+        *group += 1000;
+        roman++;
+    }
+    roman = _num_parse_short_digit(roman, 'C', 'D', 'M', &digit);
+    *group += digit * 100;
+    roman = _num_parse_short_digit(roman, 'X', 'L', 'C', &digit);
+    *group += digit * 10;
+    roman = _num_parse_short_digit(roman, 'I', 'V', 'X', &digit);
+    *group += digit;
+    if (toupper(*roman) == 'M') {
+        *errcode = top ? NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE
+                       : NUMERUS_ERROR_M_IN_SHORT_PART;
+        return NULL;
+    }
+    return roman;
+}
+
+
+/**
+ * @internal
+ * Parses a numeral with nested levels of overline, its chars checked.
+ *
+ * @returns int64_t value of the integer part, without sign, or -1 with the
+ * error code set.
+ */
+static int64_t _num_ext_parse_levels(char *roman, short *twelfths,
+                                     int *errcode) {
+    int64_t int_part = 0;
+    int64_t group;
+    int previous_level = NUMERUS_EXT_MAX_LEVELS + 1;
+    bool top = true;
+    while (*roman == '_') {
+        int level = 0;
+        while (roman[level] == '_') {
+            level++;
+        }
+        if (level > NUMERUS_EXT_MAX_LEVELS) {
+            *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+            return -1;
+        } else if (level >= previous_level) {
+            *errcode = NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART;
+            return -1;
+        }
+        roman = _num_ext_parse_group(roman + level, top, &group, errcode);
+        if (roman == NULL) {
+            return -1;
+        }
+        for (int closing = 0; closing < level; closing++, roman++) {
+            if (*roman != '_') {
+                *errcode = toupper(*roman) == 'S' || *roman == '.'
+                           ? NUMERUS_ERROR_DECIMALS_IN_LONG_PART
+                           : *roman == '\0'
+                             ? NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE
+                             : NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE;
+                return -1;
+            }
+        }
+        if (group == 0) {
+            *errcode = NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE;
+            return -1;
+        }
+        int_part += group * _NUM_EXT_LEVEL_MULTIPLIERS[level];
+        previous_level = level;
+        top = false;
+    }
+    roman = _num_ext_parse_group(roman, top, &group, errcode);
+    if (roman == NULL) {
+        return -1;
+    }
+    int_part += group;
+    *twelfths = 0;
+    if (toupper(*roman) == 'S') {
+        *twelfths = 6;
+        roman++;
+    }
+    while (*roman == '.' && *twelfths % 6 < 5) {
+        (*twelfths)++;
+        roman++;
+    }
+    if (*roman != '\0') {
+        *errcode = *roman == '_' ? NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART
+                                 : NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE;
+        return -1;
+    }
+    *errcode = NUMERUS_OK;
+    return int_part;
+}
+
+
+/**
+ * Converts a roman numeral of the extended range to its value expressed as
+ * pair of its 64-bit integer part and number of twelfths.
+ *
+ * Numerals with at most one level of underscores are parsed by
+ * numerus_roman_to_int_part_and_twelfths(), so they are accepted and
+ * rejected with the same error codes. Numerals with nested levels follow the
+ * syntax of numerus_ext_int_with_twelfth_to_roman_into(), case INsensitive;
+ * the errors are the ones of the same mistakes in long numerals, e.g.
+ * NUMERUS_ERROR_M_IN_SHORT_PART for an M in a group after the top one.
+ *
+ * @param *roman string with a roman numeral.
+ * @param *twelfths number of twelfths from -11 to 11, with the sign of the
+ * value. NULL is interpreted as 0 twelfths.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns int64_t integer part of the value of the roman numeral or a value
+ * outside the extended range when an error occurs.
+ */
+int64_t numerus_ext_roman_to_int_part_and_twelfths(char *roman,
+                                                   short *twelfths,
+                                                   int *errcode) {
+    short zero_twelfths;
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    if (twelfths == NULL) {
+        twelfths = &zero_twelfths;
+    }
+    if (roman == NULL || strstr(roman, "__") == NULL) {
+        /* No nested levels: a numeral of the normal range */
+        long int_part = numerus_roman_to_int_part_and_twelfths(
+                roman, twelfths, errcode);
+        return *errcode == NUMERUS_OK ? int_part : NUMERUS_EXT_MAX_VALUE + 10;
+    }
+    /* "__" is also an empty long part of the normal range, as in "__X" */
+    long normal_int_part = numerus_roman_to_int_part_and_twelfths(
+            roman, twelfths, errcode);
+    if (*errcode == NUMERUS_OK) {
+        return normal_int_part;
+    }
+    *errcode = _num_ext_check_chars(roman);
+    int64_t int_part = -1;
+    if (*errcode == NUMERUS_OK) {
+        int_part = _num_ext_parse_levels(roman + (*roman == '-'), twelfths,
+                                         errcode);
+    }
+    numerus_error_code = *errcode;
+    if (*errcode != NUMERUS_OK) {
+        return NUMERUS_EXT_MAX_VALUE + 10;
+    }
+    if (*roman == '-') {
+        *twelfths = (short) -*twelfths;
+        return -int_part;
+    }
+    return int_part;
+}
+
+
+/**
+ * Styles a roman numeral of the extended range with Unicode overlines on one
+ * line: each char of a group of level `k` is followed by the combining marks
+ * of `k` levels of overline and the underscores are dropped.
+ *
+ * The numeral is not checked beyond its underscores: convert it first to be
+ * sure it's valid.
+ *
+ * @param *roman roman numeral of the extended range.
+ * @param *styled buffer of at least NUMERUS_EXT_MAX_STYLED_LENGTH bytes where
+ * to write the null-terminated UTF-8 string.
+ * @param *errcode int where to store the status: NUMERUS_OK,
+ * NUMERUS_ERROR_NULL_ROMAN or NUMERUS_ERROR_TOO_LONG_NUMERAL.
+ * Can be NULL to ignore the error (NOT recommended).
+ * @returns short length in bytes of the styled string, excluding '\0', or -1
+ * when an error occurs.
+ */
+short numerus_ext_overline_into(char *roman, char *styled, int *errcode) {
+    char *position = styled;
+    int level = 0;
+    bool closing = false;
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    if (roman == NULL) {
+        *styled = '\0';
+        numerus_error_code = NUMERUS_ERROR_NULL_ROMAN;
+        *errcode = NUMERUS_ERROR_NULL_ROMAN;
+        return -1;
+    }
+    if (strlen(roman) >= (size_t) NUMERUS_EXT_MAX_LENGTH) {
+        *styled = '\0';
+        numerus_error_code = NUMERUS_ERROR_TOO_LONG_NUMERAL;
+        *errcode = NUMERUS_ERROR_TOO_LONG_NUMERAL;
+        return -1;
+    }
+    while (*roman != '\0') {
+        if (*roman == '_') {
+            int run = 0;
+            while (roman[run] == '_') {
+                run++;
+            }
+            roman += run;
+            /* A run closes the open group, what's left opens the next */
+            if (closing) {
+                run -= level;
+            }
+            level = run > NUMERUS_EXT_MAX_LEVELS ? NUMERUS_EXT_MAX_LEVELS
+                                                 : run;
+            closing = level > 0;
+            continue;
+        }
+        *(position++) = *(roman++);
+        strcpy(position, _NUM_EXT_OVERLINES[level]);
+        position += strlen(_NUM_EXT_OVERLINES[level]);
+    }
+    *position = '\0';
+    numerus_error_code = NUMERUS_OK;
+    *errcode = NUMERUS_OK;
+    return (short) (position - styled);
+}
@@ -0,0 +1,256 @@
+/**
+ * @file numerus_format.hpp
+ * @brief Numerus formatters for `std::format` and {fmt}
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This header adds formatter specialisations that write roman numerals
+ * directly into the output iterator of `std::format` (when the standard
+ * library provides it) and of {fmt} (when `<fmt/format.h>` is available).
+ * Values are converted with the buffer-based encoder
+ * numerus_int_with_twelfth_to_roman_into(), so formatting allocates nothing.
+ *
+ * Formattable types are numerus::roman and numerus::as_roman, a thin wrapper
+ * around any integer or floating point value:
+ *
+ * <pre>
+ * std::format("{:R}", numerus::as_roman(2016));    // "MMXVI"
+ * std::format("{:r}", numerus::as_roman(2016));    // "mmxvi"
+ * std::format("{:tR}", numerus::as_roman(30));     // "IIS", 30 twelfths
+ * std::format("{:uR}", numerus::as_roman(12000));  // "X̅I̅I̅", Unicode
+ * std::format("{:oR}", numerus::as_roman(-12000)); // " ___\n-XII"
+ * </pre>
+ *
+ * The format specification is `[o|u][t][R|r]`:
+ *
+ * - `R` uppercase numeral (default), `r` lowercase numeral;
+ * - `o` overlines the long part on a line above, like
+ *   numerus_overline_long_numerals(); `u` overlines it with the Unicode
+ *   combining overline U+0305 instead; without either, the underscore
+ *   notation is kept;
+ * - `t` interprets an integer argument as a number of twelfths, for
+ *   fixed-point values. Floating point arguments always keep their twelfths.
+ */
+
+#ifndef NUMERUS_FORMAT_HPP
+#define NUMERUS_FORMAT_HPP
+
+#include <type_traits>  /* For `std::is_integral_v` */
+#include <version>      /* For `__cpp_lib_format` */
+#include "numerus.hpp"
+
+#if defined(__cpp_lib_format)
+#include <format>
+#endif
+
+#if __has_include(<fmt/format.h>)
+#include <fmt/format.h>
+#endif
+
+
+namespace numerus {
+
+
+/**
+ * Value to be formatted as roman numeral with `std::format` or {fmt}.
+ *
+ * Just stores the value: the conversion happens while formatting.
+ */
+class as_roman {
+public:
+    template<typename Integer,
+             typename std::enable_if_t<std::is_integral_v<Integer>, int> = 0>
+    constexpr explicit as_roman(Integer integer) noexcept
+            : integer_value(static_cast<long>(integer)),
+              double_value(0), is_integer(true) {
+    }
+
+    template<typename Floating,
+             typename std::enable_if_t<std::is_floating_point_v<Floating>,
+                                       long> = 0>
+    constexpr explicit as_roman(Floating floating) noexcept
+            : integer_value(0), double_value(static_cast<double>(floating)),
+              is_integer(false) {
+    }
+
+    /**
+     * Converts the value to roman numeral into the buffer of at least
+     * NUMERUS_MAX_LENGTH chars.
+     *
+     * @param twelfths if true, an integer value is a number of twelfths.
+     * @returns short length of the numeral or -1 on error.
+     */
+    short to_roman_into(bool twelfths, char *roman, int *errcode) const {
+        if (!is_integer) {
+            return numerus_double_to_roman_into(double_value, roman, errcode);
+        }
+        if (!twelfths) {
+            return numerus_int_to_roman_into(integer_value, roman, errcode);
+        }
+        return numerus_int_with_twelfth_to_roman_into(
+                integer_value / 12, static_cast<short>(integer_value % 12),
+                roman, errcode);
+    }
+
+private:
+    long integer_value;
+    double double_value;
+    bool is_integer;
+};
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * Formatter of roman numerals shared by the `std::format` and {fmt}
+ * specialisations, which only differ in the exception type to throw on
+ * errors.
+ */
+template<typename FormatError>
+class roman_formatter {
+public:
+
+    template<typename ParseContext>
+    constexpr auto parse(ParseContext &context) {
+        auto position = context.begin();
+        while (position != context.end() && *position != '}') {
+            switch (*position) {
+                case 'R': {
+                    lowercase = false;
+                    break;
+                }
+                case 'r': {
+                    lowercase = true;
+                    break;
+                }
+                case 'o':
+                case 'u': {
+                    if (overline != '_') {
+                        throw FormatError(
+                                "Roman numeral format: only one of 'o' and "
+                                "'u' is allowed.");
+                    }
+                    overline = *position;
+                    break;
+                }
+                case 't': {
+                    twelfths = true;
+                    break;
+                }
+                default: {
+                    throw FormatError("Roman numeral format: invalid "
+                                      "specifier, expected [o|u][t][R|r].");
+                }
+            }
+            ++position;
+        }
+        return position;
+    }
+
+    template<typename FormatContext>
+    auto format(const as_roman &value, FormatContext &context) const {
+        char roman[max_length];
+        int errcode;
+        value.to_roman_into(twelfths, roman, &errcode);
+        if (errcode != NUMERUS_OK) {
+            throw FormatError(numerus_explain_error(errcode));
+        }
+        return write(roman, context.out());
+    }
+
+    template<typename FormatContext>
+    auto format(const roman &value, FormatContext &context) const {
+        return write(value.c_str(), context.out());
+    }
+
+private:
+    bool lowercase = false;
+    bool twelfths = false;
+    char overline = '_';
+
+    constexpr char cased(char roman_char) const {
+        if (lowercase && roman_char >= 'A' && roman_char <= 'Z') {
+            return static_cast<char>(roman_char - 'A' + 'a');
+        }
+        return roman_char;
+    }
+
+    /**
+     * Writes the valid roman numeral to the output iterator, applying case
+     * and overlining.
+     */
+    template<typename OutputIterator>
+    OutputIterator write(const char *roman, OutputIterator out) const {
+        bool is_long = roman[0] == '_' || (roman[0] == '-' && roman[1] == '_');
+        if (overline == 'o' && is_long) {
+            /* Overline on the line above, as numerus_overline_long_numerals */
+            const char *current = roman;
+            if (*current == '-') {
+                *out++ = ' ';
+                current++;
+            }
+            current++; /* Skip first underscore */
+            while (*current != '_') {
+                *out++ = '_';
+                current++;
+            }
+            *out++ = '\n';
+        }
+        bool in_long_part = false;
+        for (const char *current = roman; *current != '\0'; current++) {
+            if (*current == '_' && overline != '_') {
+                in_long_part = !in_long_part;
+                continue;
+            }
+            *out++ = cased(*current);
+            if (in_long_part && overline == 'u') {
+                /* UTF-8 encoding of the combining overline U+0305 */
+                *out++ = static_cast<char>(0xCC);
+                *out++ = static_cast<char>(0x85);
+            }
+        }
+        return out;
+    }
+};
+
+
+} /* namespace detail */
+
+
+} /* namespace numerus */
+
+
+#if defined(__cpp_lib_format)
+
+template<>
+struct std::formatter<numerus::as_roman>
+        : numerus::detail::roman_formatter<std::format_error> {
+};
+
+template<>
+struct std::formatter<numerus::roman>
+        : numerus::detail::roman_formatter<std::format_error> {
+};
+
+#endif /* __cpp_lib_format */
+
+
+#if defined(FMT_VERSION)
+
+template<>
+struct fmt::formatter<numerus::as_roman>
+        : numerus::detail::roman_formatter<fmt::format_error> {
+};
+
+template<>
+struct fmt::formatter<numerus::roman>
+        : numerus::detail::roman_formatter<fmt::format_error> {
+};
+
+#endif /* FMT_VERSION */
+
+#endif /* NUMERUS_FORMAT_HPP */
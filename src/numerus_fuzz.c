@@ -0,0 +1,359 @@
+/**
+ * @file numerus_fuzz.c
+ * @brief Numerus differential fuzzing harness of the parsers and encoders.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Feeds arbitrary bytes to every parser as a null-terminated string and
+ * aborts when one of them doesn't give the same error code and, for valid
+ * numerals, the same value as the reference: the dictionary walk of the
+ * `_num_parse_*` functions behind numerus_roman_to_int_part_and_twelfths().
+ *
+ * The first 8 bytes are also read as a value, mostly within the conversion
+ * range, encoded by every encoder, whose numerals and errors must be the
+ * ones of numerus_int_with_twelfth_to_roman_into() and parse back to the
+ * value.
+ *
+ * The parsers are the core ones for doubles, integers and short integers,
+ * the short parser of numerus_inline.h, the batch parser with each SIMD
+ * level, the extended range parser, the value range of the completion
+ * automaton and the table file given by the NUMERUS_FUZZ_TABLE environment
+ * variable.
+ *
+ * Built with Clang it's a libFuzzer target, also for AFL++ with
+ * afl-clang-fast: `cmake -DNUMERUS_FUZZ=ON -DCMAKE_C_COMPILER=clang` and
+ * `numerus_fuzz corpus/`. Built with other compilers it replays the inputs
+ * of the files given as arguments, or of stdin, e.g. for AFL++ with
+ * afl-gcc-fast: `afl-fuzz -i seeds -o findings -- numerus_fuzz`.
+ */
+
+#include <stdint.h>   /* For `uint8_t`, `uint64_t` */
+#include <stdio.h>    /* For `fprintf()`, `fread()` */
+#include <stdlib.h>   /* For `abort()`, `getenv()`, `free()` */
+#include <string.h>   /* For `memcpy()`, `memset()`, `strcmp()` */
+#include "numerus.h"
+#include "numerus_inline.h"
+
+
+/**
+ * @internal
+ * Longest input parsed, longer than any numeral and than the max length
+ * checked by the parsers.
+ */
+#define _NUM_FUZZ_MAX_INPUT 256
+
+
+/**
+ * @internal
+ * Slot of the batch parser, larger than the input so the SIMD kernels may
+ * read the garbage after its '\0'.
+ */
+#define _NUM_FUZZ_STRIDE (_NUM_FUZZ_MAX_INPUT + 64)
+
+
+/**
+ * @internal
+ * Size of the buffers of the numerals, large enough for the extended range.
+ */
+#define _NUM_FUZZ_ROMAN_SIZE 128
+
+
+#ifndef NUMERUS_NO_MALLOC
+/**
+ * @internal
+ * Table file of NUMERUS_FUZZ_TABLE, opened at the first input.
+ */
+static struct numerus_table *_num_fuzz_table = NULL;
+static int _num_fuzz_table_opened = 0;
+#endif
+
+
+/**
+ * @internal
+ * Reports a difference from the reference and aborts, so the fuzzer keeps
+ * the input.
+ */
+static void _num_fuzz_fail(const char *backend, const char *roman,
+                           long expected_int_part, short expected_twelfths,
+                           int expected_errcode, long got_int_part,
+                           short got_twelfths, int got_errcode) {
+    fprintf(stderr,
+            "%s differs on \"%s\": expected %ld and %d/12 (%s), "
+            "got %ld and %d/12 (%s)\n",
+            backend, roman, expected_int_part, expected_twelfths,
+            numerus_explain_error(expected_errcode), got_int_part,
+            got_twelfths, numerus_explain_error(got_errcode));
+    abort();
+}
+
+
+/**
+ * @internal
+ * Checks that a parser gives the result of the reference: the same error
+ * code and, if valid, the same value.
+ */
+static void _num_fuzz_check(const char *backend, const char *roman,
+                            long int_part, short twelfths, int errcode,
+                            long got_int_part, short got_twelfths,
+                            int got_errcode) {
+    if (got_errcode != errcode
+        || (errcode == NUMERUS_OK
+            && (got_int_part != int_part || got_twelfths != twelfths))) {
+        _num_fuzz_fail(backend, roman, int_part, twelfths, errcode,
+                       got_int_part, got_twelfths, got_errcode);
+    }
+}
+
+
+/**
+ * @internal
+ * Parses the input with every parser and compares them with the reference.
+ */
+static void _num_fuzz_parsers(char *roman, size_t length) {
+    static const char *const simd_names[] = {
+        "batch scalar", "batch sse4.1", "batch avx2", "batch avx512"
+    };
+    static char slot[_NUM_FUZZ_STRIDE];
+    int errcode;
+    short twelfths = 0;
+    long int_part = numerus_roman_to_int_part_and_twelfths(roman, &twelfths,
+                                                           &errcode);
+    int got_errcode;
+    short got_twelfths = 0;
+
+    /* Core parsers of other types */
+    double double_value = numerus_roman_to_double(roman, &got_errcode);
+    if (got_errcode != errcode
+        || (errcode == NUMERUS_OK
+            && double_value != numerus_parts_to_double(int_part, twelfths))) {
+        _num_fuzz_fail("numerus_roman_to_double", roman, int_part, twelfths,
+                       errcode, (long) double_value, 0, got_errcode);
+    }
+    /* The integer part, without the twelfths */
+    long got_int_part = numerus_roman_to_int(roman, &got_errcode);
+    _num_fuzz_check("numerus_roman_to_int", roman, int_part, 0, errcode,
+                    got_int_part, 0, got_errcode);
+
+    /* Short parsers: out of range for the valid numerals out of the domain */
+    int short_errcode = errcode;
+    if (errcode == NUMERUS_OK
+        && (twelfths != 0 || int_part > NUMERUS_MAX_SHORT_VALUE
+            || int_part < NUMERUS_MIN_SHORT_VALUE)) {
+        short_errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+    }
+    got_int_part = numerus_roman_to_short_int(roman, &got_errcode);
+    _num_fuzz_check("numerus_roman_to_short_int", roman, int_part, 0,
+                    short_errcode, got_int_part, 0, got_errcode);
+    got_int_part = numerus_inline_roman_to_short_int(roman, &got_errcode);
+    _num_fuzz_check("numerus_inline_roman_to_short_int", roman, int_part, 0,
+                    short_errcode, got_int_part, 0, got_errcode);
+
+    /* Batch parser with each SIMD level, with garbage after the '\0' */
+    memset(slot, 'M', sizeof(slot));
+    memcpy(slot, roman, length + 1);
+    int best_level = numerus_simd_level();
+    for (int level = NUMERUS_SIMD_SCALAR; level <= best_level; level++) {
+        numerus_set_simd_level(level);
+        numerus_roman_to_int_part_and_twelfths_batch(
+                slot, _NUM_FUZZ_STRIDE, 1, &got_int_part, &got_twelfths,
+                &got_errcode);
+        _num_fuzz_check(simd_names[level], roman, int_part, twelfths,
+                        errcode, got_int_part, got_twelfths, got_errcode);
+    }
+    numerus_set_simd_level(best_level);
+
+    /* Extended range: the same as the core without nested levels "__" */
+    got_int_part = (long) numerus_ext_roman_to_int_part_and_twelfths(
+            roman, &got_twelfths, &got_errcode);
+    if (errcode == NUMERUS_OK || strstr(roman, "__") == NULL) {
+        _num_fuzz_check("numerus_ext_roman_to_int_part_and_twelfths", roman,
+                        int_part, twelfths, errcode, got_int_part,
+                        got_twelfths, got_errcode);
+    }
+
+    /* Completion automaton, of the numerals as the encoders write them: one
+     * of them is within the range of values of itself as prefix */
+    char canonical[_NUM_FUZZ_ROMAN_SIZE];
+    double min_value;
+    double max_value;
+    if (errcode == NUMERUS_OK
+        && numerus_int_with_twelfth_to_roman_into(int_part, twelfths,
+                                                  canonical, NULL) > 0
+        && strcmp(canonical, roman) == 0
+        && (!numerus_prefix_value_range(roman, &min_value, &max_value)
+            || double_value < min_value || double_value > max_value)) {
+        _num_fuzz_fail("numerus_prefix_value_range", roman, int_part,
+                       twelfths, errcode, 0, 0, NUMERUS_ERROR_GENERIC);
+    }
+
+#ifndef NUMERUS_NO_MALLOC
+    if (_num_fuzz_table != NULL) {
+        got_int_part = numerus_table_roman_to_int_part_and_twelfths(
+                _num_fuzz_table, roman, &got_twelfths, &got_errcode);
+        _num_fuzz_check("numerus_table_roman_to_int_part_and_twelfths", roman,
+                        int_part, twelfths, errcode, got_int_part,
+                        got_twelfths, got_errcode);
+    }
+#endif
+}
+
+
+/**
+ * @internal
+ * Checks that an encoder gives the numeral and the error of the reference.
+ */
+static void _num_fuzz_check_numeral(const char *backend, long int_part,
+                                    short twelfths, const char *expected,
+                                    short expected_length, int errcode,
+                                    const char *got, short got_length,
+                                    int got_errcode) {
+    if (got_errcode != errcode
+        || (errcode == NUMERUS_OK
+            && (got_length != expected_length || strcmp(got, expected) != 0))) {
+        fprintf(stderr,
+                "%s differs on %ld and %d/12: expected \"%s\" (%s), "
+                "got \"%s\" (%s)\n",
+                backend, int_part, twelfths,
+                errcode == NUMERUS_OK ? expected : "",
+                numerus_explain_error(errcode),
+                got_errcode == NUMERUS_OK ? got : "",
+                numerus_explain_error(got_errcode));
+        abort();
+    }
+}
+
+
+/**
+ * @internal
+ * Encodes a value with every encoder and compares them with the reference,
+ * parsing the reference numeral back.
+ */
+static void _num_fuzz_encoders(long int_part, short twelfths) {
+    char expected[_NUM_FUZZ_ROMAN_SIZE];
+    char roman[_NUM_FUZZ_ROMAN_SIZE];
+    int errcode;
+    int got_errcode;
+    short length = numerus_int_with_twelfth_to_roman_into(int_part, twelfths,
+                                                          expected, &errcode);
+    short got_length = numerus_int_with_twelfth_to_roman_length(
+            int_part, twelfths, &got_errcode);
+    _num_fuzz_check_numeral("numerus_int_with_twelfth_to_roman_length",
+                            int_part, twelfths, expected, length, errcode,
+                            expected, got_length, got_errcode);
+    got_length = numerus_inline_int_with_twelfth_to_roman_into(
+            int_part, twelfths, roman, &got_errcode);
+    _num_fuzz_check_numeral("numerus_inline_int_with_twelfth_to_roman_into",
+                            int_part, twelfths, expected, length, errcode,
+                            roman, got_length, got_errcode);
+    numerus_int_with_twelfth_to_roman_batch(&int_part, &twelfths, 1, roman,
+                                            _NUM_FUZZ_ROMAN_SIZE,
+                                            &got_errcode);
+    _num_fuzz_check_numeral("numerus_int_with_twelfth_to_roman_batch",
+                            int_part, twelfths, expected, length, errcode,
+                            roman, (short) strlen(roman), got_errcode);
+    got_length = numerus_double_to_roman_into(
+            numerus_parts_to_double(int_part, twelfths), roman, &got_errcode);
+    _num_fuzz_check_numeral("numerus_double_to_roman_into", int_part,
+                            twelfths, expected, length, errcode, roman,
+                            got_length, got_errcode);
+    if (twelfths == 0 && int_part >= NUMERUS_MIN_SHORT_VALUE
+        && int_part <= NUMERUS_MAX_SHORT_VALUE) {
+        got_length = numerus_short_int_to_roman_into(int_part, roman,
+                                                     &got_errcode);
+        _num_fuzz_check_numeral("numerus_short_int_to_roman_into", int_part,
+                                twelfths, expected, length, errcode, roman,
+                                got_length, got_errcode);
+    }
+    if (errcode != NUMERUS_OK) {
+        return;
+    }
+    /* The extended range and the iterator only for values in range */
+    got_length = numerus_ext_int_with_twelfth_to_roman_into(
+            int_part, twelfths, roman, &got_errcode);
+    _num_fuzz_check_numeral("numerus_ext_int_with_twelfth_to_roman_into",
+                            int_part, twelfths, expected, length, errcode,
+                            roman, got_length, got_errcode);
+    struct numerus_iter iter;
+    numerus_iter_init(&iter, int_part, twelfths, 1, &got_errcode);
+    got_length = numerus_iter_next(&iter, roman, &got_errcode);
+    _num_fuzz_check_numeral("numerus_iter_next", int_part, twelfths, expected,
+                            length, errcode, roman, got_length, got_errcode);
+#ifndef NUMERUS_NO_MALLOC
+    if (_num_fuzz_table != NULL) {
+        got_length = numerus_table_int_with_twelfth_to_roman_into(
+                _num_fuzz_table, int_part, twelfths, roman, &got_errcode);
+        _num_fuzz_check_numeral(
+                "numerus_table_int_with_twelfth_to_roman_into", int_part,
+                twelfths, expected, length, errcode, roman, got_length,
+                got_errcode);
+    }
+#endif
+    short parsed_twelfths = 0;
+    long parsed = numerus_roman_to_int_part_and_twelfths(
+            expected, &parsed_twelfths, &got_errcode);
+    _num_fuzz_check("round trip", expected, int_part, twelfths, errcode,
+                    parsed, parsed_twelfths, got_errcode);
+}
+
+
+/**
+ * Entry point of libFuzzer and of the replay driver: one input.
+ */
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    char roman[_NUM_FUZZ_MAX_INPUT + 1];
+#ifndef NUMERUS_NO_MALLOC
+    if (!_num_fuzz_table_opened) {
+        const char *path = getenv("NUMERUS_FUZZ_TABLE");
+        _num_fuzz_table = path == NULL ? NULL
+                                       : numerus_open_table_file(path, NULL);
+        _num_fuzz_table_opened = 1;
+    }
+#endif
+    size_t length = size > _NUM_FUZZ_MAX_INPUT ? _NUM_FUZZ_MAX_INPUT : size;
+    memcpy(roman, data, length);
+    roman[length] = '\0';
+    _num_fuzz_parsers(roman, strlen(roman));
+    if (size >= 8) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; i++) {
+            bits = bits << 8 | data[i];
+        }
+        /* Mostly in range, with a few values out of it on both sides */
+        long value = (long) (bits % 96000099ULL) - 48000049L;
+        _num_fuzz_encoders(value / 12, (short) (value % 12));
+    }
+    return 0;
+}
+
+
+#ifdef NUMERUS_FUZZ_REPLAY
+/**
+ * @internal
+ * Reads a whole input, truncated to what the harness uses.
+ */
+static size_t _num_fuzz_read(FILE *file, uint8_t *data) {
+    return fread(data, 1, _NUM_FUZZ_MAX_INPUT, file);
+}
+
+
+int main(int argc, char **args) {
+    uint8_t data[_NUM_FUZZ_MAX_INPUT];
+    if (argc < 2) {
+        LLVMFuzzerTestOneInput(data, _num_fuzz_read(stdin, data));
+        return 0;
+    }
+    for (int i = 1; i < argc; i++) {
+        FILE *file = fopen(args[i], "rb");
+        if (file == NULL) {
+            perror(args[i]);
+            return 1;
+        }
+        size_t size = _num_fuzz_read(file, data);
+        fclose(file);
+        LLVMFuzzerTestOneInput(data, size);
+    }
+    return 0;
+}
+#endif
@@ -0,0 +1,362 @@
+/**
+ * @file numerus_inline.h
+ * @brief Numerus inline versions of the hot conversion functions
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This optional header contains `static inline` versions of the value to
+ * roman numeral encoder, of the short numeral decoder and of the twelfths
+ * management functions, so the compiler can inline and constant-fold them
+ * into the loops of the caller instead of calling into the library.
+ *
+ * Each `numerus_inline_*()` function has the same parameters, results, error
+ * codes and effects on numerus_error_code of the library function with the
+ * same name without `inline_`, and uses the same tables, generated at build
+ * time into `numerus_tables.h`, which must be in the include path. The
+ * library must still be linked: numerals the inline short decoder can't
+ * parse on its own are left to the library.
+ *
+ * Defining NUMERUS_INLINE_CHECK before including this header makes every
+ * inline function call the library function too and assert() that the
+ * results agree. The CMake option of the same name builds and runs an
+ * exhaustive comparison of the two implementations as part of the build.
+ */
+
+#ifndef NUMERUS_INLINE_H
+#define NUMERUS_INLINE_H
+
+#include <ctype.h>    /* For `toupper()` */
+#include <math.h>     /* For `round()` */
+#include <string.h>   /* For `strcpy()`, `strlen()` */
+#if defined(NUMERUS_INLINE_CHECK)
+#include <assert.h>   /* For `assert()` */
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "numerus.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+
+/**
+ * Converts a value expressed as sum of an integer part and a number of twelfths
+ * to a double.
+ *
+ * @see numerus_parts_to_double()
+ */
+static inline double numerus_inline_parts_to_double(long int_part,
+                                                    short twelfths) {
+    double value = (double) (int_part) + twelfths / 12.0;
+#if defined(NUMERUS_INLINE_CHECK)
+    assert(value == numerus_parts_to_double(int_part, twelfths));
+#endif
+    return value;
+}
+
+
+/**
+ * Splits a double value to a pair of its integer part and a number of twelfths.
+ *
+ * @see numerus_double_to_parts()
+ */
+static inline long numerus_inline_double_to_parts(double value,
+                                                  short *twelfths) {
+    short zero_twelfths = 0;
+    if (twelfths == NULL) {
+        twelfths = &zero_twelfths;
+    }
+    long int_part = (long) value;
+    double decimals = value - int_part;
+    decimals = round(decimals * 12) / 12; /* Round to nearest twelfth */
+    *twelfths = (short) round(decimals * 12);
+#if defined(NUMERUS_INLINE_CHECK)
+    short checked_twelfths;
+    assert(int_part == numerus_double_to_parts(value, &checked_twelfths));
+    assert(*twelfths == checked_twelfths);
+    (void) checked_twelfths;
+#endif
+    return int_part;
+}
+
+
+/**
+ * Shortens the twelfths by adding the remainder to the int part so that they
+ * have the same sign.
+ *
+ * @see numerus_shorten_and_same_sign_to_parts()
+ */
+static inline void numerus_inline_shorten_and_same_sign_to_parts(
+        long *int_part, short *twelfths) {
+#if defined(NUMERUS_INLINE_CHECK)
+    long checked_int_part = *int_part;
+    short checked_twelfths = *twelfths;
+    numerus_shorten_and_same_sign_to_parts(&checked_int_part,
+                                           &checked_twelfths);
+#endif
+    *int_part += *twelfths / 12;
+    *twelfths = *twelfths % (short) 12;
+    if (*int_part > 0 && *twelfths < 0) {
+        *int_part -= 1;
+        *twelfths += 12;
+    } else if (*int_part < 0 && *twelfths > 0) {
+        *int_part += 1;
+        *twelfths -= 12;
+    }
+#if defined(NUMERUS_INLINE_CHECK)
+    assert(*int_part == checked_int_part && *twelfths == checked_twelfths);
+#endif
+}
+
+
+/**
+ * @internal
+ * Writes the roman numeral of a value within [0, 3999] without sign, starting
+ * from the given decade: 0 for the thousands, 1 for the hundreds.
+ *
+ * @returns position after the written chars.
+ */
+static inline char *_num_inline_digits_to_roman(long value, char *roman,
+                                                int first_decade) {
+    long divisor = 1000;
+    for (int decade = 0; decade < 4; decade++) {
+        if (decade >= first_decade) {
+            roman = _num_append_short_digit(roman, decade,
+                                            (int) (value / divisor));
+        }
+        value %= divisor;
+        divisor /= 10;
+    }
+    return roman;
+}
+
+
+/**
+ * @internal
+ * Body of numerus_inline_int_with_twelfth_to_roman_into(), without the error
+ * code handling.
+ */
+static inline short _num_inline_int_with_twelfth_to_roman_into(
+        long int_part, short twelfths, char *roman, int *errcode) {
+    char *roman_numeral = roman;
+    numerus_inline_shorten_and_same_sign_to_parts(&int_part, &twelfths);
+
+    /* Out of range check: parts now have the same sign and |twelfths| < 12 */
+    if (int_part > NUMERUS_MAX_LONG_NONFLOAT_VALUE
+        || int_part < NUMERUS_MIN_LONG_NONFLOAT_VALUE) {
+        *roman = '\0';
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return -1;
+    }
+
+    /* Save sign or return NUMERUS_ZERO for 0 */
+    *errcode = NUMERUS_OK;
+    if (int_part == 0 && twelfths == 0) {
+        strcpy(roman, NUMERUS_ZERO);
+        return (short) strlen(NUMERUS_ZERO);
+    } else if (int_part < 0 || twelfths < 0) {
+        int_part = -int_part;
+        twelfths = (short) -twelfths;
+        *(roman_numeral++) = '-';
+    }
+
+    /* Integer part, with underscores above 3999 */
+    if (int_part > NUMERUS_MAX_SHORT_VALUE) {
+        *(roman_numeral++) = '_';
+        roman_numeral = _num_inline_digits_to_roman(int_part / 1000,
+                                                    roman_numeral, 0);
+        *(roman_numeral++) = '_';
+        roman_numeral = _num_inline_digits_to_roman(int_part % 1000,
+                                                    roman_numeral, 1);
+    } else {
+        roman_numeral = _num_inline_digits_to_roman(int_part,
+                                                    roman_numeral, 0);
+    }
+
+    /* Decimal part */
+    roman_numeral = _num_append_twelfths(roman_numeral, twelfths);
+    *roman_numeral = '\0';
+    return (short) (roman_numeral - roman);
+}
+
+
+/**
+ * Converts an integer value and a number of twelfths to a roman numeral with
+ * their sum as value, written into a buffer provided by the caller.
+ *
+ * Uses one table lookup per digit instead of the dictionary walk of the
+ * library.
+ *
+ * @see numerus_int_with_twelfth_to_roman_into()
+ */
+static inline short numerus_inline_int_with_twelfth_to_roman_into(
+        long int_part, short twelfths, char *roman, int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    short length = _num_inline_int_with_twelfth_to_roman_into(
+            int_part, twelfths, roman, errcode);
+    numerus_error_code = *errcode;
+#if defined(NUMERUS_INLINE_CHECK)
+    char checked_roman[64];
+    int checked_errcode;
+    assert(length == numerus_int_with_twelfth_to_roman_into(
+            int_part, twelfths, checked_roman, &checked_errcode));
+    assert(*errcode == checked_errcode);
+    assert(strcmp(roman, checked_roman) == 0);
+    (void) checked_roman;
+    (void) checked_errcode;
+#endif
+    return length;
+}
+
+
+/**
+ * Converts a long integer value to a roman numeral with its value, written into
+ * a buffer provided by the caller.
+ *
+ * @see numerus_int_to_roman_into()
+ */
+static inline short numerus_inline_int_to_roman_into(long int_value,
+                                                     char *roman,
+                                                     int *errcode) {
+    return numerus_inline_int_with_twelfth_to_roman_into(int_value, 0, roman,
+                                                         errcode);
+}
+
+
+/**
+ * Converts a double value to a roman numeral with its value, written into
+ * a buffer provided by the caller.
+ *
+ * @see numerus_double_to_roman_into()
+ */
+static inline short numerus_inline_double_to_roman_into(double double_value,
+                                                        char *roman,
+                                                        int *errcode) {
+    short twelfths;
+    long int_part = numerus_inline_double_to_parts(double_value, &twelfths);
+    return numerus_inline_int_with_twelfth_to_roman_into(int_part, twelfths,
+                                                         roman, errcode);
+}
+
+
+/**
+ * Converts an integer value within
+ * [NUMERUS_MIN_SHORT_VALUE, NUMERUS_MAX_SHORT_VALUE] to a roman numeral,
+ * written into a buffer provided by the caller.
+ *
+ * @see numerus_short_int_to_roman_into()
+ */
+static inline short numerus_inline_short_int_to_roman_into(long value,
+                                                           char *roman,
+                                                           int *errcode) {
+    if (value < NUMERUS_MIN_SHORT_VALUE || value > NUMERUS_MAX_SHORT_VALUE) {
+        if (errcode == NULL) {
+            errcode = &numerus_error_code;
+        }
+        *roman = '\0';
+        numerus_error_code = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return -1;
+    }
+    return numerus_inline_int_with_twelfth_to_roman_into(value, 0, roman,
+                                                         errcode);
+}
+
+
+/**
+ * @internal
+ * Parses the digit of one decade of a canonical roman numeral, written with
+ * the chars for one, five and ten units of that decade.
+ *
+ * @returns position in the numeral after the decade.
+ */
+static inline const char *_num_inline_parse_short_digit(
+        const char *roman, char one, char five, char ten, short *digit) {
+    *digit = 0;
+    if (toupper(*roman) == one && toupper(roman[1]) == ten) {
+        *digit = 9;
+        return roman + 2;
+    }
+    if (toupper(*roman) == one && toupper(roman[1]) == five) {
+        *digit = 4;
+        return roman + 2;
+    }
+    if (toupper(*roman) == five) {
+        *digit = 5;
+        roman++;
+    }
+    for (int repetitions = 0; repetitions < 3; repetitions++) {
+        if (toupper(*roman) != one) {
+            break;
+        }
+        (*digit)++;
+        roman++;
+    }
+    return roman;
+}
+
+
+/**
+ * Converts a roman numeral without underscores and without decimals to its
+ * integer value within [NUMERUS_MIN_SHORT_VALUE, NUMERUS_MAX_SHORT_VALUE].
+ *
+ * Canonical numerals are parsed inline; anything else, including every
+ * numeral with a syntax error, is left to the library function.
+ *
+ * @see numerus_roman_to_short_int()
+ */
+static inline short numerus_inline_roman_to_short_int(char *roman,
+                                                      int *errcode) {
+    const char *position = roman;
+    short value = 0;
+    short sign = 1;
+    short digit;
+    if (position != NULL) {
+        if (*position == '-') {
+            sign = -1;
+            position++;
+        }
+        const char *start = position;
+        while (toupper(*position) == 'M' && value < 3000) {
+            value += 1000;
+            position++;
+        }
+        position = _num_inline_parse_short_digit(position, 'C', 'D', 'M',
+                                                 &digit);
+        value += digit * 100;
+        position = _num_inline_parse_short_digit(position, 'X', 'L', 'C',
+                                                 &digit);
+        value += digit * 10;
+        position = _num_inline_parse_short_digit(position, 'I', 'V', 'X',
+                                                 &digit);
+        value += digit;
+        if (*position == '\0' && position != start) {
+            if (errcode == NULL) {
+                errcode = &numerus_error_code;
+            }
+            numerus_error_code = NUMERUS_OK;
+            *errcode = NUMERUS_OK;
+#if defined(NUMERUS_INLINE_CHECK)
+            int checked_errcode;
+            assert(sign * value == numerus_roman_to_short_int(
+                    roman, &checked_errcode));
+            assert(checked_errcode == NUMERUS_OK);
+            (void) checked_errcode;
+#endif
+            return (short) (sign * value);
+        }
+    }
+    return numerus_roman_to_short_int(roman, errcode);
+}
+
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* NUMERUS_INLINE_H */
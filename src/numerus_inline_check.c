@@ -0,0 +1,135 @@
+/**
+ * @file numerus_inline_check.c
+ * @brief Numerus comparison of the inline functions with the library ones.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Program run by the build when the NUMERUS_INLINE_CHECK CMake option is on:
+ * it compares the functions of numerus_inline.h with the library functions
+ * over their whole domain and fails the build on the first difference.
+ */
+
+#include <stdio.h>
+#include <ctype.h>
+#include <string.h>
+#include "numerus_inline.h"
+
+
+/**
+ * Compares the encoders on every integer part within the range of values,
+ * with a number of twelfths of both signs, out of range values included.
+ *
+ * @returns 0 on success or outputs the first difference on stderr and
+ * returns 1.
+ */
+static int _num_check_encoders(void) {
+    char roman[NUMERUS_MAX_LENGTH];
+    char expected[NUMERUS_MAX_LENGTH];
+    for (long value = NUMERUS_MIN_LONG_NONFLOAT_VALUE - 2;
+         value <= NUMERUS_MAX_LONG_NONFLOAT_VALUE + 2; value++) {
+        short twelfths = (short) (value % 25 - 12);
+        int errcode;
+        int expected_errcode;
+        short length = numerus_inline_int_with_twelfth_to_roman_into(
+                value, twelfths, roman, &errcode);
+        short expected_length = numerus_int_with_twelfth_to_roman_into(
+                value, twelfths, expected, &expected_errcode);
+        if (length != expected_length || errcode != expected_errcode
+            || strcmp(roman, expected) != 0) {
+            fprintf(stderr, "Encoders differ at %ld, %d: %s != %s\n",
+                    value, twelfths, roman, expected);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Compares the short decoders on every short numeral, in upper and lower
+ * case, and on the same numerals with an extra char appended.
+ *
+ * @returns 0 on success or outputs the first difference on stderr and
+ * returns 1.
+ */
+static int _num_check_short_decoders(void) {
+    const char extra_chars[] = "IVXLCDMS._- a";
+    char roman[NUMERUS_MAX_LENGTH + 1];
+    for (short value = -4000; value <= 4000; value++) {
+        numerus_int_to_roman_into(value, roman, NULL);
+        size_t length = strlen(roman);
+        for (size_t extra = 0; extra <= sizeof(extra_chars); extra++) {
+            int errcode;
+            int expected_errcode;
+            if (extra == sizeof(extra_chars)) {
+                for (size_t i = 0; i < length; i++) {
+                    roman[i] = (char) tolower(roman[i]);
+                }
+            } else if (extra > 0) {
+                roman[length] = extra_chars[extra - 1];
+                roman[length + 1] = '\0';
+            }
+            short parsed = numerus_inline_roman_to_short_int(roman, &errcode);
+            short expected = numerus_roman_to_short_int(roman,
+                                                        &expected_errcode);
+            if (parsed != expected || errcode != expected_errcode) {
+                fprintf(stderr, "Short decoders differ at %s: %d != %d\n",
+                        roman, parsed, expected);
+                return 1;
+            }
+            roman[length] = '\0';
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Compares the twelfths management functions on a grid of values.
+ *
+ * @returns 0 on success or outputs the first difference on stderr and
+ * returns 1.
+ */
+static int _num_check_parts(void) {
+    for (long int_part = -5000; int_part <= 5000; int_part += 7) {
+        for (short twelfths = -40; twelfths <= 40; twelfths++) {
+            long shortened_int_part = int_part;
+            short shortened_twelfths = twelfths;
+            long expected_int_part = int_part;
+            short expected_twelfths = twelfths;
+            numerus_inline_shorten_and_same_sign_to_parts(
+                    &shortened_int_part, &shortened_twelfths);
+            numerus_shorten_and_same_sign_to_parts(&expected_int_part,
+                                                   &expected_twelfths);
+            double value = numerus_inline_parts_to_double(int_part, twelfths);
+            short split_twelfths;
+            short expected_split_twelfths;
+            long split = numerus_inline_double_to_parts(value / 7,
+                                                        &split_twelfths);
+            long expected_split = numerus_double_to_parts(
+                    value / 7, &expected_split_twelfths);
+            if (shortened_int_part != expected_int_part
+                || shortened_twelfths != expected_twelfths
+                || value != numerus_parts_to_double(int_part, twelfths)
+                || split != expected_split
+                || split_twelfths != expected_split_twelfths) {
+                fprintf(stderr, "Parts functions differ at %ld, %d\n",
+                        int_part, twelfths);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+int main(void) {
+    int result = _num_check_encoders() | _num_check_short_decoders()
+                 | _num_check_parts();
+    if (result == 0) {
+        printf("Inline functions agree with the library.\n");
+    }
+    return result;
+}
@@ -17,5 +17,13 @@
 
 
 short _num_is_zero(char *roman);
+short _num_count_roman_chars(char *roman, int *errcode);
+long _num_parse_checked_numeral(char *roman, short *twelfths, int *errcode);
+long _num_decode_roman_slot(char *roman, size_t capacity, short *twelfths,
+                            int *errcode);
+char *_num_parse_short_digit(char *roman, char one, char five, char ten,
+                             short *digit);
+char *_num_value_part_to_roman(long value, char *roman,
+                               int dictionary_start_char);
 #define SIGN(x)    (((x) >= 0)  - ((x) < 0))
 #define ABS(x)     (((x) < 0) ? -(x) : (x))
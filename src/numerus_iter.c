@@ -0,0 +1,288 @@
+/**
+ * @file numerus_iter.c
+ * @brief Numerus iterator over arithmetic sequences of roman numerals.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the iterator generating the numerals of a sequence of
+ * values with a constant step in twelfths, like page numbers or years,
+ * without converting each value from scratch.
+ *
+ * The iterator keeps the numeral of the last value split in groups of chars:
+ * the sign and underscores, one group per digit and the twelfths. Each group
+ * is a function of one small key, so a step compares the keys of the new
+ * value with the ones of the previous value and rewrites only the numeral
+ * from the first changed group on, from the generated tables. With a step of
+ * one twelfth or one unit most steps rewrite only the last group.
+ */
+
+#include <string.h>   /* For `memcpy()`, `strcpy()`, `strlen()` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include "numerus_internal.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+
+/**
+ * @internal
+ * Kinds of numeral the iterator distinguishes in its first group key: a
+ * change of kind rewrites the whole numeral.
+ */
+#define _NUM_ITER_POSITIVE 0
+#define _NUM_ITER_NEGATIVE 1
+#define _NUM_ITER_LONG 2
+#define _NUM_ITER_ZERO 4
+
+
+/**
+ * @internal
+ * Computes the keys of the groups of the numeral of a value in twelfths.
+ *
+ * Key 0 is the kind of numeral, keys 1-4 the digits of the thousands,
+ * hundreds, tens and units of the value or of the part between underscores
+ * for long numerals, keys 5-7 the hundreds, tens and units after the
+ * underscores of long numerals, key 8 the twelfths.
+ */
+static void _num_iter_keys(long value, unsigned char *keys) {
+    long abs_value = ABS(value);
+    long int_part = abs_value / 12;
+    long high_part = int_part;
+    long low_part = 0;
+    keys[0] = (unsigned char) (value < 0 ? _NUM_ITER_NEGATIVE
+                                         : _NUM_ITER_POSITIVE);
+    if (value == 0) {
+        keys[0] = _NUM_ITER_ZERO;
+    } else if (int_part > NUMERUS_MAX_SHORT_VALUE) {
+        keys[0] |= _NUM_ITER_LONG;
+        high_part = int_part / 1000;
+        low_part = int_part % 1000;
+    }
+    keys[1] = (unsigned char) (high_part / 1000);
+    keys[2] = (unsigned char) (high_part / 100 % 10);
+    keys[3] = (unsigned char) (high_part / 10 % 10);
+    keys[4] = (unsigned char) (high_part % 10);
+    keys[5] = (unsigned char) (low_part / 100);
+    keys[6] = (unsigned char) (low_part / 10 % 10);
+    keys[7] = (unsigned char) (low_part % 10);
+    keys[8] = (unsigned char) (abs_value % 12);
+}
+
+
+/**
+ * @internal
+ * Rewrites the numeral of the iterator from the given group on, following
+ * its keys, and updates the start of the following groups.
+ */
+static void _num_iter_write_groups(struct numerus_iter *iter, int first_group) {
+    char *roman = iter->roman + iter->group_starts[first_group];
+    for (int group = first_group; group < NUMERUS_ITER_GROUPS; group++) {
+        iter->group_starts[group] = (unsigned char) (roman - iter->roman);
+        if (group == 0) {
+            if (iter->keys[0] == _NUM_ITER_ZERO) {
+                strcpy(roman, NUMERUS_ZERO);
+                roman += strlen(NUMERUS_ZERO);
+            }
+            if (iter->keys[0] & _NUM_ITER_NEGATIVE) {
+                *(roman++) = '-';
+            }
+            if (iter->keys[0] & _NUM_ITER_LONG) {
+                *(roman++) = '_';
+            }
+        } else if (group <= 4) {
+            roman = _num_append_short_digit(roman, group - 1,
+                                            iter->keys[group]);
+        } else if (group <= 7) {
+            if (group == 5 && (iter->keys[0] & _NUM_ITER_LONG)) {
+                *(roman++) = '_';
+            }
+            roman = _num_append_short_digit(roman, group - 4,
+                                            iter->keys[group]);
+        } else {
+            roman = _num_append_twelfths(roman, iter->keys[group]);
+        }
+    }
+    *roman = '\0';
+    iter->length = (short) (roman - iter->roman);
+}
+
+
+/**
+ * @internal
+ * Moves the iterator to the given value in twelfths, rewriting only the
+ * groups of the numeral that change.
+ */
+static void _num_iter_move_to(struct numerus_iter *iter, long value) {
+    unsigned char keys[NUMERUS_ITER_GROUPS];
+    int first_changed = 0;
+    if (value / 12 == iter->value / 12 && value != 0
+        && (value < 0) == (iter->value < 0) && iter->value != 0) {
+        /* Same integer part and sign: only the twelfths change */
+        iter->value = value;
+        iter->keys[8] = (unsigned char) (ABS(value) % 12);
+        _num_iter_write_groups(iter, 8);
+        return;
+    }
+    _num_iter_keys(value, keys);
+    if (keys[0] == iter->keys[0]) {
+        first_changed = 1;
+        while (first_changed < NUMERUS_ITER_GROUPS
+               && keys[first_changed] == iter->keys[first_changed]) {
+            first_changed++;
+        }
+    }
+    iter->value = value;
+    if (first_changed < NUMERUS_ITER_GROUPS) {
+        memcpy(iter->keys, keys, sizeof(keys));
+        _num_iter_write_groups(iter, first_changed);
+    }
+}
+
+
+/**
+ * Initialises an iterator over the numerals of the values starting from the
+ * given one, each `step_twelfths` twelfths from the previous one.
+ *
+ * The first call to numerus_iter_next() returns the numeral of the starting
+ * value, the following ones the numerals of the next values, until the end
+ * of the range of values is crossed. Negative steps iterate backwards, a
+ * zero step repeats the same numeral.
+ *
+ * The iterator lives in memory provided by the caller and uses no heap, so
+ * it can be on the stack and many iterators can run on different threads.
+ *
+ * @param *iter iterator to initialise.
+ * @param int_part integer part of the starting value.
+ * @param twelfths number of twelfths of the starting value, added to the
+ * integer part as numerus_int_with_twelfth_to_roman() does.
+ * @param step_twelfths distance in twelfths between two consecutive values.
+ * @param *errcode int where to store the status: NUMERUS_OK or
+ * NUMERUS_ERROR_VALUE_OUT_OF_RANGE if the starting value is outside the range
+ * of values, in which case the iterator is already exhausted.
+ * Can be NULL to ignore the error (NOT recommended).
+ */
+void numerus_iter_init(struct numerus_iter *iter, long int_part,
+                       short twelfths, long step_twelfths, int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    numerus_shorten_and_same_sign_to_parts(&int_part, &twelfths);
+    iter->step = step_twelfths;
+    iter->started = 0;
+    if (int_part > NUMERUS_MAX_LONG_NONFLOAT_VALUE
+        || int_part < NUMERUS_MIN_LONG_NONFLOAT_VALUE) {
+        iter->exhausted = 1;
+        iter->roman[0] = '\0';
+        iter->length = 0;
+        numerus_error_code = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return;
+    }
+    iter->exhausted = 0;
+    iter->value = int_part * 12 + twelfths;
+    _num_iter_keys(iter->value, iter->keys);
+    iter->group_starts[0] = 0;
+    _num_iter_write_groups(iter, 0);
+    numerus_error_code = NUMERUS_OK;
+    *errcode = NUMERUS_OK;
+}
+
+
+/**
+ * @internal
+ * Advances the iterator without touching numerus_error_code.
+ *
+ * @returns true if the iterator holds the numeral of a new value, false if
+ * the sequence is over.
+ */
+static bool _num_iter_advance(struct numerus_iter *iter) {
+    if (iter->exhausted) {
+        return false;
+    }
+    if (!iter->started) {
+        iter->started = 1;
+        return true;
+    }
+    const long max_value = NUMERUS_MAX_LONG_NONFLOAT_VALUE * 12 + 11;
+    if ((iter->step > 0 && iter->value > max_value - iter->step)
+        || (iter->step < 0 && iter->value < -max_value - iter->step)) {
+        iter->exhausted = 1;
+        return false;
+    }
+    _num_iter_move_to(iter, iter->value + iter->step);
+    return true;
+}
+
+
+/**
+ * Moves the iterator to the next value of its sequence and copies its roman
+ * numeral into a buffer provided by the caller.
+ *
+ * The numeral is the same numerus_int_with_twelfth_to_roman_into() would
+ * write. It's also readable, until the next call, in the `roman` field of
+ * the iterator, so `roman` can be NULL to skip the copy.
+ *
+ * @param *iter iterator initialised with numerus_iter_init().
+ * @param *roman buffer of at least NUMERUS_MAX_LENGTH chars where to copy the
+ * null-terminated roman numeral. Can be NULL.
+ * @param *errcode int where to store the status: NUMERUS_OK or
+ * NUMERUS_ERROR_VALUE_OUT_OF_RANGE when the sequence is over.
+ * Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the roman numeral, excluding '\0', or -1 when the
+ * sequence is over.
+ */
+short numerus_iter_next(struct numerus_iter *iter, char *roman, int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    if (!_num_iter_advance(iter)) {
+        if (roman != NULL) {
+            *roman = '\0';
+        }
+        numerus_error_code = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        return -1;
+    }
+    if (roman != NULL) {
+        memcpy(roman, iter->roman, (size_t) iter->length + 1);
+    }
+    numerus_error_code = NUMERUS_OK;
+    *errcode = NUMERUS_OK;
+    return iter->length;
+}
+
+
+/**
+ * Writes the numerals of the next values of the iterator into an arena of
+ * fixed-size slots, as numerus_int_with_twelfth_to_roman_batch() does.
+ *
+ * The i-th numeral is written null-terminated at `romans + i * stride`. The
+ * stride must be at least NUMERUS_MAX_LENGTH. Stops early when the sequence
+ * is over, leaving the rest of the arena untouched.
+ *
+ * Does not touch numerus_error_code, so different threads may fill different
+ * arenas with different iterators at the same time.
+ *
+ * @param *iter iterator initialised with numerus_iter_init().
+ * @param count max number of numerals to write.
+ * @param *romans arena of at least `count * stride` chars.
+ * @param stride distance in chars between two consecutive numerals in the
+ * arena, at least NUMERUS_MAX_LENGTH.
+ * @param *lengths array of `count` shorts where to store the length of each
+ * numeral. Can be NULL to ignore them.
+ * @returns size_t number of numerals written, less than `count` only if the
+ * sequence is over.
+ */
+size_t numerus_iter_batch(struct numerus_iter *iter, size_t count,
+                          char *romans, size_t stride, short *lengths) {
+    size_t written = 0;
+    while (written < count && _num_iter_advance(iter)) {
+        memcpy(romans + written * stride, iter->roman,
+               (size_t) iter->length + 1);
+        if (lengths != NULL) {
+            lengths[written] = iter->length;
+        }
+        written++;
+    }
+    return written;
+}
@@ -0,0 +1,29 @@
+/**
+ * @file numerus_mktable.c
+ * @brief Numerus tool writing the table file of the table conversions.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Writes the table file used by numerus_open_table_file(), about 1.35 GB.
+ *
+ * Usage: `numerus_mktable path/to/numerus.table`
+ */
+
+#include <stdio.h>
+#include "numerus.h"
+
+
+int main(int argc, char **args) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s path/to/numerus.table\n", args[0]);
+        return 1;
+    }
+    int errcode = numerus_write_table_file(args[1]);
+    if (errcode != NUMERUS_OK) {
+        fprintf(stderr, "%s: %s\n", args[1], numerus_explain_error(errcode));
+        return 1;
+    }
+    return 0;
+}
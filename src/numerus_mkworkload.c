@@ -0,0 +1,121 @@
+/**
+ * @file numerus_mkworkload.c
+ * @brief Numerus tool writing workloads of numerals into text files.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Writes the numerals of a workload of numerus_workload_generate(), one per
+ * line, and optionally their expected values, starting from a preset, the
+ * production one by default, and changing it with the options, applied in
+ * their order.
+ *
+ * Usage: `numerus_mkworkload [--preset uniform|production] [--seed N]
+ * [--count N] [--uniform] [--zipf EXPONENT] [--center N]
+ * [--kinds SHORT,LONG,FLOAT] [--negative RATE] [--error CODE=RATE]...
+ * [--lowercase RATE] [--mixed-case RATE] [--whitespace RATE]
+ * [--expected path/to/expected.txt] path/to/numerals.txt`
+ *
+ * For example `numerus_mkworkload --preset production --error 104=0.01
+ * --count 1000000 numerals.txt` writes a million numerals of the production
+ * preset but with 1% of them with too many repeated chars instead of 0.4%.
+ */
+
+#include <stdint.h>   /* For `uint64_t` */
+#include <stdio.h>    /* For `fprintf()`, `sscanf()` */
+#include <stdlib.h>   /* For `strtod()`, `strtol()`, `strtoull()` */
+#include <string.h>   /* For `strcmp()` */
+#include "numerus.h"
+
+
+#define _NUM_MKWORKLOAD_DEFAULT_COUNT 1000000
+#define _NUM_MKWORKLOAD_DEFAULT_SEED 2016
+
+
+static int _num_mkworkload_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [--preset uniform|production] [--seed N] [--count N]"
+            " [--uniform] [--zipf EXPONENT] [--center N]"
+            " [--kinds SHORT,LONG,FLOAT] [--negative RATE]"
+            " [--error CODE=RATE]... [--lowercase RATE] [--mixed-case RATE]"
+            " [--whitespace RATE] [--expected path/to/expected.txt]"
+            " path/to/numerals.txt\n", program);
+    return 1;
+}
+
+
+int main(int argc, char **args) {
+    struct numerus_workload workload;
+    numerus_workload_production(&workload, _NUM_MKWORKLOAD_DEFAULT_SEED);
+    size_t count = _NUM_MKWORKLOAD_DEFAULT_COUNT;
+    const char *expected_path = NULL;
+    if (argc < 2) {
+        return _num_mkworkload_usage(args[0]);
+    }
+    for (int i = 1; i < argc - 1; i++) {
+        const char *option = args[i];
+        if (strcmp(option, "--uniform") == 0) {
+            workload.distribution = NUMERUS_WORKLOAD_UNIFORM;
+            continue;
+        }
+        if (i + 1 == argc - 1) {
+            return _num_mkworkload_usage(args[0]);
+        }
+        const char *value = args[++i];
+        if (strcmp(option, "--preset") == 0) {
+            if (strcmp(value, "uniform") == 0) {
+                numerus_workload_uniform(&workload, workload.seed);
+            } else if (strcmp(value, "production") == 0) {
+                numerus_workload_production(&workload, workload.seed);
+            } else {
+                return _num_mkworkload_usage(args[0]);
+            }
+        } else if (strcmp(option, "--seed") == 0) {
+            workload.seed = strtoull(value, NULL, 10);
+        } else if (strcmp(option, "--count") == 0) {
+            count = strtoull(value, NULL, 10);
+        } else if (strcmp(option, "--zipf") == 0) {
+            workload.distribution = NUMERUS_WORKLOAD_ZIPF;
+            workload.zipf_exponent = strtod(value, NULL);
+        } else if (strcmp(option, "--center") == 0) {
+            workload.zipf_center = strtol(value, NULL, 10);
+        } else if (strcmp(option, "--kinds") == 0) {
+            if (sscanf(value, "%lf,%lf,%lf",
+                       &workload.kind_weights[NUMERUS_WORKLOAD_SHORT],
+                       &workload.kind_weights[NUMERUS_WORKLOAD_LONG],
+                       &workload.kind_weights[NUMERUS_WORKLOAD_FLOAT]) != 3) {
+                return _num_mkworkload_usage(args[0]);
+            }
+        } else if (strcmp(option, "--negative") == 0) {
+            workload.negative_rate = strtod(value, NULL);
+        } else if (strcmp(option, "--error") == 0) {
+            int code;
+            double rate;
+            if (sscanf(value, "%d=%lf", &code, &rate) != 2
+                || code < NUMERUS_ERROR_GENERIC
+                || code >= NUMERUS_ERROR_GENERIC + NUMERUS_WORKLOAD_ERRORS) {
+                return _num_mkworkload_usage(args[0]);
+            }
+            workload.error_rates[code - NUMERUS_ERROR_GENERIC] = rate;
+        } else if (strcmp(option, "--lowercase") == 0) {
+            workload.lowercase_rate = strtod(value, NULL);
+        } else if (strcmp(option, "--mixed-case") == 0) {
+            workload.mixed_case_rate = strtod(value, NULL);
+        } else if (strcmp(option, "--whitespace") == 0) {
+            workload.whitespace_rate = strtod(value, NULL);
+        } else if (strcmp(option, "--expected") == 0) {
+            expected_path = value;
+        } else {
+            return _num_mkworkload_usage(args[0]);
+        }
+    }
+    int errcode = numerus_workload_write_files(&workload, count,
+                                               args[argc - 1], expected_path);
+    if (errcode != NUMERUS_OK) {
+        fprintf(stderr, "%s: %s\n", args[argc - 1],
+                numerus_explain_error(errcode));
+        return 1;
+    }
+    return 0;
+}
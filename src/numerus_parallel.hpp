@@ -0,0 +1,384 @@
+/**
+ * @file numerus_parallel.hpp
+ * @brief Numerus bulk conversions with the C++17 execution policies
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This header adds overloads converting whole sequences of values or
+ * numerals with an execution policy, like `std::transform()`:
+ *
+ * <pre>
+ * std::vector<numerus::roman> romans(values.size());
+ * numerus::transform_to_roman(std::execution::par_unseq,
+ *                             values.begin(), values.end(), romans.begin());
+ *
+ * numerus::roman_arena arena;  // all numerals packed in one buffer
+ * numerus::transform_to_roman(std::execution::par, values.begin(),
+ *                             values.end(), arena);
+ * std::string_view first = arena[0];
+ *
+ * numerus::transform_from_roman(std::execution::par, lines.begin(),
+ *                               lines.end(), romans.begin());
+ * </pre>
+ *
+ * The sequence is split in chunks of chunk_size elements, converted
+ * concurrently each with one call to the batch conversion functions of the C
+ * library. Unlike calling numerus_int_to_roman() from `std::transform()`,
+ * nothing is allocated per element and numerus_error_code is never written,
+ * so the threads don't contend on the heap nor race on the global error
+ * code. The numerals written to a numerus::roman_arena are packed in a single
+ * allocation, sized exactly by a first parallel pass computing their lengths.
+ *
+ * An element that can't be converted doesn't stop the other chunks: once all
+ * chunks are done, the numerus::error of the first such element in the
+ * sequence is thrown. Requires random access iterators for both the input
+ * and the output.
+ */
+
+#ifndef NUMERUS_PARALLEL_HPP
+#define NUMERUS_PARALLEL_HPP
+
+#include <algorithm>        /* For `std::for_each()` */
+#include <cstring>          /* For `std::memcpy()` */
+#include <execution>        /* For `std::is_execution_policy_v` */
+#include <iterator>         /* For `std::distance()` */
+#include <memory_resource>  /* For `std::pmr::vector` */
+#include <numeric>          /* For `std::exclusive_scan()`, `std::iota()` */
+#include <string_view>      /* For `std::string_view` */
+#include <type_traits>      /* For `std::is_integral_v` */
+#include <vector>           /* For `std::vector` */
+#include "numerus.hpp"
+
+
+namespace numerus {
+
+
+/**
+ * Number of elements converted by each call to the batch conversion
+ * functions, the unit of work of the parallel conversions.
+ */
+constexpr std::size_t chunk_size = 256;
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * Enables an overload only for execution policies.
+ */
+template<typename Policy>
+using if_execution_policy = std::enable_if_t<
+        std::is_execution_policy_v<std::decay_t<Policy>>, int>;
+
+
+/**
+ * @internal
+ * Distance in chars between two numerals in the arena of a chunk to parse.
+ * Numerals longer than this are converted one by one.
+ */
+constexpr std::size_t chunk_stride = 64;
+
+
+/**
+ * @internal
+ * Splits the sequence in chunks and calls `convert(chunk_begin, chunk_end)`
+ * for each of them with the execution policy, then throws the error of the
+ * first element that could not be converted, if any.
+ *
+ * `convert` returns the error code of the first element of its chunk that
+ * could not be converted, or NUMERUS_OK.
+ */
+template<typename Policy, typename Convert>
+void for_each_chunk(Policy &&policy, std::size_t count,
+                    const Convert &convert) {
+    std::size_t chunks = (count + chunk_size - 1) / chunk_size;
+    std::vector<std::size_t> chunk_indices(chunks);
+    std::vector<int> chunk_errcodes(chunks, NUMERUS_OK);
+    std::iota(chunk_indices.begin(), chunk_indices.end(), std::size_t(0));
+    std::for_each(std::forward<Policy>(policy), chunk_indices.begin(),
+                  chunk_indices.end(), [&](std::size_t chunk) {
+                std::size_t begin = chunk * chunk_size;
+                std::size_t end = std::min(begin + chunk_size, count);
+                chunk_errcodes[chunk] = convert(begin, end);
+            });
+    for (int errcode : chunk_errcodes) {
+        if (errcode != NUMERUS_OK) {
+            throw error(errcode);
+        }
+    }
+}
+
+
+/**
+ * @internal
+ * Copies the values of the elements in [begin, end) of the sequence as
+ * integer parts and twelfths of the same sign.
+ */
+template<typename RandomIterator>
+void gather_parts(RandomIterator first, std::size_t begin, std::size_t end,
+                  long *int_parts, short *twelfths) {
+    for (std::size_t i = 0; i < end - begin; i++) {
+        auto value = first[static_cast<std::ptrdiff_t>(begin + i)];
+        if constexpr (std::is_integral_v<decltype(value)>) {
+            int_parts[i] = static_cast<long>(value);
+            twelfths[i] = 0;
+        } else {
+            int_parts[i] = numerus_double_to_parts(static_cast<double>(value),
+                                                   &twelfths[i]);
+        }
+        shorten_and_same_sign_to_parts(&int_parts[i], &twelfths[i]);
+    }
+}
+
+
+/**
+ * @internal
+ * Returns the first error code different than NUMERUS_OK, or NUMERUS_OK.
+ */
+inline int first_error(const int *errcodes, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) {
+        if (errcodes[i] != NUMERUS_OK) {
+            return errcodes[i];
+        }
+    }
+    return NUMERUS_OK;
+}
+
+
+} /* namespace detail */
+
+
+/**
+ * Sequence of roman numerals packed one after the other in one buffer.
+ *
+ * Filled by numerus::transform_to_roman(), it holds each numeral
+ * null-terminated and its offset, so accessing a numeral never copies it.
+ * Its memory comes from a `std::pmr::memory_resource`, by default the
+ * default one.
+ */
+class roman_arena {
+public:
+
+    roman_arena() = default;
+
+    explicit roman_arena(std::pmr::memory_resource *resource)
+            : chars(resource), offsets(resource) {
+    }
+
+    /**
+     * Number of numerals in the arena.
+     */
+    std::size_t size() const noexcept {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    bool empty() const noexcept {
+        return size() == 0;
+    }
+
+    /**
+     * Total number of chars in the buffer, '\0's included.
+     */
+    std::size_t bytes() const noexcept {
+        return offsets.empty() ? 0 : offsets.back();
+    }
+
+    /**
+     * The i-th numeral, pointing into the arena.
+     */
+    std::string_view operator[](std::size_t i) const {
+        return std::string_view(chars.data() + offsets[i],
+                                offsets[i + 1] - offsets[i] - 1);
+    }
+
+    /**
+     * The i-th numeral as null-terminated string, pointing into the arena.
+     */
+    const char *c_str(std::size_t i) const {
+        return chars.data() + offsets[i];
+    }
+
+    /**
+     * Replaces the content of the arena with the numerals of the values in
+     * [first, last), converted with the execution policy.
+     *
+     * A first parallel pass computes the length of each numeral, so the
+     * buffer is allocated once with the exact size; a second pass converts
+     * the values straight into it.
+     *
+     * @throws numerus::error if a value is out of range, leaving the arena
+     * empty.
+     */
+    template<typename Policy, typename RandomIterator>
+    void assign(Policy &&policy, RandomIterator first, RandomIterator last) {
+        std::size_t count = static_cast<std::size_t>(
+                std::distance(first, last));
+        std::pmr::vector<std::size_t> lengths(count + 1, 0,
+                                              offsets.get_allocator());
+        offsets.resize(count + 1);
+        chars.clear();
+        try {
+            /* Length of each numeral plus its '\0' */
+            detail::for_each_chunk(policy, count, [&](std::size_t begin,
+                                                      std::size_t end) {
+                long int_parts[chunk_size];
+                short twelfths[chunk_size];
+                int errcodes[chunk_size];
+                detail::gather_parts(first, begin, end, int_parts, twelfths);
+                numerus_int_with_twelfth_to_roman_batch_lengths(
+                        int_parts, twelfths, end - begin, &lengths[begin],
+                        errcodes);
+                for (std::size_t i = begin; i < end; i++) {
+                    lengths[i]++;
+                }
+                return detail::first_error(errcodes, end - begin);
+            });
+            /* Not in place: some parallel implementations don't support it */
+            std::exclusive_scan(policy, lengths.begin(), lengths.end(),
+                                offsets.begin(), std::size_t(0));
+
+            /* Numerals written straight at their offsets */
+            chars.resize(offsets.back());
+            detail::for_each_chunk(policy, count, [&](std::size_t begin,
+                                                      std::size_t end) {
+                long int_parts[chunk_size];
+                short twelfths[chunk_size];
+                detail::gather_parts(first, begin, end, int_parts, twelfths);
+                numerus_int_with_twelfth_to_roman_batch_packed(
+                        int_parts, twelfths, end - begin, chars.data(),
+                        &offsets[begin], nullptr);
+                return NUMERUS_OK;
+            });
+        } catch (...) {
+            offsets.clear();
+            chars.clear();
+            throw;
+        }
+    }
+
+private:
+    std::pmr::vector<char> chars;
+    std::pmr::vector<std::size_t> offsets;
+};
+
+
+/**
+ * Converts the integer or floating point values in [first, last) to
+ * numerus::roman, written to the range beginning at out, with the execution
+ * policy.
+ *
+ * @throws numerus::error if a value is out of range, once all values have
+ * been processed. Its numeral in the output is NUMERUS_ZERO.
+ * @returns the end of the output range.
+ */
+template<typename Policy, typename RandomIterator, typename OutputIterator,
+         detail::if_execution_policy<Policy> = 0>
+OutputIterator transform_to_roman(Policy &&policy, RandomIterator first,
+                                  RandomIterator last, OutputIterator out) {
+    std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+    detail::for_each_chunk(policy, count, [&](std::size_t begin,
+                                              std::size_t end) {
+        long int_parts[chunk_size];
+        short twelfths[chunk_size];
+        int errcodes[chunk_size];
+        char arena[chunk_size * max_length];
+        detail::gather_parts(first, begin, end, int_parts, twelfths);
+        numerus_int_with_twelfth_to_roman_batch(
+                int_parts, twelfths, end - begin, arena, max_length,
+                errcodes);
+        for (std::size_t i = 0; i < end - begin; i++) {
+            out[static_cast<std::ptrdiff_t>(begin + i)] =
+                    errcodes[i] != NUMERUS_OK ? roman()
+                    : detail::roman_builder::from_valid_numeral(
+                            arena + i * max_length, int_parts[i],
+                            twelfths[i]);
+        }
+        return detail::first_error(errcodes, end - begin);
+    });
+    return out + static_cast<std::ptrdiff_t>(count);
+}
+
+
+/**
+ * Converts the integer or floating point values in [first, last) to roman
+ * numerals packed in the arena, with the execution policy.
+ *
+ * @throws numerus::error if a value is out of range, leaving the arena
+ * empty.
+ * @see numerus::roman_arena::assign()
+ */
+template<typename Policy, typename RandomIterator,
+         detail::if_execution_policy<Policy> = 0>
+void transform_to_roman(Policy &&policy, RandomIterator first,
+                        RandomIterator last, roman_arena &out) {
+    out.assign(std::forward<Policy>(policy), first, last);
+}
+
+
+/**
+ * Converts the roman numerals in [first, last), any type convertible to
+ * `std::string_view`, to numerus::roman, written to the range beginning at
+ * out, with the execution policy.
+ *
+ * @throws numerus::error if a numeral has wrong syntax, once all numerals
+ * have been processed. Its roman in the output is NUMERUS_ZERO.
+ * @returns the end of the output range.
+ */
+template<typename Policy, typename RandomIterator, typename OutputIterator,
+         detail::if_execution_policy<Policy> = 0>
+OutputIterator transform_from_roman(Policy &&policy, RandomIterator first,
+                                    RandomIterator last, OutputIterator out) {
+    std::size_t count = static_cast<std::size_t>(std::distance(first, last));
+    detail::for_each_chunk(policy, count, [&](std::size_t begin,
+                                              std::size_t end) {
+        constexpr std::size_t stride = detail::chunk_stride;
+        long int_parts[chunk_size];
+        short twelfths[chunk_size];
+        int errcodes[chunk_size];
+        char arena[chunk_size * stride];
+        std::size_t pulled = end - begin;
+
+        /* Copy the numerals into the arena, null-terminated */
+        for (std::size_t i = 0; i < pulled; i++) {
+            std::string_view numeral(
+                    first[static_cast<std::ptrdiff_t>(begin + i)]);
+            char *slot = arena + i * stride;
+            if (numeral.size() >= stride) {
+                slot[0] = '\0';
+            } else {
+                std::memcpy(slot, numeral.data(), numeral.size());
+                slot[numeral.size()] = '\0';
+            }
+        }
+
+        /* Parse them all at once, then rewrite them canonical */
+        numerus_roman_to_int_part_and_twelfths_batch(
+                arena, stride, pulled, int_parts, twelfths, errcodes);
+        for (std::size_t i = 0; i < pulled; i++) {
+            std::string_view numeral(
+                    first[static_cast<std::ptrdiff_t>(begin + i)]);
+            if (numeral.size() >= stride) {
+                int_parts[i] = roman_to_int_part_and_twelfths(
+                        numeral, &twelfths[i], &errcodes[i]);
+            }
+        }
+        numerus_int_with_twelfth_to_roman_batch(
+                int_parts, twelfths, pulled, arena, stride, nullptr);
+        for (std::size_t i = 0; i < pulled; i++) {
+            out[static_cast<std::ptrdiff_t>(begin + i)] =
+                    errcodes[i] != NUMERUS_OK ? roman()
+                    : detail::roman_builder::from_valid_numeral(
+                            arena + i * stride, int_parts[i], twelfths[i]);
+        }
+        return detail::first_error(errcodes, pulled);
+    });
+    return out + static_cast<std::ptrdiff_t>(count);
+}
+
+
+} /* namespace numerus */
+
+#endif /* NUMERUS_PARALLEL_HPP */
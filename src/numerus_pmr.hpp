@@ -0,0 +1,148 @@
+/**
+ * @file numerus_pmr.hpp
+ * @brief Numerus conversions allocating from polymorphic memory resources
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This header adds conversions that obtain the memory for the numerals from
+ * a `std::pmr::memory_resource` instead of the heap, through the allocator
+ * hooks of numerus_int_with_twelfth_to_roman_using(). With a
+ * `std::pmr::monotonic_buffer_resource` all numerals produced while handling
+ * a request are released at once with the resource, without any
+ * malloc()/free() pair:
+ *
+ * <pre>
+ * char buffer[4096];
+ * std::pmr::monotonic_buffer_resource request(buffer, sizeof(buffer));
+ * std::string_view year = numerus::pmr::int_to_roman(2016, &request);
+ * std::pmr::string text = numerus::pmr::to_string(numerus::roman(14),
+ *                                                 &request);
+ * </pre>
+ *
+ * The views returned point to null-terminated numerals living in the memory
+ * resource, valid until it releases them. Nothing deallocates them one by
+ * one, so the resource is always the caller's, usually a monotonic one:
+ * there is no default resource to leak into.
+ */
+
+#ifndef NUMERUS_PMR_HPP
+#define NUMERUS_PMR_HPP
+
+#include <memory_resource>  /* For `std::pmr::memory_resource` */
+#include <new>              /* For `std::bad_alloc` */
+#include <string>           /* For `std::pmr::string` */
+#include <string_view>      /* For `std::string_view` */
+#include "numerus.hpp"
+
+
+namespace numerus {
+namespace pmr {
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * Allocate hook of numerus_allocator drawing from the memory resource passed
+ * as context. Exceptions can't cross the C library, so failures are reported
+ * as NULL.
+ */
+inline void *allocate_from_resource(std::size_t size, void *context) noexcept {
+    try {
+        return static_cast<std::pmr::memory_resource *>(context)->allocate(
+                size, alignof(char));
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+
+/**
+ * @internal
+ * Throws the exception matching the error code of a conversion, if any.
+ */
+inline void throw_if_error(int errcode) {
+    if (errcode == NUMERUS_ERROR_MALLOC_FAIL) {
+        throw std::bad_alloc();
+    } else if (errcode != NUMERUS_OK) {
+        throw error(errcode);
+    }
+}
+
+
+} /* namespace detail */
+
+
+/**
+ * Allocator hooks for the C library drawing from the memory resource.
+ */
+inline numerus_allocator allocator_of(std::pmr::memory_resource *resource)
+        noexcept {
+    return numerus_allocator{detail::allocate_from_resource, resource};
+}
+
+
+/**
+ * Converts an integer value and a number of twelfths to a roman numeral
+ * allocated in the memory resource.
+ *
+ * @throws numerus::error if the value is out of range.
+ * @throws std::bad_alloc if the memory resource can't allocate the numeral.
+ * @returns view of the null-terminated numeral in the memory resource.
+ */
+inline std::string_view int_with_twelfth_to_roman(
+        long int_part, short twelfths,
+        std::pmr::memory_resource *resource) {
+    int errcode;
+    numerus_allocator allocator = allocator_of(resource);
+    const char *roman = numerus_int_with_twelfth_to_roman_using(
+            int_part, twelfths, &allocator, &errcode);
+    detail::throw_if_error(errcode);
+    return std::string_view(roman);
+}
+
+
+/**
+ * Converts an integer value to a roman numeral allocated in the memory
+ * resource.
+ *
+ * @see numerus::pmr::int_with_twelfth_to_roman()
+ */
+inline std::string_view int_to_roman(
+        long int_value, std::pmr::memory_resource *resource) {
+    return int_with_twelfth_to_roman(int_value, 0, resource);
+}
+
+
+/**
+ * Converts a double value to a roman numeral allocated in the memory
+ * resource.
+ *
+ * @see numerus::pmr::int_with_twelfth_to_roman()
+ */
+inline std::string_view double_to_roman(
+        double double_value, std::pmr::memory_resource *resource) {
+    short twelfths;
+    long int_part = numerus_double_to_parts(double_value, &twelfths);
+    return int_with_twelfth_to_roman(int_part, twelfths, resource);
+}
+
+
+/**
+ * Copies the numeral of the roman into a string allocated in the memory
+ * resource.
+ */
+inline std::pmr::string to_string(
+        const roman &value,
+        std::pmr::memory_resource *resource = std::pmr::get_default_resource()) {
+    return std::pmr::string(value.view(), resource);
+}
+
+
+} /* namespace pmr */
+} /* namespace numerus */
+
+#endif /* NUMERUS_PMR_HPP */
@@ -0,0 +1,360 @@
+/**
+ * @file numerus_ranges.hpp
+ * @brief Numerus lazy C++20 range adaptors for conversion pipelines
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This header adds range adaptors converting the elements of a range lazily,
+ * while they are iterated. Requires C++20.
+ *
+ * - `numerus::views::to_roman` converts integer or floating point values to
+ *   numerus::roman, throwing numerus::error on values out of range;
+ * - `numerus::views::from_roman` converts strings to numerus::roman,
+ *   throwing numerus::error on numerals with wrong syntax;
+ * - `numerus::views::valid_numerals` converts strings to numerus::roman,
+ *   silently skipping numerals with wrong syntax.
+ *
+ * The views don't convert one element at a time: they pull blocks of
+ * elements from the underlying range into an arena stored in the view and
+ * convert each block with the batch conversion functions
+ * numerus_int_with_twelfth_to_roman_batch() and
+ * numerus_roman_to_int_part_and_twelfths_batch(). Pipelines keep the batch
+ * throughput without intermediate containers:
+ *
+ * <pre>
+ * auto years = lines | numerus::views::valid_numerals
+ *              | std::views::filter([](auto &r) { return r.int_part() > 1900; });
+ * for (const numerus::roman &year : years) { ... }
+ * </pre>
+ *
+ * Like `std::ranges::istream_view`, the views are single-pass input ranges:
+ * the current block lives in the view itself.
+ */
+
+#ifndef NUMERUS_RANGES_HPP
+#define NUMERUS_RANGES_HPP
+
+#include <cstring>      /* For `std::memcpy()` */
+#include <iterator>     /* For `std::default_sentinel_t` */
+#include <optional>     /* For `std::optional` */
+#include <ranges>       /* For `std::ranges::view_interface` */
+#include <string_view>  /* For `std::string_view` */
+#include <type_traits>  /* For `std::is_integral_v` */
+#include "numerus.hpp"
+
+
+namespace numerus {
+
+
+namespace detail {
+
+
+/**
+ * @internal
+ * Number of elements converted at once by the range adaptors.
+ */
+constexpr std::size_t batch_block_size = 64;
+
+
+/**
+ * @internal
+ * Distance in chars between two numerals in the arena of a block. Numerals to
+ * parse longer than this are converted one by one.
+ */
+constexpr std::size_t batch_stride = 64;
+
+
+/**
+ * @internal
+ * Block of romans converted together by the batch conversion functions.
+ */
+class roman_batch {
+public:
+    roman romans[batch_block_size];
+    std::size_t count = 0;
+
+    /**
+     * Pulls up to batch_block_size values from the range and converts them.
+     *
+     * @throws numerus::error if a value is out of range, once all values
+     * before it have been iterated.
+     */
+    template<typename Iterator, typename Sentinel>
+    void encode(Iterator &current, const Sentinel &last) {
+        long int_parts[batch_block_size];
+        short twelfths[batch_block_size];
+        throw_pending_error();
+        for (; count < batch_block_size && current != last; ++current) {
+            auto value = *current;
+            if constexpr (std::is_integral_v<decltype(value)>) {
+                int_parts[count] = static_cast<long>(value);
+                twelfths[count] = 0;
+            } else {
+                int_parts[count] = numerus_double_to_parts(
+                        static_cast<double>(value), &twelfths[count]);
+            }
+            shorten_and_same_sign_to_parts(&int_parts[count],
+                                           &twelfths[count]);
+            count++;
+        }
+        build(int_parts, twelfths);
+        if (count == 0) {
+            throw_pending_error();
+        }
+    }
+
+    /**
+     * Pulls values from the range until a block of up to batch_block_size
+     * numerals has been converted or the range ends.
+     *
+     * @param skip_invalid if true, numerals with wrong syntax are skipped,
+     * otherwise a numerus::error is thrown once all numerals before it have
+     * been iterated.
+     */
+    template<typename Iterator, typename Sentinel>
+    void decode(Iterator &current, const Sentinel &last, bool skip_invalid) {
+        long int_parts[batch_block_size];
+        short twelfths[batch_block_size];
+        int errcodes[batch_block_size];
+        throw_pending_error();
+        while (count == 0 && pending_error == NUMERUS_OK && current != last) {
+            /* Copy the numerals into the arena, null-terminated */
+            long long_int_parts[batch_block_size];
+            short long_twelfths[batch_block_size];
+            int long_errcodes[batch_block_size];
+            bool is_too_long[batch_block_size];
+            std::size_t pulled = 0;
+            for (; pulled < batch_block_size && current != last; ++current) {
+                auto &&element = *current;
+                std::string_view numeral(element);
+                char *slot = arena + pulled * batch_stride;
+                is_too_long[pulled] = numeral.size() >= batch_stride;
+                if (is_too_long[pulled]) {
+                    long_int_parts[pulled] = roman_to_int_part_and_twelfths(
+                            numeral, &long_twelfths[pulled],
+                            &long_errcodes[pulled]);
+                    slot[0] = '\0';
+                } else {
+                    std::memcpy(slot, numeral.data(), numeral.size());
+                    slot[numeral.size()] = '\0';
+                }
+                pulled++;
+            }
+
+            /* Parse them all at once, keeping only the valid ones */
+            numerus_roman_to_int_part_and_twelfths_batch(
+                    arena, batch_stride, pulled, int_parts, twelfths,
+                    errcodes);
+            for (std::size_t i = 0; i < pulled; i++) {
+                if (is_too_long[i]) {
+                    int_parts[i] = long_int_parts[i];
+                    twelfths[i] = long_twelfths[i];
+                    errcodes[i] = long_errcodes[i];
+                }
+                if (errcodes[i] == NUMERUS_OK) {
+                    int_parts[count] = int_parts[i];
+                    twelfths[count] = twelfths[i];
+                    count++;
+                } else if (!skip_invalid) {
+                    /* Thrown when the iteration reaches it */
+                    pending_error = errcodes[i];
+                    break;
+                }
+            }
+        }
+        build(int_parts, twelfths);
+        if (count == 0) {
+            throw_pending_error();
+        }
+    }
+
+private:
+    char arena[batch_block_size * batch_stride];
+    int pending_error = NUMERUS_OK;
+
+    /**
+     * Throws the error of an element that could not be converted, once all
+     * the elements before it have been iterated.
+     */
+    void throw_pending_error() {
+        count = 0;
+        if (pending_error != NUMERUS_OK) {
+            int errcode = pending_error;
+            pending_error = NUMERUS_OK;
+            throw error(errcode);
+        }
+    }
+
+    /**
+     * Batch-encodes the first `count` values to canonical numerals and stores
+     * them in the romans of the block, stopping at the first value out of
+     * range.
+     */
+    void build(const long *int_parts, const short *twelfths) {
+        int errcodes[batch_block_size];
+        numerus_int_with_twelfth_to_roman_batch(int_parts, twelfths, count,
+                                                arena, batch_stride, errcodes);
+        for (std::size_t i = 0; i < count; i++) {
+            if (errcodes[i] != NUMERUS_OK) {
+                pending_error = errcodes[i];
+                count = i;
+                return;
+            }
+            romans[i] = roman_builder::from_valid_numeral(
+                    arena + i * batch_stride, int_parts[i], twelfths[i]);
+        }
+    }
+};
+
+
+/**
+ * @internal
+ * Kind of conversion performed by a batch_view.
+ */
+enum class batch_conversion {
+    to_roman, from_roman, valid_numerals
+};
+
+
+/**
+ * @internal
+ * Single-pass view converting the elements of the underlying view one block
+ * at a time.
+ */
+template<std::ranges::view View, batch_conversion Conversion>
+class batch_view
+        : public std::ranges::view_interface<batch_view<View, Conversion>> {
+public:
+
+    class iterator {
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = roman;
+        using difference_type = std::ptrdiff_t;
+
+        iterator() = default;
+
+        explicit iterator(batch_view *parent) : parent(parent) {
+        }
+
+        const roman &operator*() const {
+            return parent->block.romans[parent->block_index];
+        }
+
+        const roman *operator->() const {
+            return &parent->block.romans[parent->block_index];
+        }
+
+        iterator &operator++() {
+            if (++parent->block_index == parent->block.count) {
+                parent->refill();
+            }
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        friend bool operator==(const iterator &position,
+                               std::default_sentinel_t) {
+            return position.is_at_end();
+        }
+
+    private:
+        batch_view *parent = nullptr;
+
+        bool is_at_end() const {
+            return parent->block.count == 0;
+        }
+    };
+
+    explicit batch_view(View base) : base(std::move(base)) {
+    }
+
+    iterator begin() {
+        current.emplace(std::ranges::begin(base));
+        refill();
+        return iterator(this);
+    }
+
+    std::default_sentinel_t end() const noexcept {
+        return std::default_sentinel;
+    }
+
+private:
+    View base;
+    std::optional<std::ranges::iterator_t<View>> current;
+    roman_batch block;
+    std::size_t block_index = 0;
+
+    void refill() {
+        block_index = 0;
+        if constexpr (Conversion == batch_conversion::to_roman) {
+            block.encode(*current, std::ranges::end(base));
+        } else {
+            block.decode(*current, std::ranges::end(base),
+                         Conversion == batch_conversion::valid_numerals);
+        }
+    }
+};
+
+
+/**
+ * @internal
+ * Range adaptor object creating a batch_view, usable both as
+ * `adaptor(range)` and as `range | adaptor`.
+ */
+template<batch_conversion Conversion>
+struct batch_adaptor {
+    template<std::ranges::viewable_range Range>
+    auto operator()(Range &&range) const {
+        using View = std::views::all_t<Range>;
+        return batch_view<View, Conversion>(
+                std::views::all(std::forward<Range>(range)));
+    }
+
+    template<std::ranges::viewable_range Range>
+    friend auto operator|(Range &&range, const batch_adaptor &adaptor) {
+        return adaptor(std::forward<Range>(range));
+    }
+};
+
+
+} /* namespace detail */
+
+
+namespace views {
+
+
+/**
+ * Converts integer or floating point values to numerus::roman lazily.
+ */
+inline constexpr detail::batch_adaptor<detail::batch_conversion::to_roman>
+        to_roman;
+
+
+/**
+ * Converts strings to numerus::roman lazily, throwing numerus::error on
+ * numerals with wrong syntax.
+ */
+inline constexpr detail::batch_adaptor<detail::batch_conversion::from_roman>
+        from_roman;
+
+
+/**
+ * Converts strings to numerus::roman lazily, skipping numerals with wrong
+ * syntax.
+ */
+inline constexpr detail::batch_adaptor<
+        detail::batch_conversion::valid_numerals> valid_numerals;
+
+
+} /* namespace views */
+
+
+} /* namespace numerus */
+
+#endif /* NUMERUS_RANGES_HPP */
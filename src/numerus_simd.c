@@ -0,0 +1,548 @@
+/**
+ * @file numerus_simd.c
+ * @brief Numerus SIMD kernels and their runtime dispatch.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the implementations of the kernels that can use the
+ * vector instructions of the CPU, one per instruction set, and the table
+ * of function pointers choosing among them. The table is initialised once
+ * when the library is loaded, from the features the CPU reports with
+ * `cpuid`, so a single binary runs on any x86 CPU with the best kernels it
+ * supports. On other architectures or compilers only the scalar kernels
+ * exist.
+ *
+ * Only the batch decoding is dispatched. The vector kernels classify the
+ * chars of a numeral into one bit mask per roman char, sum their values
+ * with popcounts and accept the sum if the numeral is the canonical one of
+ * that value, compared with the generated tables; everything else, errors
+ * included, is decoded by the scalar dictionary walk. The conversions of
+ * single values are driven by small tables and have no vector kernels.
+ *
+ * The level can be lowered with the NUMERUS_SIMD_LEVEL environment variable
+ * (`scalar`, `sse4.1`, `avx2`, `avx512`) or with numerus_set_simd_level(),
+ * for testing and benchmarking.
+ */
+
+#include <stdint.h>   /* For `uint64_t` */
+#include <stdlib.h>   /* For `getenv()` */
+#include <string.h>   /* For `strcmp()` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include "numerus_internal.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define _NUM_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define _NUM_SIMD_X86 0
+#endif
+
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-{   DECODING KERNELS   }-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Type of the kernels decoding a numeral in a slot of an arena, with the
+ * same result, twelfths and error code of
+ * numerus_roman_to_int_part_and_twelfths().
+ */
+typedef long (*_num_decode_kernel)(char *roman, size_t capacity,
+                                   short *twelfths, int *errcode);
+
+
+/**
+ * Scalar kernel: the character by character check and the dictionary walk
+ * of the library.
+ */
+static long _num_decode_scalar(char *roman, size_t capacity, short *twelfths,
+                               int *errcode) {
+    (void) capacity;
+    _num_count_roman_chars(roman, errcode);
+    if (*errcode != NUMERUS_OK) {
+        return NUMERUS_MAX_LONG_NONFLOAT_VALUE + 10;
+    }
+    return _num_parse_checked_numeral(roman, twelfths, errcode);
+}
+
+
+#if _NUM_SIMD_X86
+
+/**
+ * Roman chars classified by the vector kernels, by descending value, as
+ * compared after setting the lowercase bit, and their values in twelfths.
+ */
+static const char _NUM_SIMD_LOWERCASE_CHARS[] = "mdclxvis.";
+static const long _NUM_SIMD_CHAR_TWELFTHS[] = {
+    12000, 6000, 1200, 600, 120, 60, 12, 6, 1
+};
+#define _NUM_SIMD_CHAR_CLASSES 9
+
+
+/**
+ * Bit masks of the chars of a numeral, one bit per char, as classified by
+ * a vector kernel. The chars after the '\0' are zeroed before being
+ * classified, so no bit is set after the length.
+ */
+struct _num_simd_numeral {
+    uint64_t chars[_NUM_SIMD_CHAR_CLASSES];
+    uint64_t minus;
+    uint64_t underscores;
+    int length;
+};
+
+
+/**
+ * Value in twelfths of the chars of the numeral within a bit mask, adding
+ * each char and subtracting the ones followed by a char of greater value,
+ * like the "I" of "IV".
+ */
+static long _num_simd_sum(const struct _num_simd_numeral *numeral,
+                          uint64_t region) {
+    uint64_t greater = 0;
+    uint64_t subtracted = 0;
+    long sum = 0;
+    for (int i = 0; i < _NUM_SIMD_CHAR_CLASSES; i++) {
+        subtracted |= numeral->chars[i] & (greater >> 1);
+        greater |= numeral->chars[i];
+    }
+    for (int i = 0; i < _NUM_SIMD_CHAR_CLASSES; i++) {
+        uint64_t chars = numeral->chars[i] & region;
+        sum += _NUM_SIMD_CHAR_TWELFTHS[i]
+               * (__builtin_popcountll(chars & ~subtracted)
+                  - __builtin_popcountll(chars & subtracted));
+    }
+    return sum;
+}
+
+
+/**
+ * Uppercase of a char of a numeral already known to hold only roman chars,
+ * minus and underscores, without the locale lookup of `toupper()`.
+ */
+static char _num_simd_upper(char c) {
+    return (char) (c >= 'a' && c <= 'z' ? c - 'a' + 'A' : c);
+}
+
+
+/**
+ * Compares the numeral with the canonical chars of a value within [0, 3999],
+ * from the given decade: 0 for the thousands, 1 for the hundreds.
+ *
+ * @returns position after the matching chars or NULL if they differ.
+ */
+static const char *_num_simd_match_digits(const char *roman, long value,
+                                          int first_decade) {
+    static const long weights[4] = {1000, 100, 10, 1};
+    char digit[8];
+    for (int decade = first_decade; decade < 4; decade++) {
+        /* Through the helper of the tables, provided by both of their forms */
+        const char *end = _num_append_short_digit(
+                digit, decade, (int) (value / weights[decade] % 10));
+        for (const char *chars = digit; chars < end; chars++, roman++) {
+            if (_num_simd_upper(*roman) != *chars) {
+                return NULL;
+            }
+        }
+    }
+    return roman;
+}
+
+
+/**
+ * Decodes the common case from the bit masks of a numeral: an optional
+ * minus, then roman chars, possibly with the part between underscores of a
+ * long numeral.
+ *
+ * The value is the sum of the chars, which is the right one only for
+ * canonical numerals, so the numeral is accepted only if it's the one
+ * numerus_int_with_twelfth_to_roman() writes for that value, in any case.
+ * Anything else, like NUMERUS_ZERO, whitespace or any syntax error, is left
+ * to the scalar kernel, which knows the exact error to report.
+ *
+ * @returns true if decoded, false if the scalar kernel has to decode it.
+ */
+static bool _num_simd_decode(const char *roman,
+                             const struct _num_simd_numeral *numeral,
+                             long *int_part, short *twelfths) {
+    uint64_t before_terminator = (1ULL << numeral->length) - 1;
+    uint64_t legal = numeral->minus | numeral->underscores;
+    for (int i = 0; i < _NUM_SIMD_CHAR_CLASSES; i++) {
+        legal |= numeral->chars[i];
+    }
+    int start = (int) (numeral->minus & 1);
+    if (numeral->length == 0 || numeral->length >= NUMERUS_MAX_LENGTH
+        || legal != before_terminator || numeral->minus >> 1 != 0) {
+        return false;
+    }
+    long long_part = 0;
+    uint64_t short_region = before_terminator >> start << start;
+    const char *position = roman + start;
+    if (numeral->underscores != 0) {
+        /* Long numeral: "_", the part to multiply by 1000 and "_" */
+        int second = 63 - __builtin_clzll(numeral->underscores);
+        uint64_t long_region = ((1ULL << second) - 1) >> (start + 1)
+                               << (start + 1);
+        if (numeral->underscores != ((1ULL << start) | (1ULL << second))
+            || long_region == 0) {
+            return false;
+        }
+        long_part = _num_simd_sum(numeral, long_region);
+        short_region = before_terminator >> (second + 1) << (second + 1);
+        if (long_part % 12 != 0 || long_part < 4 * 12
+            || long_part > NUMERUS_MAX_SHORT_VALUE * 12) {
+            return false;
+        }
+        long_part /= 12;
+    }
+    long short_part = _num_simd_sum(numeral, short_region);
+    if (short_part < 0 || (long_part == 0 && short_part == 0)
+        || short_part / 12 > NUMERUS_MAX_SHORT_VALUE
+        || (long_part != 0 && short_part / 12 > 999)) {
+        return false;
+    }
+    if (long_part != 0) {
+        position = _num_simd_match_digits(position + 1, long_part, 0);
+        if (position == NULL || *(position++) != '_') {
+            return false;
+        }
+        position = _num_simd_match_digits(position, short_part / 12, 1);
+    } else {
+        position = _num_simd_match_digits(position, short_part / 12, 0);
+    }
+    if (position == NULL) {
+        return false;
+    }
+    char twelfths_chars[8];
+    const char *end = _num_append_twelfths(twelfths_chars,
+                                           (int) (short_part % 12));
+    for (const char *chars = twelfths_chars; chars < end;
+         chars++, position++) {
+        if (_num_simd_upper(*position) != *chars) {
+            return false;
+        }
+    }
+    if (position != roman + numeral->length) {
+        return false;
+    }
+    *int_part = long_part * 1000 + short_part / 12;
+    *twelfths = (short) (short_part % 12);
+    if (start == 1) {
+        *int_part = -*int_part;
+        *twelfths = (short) -*twelfths;
+    }
+    return true;
+}
+
+
+/**
+ * Adds to the bit masks of a numeral the ones of a block of 16 chars,
+ * already zeroed after the '\0'.
+ *
+ * Letters are compared after setting their lowercase bit, since the only
+ * chars that become a lowercase roman letter are its two cases.
+ */
+__attribute__((target("sse4.1")))
+static void _num_classify_sse41(__m128i block,
+                                struct _num_simd_numeral *numeral,
+                                int shift) {
+    __m128i folded = _mm_or_si128(block, _mm_set1_epi8(0x20));
+    for (int i = 0; i < _NUM_SIMD_CHAR_CLASSES - 1; i++) {
+        numeral->chars[i] |= (uint64_t) (uint16_t) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(folded, _mm_set1_epi8(
+                        _NUM_SIMD_LOWERCASE_CHARS[i]))) << shift;
+    }
+    numeral->chars[_NUM_SIMD_CHAR_CLASSES - 1] |=
+            (uint64_t) (uint16_t) _mm_movemask_epi8(
+                    _mm_cmpeq_epi8(block, _mm_set1_epi8('.'))) << shift;
+    numeral->minus |= (uint64_t) (uint16_t) _mm_movemask_epi8(
+            _mm_cmpeq_epi8(block, _mm_set1_epi8('-'))) << shift;
+    numeral->underscores |= (uint64_t) (uint16_t) _mm_movemask_epi8(
+            _mm_cmpeq_epi8(block, _mm_set1_epi8('_'))) << shift;
+}
+
+
+/**
+ * SSE4.1 kernel, classifying 48 chars with three 16-byte loads.
+ */
+__attribute__((target("sse4.1")))
+static long _num_decode_sse41(char *roman, size_t capacity, short *twelfths,
+                              int *errcode) {
+    struct _num_simd_numeral numeral = {{0}, 0, 0, 0};
+    __m128i blocks[3];
+    uint64_t terminators = 0;
+    long int_part;
+    if (capacity < 48) {
+        return _num_decode_scalar(roman, capacity, twelfths, errcode);
+    }
+    for (int i = 0; i < 3; i++) {
+        blocks[i] = _mm_loadu_si128((const __m128i *) (roman + 16 * i));
+        terminators |= (uint64_t) (uint16_t) _mm_movemask_epi8(
+                _mm_cmpeq_epi8(blocks[i], _mm_setzero_si128())) << (16 * i);
+    }
+    if (terminators != 0) {
+        numeral.length = __builtin_ctzll(terminators);
+        for (int i = 0; i < 3; i++) {
+            /* Zero the chars after the '\0', which may be anything */
+            __m128i positions = _mm_add_epi8(
+                    _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                  13, 14, 15),
+                    _mm_set1_epi8((char) (16 * i)));
+            __m128i before_terminator = _mm_cmpgt_epi8(
+                    _mm_set1_epi8((char) numeral.length), positions);
+            _num_classify_sse41(_mm_and_si128(blocks[i], before_terminator),
+                                &numeral, 16 * i);
+        }
+        if (_num_simd_decode(roman, &numeral, &int_part, twelfths)) {
+            *errcode = NUMERUS_OK;
+            return int_part;
+        }
+    }
+    return _num_decode_scalar(roman, capacity, twelfths, errcode);
+}
+
+
+/**
+ * AVX2 kernel, classifying 64 chars with two 32-byte loads.
+ */
+__attribute__((target("avx2")))
+static long _num_decode_avx2(char *roman, size_t capacity, short *twelfths,
+                             int *errcode) {
+    struct _num_simd_numeral numeral = {{0}, 0, 0, 0};
+    __m256i blocks[2];
+    uint64_t terminators = 0;
+    long int_part;
+    if (capacity < 64) {
+        return _num_decode_sse41(roman, capacity, twelfths, errcode);
+    }
+    for (int i = 0; i < 2; i++) {
+        blocks[i] = _mm256_loadu_si256((const __m256i *) (roman + 32 * i));
+        terminators |= (uint64_t) (uint32_t) _mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(blocks[i], _mm256_setzero_si256()))
+                << (32 * i);
+    }
+    if (terminators != 0) {
+        numeral.length = __builtin_ctzll(terminators);
+        for (int i = 0; i < 2; i++) {
+            /* Zero the chars after the '\0', which may be anything */
+            __m256i positions = _mm256_add_epi8(
+                    _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+                                     12, 13, 14, 15, 16, 17, 18, 19, 20, 21,
+                                     22, 23, 24, 25, 26, 27, 28, 29, 30, 31),
+                    _mm256_set1_epi8((char) (32 * i)));
+            __m256i block = _mm256_and_si256(blocks[i], _mm256_cmpgt_epi8(
+                    _mm256_set1_epi8((char) numeral.length), positions));
+            __m256i folded = _mm256_or_si256(block, _mm256_set1_epi8(0x20));
+            for (int c = 0; c < _NUM_SIMD_CHAR_CLASSES - 1; c++) {
+                numeral.chars[c] |= (uint64_t) (uint32_t) _mm256_movemask_epi8(
+                        _mm256_cmpeq_epi8(folded, _mm256_set1_epi8(
+                                _NUM_SIMD_LOWERCASE_CHARS[c]))) << (32 * i);
+            }
+            numeral.chars[_NUM_SIMD_CHAR_CLASSES - 1] |=
+                    (uint64_t) (uint32_t) _mm256_movemask_epi8(
+                            _mm256_cmpeq_epi8(block, _mm256_set1_epi8('.')))
+                    << (32 * i);
+            numeral.minus |= (uint64_t) (uint32_t) _mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(block, _mm256_set1_epi8('-')))
+                    << (32 * i);
+            numeral.underscores |= (uint64_t) (uint32_t) _mm256_movemask_epi8(
+                    _mm256_cmpeq_epi8(block, _mm256_set1_epi8('_')))
+                    << (32 * i);
+        }
+        if (_num_simd_decode(roman, &numeral, &int_part, twelfths)) {
+            *errcode = NUMERUS_OK;
+            return int_part;
+        }
+    }
+    return _num_decode_scalar(roman, capacity, twelfths, errcode);
+}
+
+
+/**
+ * AVX-512 kernel, classifying 64 chars with one load straight into masks.
+ */
+__attribute__((target("avx512f,avx512bw")))
+static long _num_decode_avx512(char *roman, size_t capacity, short *twelfths,
+                               int *errcode) {
+    struct _num_simd_numeral numeral = {{0}, 0, 0, 0};
+    long int_part;
+    if (capacity < 64) {
+        return _num_decode_sse41(roman, capacity, twelfths, errcode);
+    }
+    __m512i block = _mm512_loadu_si512((const void *) roman);
+    __mmask64 terminators = _mm512_cmpeq_epi8_mask(block,
+                                                   _mm512_setzero_si512());
+    if (terminators != 0) {
+        numeral.length = __builtin_ctzll(terminators);
+        /* Zero the chars after the '\0', which may be anything */
+        block = _mm512_maskz_mov_epi8((1ULL << numeral.length) - 1, block);
+        __m512i folded = _mm512_or_si512(block, _mm512_set1_epi8(0x20));
+        for (int c = 0; c < _NUM_SIMD_CHAR_CLASSES - 1; c++) {
+            numeral.chars[c] = _mm512_cmpeq_epi8_mask(
+                    folded, _mm512_set1_epi8(_NUM_SIMD_LOWERCASE_CHARS[c]));
+        }
+        numeral.chars[_NUM_SIMD_CHAR_CLASSES - 1] = _mm512_cmpeq_epi8_mask(
+                block, _mm512_set1_epi8('.'));
+        numeral.minus = _mm512_cmpeq_epi8_mask(block, _mm512_set1_epi8('-'));
+        numeral.underscores = _mm512_cmpeq_epi8_mask(block,
+                                                     _mm512_set1_epi8('_'));
+        if (_num_simd_decode(roman, &numeral, &int_part, twelfths)) {
+            *errcode = NUMERUS_OK;
+            return int_part;
+        }
+    }
+    return _num_decode_scalar(roman, capacity, twelfths, errcode);
+}
+
+#endif /* _NUM_SIMD_X86 */
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-+-{   DISPATCH   }-+-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Kernels of each level, indexed by NUMERUS_SIMD_* level.
+ */
+static const _num_decode_kernel _NUM_DECODE_KERNELS[] = {
+    _num_decode_scalar,
+#if _NUM_SIMD_X86
+    _num_decode_sse41,
+    _num_decode_avx2,
+    _num_decode_avx512
+#endif
+};
+
+
+/**
+ * Names of the levels for the NUMERUS_SIMD_LEVEL environment variable,
+ * indexed by NUMERUS_SIMD_* level.
+ */
+static const char *const _NUM_SIMD_LEVEL_NAMES[] = {
+    "scalar", "sse4.1", "avx2", "avx512"
+};
+
+
+/**
+ * The level of the kernels in use and the kernels themselves.
+ *
+ * Written when the library is loaded and by numerus_set_simd_level() only.
+ */
+static int _num_simd_level = NUMERUS_SIMD_SCALAR;
+static _num_decode_kernel _num_decode_roman_kernel = _num_decode_scalar;
+
+
+/**
+ * Detects the best level supported by the CPU and the OS.
+ *
+ * @returns int one of the NUMERUS_SIMD_* levels.
+ */
+static int _num_simd_supported_level(void) {
+#if _NUM_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        return NUMERUS_SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return NUMERUS_SIMD_AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.1")) {
+        return NUMERUS_SIMD_SSE41;
+    }
+#endif
+    return NUMERUS_SIMD_SCALAR;
+}
+
+
+/**
+ * Initialises the table of kernels with the best level, or the one of the
+ * NUMERUS_SIMD_LEVEL environment variable if lower.
+ *
+ * Runs when the library is loaded, before any thread of the program may
+ * call a conversion.
+ */
+#if defined(__GNUC__)
+__attribute__((constructor))
+#endif
+static void _num_simd_init(void) {
+    int level = _num_simd_supported_level();
+    const char *forced = getenv("NUMERUS_SIMD_LEVEL");
+    if (forced != NULL) {
+        for (int i = NUMERUS_SIMD_SCALAR; i <= NUMERUS_SIMD_AVX512; i++) {
+            if (strcmp(forced, _NUM_SIMD_LEVEL_NAMES[i]) == 0) {
+                level = i;
+            }
+        }
+    }
+    numerus_set_simd_level(level);
+}
+
+
+/**
+ * Returns the level of the SIMD kernels in use.
+ *
+ * @returns int one of NUMERUS_SIMD_SCALAR, NUMERUS_SIMD_SSE41,
+ * NUMERUS_SIMD_AVX2, NUMERUS_SIMD_AVX512.
+ */
+int numerus_simd_level(void) {
+    return _num_simd_level;
+}
+
+
+/**
+ * Forces the level of the SIMD kernels used by the conversions, for testing
+ * and benchmarking.
+ *
+ * Levels above the one supported by the CPU are lowered to it, so the result
+ * is always safe to run. Not thread safe: call it before any conversion runs
+ * on other threads.
+ *
+ * @param level one of NUMERUS_SIMD_SCALAR, NUMERUS_SIMD_SSE41,
+ * NUMERUS_SIMD_AVX2, NUMERUS_SIMD_AVX512.
+ * @returns int the level actually set.
+ */
+int numerus_set_simd_level(int level) {
+    int supported = _num_simd_supported_level();
+    if (level > supported) {
+        level = supported;
+    }
+    if (level < NUMERUS_SIMD_SCALAR) {
+        level = NUMERUS_SIMD_SCALAR;
+    }
+    _num_simd_level = level;
+    _num_decode_roman_kernel = _NUM_DECODE_KERNELS[level];
+    return level;
+}
+
+
+/**
+ * Converts a roman numeral to its value as integer part and number of
+ * twelfths, like numerus_roman_to_int_part_and_twelfths() but without
+ * touching numerus_error_code, with the SIMD kernel of the current level.
+ *
+ * The kernels may read the whole buffer of the numeral, not just up to its
+ * '\0', so it's used for numerals in arenas, like the batch conversions.
+ *
+ * @param *roman string containing the roman numeral.
+ * @param capacity number of chars that can be read from *roman.
+ * @param *twelfths number of twelfths from 0 to 11. Can NOT be NULL.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can NOT be NULL.
+ * @returns long as the integer part of the value of the roman numeral or a
+ * value outside the the possible range of values when an error occurs.
+ */
+long _num_decode_roman_slot(char *roman, size_t capacity, short *twelfths,
+                            int *errcode) {
+#if !defined(__GNUC__)
+    static bool initialised = false;
+    if (!initialised) {
+        _num_simd_init();
+        initialised = true;
+    }
+#endif
+    return _num_decode_roman_kernel(roman, capacity, twelfths, errcode);
+}
@@ -0,0 +1,500 @@
+/**
+ * @file numerus_suggest.c
+ * @brief Numerus approximate matching and correction of malformed numerals.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the functions suggesting the valid roman numerals
+ * closest to a malformed one, like "XllV" or "MCMLXXXXIV" read by an OCR.
+ *
+ * The suggestions are found by running a Levenshtein automaton of the
+ * malformed numeral on the automaton of the grammar of the numerals. The
+ * grammar is walked depth-first as numerus_enumerate() does, one char at a
+ * time, while the state of the Levenshtein automaton is kept as a row of
+ * edit costs, one per prefix of the malformed numeral. A branch of the
+ * grammar is abandoned as soon as every cost of its row exceeds the max
+ * cost, so the walk visits only the prefixes of numerals close to a prefix
+ * of the malformed one and never the whole domain.
+ *
+ * The numerals after a digit group depend only on the group, not on the
+ * digits before it, so many prefixes reach the same state of the grammar
+ * with the same row. Walking the branch again would give the same costs:
+ * the min cost found in the branch is memoised on the state of the grammar
+ * and the row, and a branch already known to have no numeral within the max
+ * cost is skipped. Without the memo a long malformed numeral walked with
+ * many edits visits an exponential number of such dead branches.
+ *
+ * The edit costs are weighted: substituting a char with one an OCR easily
+ * confuses it with, like 'l' or '1' with 'I', costs half an edit and a
+ * lowercase letter matches its uppercase one for free.
+ */
+
+#include <string.h>   /* For `memcpy()`, `memset()`, `strlen()` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include <stdint.h>   /* For `uint64_t` */
+#include "numerus_internal.h"
+#include "numerus_tables.h"  /* Generated by numerus_tables_gen.c */
+
+
+/**
+ * @internal
+ * Max number of chars of a malformed numeral: longer ones can't be within
+ * NUMERUS_SUGGEST_MAX_EDITS edits of any numeral.
+ */
+#define _NUM_SUGGEST_MAX_INPUT (36 + NUMERUS_SUGGEST_MAX_EDITS)
+
+
+/**
+ * @internal
+ * Max number of chars of a numeral walked by the suggestions, NUMERUS_ZERO,
+ * the sign and the underscores included.
+ */
+#define _NUM_SUGGEST_MAX_DEPTH 36
+
+
+/**
+ * @internal
+ * Number of entries of the memo of the walked branches, a power of 2.
+ */
+#define _NUM_SUGGEST_MEMO_SIZE 1024
+
+
+/**
+ * @internal
+ * Bits of a cost of a row packed in a memo entry, enough for
+ * NUMERUS_SUGGEST_MAX_EDITS * NUMERUS_SUGGEST_EDIT_COST + 1.
+ */
+#define _NUM_SUGGEST_MEMO_COST_BITS 5
+
+
+/**
+ * @internal
+ * Cost of a branch of the grammar without any numeral.
+ */
+#define _NUM_SUGGEST_NO_NUMERALS 0x7FFF
+
+
+/**
+ * @internal
+ * Chars an OCR confuses with the chars of the numerals, substituted for half
+ * an edit: each char of `confused` with the numeral char `roman`.
+ */
+struct _num_confusable {
+    char roman;
+    const char *confused;
+};
+
+static const struct _num_confusable _NUM_CONFUSABLES[] = {
+        {'I', "l1|!Jj"},
+        {'V', "UuYy"},
+        {'X', "Kk%"},
+        {'C', "O0oG(<"},
+        {'D', "O0o"},
+        {'M', "Nn"},
+        {'S', "5$"},
+        {'.', ",'`"},
+        {'-', "~"},
+        {'_', "-"},
+};
+
+
+/**
+ * @internal
+ * Cost of substituting a char of the malformed numeral with a char of a
+ * valid numeral.
+ *
+ * @returns short NUMERUS_SUGGEST_EDIT_COST for a generic substitution,
+ * NUMERUS_SUGGEST_CONFUSABLE_COST for confusable chars, 0 for the same char
+ * or the same letter in lowercase.
+ */
+static short _num_suggest_substitution_cost(char bad, char good) {
+    if (bad == good || (bad >= 'a' && bad <= 'z' && bad - 'a' + 'A' == good)) {
+        return 0;
+    }
+    for (size_t i = 0;
+         i < sizeof(_NUM_CONFUSABLES) / sizeof(_NUM_CONFUSABLES[0]); i++) {
+        if (_NUM_CONFUSABLES[i].roman == good
+            && strchr(_NUM_CONFUSABLES[i].confused, bad) != NULL) {
+            return NUMERUS_SUGGEST_CONFUSABLE_COST;
+        }
+    }
+    return NUMERUS_SUGGEST_EDIT_COST;
+}
+
+
+/**
+ * @internal
+ * Memoised branch of the grammar: the state of the grammar the branch starts
+ * from, its row with the costs packed in _NUM_SUGGEST_MEMO_COST_BITS each
+ * and the min cost of its numerals.
+ *
+ * The min cost is exact if within the max cost of the walk when the branch
+ * was walked, otherwise it's only known to be greater than that max cost,
+ * which never grows, so both are lower bounds.
+ */
+struct _num_suggest_memo_entry {
+    uint64_t row[4];
+    short state;
+    short min_cost;
+};
+
+
+/**
+ * @internal
+ * State of a walk of the grammar against one malformed numeral.
+ *
+ * rows[d] is the state of the Levenshtein automaton after the first d chars
+ * of the numeral being walked: rows[d][j] is the min cost of editing the
+ * first j chars of the malformed numeral into them.
+ */
+struct _num_suggest_walk {
+    short bad_length;
+    short max_cost;
+    short initial_max_cost;
+    short costs[128][_NUM_SUGGEST_MAX_INPUT];
+    short rows[_NUM_SUGGEST_MAX_DEPTH + 1][_NUM_SUGGEST_MAX_INPUT + 1];
+    char roman[_NUM_SUGGEST_MAX_DEPTH + 1];
+    bool negative;
+    bool long_numeral;
+    struct numerus_suggestion *out;
+    size_t capacity;
+    size_t found;
+    struct _num_suggest_memo_entry memo[_NUM_SUGGEST_MEMO_SIZE];
+};
+
+
+/**
+ * @internal
+ * Feeds the chars of the walked numeral from `start` to `end` to the
+ * Levenshtein automaton, computing their rows.
+ *
+ * @returns true if some prefix of the malformed numeral is still within the
+ * max cost, false if the branch of the grammar can be abandoned.
+ */
+static bool _num_suggest_feed(struct _num_suggest_walk *walk,
+                              const char *start, const char *end) {
+    bool alive = true;
+    for (const char *c = start; c < end; c++) {
+        int depth = (int) (c - walk->roman);
+        const short *previous = walk->rows[depth];
+        short *row = walk->rows[depth + 1];
+        const short *costs = walk->costs[(unsigned char) *c & 0x7F];
+        short min_cost = row[0] = previous[0] + NUMERUS_SUGGEST_EDIT_COST;
+        for (int j = 1; j <= walk->bad_length; j++) {
+            short cost = previous[j - 1] + costs[j - 1];
+            if (previous[j] + NUMERUS_SUGGEST_EDIT_COST < cost) {
+                cost = previous[j] + NUMERUS_SUGGEST_EDIT_COST;
+            }
+            if (row[j - 1] + NUMERUS_SUGGEST_EDIT_COST < cost) {
+                cost = row[j - 1] + NUMERUS_SUGGEST_EDIT_COST;
+            }
+            row[j] = cost;
+            if (cost < min_cost) {
+                min_cost = cost;
+            }
+        }
+        alive = min_cost <= walk->max_cost;
+        if (!alive) {
+            break;
+        }
+    }
+    return alive;
+}
+
+
+/**
+ * @internal
+ * Inserts a complete numeral among the suggestions if it's within the max
+ * cost, keeping them sorted by cost, and lowers the max cost to the one of
+ * the worst suggestion once they are as many as requested.
+ *
+ * @returns short the cost of the numeral.
+ */
+static short _num_suggest_offer(struct _num_suggest_walk *walk, char *end,
+                                long magnitude, short twelfths) {
+    short cost = walk->rows[end - walk->roman][walk->bad_length];
+    if (cost > walk->max_cost) {
+        return cost;
+    }
+    size_t position = walk->found < walk->capacity ? walk->found
+                                                   : walk->capacity - 1;
+    while (position > 0 && walk->out[position - 1].cost > cost) {
+        walk->out[position] = walk->out[position - 1];
+        position--;
+    }
+    struct numerus_suggestion *suggestion = &walk->out[position];
+    memcpy(suggestion->roman, walk->roman, (size_t) (end - walk->roman));
+    suggestion->roman[end - walk->roman] = '\0';
+    suggestion->int_part = walk->negative ? -magnitude : magnitude;
+    suggestion->twelfths = (short) (walk->negative ? -twelfths : twelfths);
+    suggestion->cost = cost;
+    if (walk->found < walk->capacity) {
+        walk->found++;
+    }
+    if (walk->found == walk->capacity) {
+        /* Ties with the worst suggestion don't replace it */
+        walk->max_cost = (short) (walk->out[walk->capacity - 1].cost - 1);
+    }
+    return cost;
+}
+
+
+/**
+ * @internal
+ * Lowers the min cost of a branch to the one of a sub-branch: the cost
+ * returned by walking it or, if it was abandoned, the current max cost + 1.
+ */
+static void _num_suggest_lower_min_cost(short *min_cost, short cost) {
+    if (cost < *min_cost) {
+        *min_cost = cost;
+    }
+}
+
+
+/**
+ * @internal
+ * Walks the twelfths after the complete integer part.
+ *
+ * @returns short the min cost of the numerals of the branch.
+ */
+static short _num_suggest_twelfths(struct _num_suggest_walk *walk,
+                                   char *position, long magnitude) {
+    short min_cost = _NUM_SUGGEST_NO_NUMERALS;
+    for (short twelfths = 0; twelfths < 12; twelfths++) {
+        if (twelfths == 0 && magnitude == 0) {
+            continue;
+        }
+        char *end = _num_append_twelfths(position, twelfths);
+        if (_num_suggest_feed(walk, position, end)) {
+            _num_suggest_lower_min_cost(
+                    &min_cost, _num_suggest_offer(walk, end, magnitude,
+                                                  twelfths));
+        } else {
+            _num_suggest_lower_min_cost(&min_cost,
+                                        (short) (walk->max_cost + 1));
+        }
+    }
+    return min_cost;
+}
+
+
+/**
+ * @internal
+ * Finds the memo entry of the branch starting from a digit group with the
+ * row of the numeral walked up to `position`, packing the row in `row`.
+ *
+ * The state of the grammar is the kind of numeral, the group and, as they
+ * decide which numerals are valid, whether the magnitude is still 0 for
+ * short numerals or the thousands of the part between the underscores so
+ * far, up to 4, for long ones.
+ *
+ * @returns the entry where the branch is or is going to be memoised, always
+ * the same one for the same state and row.
+ */
+static struct _num_suggest_memo_entry *_num_suggest_memo_find(
+        struct _num_suggest_walk *walk, int group, char *position,
+        long magnitude, uint64_t row[4], short *state) {
+    long value_class = magnitude != 0;
+    if (walk->long_numeral) {
+        value_class = magnitude / 1000 < 4 ? magnitude / 1000 : 4;
+    }
+    *state = (short) (1 + ((walk->negative * 2 + walk->long_numeral) * 8
+                           + group) * 5 + value_class);
+    const short *costs = walk->rows[position - walk->roman];
+    const int per_word = 64 / _NUM_SUGGEST_MEMO_COST_BITS;
+    uint64_t hash = (uint64_t) *state;
+    for (int word = 0; word < 4; word++) {
+        row[word] = 0;
+        for (int i = word * per_word;
+             i < (word + 1) * per_word && i <= walk->bad_length; i++) {
+            /* Costs above the initial max cost are all the same dead end */
+            short cost = costs[i] <= walk->initial_max_cost
+                         ? costs[i] : (short) (walk->initial_max_cost + 1);
+            row[word] |= (uint64_t) cost
+                    << ((i - word * per_word) * _NUM_SUGGEST_MEMO_COST_BITS);
+        }
+        hash = (hash ^ row[word]) * 0x100000001B3ULL;
+    }
+    return &walk->memo[(hash ^ (hash >> 29)) & (_NUM_SUGGEST_MEMO_SIZE - 1)];
+}
+
+
+/**
+ * @internal
+ * Walks the digits of one group and, recursively, the following groups, as
+ * the enumeration does, abandoning the digits whose chars are too far from
+ * the malformed numeral and the branches memoised as such.
+ *
+ * Groups 0-3 are the thousands to the units of short numerals or of the part
+ * between the underscores of long numerals, groups 4-6 the hundreds to the
+ * units after the underscores.
+ *
+ * @returns short the min cost of the numerals of the branch.
+ */
+static short _num_suggest_group(struct _num_suggest_walk *walk, int group,
+                                char *position, long magnitude) {
+    int groups = walk->long_numeral ? 7 : 4;
+    if (group == groups) {
+        return _num_suggest_twelfths(walk, position, magnitude);
+    }
+    if (walk->long_numeral && group == 4
+        && magnitude <= NUMERUS_MAX_SHORT_VALUE) {
+        /* Long numerals below 4000 are written as short ones */
+        return _NUM_SUGGEST_NO_NUMERALS;
+    }
+    uint64_t row[4];
+    short state;
+    struct _num_suggest_memo_entry *entry = _num_suggest_memo_find(
+            walk, group, position, magnitude, row, &state);
+    if (entry->state == state && memcmp(entry->row, row, sizeof(row)) == 0
+        && entry->min_cost > walk->max_cost) {
+        return entry->min_cost;
+    }
+    short min_cost = _NUM_SUGGEST_NO_NUMERALS;
+    if (walk->long_numeral && group == 4) {
+        *position = '_';
+        if (!_num_suggest_feed(walk, position, position + 1)) {
+            return (short) (walk->max_cost + 1);
+        }
+        position++;
+    }
+    int decade = group < 4 ? group : group - 3;
+    int max_digit = decade == 0 ? 3 : 9;
+    long weight = 1;
+    for (int i = decade; i < 3; i++) {
+        weight *= 10;
+    }
+    if (walk->long_numeral && group < 4) {
+        weight *= 1000;
+    }
+    for (int digit = 0; digit <= max_digit; digit++) {
+        char *end = _num_append_short_digit(position, decade, digit);
+        if (_num_suggest_feed(walk, position, end)) {
+            _num_suggest_lower_min_cost(
+                    &min_cost, _num_suggest_group(walk, group + 1, end,
+                                                  magnitude + digit * weight));
+        } else {
+            _num_suggest_lower_min_cost(&min_cost,
+                                        (short) (walk->max_cost + 1));
+        }
+    }
+    /* The slot may hold another branch walked meanwhile: overwrite it */
+    memcpy(entry->row, row, sizeof(row));
+    entry->state = state;
+    entry->min_cost = min_cost;
+    return min_cost;
+}
+
+
+/**
+ * @internal
+ * Walks the numerals with one sign and one kind of integer part.
+ */
+static void _num_suggest_walk_kind(struct _num_suggest_walk *walk,
+                                   bool negative, bool long_numeral) {
+    char *position = walk->roman;
+    walk->negative = negative;
+    walk->long_numeral = long_numeral;
+    if (negative) {
+        *(position++) = '-';
+    }
+    if (long_numeral) {
+        *(position++) = '_';
+    }
+    if (_num_suggest_feed(walk, walk->roman, position)) {
+        _num_suggest_group(walk, 0, position, 0);
+    }
+}
+
+
+/**
+ * Suggests the valid roman numerals closest to a malformed one, by weighted
+ * edit distance, like a spell checker does.
+ *
+ * Each insertion, deletion or substitution of a char costs
+ * NUMERUS_SUGGEST_EDIT_COST, except substituting a char an OCR confuses with
+ * a char of the numerals, like 'l', '1' or '|' for 'I', '0' or 'O' for 'C'
+ * and 'D', 'U' for 'V' or '5' for 'S', which costs
+ * NUMERUS_SUGGEST_CONFUSABLE_COST, half an edit. Lowercase letters match the
+ * uppercase ones for free. The letter 'O' is not a char of the numerals, so
+ * the "0 to O" confusion of OCRs is handled as '0' and 'O' both being
+ * confusable with 'C' and 'D'.
+ *
+ * The suggestions are the canonical uppercase numerals
+ * numerus_int_with_twelfth_to_roman() writes, within `max_edits` edits of the
+ * malformed numeral, sorted by ascending cost and, within the same cost,
+ * NUMERUS_ZERO first, then the positive and the negative numerals, each by
+ * ascending magnitude, short numerals before long ones. A valid numeral written in
+ * canonical form is suggested first with cost 0.
+ *
+ * The search runs a Levenshtein automaton on the grammar of the numerals,
+ * memoising the branches without close numerals, so its time grows with the
+ * length of the malformed numeral and with `max_edits`, not with the size of
+ * the domain.
+ *
+ * @param *bad null-terminated malformed numeral.
+ * @param max_edits max number of edits of the suggestions, at most
+ * NUMERUS_SUGGEST_MAX_EDITS: bigger values are lowered to it.
+ * @param *out array of `n` suggestions where to write the closest numerals,
+ * with their value and cost.
+ * @param n max number of suggestions to write.
+ * @param *errcode int where to store the status: NUMERUS_OK or
+ * NUMERUS_ERROR_NULL_ROMAN, also stored in numerus_error_code. Can be NULL
+ * to store it only in numerus_error_code.
+ * @returns size_t number of suggestions written, 0 if no numeral is within
+ * `max_edits` edits or when an error occurs.
+ */
+size_t numerus_suggest(const char *bad, short max_edits,
+                       struct numerus_suggestion *out, size_t n,
+                       int *errcode) {
+    struct _num_suggest_walk walk;
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    if (bad == NULL) {
+        numerus_error_code = NUMERUS_ERROR_NULL_ROMAN;
+        *errcode = NUMERUS_ERROR_NULL_ROMAN;
+        return 0;
+    }
+    numerus_error_code = NUMERUS_OK;
+    *errcode = NUMERUS_OK;
+    size_t bad_length = strlen(bad);
+    if (max_edits > NUMERUS_SUGGEST_MAX_EDITS) {
+        max_edits = NUMERUS_SUGGEST_MAX_EDITS;
+    }
+    if (n == 0 || max_edits < 0 || bad_length > _NUM_SUGGEST_MAX_INPUT) {
+        return 0;
+    }
+    walk.bad_length = (short) bad_length;
+    walk.max_cost = (short) (max_edits * NUMERUS_SUGGEST_EDIT_COST);
+    walk.initial_max_cost = walk.max_cost;
+    memset(walk.memo, 0, sizeof(walk.memo));
+    walk.out = out;
+    walk.capacity = n;
+    walk.found = 0;
+    /* Substitution costs of the chars of the numerals, looked up per char */
+    const char *roman_chars = "MDCLXVIS.-_NUA";
+    for (const char *good = roman_chars; *good != '\0'; good++) {
+        for (size_t j = 0; j < bad_length; j++) {
+            walk.costs[(unsigned char) *good][j] =
+                    _num_suggest_substitution_cost(bad[j], *good);
+        }
+    }
+    for (short j = 0; j <= walk.bad_length; j++) {
+        walk.rows[0][j] = (short) (j * NUMERUS_SUGGEST_EDIT_COST);
+    }
+    /* NUMERUS_ZERO, then positive and negative numerals */
+    size_t zero_length = strlen(NUMERUS_ZERO);
+    walk.negative = false;
+    memcpy(walk.roman, NUMERUS_ZERO, zero_length);
+    if (_num_suggest_feed(&walk, walk.roman, walk.roman + zero_length)) {
+        _num_suggest_offer(&walk, walk.roman + zero_length, 0, 0);
+    }
+    _num_suggest_walk_kind(&walk, false, false);
+    _num_suggest_walk_kind(&walk, false, true);
+    _num_suggest_walk_kind(&walk, true, false);
+    _num_suggest_walk_kind(&walk, true, true);
+    return walk.found;
+}
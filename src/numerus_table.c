@@ -0,0 +1,508 @@
+/**
+ * @file numerus_table.c
+ * @brief Numerus conversions through a memory-mapped table file.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the functions writing and reading a table file with the
+ * canonical roman numeral of every value in the conversion range, so that
+ * both conversions become a lookup in constant time:
+ *
+ * - value -> roman: the numerals are indexed by their value in twelfths,
+ *   `abs(int_part) * 12 + abs(twelfths)`, through an array of offsets;
+ * - roman -> value: a hash index with open addressing maps each numeral to
+ *   its value in twelfths.
+ *
+ * The file is mapped in memory read-only and shared, so all processes using
+ * it share one copy in the page cache and open it without building anything.
+ * Negative values are not stored: they are the numerals of the positive ones
+ * with a leading minus.
+ *
+ * Layout of the file, with the integers in the byte order of the machine
+ * that wrote it:
+ *
+ * <pre>
+ * header          56 bytes, struct _num_table_header
+ * offsets         (count + 1) * 4 bytes, start of each numeral in chars
+ * hash index      hash_slots * 4 bytes, value in twelfths + 1 or 0 if empty
+ * chars           the numerals, uppercase, one after the other without '\0'
+ * </pre>
+ *
+ * With 48 000 000 values and 2^26 hash slots, the file is 1.35 GB: 192 MB of
+ * offsets, 268 MB of hash index and 888 MB of chars; `numerus_mktable` writes
+ * it in about 20 seconds. With the pages in the page cache, measured on a
+ * virtual machine where the computed encoder takes 65 ns per long numeral:
+ *
+ * - value -> roman: about 30 ns for consecutive values, 140 ns for random
+ *   ones, limited by the cache and TLB misses on the offsets and chars;
+ * - roman -> value: about 330 ns for consecutive values and 580 ns for random
+ *   ones, three cache misses (index, offsets, chars), against 700-950 ns of
+ *   the parser on the same long numerals.
+ *
+ * The latency doesn't depend on the value, but on the locality of the
+ * lookups: the table pays off for large batches of long numerals.
+ *
+ * Without the table file, like when numerus_open_table_file() fails or with a
+ * NULL table, the conversions taking a table use the computed functions of
+ * the library, with the same results. Numerals not found in the index, like
+ * lowercase or wrong ones, are also given to the library parser, which knows
+ * the exact error code.
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* For `mmap()`, `fstat()` */
+
+#include <stdint.h>   /* For `uint32_t`, `uint64_t` */
+#include <stdio.h>    /* For `fopen()`, `fwrite()` */
+#include <stdlib.h>   /* For `malloc()`, `calloc()`, `free()` */
+#include <string.h>   /* For `memcmp()`, `memcpy()` */
+#include "numerus_internal.h"
+#include "numerus_inline.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _NUM_TABLE_MMAP 1
+#include <fcntl.h>     /* For `open()` */
+#include <sys/mman.h>  /* For `mmap()`, `munmap()` */
+#include <sys/stat.h>  /* For `fstat()` */
+#include <unistd.h>    /* For `close()` */
+#else
+#define _NUM_TABLE_MMAP 0
+#endif
+
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   TABLE FILE FORMAT   }-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * @internal
+ * First bytes of every table file.
+ */
+static const char _NUM_TABLE_MAGIC[8] = "NUMTABLE";
+
+
+/**
+ * @internal
+ * Version of the layout of the table file.
+ */
+#define _NUM_TABLE_VERSION 1
+
+
+/**
+ * @internal
+ * Written as is in the file, to recognize files written on a machine with
+ * another byte order.
+ */
+#define _NUM_TABLE_BYTE_ORDER 0x01020304
+
+
+/**
+ * @internal
+ * Number of values stored in the table: all the values in twelfths from 0 to
+ * NUMERUS_MAX_LONG_NONFLOAT_VALUE and 11/12.
+ */
+#define _NUM_TABLE_COUNT ((NUMERUS_MAX_LONG_NONFLOAT_VALUE + 1) * 12)
+
+
+/**
+ * @internal
+ * Number of slots of the hash index, a power of 2 with a load factor of 0.72.
+ */
+#define _NUM_TABLE_HASH_SLOTS (1UL << 26)
+
+
+/**
+ * @internal
+ * Header at the start of the table file.
+ */
+struct _num_table_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t count;
+    uint32_t hash_slots;
+    uint64_t offsets_start;
+    uint64_t hash_start;
+    uint64_t chars_start;
+    uint64_t file_size;
+};
+
+
+/**
+ * Table file mapped in memory, opened with numerus_open_table_file().
+ */
+struct numerus_table {
+    void *map;
+    size_t size;
+    const uint32_t *offsets;
+    const uint32_t *hash_slots;
+    const char *chars;
+    uint64_t chars_size;
+    uint32_t count;
+    uint32_t hash_mask;
+};
+
+
+/**
+ * @internal
+ * Finds the numeral of a value in the chars of the table, refusing the
+ * offsets pointing outside of them, as a corrupt file may contain any.
+ *
+ * @param *table mapped with numerus_open_table_file()
+ * @param value index of the numeral, less than the count of the table
+ * @param *offset where to store the offset of the numeral in the chars
+ * @returns long length of the numeral or -1 if its offsets are invalid.
+ */
+static long _num_table_numeral(const struct numerus_table *table,
+                               uint32_t value, uint32_t *offset) {
+    uint32_t start = table->offsets[value];
+    uint32_t end = table->offsets[value + 1];
+    if (start > end || end > table->chars_size
+        || end - start > NUMERUS_MAX_LENGTH - 2) {
+        return -1;
+    }
+    *offset = start;
+    return (long) (end - start);
+}
+
+
+/**
+ * @internal
+ * FNV-1a hash of a numeral.
+ *
+ * @param *roman chars of the numeral.
+ * @param length number of chars of the numeral.
+ * @returns uint32_t the hash of the numeral.
+ */
+static uint32_t _num_table_hash(const char *roman, size_t length) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (unsigned char) roman[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   WRITING THE TABLE   }-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Writes the table file with the numerals of all the values in the conversion
+ * range, to be used by numerus_open_table_file().
+ *
+ * It's the function behind the `numerus_mktable` tool. Takes a few seconds and
+ * about 500 MB of memory, for the offsets and the hash index.
+ *
+ * @param *path of the table file to write.
+ * @returns int NUMERUS_OK, NUMERUS_ERROR_MALLOC_FAIL or
+ * NUMERUS_ERROR_TABLE_FILE if the file can't be written. Also stored in
+ * numerus_error_code.
+ */
+int numerus_write_table_file(const char *path) {
+    struct _num_table_header header;
+    char roman[NUMERUS_MAX_LENGTH];
+    int errcode = NUMERUS_OK;
+    uint32_t *offsets = malloc((_NUM_TABLE_COUNT + 1) * sizeof(uint32_t));
+    uint32_t *hash_slots = calloc(_NUM_TABLE_HASH_SLOTS, sizeof(uint32_t));
+    FILE *file = fopen(path, "wb");
+    if (offsets == NULL || hash_slots == NULL) {
+        errcode = NUMERUS_ERROR_MALLOC_FAIL;
+    } else if (file == NULL) {
+        errcode = NUMERUS_ERROR_TABLE_FILE;
+    } else {
+        memcpy(header.magic, _NUM_TABLE_MAGIC, sizeof(header.magic));
+        header.version = _NUM_TABLE_VERSION;
+        header.byte_order = _NUM_TABLE_BYTE_ORDER;
+        header.count = _NUM_TABLE_COUNT;
+        header.hash_slots = _NUM_TABLE_HASH_SLOTS;
+        header.offsets_start = sizeof(header);
+        header.hash_start = header.offsets_start
+                            + (_NUM_TABLE_COUNT + 1) * sizeof(uint32_t);
+        header.chars_start = header.hash_start
+                             + _NUM_TABLE_HASH_SLOTS * sizeof(uint32_t);
+
+        /* Write the chars, filling the offsets and the index */
+        uint32_t offset = 0;
+        if (fseek(file, (long) header.chars_start, SEEK_SET) != 0) {
+            errcode = NUMERUS_ERROR_TABLE_FILE;
+        }
+        for (uint32_t value = 0;
+             value < _NUM_TABLE_COUNT && errcode == NUMERUS_OK; value++) {
+            short length = numerus_inline_int_with_twelfth_to_roman_into(
+                    value / 12, (short) (value % 12), roman, &errcode);
+            uint32_t slot = _num_table_hash(roman, (size_t) length)
+                            & (_NUM_TABLE_HASH_SLOTS - 1);
+            while (hash_slots[slot] != 0) {
+                slot = (slot + 1) & (_NUM_TABLE_HASH_SLOTS - 1);
+            }
+            hash_slots[slot] = value + 1;
+            offsets[value] = offset;
+            offset += (uint32_t) length;
+            if (fwrite(roman, 1, (size_t) length, file) != (size_t) length) {
+                errcode = NUMERUS_ERROR_TABLE_FILE;
+            }
+        }
+        offsets[_NUM_TABLE_COUNT] = offset;
+        header.file_size = header.chars_start + offset;
+
+        /* Then the header, the offsets and the index before the chars */
+        if (errcode == NUMERUS_OK
+            && (fseek(file, 0, SEEK_SET) != 0
+                || fwrite(&header, sizeof(header), 1, file) != 1
+                || fwrite(offsets, sizeof(uint32_t), _NUM_TABLE_COUNT + 1,
+                          file) != _NUM_TABLE_COUNT + 1
+                || fwrite(hash_slots, sizeof(uint32_t), _NUM_TABLE_HASH_SLOTS,
+                          file) != _NUM_TABLE_HASH_SLOTS)) {
+            errcode = NUMERUS_ERROR_TABLE_FILE;
+        }
+    }
+    if (file != NULL && fclose(file) != 0) {
+        errcode = NUMERUS_ERROR_TABLE_FILE;
+    }
+    free(offsets);
+    free(hash_slots);
+    numerus_error_code = errcode;
+    return errcode;
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-{   OPENING THE TABLE   }-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Maps a table file written by numerus_write_table_file() in memory,
+ * read-only and shared with the other processes mapping it.
+ *
+ * The conversions taking a table accept NULL too, so the result can be used
+ * as is even if the file is missing: they fall back to the computed
+ * conversions.
+ *
+ * The header must describe the layout written by numerus_write_table_file(),
+ * otherwise the file is refused. The offsets are not scanned here, as they
+ * are hundreds of MB: the lookups check the ones they use instead.
+ *
+ * @param *path of the table file.
+ * @param *errcode int where to store the status: NUMERUS_OK,
+ * NUMERUS_ERROR_TABLE_FILE or NUMERUS_ERROR_MALLOC_FAIL. Can be NULL to
+ * ignore the error.
+ * @returns struct numerus_table* the mapped table, to be closed with
+ * numerus_close_table_file(), or NULL when an error occurs.
+ */
+struct numerus_table *numerus_open_table_file(const char *path,
+                                              int *errcode) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    *errcode = NUMERUS_ERROR_TABLE_FILE;
+#if _NUM_TABLE_MMAP
+    struct stat file_status;
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        numerus_error_code = *errcode;
+        return NULL;
+    }
+    void *map = MAP_FAILED;
+    if (fstat(file, &file_status) == 0
+        && (size_t) file_status.st_size >= sizeof(struct _num_table_header)) {
+        map = mmap(NULL, (size_t) file_status.st_size, PROT_READ, MAP_SHARED,
+                   file, 0);
+    }
+    close(file);
+    if (map == MAP_FAILED) {
+        numerus_error_code = *errcode;
+        return NULL;
+    }
+
+    /* Check that the file is the one expected by this library */
+    const struct _num_table_header *header = map;
+    size_t size = (size_t) file_status.st_size;
+    if (memcmp(header->magic, _NUM_TABLE_MAGIC, sizeof(header->magic)) != 0
+        || header->version != _NUM_TABLE_VERSION
+        || header->byte_order != _NUM_TABLE_BYTE_ORDER
+        || header->count != _NUM_TABLE_COUNT
+        || header->hash_slots != _NUM_TABLE_HASH_SLOTS
+        || header->file_size != size
+        || header->offsets_start != sizeof(struct _num_table_header)
+        || header->hash_start != header->offsets_start
+                                 + ((uint64_t) header->count + 1)
+                                   * sizeof(uint32_t)
+        || header->chars_start != header->hash_start
+                                  + (uint64_t) header->hash_slots
+                                    * sizeof(uint32_t)
+        || header->chars_start > size) {
+        munmap(map, size);
+        numerus_error_code = *errcode;
+        return NULL;
+    }
+    struct numerus_table *table = malloc(sizeof(struct numerus_table));
+    if (table == NULL) {
+        munmap(map, size);
+        *errcode = NUMERUS_ERROR_MALLOC_FAIL;
+        numerus_error_code = *errcode;
+        return NULL;
+    }
+    table->map = map;
+    table->size = size;
+    table->offsets = (const uint32_t *) ((const char *) map
+                                         + header->offsets_start);
+    table->hash_slots = (const uint32_t *) ((const char *) map
+                                            + header->hash_start);
+    table->chars = (const char *) map + header->chars_start;
+    table->chars_size = size - header->chars_start;
+    table->count = header->count;
+    table->hash_mask = header->hash_slots - 1;
+    *errcode = NUMERUS_OK;
+    numerus_error_code = *errcode;
+    return table;
+#else
+    (void) path;
+    numerus_error_code = *errcode;
+    return NULL;
+#endif
+}
+
+
+/**
+ * Unmaps a table file mapped by numerus_open_table_file().
+ *
+ * @param *table the mapped table. Can be NULL.
+ */
+void numerus_close_table_file(struct numerus_table *table) {
+    if (table != NULL) {
+#if _NUM_TABLE_MMAP
+        munmap(table->map, table->size);
+#endif
+        free(table);
+    }
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-{   CONVERSIONS WITH TABLE   }-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * Converts an integer value and a number of twelfths to a roman numeral,
+ * written into a buffer provided by the caller, copying it from the table.
+ *
+ * Same parameters, results and error codes of
+ * numerus_int_with_twelfth_to_roman_into(): numerals whose offsets point
+ * outside the table are computed by it.
+ *
+ * @param *table mapped with numerus_open_table_file(). If NULL, the numeral
+ * is computed by numerus_int_with_twelfth_to_roman_into().
+ * @param int_part long integer part of a value to be added to the twelfths
+ * and converted to roman numeral.
+ * @param twelfths short integer as number of twelfths (1/12) to be added to the
+ * integer part and converted to roman numeral.
+ * @param *roman buffer of at least NUMERUS_MAX_LENGTH chars where to write the
+ * null-terminated roman numeral.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns short length of the written roman numeral, excluding '\0', or -1
+ * when an error occurs.
+ */
+short numerus_table_int_with_twelfth_to_roman_into(
+        const struct numerus_table *table, long int_part, short twelfths,
+        char *roman, int *errcode) {
+    if (table == NULL) {
+        return numerus_int_with_twelfth_to_roman_into(int_part, twelfths,
+                                                      roman, errcode);
+    }
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    numerus_inline_shorten_and_same_sign_to_parts(&int_part, &twelfths);
+    if (int_part > NUMERUS_MAX_LONG_NONFLOAT_VALUE
+        || int_part < NUMERUS_MIN_LONG_NONFLOAT_VALUE) {
+        *roman = '\0';
+        *errcode = NUMERUS_ERROR_VALUE_OUT_OF_RANGE;
+        numerus_error_code = *errcode;
+        return -1;
+    }
+    char *roman_numeral = roman;
+    if (int_part < 0 || twelfths < 0) {
+        *(roman_numeral++) = '-';
+    }
+    uint32_t value = (uint32_t) (ABS(int_part) * 12 + ABS(twelfths));
+    uint32_t offset;
+    long length = _num_table_numeral(table, value, &offset);
+    if (length < 0) {
+        return numerus_int_with_twelfth_to_roman_into(int_part, twelfths,
+                                                      roman, errcode);
+    }
+    memcpy(roman_numeral, table->chars + offset, (size_t) length);
+    roman_numeral[length] = '\0';
+    *errcode = NUMERUS_OK;
+    numerus_error_code = *errcode;
+    return (short) (roman_numeral + length - roman);
+}
+
+
+/**
+ * Converts a roman numeral to its value expressed as pair of its integer part
+ * and number of twelfths, looking it up in the hash index of the table.
+ *
+ * Same parameters, results and error codes of
+ * numerus_roman_to_int_part_and_twelfths(): numerals not in the table are
+ * parsed by it.
+ *
+ * @param *table mapped with numerus_open_table_file(). If NULL, the numeral
+ * is parsed by numerus_roman_to_int_part_and_twelfths().
+ * @param *roman string with a roman numeral
+ * @param *twelfths number of twelfths from 0 to 11. NULL is interpreted as 0
+ * twelfths.
+ * @param *errcode int where to store the conversion status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns long as the integer part of the value of the roman numeral or a
+ * value outside the the possible range of values when an error occurs.
+ */
+long numerus_table_roman_to_int_part_and_twelfths(
+        const struct numerus_table *table, char *roman, short *twelfths,
+        int *errcode) {
+    if (table == NULL || roman == NULL) {
+        return numerus_roman_to_int_part_and_twelfths(roman, twelfths,
+                                                      errcode);
+    }
+    const char *key = roman;
+    long sign = 1;
+    if (*key == '-') {
+        key++;
+        sign = -1;
+    }
+    size_t length = strlen(key);
+    uint32_t slot = _num_table_hash(key, length) & table->hash_mask;
+    for (uint32_t probes = 0;
+         probes <= table->hash_mask && table->hash_slots[slot] != 0;
+         probes++) {
+        uint32_t value = table->hash_slots[slot] - 1;
+        uint32_t offset;
+        if (value >= table->count) {
+            /* Corrupt slot: let the parser convert the numeral */
+            break;
+        }
+        if (_num_table_numeral(table, value, &offset) == (long) length
+            && memcmp(table->chars + offset, key, length) == 0) {
+            if (value == 0 && sign < 0) {
+                /* NUMERUS_ZERO has no minus */
+                break;
+            }
+            if (errcode == NULL) {
+                errcode = &numerus_error_code;
+            }
+            if (twelfths != NULL) {
+                *twelfths = (short) (sign * (long) (value % 12));
+            }
+            *errcode = NUMERUS_OK;
+            numerus_error_code = *errcode;
+            return sign * (long) (value / 12);
+        }
+        slot = (slot + 1) & table->hash_mask;
+    }
+    return numerus_roman_to_int_part_and_twelfths(roman, twelfths, errcode);
+}
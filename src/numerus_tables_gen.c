@@ -0,0 +1,881 @@
+/**
+ * @file numerus_tables_gen.c
+ * @brief Numerus generator of the lookup tables of the conversions.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Program run by the build to write the header `numerus_tables.h` with the
+ * lookup tables used by the table-based conversions, as `static const`
+ * arrays, so nothing is built when the program starts.
+ *
+ * The tables are built from _NUM_DICTIONARY with the greedy walk of the
+ * reference encoder _num_value_part_to_roman() of numerus_core.c, linked
+ * with this program built with NUMERUS_TABLES_BOOTSTRAP, which leaves out
+ * the few functions using the tables. Before writing them, every value the
+ * tables can produce is checked to round-trip: the numeral built by the
+ * tables must be the one of the reference encoder and must be parsed back
+ * to its value by numerus_roman_to_int_part_and_twelfths(). Any mismatch
+ * fails the build.
+ *
+ * With `--small` the tables are written in a size-optimised form for small
+ * targets: instead of one string per digit, the chars for one, five and ten
+ * units of each decade and the digit patterns packed as 2-bit symbols, one
+ * byte per digit, and the twelfths built from the "S" and "." chars. Both
+ * forms provide the same _num_append_short_digit() and
+ * _num_append_twelfths() helpers to the conversions and are checked the same
+ * way.
+ *
+ * The header also has the minimal automaton of the numerals used by the
+ * completions of numerus_complete.c: the trie of the numerals of each part,
+ * built from the same walk, is reduced merging the equivalent states and
+ * checked to accept exactly the numerals of the language with their values.
+ *
+ * Usage: `numerus_tables_gen [--small] path/to/numerus_tables.h`
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "numerus_internal.h"
+#include "numerus_dictionary.h"
+
+
+/**
+ * Index of the "S" char in _NUM_DICTIONARY, the first one of the twelfths.
+ */
+#define _NUM_GEN_FIRST_TWELFTH_CHAR 13
+
+
+/**
+ * Max length of the numeral of a table entry, including '\0'.
+ */
+#define _NUM_GEN_MAX_ENTRY_LENGTH 16
+
+
+/**
+ * Roman numeral of each digit of the thousands, hundreds, tens and units of
+ * a value, filled by the generator.
+ */
+static char _num_gen_digits[4][10][_NUM_GEN_MAX_ENTRY_LENGTH];
+
+
+/**
+ * Roman numeral of each number of twelfths, filled by the generator.
+ */
+static char _num_gen_twelfths[12][_NUM_GEN_MAX_ENTRY_LENGTH];
+
+
+/**
+ * Chars for nothing, one, five and ten units of each decade, derived from the
+ * digits of the tables: the 2-bit symbols of the packed patterns index them.
+ */
+static char _num_gen_decade_chars[4][4];
+
+
+/**
+ * Sequence of the 2-bit symbols of each digit, first symbol in the lowest
+ * bits, 0 as terminator.
+ */
+static unsigned char _num_gen_digit_patterns[10];
+
+
+/**
+ * Reference encoder: the greedy walk on _NUM_DICTIONARY of
+ * _num_value_part_to_roman() in numerus_core.c, null-terminated.
+ *
+ * @param value to convert, not negative.
+ * @param *roman where to write the null-terminated numeral.
+ * @param dictionary_start_char index of the first dictionary entry to use.
+ */
+static void _num_gen_walk_dictionary(long value, char *roman,
+                                     int dictionary_start_char) {
+    *_num_value_part_to_roman(value, roman, dictionary_start_char) = '\0';
+}
+
+
+/**
+ * Builds the tables from the dictionary.
+ */
+static void _num_gen_build_tables(void) {
+    long decade_value = 1000;
+    for (int decade = 0; decade < 4; decade++) {
+        for (int digit = 0; digit < 10; digit++) {
+            /* No thousands above MMM: their entries stay empty */
+            if (decade > 0 || digit <= 3) {
+                _num_gen_walk_dictionary(digit * decade_value,
+                                         _num_gen_digits[decade][digit], 0);
+            }
+        }
+        decade_value /= 10;
+    }
+    for (int twelfths = 0; twelfths < 12; twelfths++) {
+        _num_gen_walk_dictionary(twelfths, _num_gen_twelfths[twelfths],
+                                 _NUM_GEN_FIRST_TWELFTH_CHAR);
+    }
+}
+
+
+/**
+ * Checks that every value within [0, 3999] and every number of twelfths
+ * round-trip through the tables and the parser of the library.
+ *
+ * @returns 0 on success or outputs the first mismatch on stderr and
+ * returns 1.
+ */
+static int _num_gen_check_tables(void) {
+    char from_tables[4 * _NUM_GEN_MAX_ENTRY_LENGTH];
+    char reference[4 * _NUM_GEN_MAX_ENTRY_LENGTH];
+    short twelfths;
+    int errcode;
+    for (long value = 0; value <= 3999; value++) {
+        long divisor = 1000;
+        from_tables[0] = '\0';
+        for (int decade = 0; decade < 4; decade++) {
+            strcat(from_tables, _num_gen_digits[decade][value / divisor % 10]);
+            divisor /= 10;
+        }
+        _num_gen_walk_dictionary(value, reference, 0);
+        /* Zero has no numeral in the tables: NUMERUS_ZERO is written */
+        if (strcmp(from_tables, reference) != 0
+            || (value > 0
+                && (numerus_roman_to_int_part_and_twelfths(
+                        from_tables, &twelfths, &errcode) != value
+                    || errcode != NUMERUS_OK || twelfths != 0))) {
+            fprintf(stderr, "Table numeral of %ld does not round-trip: %s\n",
+                    value, from_tables);
+            return 1;
+        }
+    }
+    for (int number = 1; number < 12; number++) {
+        if (numerus_roman_to_int_part_and_twelfths(
+                _num_gen_twelfths[number], &twelfths, &errcode) != 0
+            || errcode != NUMERUS_OK || twelfths != number) {
+            fprintf(stderr, "Table numeral of %d/12 does not round-trip: %s\n",
+                    number, _num_gen_twelfths[number]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Derives the chars of each decade and the packed patterns of the digits from
+ * the digits built by _num_gen_build_tables().
+ *
+ * @returns 0 on success or outputs the first digit which doesn't fit the
+ * packed form on stderr and returns 1.
+ */
+static int _num_gen_build_small_tables(void) {
+    for (int decade = 0; decade < 4; decade++) {
+        _num_gen_decade_chars[decade][1] = _num_gen_digits[decade][1][0];
+        _num_gen_decade_chars[decade][2] = _num_gen_digits[decade][5][0];
+        _num_gen_decade_chars[decade][3] = _num_gen_digits[decade][9][0] == '\0'
+                                           ? '\0' : _num_gen_digits[decade][9][1];
+    }
+    /* The units have every digit: their chars give the patterns */
+    for (int digit = 0; digit < 10; digit++) {
+        const char *numeral = _num_gen_digits[3][digit];
+        unsigned char pattern = 0;
+        if (strlen(numeral) > 4) {
+            fprintf(stderr, "Digit %d does not fit 4 symbols: %s\n",
+                    digit, numeral);
+            return 1;
+        }
+        for (int i = 0; numeral[i] != '\0'; i++) {
+            unsigned char symbol = 1;
+            while (symbol < 4 && _num_gen_decade_chars[3][symbol] != numeral[i]) {
+                symbol++;
+            }
+            if (symbol == 4) {
+                fprintf(stderr, "Digit %d uses an unknown char: %s\n",
+                        digit, numeral);
+                return 1;
+            }
+            pattern |= (unsigned char) (symbol << (2 * i));
+        }
+        _num_gen_digit_patterns[digit] = pattern;
+    }
+    return 0;
+}
+
+
+/**
+ * Checks that the packed patterns expand to the digits of every decade and
+ * that "S" and dots build the twelfths, as the helpers of the small tables do.
+ *
+ * @returns 0 on success or outputs the first mismatch on stderr and
+ * returns 1.
+ */
+static int _num_gen_check_small_tables(void) {
+    char expanded[_NUM_GEN_MAX_ENTRY_LENGTH];
+    for (int decade = 0; decade < 4; decade++) {
+        for (int digit = 0; digit < (decade == 0 ? 4 : 10); digit++) {
+            char *position = expanded;
+            for (unsigned pattern = _num_gen_digit_patterns[digit];
+                 pattern != 0; pattern >>= 2) {
+                *(position++) = _num_gen_decade_chars[decade][pattern & 3];
+            }
+            *position = '\0';
+            if (strcmp(expanded, _num_gen_digits[decade][digit]) != 0) {
+                fprintf(stderr, "Packed digit %d of decade %d expands to %s "
+                        "instead of %s\n", digit, decade, expanded,
+                        _num_gen_digits[decade][digit]);
+                return 1;
+            }
+        }
+    }
+    for (int twelfths = 0; twelfths < 12; twelfths++) {
+        char *position = expanded;
+        if (twelfths >= _NUM_DICTIONARY[_NUM_GEN_FIRST_TWELFTH_CHAR].value) {
+            *(position++) = _NUM_DICTIONARY[_NUM_GEN_FIRST_TWELFTH_CHAR]
+                    .characters[0];
+        }
+        for (int dots = 0; dots < twelfths % 6; dots++) {
+            *(position++) = _NUM_DICTIONARY[_NUM_GEN_FIRST_TWELFTH_CHAR + 1]
+                    .characters[0];
+        }
+        *position = '\0';
+        if (strcmp(expanded, _num_gen_twelfths[twelfths]) != 0) {
+            fprintf(stderr, "Twelfths %d expand to %s instead of %s\n",
+                    twelfths, expanded, _num_gen_twelfths[twelfths]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Writes the tables as C arrays of strings, one per digit.
+ */
+static void _num_gen_write_tables(FILE *header) {
+    fprintf(header,
+            "/**\n"
+            " * Roman numeral of each digit of the thousands, hundreds, tens "
+            "and units of\n"
+            " * a value, as the greedy walk on _NUM_DICTIONARY from \"M\" "
+            "would build it.\n"
+            " */\n"
+            "static const char *const _NUM_SHORT_DIGITS[4][10] = {\n");
+    for (int decade = 0; decade < 4; decade++) {
+        fprintf(header, "    {");
+        for (int digit = 0; digit < 10; digit++) {
+            fprintf(header, "%s\"%s\"", digit == 0 ? "" : ", ",
+                    _num_gen_digits[decade][digit]);
+        }
+        fprintf(header, "}%s\n", decade < 3 ? "," : "");
+    }
+    fprintf(header,
+            "};\n\n\n"
+            "/**\n"
+            " * Roman numeral of each number of twelfths, as the greedy walk "
+            "on\n"
+            " * _NUM_DICTIONARY from \"S\" would build it.\n"
+            " */\n"
+            "static const char *const _NUM_TWELFTHS[12] = {\n");
+    for (int twelfths = 0; twelfths < 12; twelfths++) {
+        fprintf(header, "%s\"%s\"", twelfths % 6 == 0 ? "    " : ", ",
+                _num_gen_twelfths[twelfths]);
+        fprintf(header, "%s", twelfths == 5 ? ",\n" : "");
+    }
+    fprintf(header,
+            "\n};\n\n\n"
+            "/**\n"
+            " * Appends the numeral of a digit of the given decade: 0 for the "
+            "thousands,\n"
+            " * 3 for the units.\n"
+            " *\n"
+            " * @returns position after the written chars.\n"
+            " */\n"
+            "static inline char *_num_append_short_digit(char *roman, "
+            "int decade,\n"
+            "                                            int digit) {\n"
+            "    const char *chars = _NUM_SHORT_DIGITS[decade][digit];\n"
+            "    while (*chars != '\\0') {\n"
+            "        *(roman++) = *(chars++);\n"
+            "    }\n"
+            "    return roman;\n"
+            "}\n\n\n"
+            "/**\n"
+            " * Appends the numeral of a number of twelfths within [0, 11].\n"
+            " *\n"
+            " * @returns position after the written chars.\n"
+            " */\n"
+            "static inline char *_num_append_twelfths(char *roman, "
+            "int twelfths) {\n"
+            "    const char *chars = _NUM_TWELFTHS[twelfths];\n"
+            "    while (*chars != '\\0') {\n"
+            "        *(roman++) = *(chars++);\n"
+            "    }\n"
+            "    return roman;\n"
+            "}\n");
+}
+
+
+/**
+ * Writes the size-optimised tables: chars per decade and packed patterns.
+ */
+static void _num_gen_write_small_tables(FILE *header) {
+    fprintf(header,
+            "/**\n"
+            " * Chars for nothing, one, five and ten units of the thousands, "
+            "hundreds,\n"
+            " * tens and units, indexed by the symbols of "
+            "_NUM_DIGIT_PATTERNS.\n"
+            " */\n"
+            "static const char _NUM_DECADE_CHARS[4][4] = {\n");
+    for (int decade = 0; decade < 4; decade++) {
+        fprintf(header, "    {");
+        for (int symbol = 0; symbol < 4; symbol++) {
+            if (_num_gen_decade_chars[decade][symbol] == '\0') {
+                fprintf(header, "%s'\\0'", symbol == 0 ? "" : ", ");
+            } else {
+                fprintf(header, "%s'%c'", symbol == 0 ? "" : ", ",
+                        _num_gen_decade_chars[decade][symbol]);
+            }
+        }
+        fprintf(header, "}%s\n", decade < 3 ? "," : "");
+    }
+    fprintf(header,
+            "};\n\n\n"
+            "/**\n"
+            " * Symbols of the numeral of each digit, 2 bits each starting "
+            "from the lowest\n"
+            " * ones, 0 as terminator.\n"
+            " */\n"
+            "static const unsigned char _NUM_DIGIT_PATTERNS[10] = {\n    ");
+    for (int digit = 0; digit < 10; digit++) {
+        fprintf(header, "%s0x%02X", digit == 0 ? "" : ", ",
+                _num_gen_digit_patterns[digit]);
+    }
+    fprintf(header,
+            "\n};\n\n\n"
+            "/**\n"
+            " * Appends the numeral of a digit of the given decade: 0 for the "
+            "thousands,\n"
+            " * 3 for the units.\n"
+            " *\n"
+            " * @returns position after the written chars.\n"
+            " */\n"
+            "static inline char *_num_append_short_digit(char *roman, "
+            "int decade,\n"
+            "                                            int digit) {\n"
+            "    for (unsigned pattern = _NUM_DIGIT_PATTERNS[digit];\n"
+            "         pattern != 0; pattern >>= 2) {\n"
+            "        *(roman++) = _NUM_DECADE_CHARS[decade][pattern & 3];\n"
+            "    }\n"
+            "    return roman;\n"
+            "}\n\n\n"
+            "/**\n"
+            " * Appends the numeral of a number of twelfths within [0, 11].\n"
+            " *\n"
+            " * @returns position after the written chars.\n"
+            " */\n"
+            "static inline char *_num_append_twelfths(char *roman, "
+            "int twelfths) {\n"
+            "    if (twelfths >= %d) {\n"
+            "        *(roman++) = '%c';\n"
+            "    }\n"
+            "    for (twelfths %%= %d; twelfths > 0; twelfths--) {\n"
+            "        *(roman++) = '%c';\n"
+            "    }\n"
+            "    return roman;\n"
+            "}\n",
+            _NUM_DICTIONARY[_NUM_GEN_FIRST_TWELFTH_CHAR].value,
+            _NUM_DICTIONARY[_NUM_GEN_FIRST_TWELFTH_CHAR].characters[0],
+            _NUM_DICTIONARY[_NUM_GEN_FIRST_TWELFTH_CHAR].value,
+            _NUM_DICTIONARY[_NUM_GEN_FIRST_TWELFTH_CHAR + 1].characters[0]);
+}
+
+
+/**
+ * Writes the numerals of the components of dates and times, interned for
+ * numerus_format_date(), in both forms of the tables.
+ */
+static void _num_gen_write_date_components(FILE *header) {
+    char numeral[_NUM_GEN_MAX_ENTRY_LENGTH];
+    fprintf(header,
+            "\n\n/**\n"
+            " * Roman numeral of each value of the components of dates and "
+            "times, from 0\n"
+            " * (empty: NUMERUS_ZERO is written instead) to 60, for leap "
+            "seconds.\n"
+            " */\n"
+            "static const char *const _NUM_DATE_COMPONENTS[61] = {\n");
+    for (int value = 0; value <= 60; value++) {
+        _num_gen_walk_dictionary(value, numeral, 0);
+        fprintf(header, "%s\"%s\"%s", value % 8 == 0 ? "    " : " ", numeral,
+                value == 60 ? "\n" : value % 8 == 7 ? ",\n" : ",");
+    }
+    fprintf(header,
+            "};\n\n\n"
+            "/**\n"
+            " * Length of each numeral of _NUM_DATE_COMPONENTS.\n"
+            " */\n"
+            "static const unsigned char _NUM_DATE_COMPONENT_LENGTHS[61] = "
+            "{\n");
+    for (int value = 0; value <= 60; value++) {
+        _num_gen_walk_dictionary(value, numeral, 0);
+        fprintf(header, "%s%zu%s", value % 16 == 0 ? "    " : " ",
+                strlen(numeral),
+                value == 60 ? "\n" : value % 16 == 15 ? ",\n" : ",");
+    }
+    fprintf(header, "};\n");
+}
+
+
+/**
+ * Max number of states of the automaton of the numerals before and after
+ * the minimisation, and max number of edges of one state.
+ */
+#define _NUM_GEN_MAX_STATES 40000
+#define _NUM_GEN_MAX_STATE_EDGES 16
+
+
+/**
+ * State of the automaton of the numerals: a trie while it's built, a state
+ * of the minimal automaton after _num_gen_minimise_automaton().
+ *
+ * The value of a prefix is the sum of the weights of its edges, in twelfths.
+ */
+struct _num_gen_state {
+    int accepting;
+    long value;
+    int edge_count;
+    char chars[_NUM_GEN_MAX_STATE_EDGES];
+    int targets[_NUM_GEN_MAX_STATE_EDGES];
+    long weights[_NUM_GEN_MAX_STATE_EDGES];
+    /* Index of the equivalent state of the minimal automaton, -1 if unknown */
+    int minimal;
+};
+
+static struct _num_gen_state _num_gen_states[_NUM_GEN_MAX_STATES];
+static int _num_gen_state_count = 0;
+static struct _num_gen_state _num_gen_minimal[_NUM_GEN_MAX_STATES];
+static int _num_gen_minimal_count = 0;
+static long _num_gen_minimal_min[_NUM_GEN_MAX_STATES];
+static long _num_gen_minimal_max[_NUM_GEN_MAX_STATES];
+
+
+/**
+ * Creates a state of the trie with no edges.
+ *
+ * @returns int index of the new state.
+ */
+static int _num_gen_new_state(int accepting, long value) {
+    struct _num_gen_state *state = &_num_gen_states[_num_gen_state_count];
+    state->accepting = accepting;
+    state->value = value;
+    state->edge_count = 0;
+    state->minimal = -1;
+    return _num_gen_state_count++;
+}
+
+
+/**
+ * Adds an edge to a state of the trie.
+ *
+ * @returns 0 on success or outputs the conflict on stderr and returns 1 if
+ * the state already has an edge with that char: the automaton wouldn't be
+ * deterministic.
+ */
+static int _num_gen_add_edge(int from, char c, int to, long weight) {
+    struct _num_gen_state *state = &_num_gen_states[from];
+    for (int i = 0; i < state->edge_count; i++) {
+        if (state->chars[i] == c) {
+            fprintf(stderr, "Two edges with char %c from one state\n", c);
+            return 1;
+        }
+    }
+    state->chars[state->edge_count] = c;
+    state->targets[state->edge_count] = to;
+    state->weights[state->edge_count] = weight;
+    state->edge_count++;
+    return 0;
+}
+
+
+/**
+ * Inserts a numeral into the trie starting from the given root.
+ *
+ * The numerals are inserted in ascending order of value: every prefix of a
+ * numeral is a numeral of a smaller value, so its state already exists and
+ * the weight of the only new edge is the difference of the values.
+ *
+ * @returns int index of the state of the numeral or -1 if a prefix is missing.
+ */
+static int _num_gen_insert(int root, const char *roman, long value,
+                           int accepting) {
+    int state = root;
+    for (; *roman != '\0'; roman++) {
+        int next = -1;
+        for (int i = 0; i < _num_gen_states[state].edge_count; i++) {
+            if (_num_gen_states[state].chars[i] == *roman) {
+                next = _num_gen_states[state].targets[i];
+            }
+        }
+        if (next < 0) {
+            if (roman[1] != '\0') {
+                fprintf(stderr, "Missing prefix of numeral of %ld\n", value);
+                return -1;
+            }
+            next = _num_gen_new_state(accepting, value);
+            _num_gen_add_edge(state, *roman, next,
+                              value - _num_gen_states[state].value);
+        }
+        state = next;
+    }
+    return state;
+}
+
+
+/**
+ * Copies the edges of one state to another one, as if the language of the
+ * first one followed each numeral of the second.
+ *
+ * @returns 0 on success or 1 on conflicting chars.
+ */
+static int _num_gen_copy_edges(int from, int to) {
+    for (int i = 0; i < _num_gen_states[from].edge_count; i++) {
+        if (_num_gen_add_edge(to, _num_gen_states[from].chars[i],
+                              _num_gen_states[from].targets[i],
+                              _num_gen_states[from].weights[i]) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Builds the trie of the numerals without sign, zero excluded: short
+ * numerals, long numerals and the twelfths after both or alone.
+ *
+ * @returns int index of the root or -1 on error.
+ */
+static int _num_gen_build_automaton(void) {
+    char numeral[4 * _NUM_GEN_MAX_ENTRY_LENGTH];
+    int twelfths_root = _num_gen_new_state(0, 0);
+    int low_root = _num_gen_new_state(1, 0);
+    int long_root = _num_gen_new_state(0, 0);
+    int root = _num_gen_new_state(0, 0);
+    int error = 0;
+    for (int twelfths = 1; twelfths < 12 && !error; twelfths++) {
+        error = _num_gen_insert(twelfths_root, _num_gen_twelfths[twelfths],
+                                twelfths, 1) < 0;
+    }
+    /* After the underscores: 0-999 and the twelfths */
+    int low_first = _num_gen_state_count;
+    for (long value = 1; value <= 999 && !error; value++) {
+        _num_gen_walk_dictionary(value, numeral, 0);
+        error = _num_gen_insert(low_root, numeral, value * 12, 1) < 0;
+    }
+    int low_last = _num_gen_state_count;
+    error |= _num_gen_copy_edges(twelfths_root, low_root);
+    for (int state = low_first; state < low_last && !error; state++) {
+        error = _num_gen_copy_edges(twelfths_root, state);
+    }
+    /* Between the underscores: 4-3999, the prefixes I-III not accepting */
+    for (long value = 1; value <= 3999 && !error; value++) {
+        _num_gen_walk_dictionary(value, numeral, 0);
+        int state = _num_gen_insert(long_root, numeral, value * 12000, 0);
+        error = state < 0
+                || (value >= 4
+                    && _num_gen_add_edge(state, '_', low_root, 0) != 0);
+    }
+    /* Short numerals 1-3999, each optionally followed by twelfths */
+    for (long value = 1; value <= 3999 && !error; value++) {
+        _num_gen_walk_dictionary(value, numeral, 0);
+        int state = _num_gen_insert(root, numeral, value * 12, 1);
+        error = state < 0 || _num_gen_copy_edges(twelfths_root, state) != 0;
+    }
+    if (error
+        || _num_gen_copy_edges(twelfths_root, root) != 0
+        || _num_gen_add_edge(root, '_', long_root, 0) != 0) {
+        return -1;
+    }
+    return root;
+}
+
+
+/**
+ * Finds or adds the state of the minimal automaton equivalent to a state of
+ * the trie, after the ones of all its targets: two states are equivalent if
+ * they are both accepting or not and have the same edges, with the same
+ * weights, to equivalent states.
+ *
+ * @returns int index of the state in the minimal automaton or -1 if no
+ * numeral goes through the state.
+ */
+static int _num_gen_minimise_state(int index) {
+    struct _num_gen_state *state = &_num_gen_states[index];
+    if (state->minimal >= 0) {
+        return state->minimal;
+    }
+    struct _num_gen_state minimal;
+    minimal.accepting = state->accepting;
+    minimal.value = 0;
+    minimal.edge_count = 0;
+    minimal.minimal = -1;
+    /* Edges sorted by char, so equivalent states have the same edges */
+    for (char c = 1; c > 0; c++) {
+        for (int i = 0; i < state->edge_count; i++) {
+            int target = state->chars[i] == c
+                         ? _num_gen_minimise_state(state->targets[i]) : -1;
+            if (target >= 0) {
+                minimal.chars[minimal.edge_count] = c;
+                minimal.targets[minimal.edge_count] = target;
+                minimal.weights[minimal.edge_count] = state->weights[i];
+                minimal.edge_count++;
+            }
+        }
+    }
+    if (!minimal.accepting && minimal.edge_count == 0) {
+        /* Dead end, like "_III" of the long numerals: no state at all */
+        return -1;
+    }
+    for (int i = 0; i < _num_gen_minimal_count; i++) {
+        struct _num_gen_state *other = &_num_gen_minimal[i];
+        if (other->accepting == minimal.accepting
+            && other->edge_count == minimal.edge_count
+            && memcmp(other->chars, minimal.chars, (size_t) minimal.edge_count)
+               == 0
+            && memcmp(other->targets, minimal.targets,
+                      minimal.edge_count * sizeof(int)) == 0
+            && memcmp(other->weights, minimal.weights,
+                      minimal.edge_count * sizeof(long)) == 0) {
+            state->minimal = i;
+            return i;
+        }
+    }
+    /* Min and max value of the rest of the numerals from the new state */
+    long min_value = minimal.accepting ? 0 : -1;
+    long max_value = 0;
+    for (int i = 0; i < minimal.edge_count; i++) {
+        long edge_min = minimal.weights[i]
+                        + _num_gen_minimal_min[minimal.targets[i]];
+        long edge_max = minimal.weights[i]
+                        + _num_gen_minimal_max[minimal.targets[i]];
+        if (min_value < 0 || edge_min < min_value) {
+            min_value = edge_min;
+        }
+        if (edge_max > max_value) {
+            max_value = edge_max;
+        }
+    }
+    _num_gen_minimal_min[_num_gen_minimal_count] = min_value;
+    _num_gen_minimal_max[_num_gen_minimal_count] = max_value;
+    _num_gen_minimal[_num_gen_minimal_count] = minimal;
+    state->minimal = _num_gen_minimal_count;
+    return _num_gen_minimal_count++;
+}
+
+
+/**
+ * Follows a numeral on the minimal automaton from its root.
+ *
+ * @returns long sum of the weights of the numeral or -1 if the numeral is
+ * not accepted.
+ */
+static long _num_gen_run_automaton(int root, const char *roman) {
+    int state = root;
+    long value = 0;
+    for (; *roman != '\0' && state >= 0; roman++) {
+        int next = -1;
+        for (int i = 0; i < _num_gen_minimal[state].edge_count; i++) {
+            if (_num_gen_minimal[state].chars[i] == *roman) {
+                next = _num_gen_minimal[state].targets[i];
+                value += _num_gen_minimal[state].weights[i];
+            }
+        }
+        state = next;
+    }
+    return state >= 0 && _num_gen_minimal[state].accepting ? value : -1;
+}
+
+
+/**
+ * Checks that the minimal automaton accepts the numerals of a sample of
+ * values with their twelfths, with the sum of the weights equal to the value,
+ * and that it accepts exactly as many numerals as the language has.
+ *
+ * @returns 0 on success or outputs the first mismatch on stderr and
+ * returns 1.
+ */
+static int _num_gen_check_automaton(int root) {
+    char numeral[4 * _NUM_GEN_MAX_ENTRY_LENGTH];
+    for (long value = 0; value <= 3999999; value += value < 3999 ? 1 : 997) {
+        for (int twelfths = value == 0; twelfths < 12; twelfths++) {
+            if (value <= 3999) {
+                _num_gen_walk_dictionary(value, numeral, 0);
+            } else {
+                numeral[0] = '_';
+                _num_gen_walk_dictionary(value / 1000, numeral + 1, 0);
+                strcat(numeral, "_");
+                _num_gen_walk_dictionary(value % 1000,
+                                         numeral + strlen(numeral), 0);
+            }
+            strcat(numeral, _num_gen_twelfths[twelfths]);
+            if (_num_gen_run_automaton(root, numeral)
+                != value * 12 + twelfths) {
+                fprintf(stderr, "Automaton doesn't accept %s as %ld/12\n",
+                        numeral, value * 12 + twelfths);
+                return 1;
+            }
+        }
+    }
+    /* Numerals from each state, from the last one: targets come first */
+    static double numerals[_NUM_GEN_MAX_STATES];
+    for (int state = 0; state < _num_gen_minimal_count; state++) {
+        numerals[state] = _num_gen_minimal[state].accepting;
+        for (int i = 0; i < _num_gen_minimal[state].edge_count; i++) {
+            numerals[state] += numerals[_num_gen_minimal[state].targets[i]];
+        }
+    }
+    if (numerals[root] != 3999999.0 * 12 + 11) {
+        fprintf(stderr, "Automaton accepts %.0f numerals\n", numerals[root]);
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * Writes the minimal automaton of the numerals, root first, as arrays of
+ * states and of edges.
+ */
+static void _num_gen_write_automaton(FILE *header, int root) {
+    int order[_NUM_GEN_MAX_STATES];
+    int renumbered[_NUM_GEN_MAX_STATES];
+    int edge_count = 0;
+    /* Root first, then the other states in reverse order of creation */
+    order[0] = root;
+    for (int state = _num_gen_minimal_count - 1, i = 1; state >= 0; state--) {
+        if (state != root) {
+            order[i++] = state;
+        }
+    }
+    for (int i = 0; i < _num_gen_minimal_count; i++) {
+        renumbered[order[i]] = i;
+    }
+    fprintf(header,
+            "\n\n/**\n"
+            " * Minimal automaton of the numerals without sign, zero "
+            "excluded: %d states,\n"
+            " * root first. The edges of state s are the ones from\n"
+            " * _NUM_DAWG_FIRST_EDGES[s] to _NUM_DAWG_FIRST_EDGES[s + 1]. The "
+            "value of a\n"
+            " * numeral, in twelfths, is the sum of the weights of its "
+            "edges. Each state\n"
+            " * has the min and max value of the rest of the numerals from "
+            "it.\n"
+            " */\n"
+            "#define _NUM_DAWG_STATES %d\n\n"
+            "static const unsigned short _NUM_DAWG_FIRST_EDGES[%d] = {",
+            _num_gen_minimal_count, _num_gen_minimal_count,
+            _num_gen_minimal_count + 1);
+    for (int i = 0; i <= _num_gen_minimal_count; i++) {
+        fprintf(header, "%s%d%s", i % 12 == 0 ? "\n    " : " ", edge_count,
+                i == _num_gen_minimal_count ? "\n" : ",");
+        if (i < _num_gen_minimal_count) {
+            edge_count += _num_gen_minimal[order[i]].edge_count;
+        }
+    }
+    fprintf(header, "};\n\nstatic const unsigned char _NUM_DAWG_ACCEPTING[%d]"
+            " = {", _num_gen_minimal_count);
+    for (int i = 0; i < _num_gen_minimal_count; i++) {
+        fprintf(header, "%s%d%s", i % 24 == 0 ? "\n    " : " ",
+                _num_gen_minimal[order[i]].accepting,
+                i == _num_gen_minimal_count - 1 ? "\n" : ",");
+    }
+    fprintf(header, "};\n\nstatic const long _NUM_DAWG_MIN_VALUES[%d] = {",
+            _num_gen_minimal_count);
+    for (int i = 0; i < _num_gen_minimal_count; i++) {
+        fprintf(header, "%s%ld%s", i % 8 == 0 ? "\n    " : " ",
+                _num_gen_minimal_min[order[i]],
+                i == _num_gen_minimal_count - 1 ? "\n" : ",");
+    }
+    fprintf(header, "};\n\nstatic const long _NUM_DAWG_MAX_VALUES[%d] = {",
+            _num_gen_minimal_count);
+    for (int i = 0; i < _num_gen_minimal_count; i++) {
+        fprintf(header, "%s%ld%s", i % 8 == 0 ? "\n    " : " ",
+                _num_gen_minimal_max[order[i]],
+                i == _num_gen_minimal_count - 1 ? "\n" : ",");
+    }
+    fprintf(header, "};\n\nstatic const char _NUM_DAWG_EDGE_CHARS[%d] = {",
+            edge_count);
+    for (int i = 0, edge = 0; i < _num_gen_minimal_count; i++) {
+        for (int j = 0; j < _num_gen_minimal[order[i]].edge_count; j++) {
+            fprintf(header, "%s'%c'%s", edge % 16 == 0 ? "\n    " : " ",
+                    _num_gen_minimal[order[i]].chars[j],
+                    edge + 1 == edge_count ? "\n" : ",");
+            edge++;
+        }
+    }
+    fprintf(header, "};\n\nstatic const unsigned short "
+            "_NUM_DAWG_EDGE_TARGETS[%d] = {", edge_count);
+    for (int i = 0, edge = 0; i < _num_gen_minimal_count; i++) {
+        for (int j = 0; j < _num_gen_minimal[order[i]].edge_count; j++) {
+            fprintf(header, "%s%d%s", edge % 16 == 0 ? "\n    " : " ",
+                    renumbered[_num_gen_minimal[order[i]].targets[j]],
+                    edge + 1 == edge_count ? "\n" : ",");
+            edge++;
+        }
+    }
+    fprintf(header, "};\n\nstatic const long _NUM_DAWG_EDGE_WEIGHTS[%d] = {",
+            edge_count);
+    for (int i = 0, edge = 0; i < _num_gen_minimal_count; i++) {
+        for (int j = 0; j < _num_gen_minimal[order[i]].edge_count; j++) {
+            fprintf(header, "%s%ld%s", edge % 8 == 0 ? "\n    " : " ",
+                    _num_gen_minimal[order[i]].weights[j],
+                    edge + 1 == edge_count ? "\n" : ",");
+            edge++;
+        }
+    }
+    fprintf(header, "};\n");
+}
+
+
+int main(int argc, char **args) {
+    int small = argc == 3 && strcmp(args[1], "--small") == 0;
+    if (argc != 2 && !small) {
+        fprintf(stderr, "Usage: %s [--small] path/to/numerus_tables.h\n",
+                args[0]);
+        return 1;
+    }
+    _num_gen_build_tables();
+    if (_num_gen_check_tables() != 0
+        || _num_gen_build_small_tables() != 0
+        || _num_gen_check_small_tables() != 0) {
+        return 1;
+    }
+    int trie_root = _num_gen_build_automaton();
+    if (trie_root < 0) {
+        return 1;
+    }
+    int automaton_root = _num_gen_minimise_state(trie_root);
+    if (automaton_root < 0 || _num_gen_check_automaton(automaton_root) != 0) {
+        return 1;
+    }
+    FILE *header = fopen(args[argc - 1], "w");
+    if (header == NULL) {
+        perror(args[argc - 1]);
+        return 1;
+    }
+    fprintf(header,
+            "/* Generated by numerus_tables_gen.c from _NUM_DICTIONARY: "
+            "do not edit. */\n\n"
+            "#ifndef NUMERUS_TABLES_H\n"
+            "#define NUMERUS_TABLES_H\n\n\n");
+    if (small) {
+        _num_gen_write_small_tables(header);
+    } else {
+        _num_gen_write_tables(header);
+    }
+    _num_gen_write_date_components(header);
+    _num_gen_write_automaton(header, automaton_root);
+    fprintf(header, "\n#endif /* NUMERUS_TABLES_H */\n");
+    return fclose(header) == 0 ? 0 : 1;
+}
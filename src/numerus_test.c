@@ -11,10 +11,16 @@
  * testing of the library, not for public usage.
  */
 
+#define _POSIX_C_SOURCE 200809L  /* For `gmtime_r()` */
+
+#include <ctype.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
+#include <string.h>
 #include "numerus_internal.h"
+#include "numerus_inline.h"
 
 
 /**
@@ -217,16 +223,18 @@ int numtest_convert_all_integers_with_doubles() {
  * Perform a single test to verify the reaction of the roman to value
  * conversion when the syntax is correct.
  */
-static void _num_test_for_error(char *roman, int error_code) {
+static int _num_test_for_error(char *roman, int error_code) {
     int errcode;
-    double value = numerus_roman_to_double(roman, &errcode);
+    numerus_roman_to_double(roman, &errcode);
     if (errcode == error_code) {
         fprintf(stderr, "Test passed: %s raises error \"%s\"\n",
                 roman, numerus_explain_error(errcode));
+        return 0;
     } else {
         fprintf(stderr, "Test FAILED: %s raises \"%s\" instead of \"%s\"\n",
                 roman, numerus_explain_error(errcode),
                 numerus_explain_error(error_code));
+        return 1;
     }
 }
 
@@ -238,46 +246,49 @@ static void _num_test_for_error(char *roman, int error_code) {
  * Outputs the result to to stderr.
  *
  * @see _num_test_for_error(char *roman, int error_code)
+ * @returns 0 on success or 1 if any numeral raises another error.
  */
-void numtest_roman_syntax_errors() {
-    _num_test_for_error("-_MCM_XX_I", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART);
-    _num_test_for_error("-_MCM__I", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART);
-    _num_test_for_error("-_MCM_LI_", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART);
+int numtest_roman_syntax_errors() {
+    int failures = 0;
+    failures += _num_test_for_error("-_MCM_XX_I", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART);
+    failures += _num_test_for_error("-_MCM__I", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART);
+    failures += _num_test_for_error("-_MCM_LI_", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART);
 
-    _num_test_for_error("-MMCM-LI", NUMERUS_ERROR_ILLEGAL_MINUS);
-    _num_test_for_error("--_MCM_LI", NUMERUS_ERROR_ILLEGAL_MINUS);
+    failures += _num_test_for_error("-MMCM-LI", NUMERUS_ERROR_ILLEGAL_MINUS);
+    failures += _num_test_for_error("--_MCM_LI", NUMERUS_ERROR_ILLEGAL_MINUS);
 
-    _num_test_for_error("MMMCMLCI", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MMMCMLIIIX", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MMMCMLIII.S", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMMCMLCI", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMMCMLIIIX", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMMCMLIII.S", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
 
-    _num_test_for_error("-XVIFI", NUMERUS_ERROR_ILLEGAL_CHARACTER);
-    _num_test_for_error("-XVI.FI", NUMERUS_ERROR_ILLEGAL_CHARACTER);
-    _num_test_for_error("-XVI,.", NUMERUS_ERROR_ILLEGAL_CHARACTER);
+    failures += _num_test_for_error("-XVIFI", NUMERUS_ERROR_ILLEGAL_CHARACTER);
+    failures += _num_test_for_error("-XVI.FI", NUMERUS_ERROR_ILLEGAL_CHARACTER);
+    failures += _num_test_for_error("-XVI,.", NUMERUS_ERROR_ILLEGAL_CHARACTER);
 
-    _num_test_for_error("MMMM", NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS);
-    _num_test_for_error("MMCCCC", NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS);
-    _num_test_for_error("MMDD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MMCMCM", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MMCMD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MMDCD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MMCMCD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MMSS", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
-    _num_test_for_error("MM......", NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS);
+    failures += _num_test_for_error("MMMM", NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS);
+    failures += _num_test_for_error("MMCCCC", NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS);
+    failures += _num_test_for_error("MMDD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMCMCM", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMCMD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMDCD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMCMCD", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MMSS", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("MM......", NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS);
 
-    _num_test_for_error("-_MCMLI", NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE);
-    _num_test_for_error("_MCMLI", NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE);
+    failures += _num_test_for_error("-_MCMLI", NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE);
+    failures += _num_test_for_error("_MCMLI", NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE);
 
-    _num_test_for_error("_MCMS_LI", NUMERUS_ERROR_DECIMALS_IN_LONG_PART);
-    _num_test_for_error("_MCM.._LI", NUMERUS_ERROR_DECIMALS_IN_LONG_PART);
-    _num_test_for_error("_MCMs.._LI", NUMERUS_ERROR_DECIMALS_IN_LONG_PART);
+    failures += _num_test_for_error("_MCMS_LI", NUMERUS_ERROR_DECIMALS_IN_LONG_PART);
+    failures += _num_test_for_error("_MCM.._LI", NUMERUS_ERROR_DECIMALS_IN_LONG_PART);
+    failures += _num_test_for_error("_MCMs.._LI", NUMERUS_ERROR_DECIMALS_IN_LONG_PART);
 
-    _num_test_for_error("_MCM_MLI", NUMERUS_ERROR_M_IN_SHORT_PART);
+    failures += _num_test_for_error("_MCM_MLI", NUMERUS_ERROR_M_IN_SHORT_PART);
 
-    _num_test_for_error("CCX_II", NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG);
-    _num_test_for_error("-CCX_II", NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG);
+    failures += _num_test_for_error("CCX_II", NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG);
+    failures += _num_test_for_error("-CCX_II", NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG);
 
-    _num_test_for_error("IVI", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    failures += _num_test_for_error("IVI", NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE);
+    return failures != 0;
 }
 
 void numtest_parts_to_from_double_functions() {
@@ -316,82 +327,79 @@ void numtest_parts_to_from_double_functions() {
     }
 }
 
-void numtest_null_handling_conversions() {
+int numtest_null_handling_conversions() {
     char *roman = "M";
     int errcode;
     short frac_part;
-    long int_part;
-    double value_double;
-    value_double = numerus_roman_to_double(roman, NULL);
-    value_double = numerus_roman_to_double("", NULL);
-    value_double = numerus_roman_to_double("", &errcode);
-    value_double = numerus_roman_to_double(NULL, NULL);
-    value_double = numerus_roman_to_double(NULL, &errcode);
-    int_part = numerus_roman_to_int(roman, NULL);
-    int_part = numerus_roman_to_int("", NULL);
-    int_part = numerus_roman_to_int(NULL, &errcode);
-    int_part = numerus_roman_to_int(NULL, NULL);
-    int_part = numerus_roman_to_int_part_and_twelfths("", &frac_part, &errcode);
-    int_part = numerus_roman_to_int_part_and_twelfths(roman, &frac_part, NULL);
-    int_part = numerus_roman_to_int_part_and_twelfths(roman, NULL, &errcode);
-    int_part = numerus_roman_to_int_part_and_twelfths(NULL, &frac_part,
-                                                      &errcode);
-    int_part = numerus_roman_to_int_part_and_twelfths(roman, NULL, NULL);
-    int_part = numerus_roman_to_int_part_and_twelfths(NULL, NULL, &errcode);
-    int_part = numerus_roman_to_int_part_and_twelfths(NULL, &frac_part, NULL);
-    int_part = numerus_roman_to_int_part_and_twelfths(NULL, NULL, NULL);
-    roman = numerus_double_to_roman(12.3, NULL);
-    roman = numerus_int_to_roman(-3, NULL);
-    roman = numerus_int_with_twelfth_to_roman(4, -2, NULL);
-}
-
-
-void numtest_null_handling_utils() {
+    (void) numerus_roman_to_double(roman, NULL);
+    (void) numerus_roman_to_double("", NULL);
+    (void) numerus_roman_to_double("", &errcode);
+    (void) numerus_roman_to_double(NULL, NULL);
+    (void) numerus_roman_to_double(NULL, &errcode);
+    (void) numerus_roman_to_int(roman, NULL);
+    (void) numerus_roman_to_int("", NULL);
+    (void) numerus_roman_to_int(NULL, &errcode);
+    (void) numerus_roman_to_int(NULL, NULL);
+    (void) numerus_roman_to_int_part_and_twelfths("", &frac_part, &errcode);
+    (void) numerus_roman_to_int_part_and_twelfths(roman, &frac_part, NULL);
+    (void) numerus_roman_to_int_part_and_twelfths(roman, NULL, &errcode);
+    (void) numerus_roman_to_int_part_and_twelfths(NULL, &frac_part,
+                                                  &errcode);
+    (void) numerus_roman_to_int_part_and_twelfths(roman, NULL, NULL);
+    (void) numerus_roman_to_int_part_and_twelfths(NULL, NULL, &errcode);
+    (void) numerus_roman_to_int_part_and_twelfths(NULL, &frac_part, NULL);
+    (void) numerus_roman_to_int_part_and_twelfths(NULL, NULL, NULL);
+    free(numerus_double_to_roman(12.3, NULL));
+    free(numerus_int_to_roman(-3, NULL));
+    free(numerus_int_with_twelfth_to_roman(4, -2, NULL));
+    return 0;
+}
+
+
+int numtest_null_handling_utils() {
     int errcode;
-    int result;
-    result = numerus_is_zero(NULL, &errcode);
-    result = numerus_is_zero("", &errcode);
-    result = numerus_is_zero(NULL, NULL);
-    result = numerus_is_zero("", NULL);
-    result = numerus_is_float_numeral(NULL, &errcode);
-    result = numerus_is_float_numeral("", &errcode);
-    result = numerus_is_float_numeral("", NULL);
-    result = numerus_is_long_numeral(NULL, &errcode);
-    result = numerus_is_long_numeral("", &errcode);
-    result = numerus_is_long_numeral("   ", &errcode);
-    result = numerus_is_long_numeral("  _x", &errcode);
-    result = numerus_is_long_numeral("   _x__f", &errcode);
-    result = numerus_is_long_numeral("   _x_f", &errcode);
-    result = numerus_count_roman_chars(NULL, &errcode);
-    result = numerus_count_roman_chars("", &errcode);
-    result = numerus_count_roman_chars(NULL, NULL);
-    result = numerus_count_roman_chars("", NULL);
-    result = numerus_sign(NULL, &errcode);
-    result = numerus_sign("", &errcode);
-    result = numerus_sign(NULL, NULL);
-    result = numerus_sign("", NULL);
-    result = numerus_compare_value("", "", &errcode);
-    result = numerus_compare_value(NULL, "i", &errcode);
-    result = numerus_compare_value("i", NULL, &errcode);
-    result = numerus_compare_value("i", "i", &errcode);
-    result = numerus_compare_value("i.", "i", &errcode);
-    result = numerus_compare_value("i.", "i", NULL);
-    result = numerus_compare_value(NULL, NULL, NULL);
-    char *pretty = numerus_pretty_print_long_numerals("");
-    pretty = numerus_pretty_print_long_numerals(NULL);
-    pretty = numerus_pretty_print_long_numerals("_");
-    pretty = numerus_pretty_print_long_numerals("i..");
-    pretty = numerus_pretty_print_long_numerals("i..");
-    pretty = numerus_pretty_print_value_as_parts(20492, 3);
-    pretty = numerus_pretty_print_value_as_parts(20492, 0);
+    (void) numerus_is_zero(NULL, &errcode);
+    (void) numerus_is_zero("", &errcode);
+    (void) numerus_is_zero(NULL, NULL);
+    (void) numerus_is_zero("", NULL);
+    (void) numerus_is_float_numeral(NULL, &errcode);
+    (void) numerus_is_float_numeral("", &errcode);
+    (void) numerus_is_float_numeral("", NULL);
+    (void) numerus_is_long_numeral(NULL, &errcode);
+    (void) numerus_is_long_numeral("", &errcode);
+    (void) numerus_is_long_numeral("   ", &errcode);
+    (void) numerus_is_long_numeral("  _x", &errcode);
+    (void) numerus_is_long_numeral("   _x__f", &errcode);
+    (void) numerus_is_long_numeral("   _x_f", &errcode);
+    (void) numerus_count_roman_chars(NULL, &errcode);
+    (void) numerus_count_roman_chars("", &errcode);
+    (void) numerus_count_roman_chars(NULL, NULL);
+    (void) numerus_count_roman_chars("", NULL);
+    (void) numerus_sign(NULL, &errcode);
+    (void) numerus_sign("", &errcode);
+    (void) numerus_sign(NULL, NULL);
+    (void) numerus_sign("", NULL);
+    (void) numerus_compare_value("", "", &errcode);
+    (void) numerus_compare_value(NULL, "i", &errcode);
+    (void) numerus_compare_value("i", NULL, &errcode);
+    (void) numerus_compare_value("i", "i", &errcode);
+    (void) numerus_compare_value("i.", "i", &errcode);
+    (void) numerus_compare_value("i.", "i", NULL);
+    (void) numerus_compare_value(NULL, NULL, NULL);
+    free(numerus_overline_long_numerals("", &errcode));
+    free(numerus_overline_long_numerals(NULL, &errcode));
+    free(numerus_overline_long_numerals("_", &errcode));
+    free(numerus_overline_long_numerals("i..", &errcode));
+    free(numerus_overline_long_numerals("i..", NULL));
+    free(numerus_create_pretty_value_as_parts(20492, 3));
+    free(numerus_create_pretty_value_as_parts(20492, 0));
+    return 0;
 }
 
 
 int numtest_pretty_print_all_numerals() {
     long int_part;
     short frac_part;
-    long int_part_converted;
-    short frac_part_converted;
     char *roman;
     char *pretty_roman;
     int errcode;
@@ -407,7 +415,7 @@ int numtest_pretty_print_all_numerals() {
                         int_part, frac_part, roman, numerus_explain_error(errcode));
                 return 1;
             }
-            pretty_roman = numerus_pretty_print_long_numerals(roman);
+            pretty_roman = numerus_overline_long_numerals(roman, &errcode);
             if (errcode != NUMERUS_OK) {
                 fprintf(stderr, "Error pretty printing %s (%ld, %d) to value: %s.\n",
                         roman, int_part, frac_part, numerus_explain_error(errcode));
@@ -436,16 +444,14 @@ int numtest_pretty_print_all_numerals() {
 int numtest_pretty_print_all_values() {
     long int_part;
     short frac_part;
-    char *roman;
     char *pretty_roman;
-    int errcode;
     printf("Starting pretty printing of all values with parts\n");
     clock_t start_clock = clock();
     for (int_part = NUMERUS_MIN_LONG_NONFLOAT_VALUE;
          int_part <= NUMERUS_MAX_LONG_NONFLOAT_VALUE; int_part++) {
         for (frac_part = 0; frac_part < 12; frac_part++) {
             frac_part = SIGN(int_part) * ABS(frac_part);
-            pretty_roman = numerus_pretty_print_value_as_parts(int_part, frac_part);
+            pretty_roman = numerus_create_pretty_value_as_parts(int_part, frac_part);
             if (pretty_roman == NULL) {
                 fprintf(stderr, "Error pretty printing %ld, %d to value.\n",
                         int_part, frac_part);
@@ -467,3 +473,1558 @@ int numtest_pretty_print_all_values() {
            96000001.0/seconds_taken);
     return 0;
 }
+
+
+/**
+ * Verifies that the iterator produces the numerals of the conversion
+ * function, forward and backwards, across zero, the sign and the
+ * underscores, up to both ends of the range, also in batch mode.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_iterator() {
+    struct sequence { long int_part; short twelfths; long step; };
+    const struct sequence sequences[] = {
+            {-5000, 0, 1}, {3990, 0, 1}, {0, 0, -1}, {-1, -11, 7},
+            {NUMERUS_MAX_LONG_NONFLOAT_VALUE - 100, 0, 1},
+            {NUMERUS_MIN_LONG_NONFLOAT_VALUE + 100, 0, -12},
+            {NUMERUS_MIN_LONG_NONFLOAT_VALUE, -11, 9973},
+            {2016, 0, 0}};
+    char *arena = malloc(1000 * NUMERUS_MAX_LENGTH);
+    short lengths[1000];
+    if (arena == NULL) {
+        fprintf(stderr, "Error allocating the arena of the iterator\n");
+        return 1;
+    }
+    for (size_t s = 0; s < sizeof(sequences) / sizeof(sequences[0]); s++) {
+        struct numerus_iter iter;
+        struct numerus_iter batch_iter;
+        int errcode;
+        numerus_iter_init(&iter, sequences[s].int_part,
+                          sequences[s].twelfths, sequences[s].step, &errcode);
+        numerus_iter_init(&batch_iter, sequences[s].int_part,
+                          sequences[s].twelfths, sequences[s].step, &errcode);
+        long value = sequences[s].int_part * 12 + sequences[s].twelfths;
+        char roman[NUMERUS_MAX_LENGTH];
+        char expected[NUMERUS_MAX_LENGTH];
+        for (int i = 0; i < 120000; i += 1000) {
+            size_t written = numerus_iter_batch(&batch_iter, 1000, arena,
+                                                NUMERUS_MAX_LENGTH, lengths);
+            for (size_t j = 0; j < 1000; j++) {
+                short length = numerus_iter_next(&iter, roman, &errcode);
+                numerus_int_with_twelfth_to_roman_into(
+                        value / 12, (short) (value % 12), expected, &errcode);
+                if (errcode != NUMERUS_OK) {
+                    if (length != -1 || j != written) {
+                        fprintf(stderr, "Iterator doesn't stop at %ld\n",
+                                value);
+                        free(arena);
+                        return 1;
+                    }
+                    break;
+                }
+                if (strcmp(roman, expected) != 0
+                    || length != (short) strlen(expected)
+                    || j >= written || lengths[j] != length
+                    || strcmp(arena + j * NUMERUS_MAX_LENGTH, expected) != 0) {
+                    fprintf(stderr, "Iterator error at %ld: %s != %s\n",
+                            value, roman, expected);
+                    free(arena);
+                    return 1;
+                }
+                value += sequences[s].step;
+            }
+        }
+    }
+    free(arena);
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Numerals listed by numerus_enumerate() with their values in twelfths, in
+ * slots of NUMERUS_MAX_LENGTH chars.
+ */
+struct _num_test_numerals {
+    char *romans;
+    long *values;
+    size_t count;
+    size_t capacity;
+};
+
+
+/**
+ * @internal
+ * Allocates the slots of up to a number of numerals.
+ *
+ * @returns 0 on success or outputs the error on stderr and returns 1.
+ */
+static int _num_test_numerals_init(struct _num_test_numerals *numerals,
+                                   size_t capacity) {
+    numerals->romans = malloc(capacity * NUMERUS_MAX_LENGTH);
+    numerals->values = malloc(capacity * sizeof(long));
+    numerals->count = 0;
+    numerals->capacity = capacity;
+    if (numerals->romans == NULL || numerals->values == NULL) {
+        fprintf(stderr, "Error allocating %zu numerals\n", capacity);
+        free(numerals->romans);
+        free(numerals->values);
+        return 1;
+    }
+    return 0;
+}
+
+
+static void _num_test_numerals_free(struct _num_test_numerals *numerals) {
+    free(numerals->romans);
+    free(numerals->values);
+}
+
+
+/**
+ * @internal
+ * Collects the numerals listed by numerus_enumerate() with their values,
+ * stopping the enumeration when the slots are full.
+ */
+static int _num_test_collect_numeral(const char *roman, short length,
+                                     long int_part, short twelfths,
+                                     void *context) {
+    struct _num_test_numerals *numerals = context;
+    if (numerals->count == numerals->capacity) {
+        return 1;
+    }
+    memcpy(numerals->romans + numerals->count * NUMERUS_MAX_LENGTH, roman,
+           (size_t) length + 1);
+    numerals->values[numerals->count++] = int_part * 12 + twelfths;
+    return 0;
+}
+
+
+/**
+ * Verifies that the enumeration lists each numeral of the conversion
+ * functions once, in the requested order, with the requested kinds, also in
+ * the arena, and counts the whole language.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_enumerate() {
+    struct numerus_enum_filter filter;
+    struct _num_test_numerals numerals;
+    numerus_enum_filter_init(&filter, NUMERUS_ENUM_ALL);
+    if (numerus_enumerate(&filter, NUMERUS_ENUM_BY_VALUE, NULL, NULL)
+        != (size_t) (2 * (NUMERUS_MAX_LONG_NONFLOAT_VALUE * 12 + 11) + 1)) {
+        fprintf(stderr, "Error in the count of all numerals\n");
+        return 1;
+    }
+    const int kinds[] = {NUMERUS_ENUM_ALL,
+                         NUMERUS_ENUM_SHORT | NUMERUS_ENUM_POSITIVE,
+                         NUMERUS_ENUM_LONG | NUMERUS_ENUM_NEGATIVE,
+                         NUMERUS_ENUM_FLOAT | NUMERUS_ENUM_NEGATIVE
+                         | NUMERUS_ENUM_POSITIVE};
+    const int orders[] = {NUMERUS_ENUM_BY_VALUE, NUMERUS_ENUM_BY_LENGTH};
+    if (_num_test_numerals_init(&numerals, 2 * (4100 * 12 + 11) + 1) != 0) {
+        return 1;
+    }
+    char *arena = malloc(numerals.capacity * NUMERUS_MAX_LENGTH);
+    if (arena == NULL) {
+        fprintf(stderr, "Error allocating the arena of the enumeration\n");
+        _num_test_numerals_free(&numerals);
+        return 1;
+    }
+    int result = 0;
+    for (size_t k = 0; k < 4 && result == 0; k++) {
+        int kind = kinds[k];
+        for (size_t o = 0; o < 2 && result == 0; o++) {
+            int order = orders[o];
+            numerals.count = 0;
+            numerus_enum_filter_init(&filter, kind);
+            filter.min_int_part = -4100;
+            filter.max_int_part = 4100;
+            numerus_enumerate(&filter, order, _num_test_collect_numeral,
+                              &numerals);
+            size_t expected_count = 0;
+            for (long value = -4100 * 12 - 11; value <= 4100 * 12 + 11;
+                 value++) {
+                long int_part = value / 12;
+                int is_long = int_part > 3999 || int_part < -3999;
+                expected_count += ((value < 0 ? kind & NUMERUS_ENUM_NEGATIVE
+                                              : kind & NUMERUS_ENUM_POSITIVE)
+                                   && (value % 12 != 0
+                                       ? kind & NUMERUS_ENUM_FLOAT
+                                       : kind & (is_long ? NUMERUS_ENUM_LONG
+                                                         : NUMERUS_ENUM_SHORT)))
+                                  != 0;
+            }
+            size_t used;
+            size_t in_arena = numerus_enumerate_into(
+                    &filter, order, arena,
+                    numerals.count * NUMERUS_MAX_LENGTH, &used);
+            if (numerals.count != expected_count
+                || in_arena != expected_count) {
+                fprintf(stderr, "Error in the count of kinds %d: %zu\n",
+                        kind, numerals.count);
+                result = 1;
+                break;
+            }
+            const char *from_arena = arena;
+            for (size_t i = 0; i < numerals.count; i++) {
+                const char *numeral = numerals.romans + i * NUMERUS_MAX_LENGTH;
+                const char *previous = i == 0 ? numeral
+                                              : numeral - NUMERUS_MAX_LENGTH;
+                long value = numerals.values[i];
+                char roman[NUMERUS_MAX_LENGTH];
+                int errcode;
+                numerus_int_with_twelfth_to_roman_into(
+                        value / 12, (short) (value % 12), roman, &errcode);
+                int in_order = i == 0
+                        || (order == NUMERUS_ENUM_BY_LENGTH
+                            && strlen(previous) < strlen(numeral))
+                        || ((order == NUMERUS_ENUM_BY_VALUE
+                             || strlen(previous) == strlen(numeral))
+                            && numerals.values[i - 1] < value);
+                if (strcmp(numeral, roman) != 0 || !in_order
+                    || strcmp(numeral, from_arena) != 0) {
+                    fprintf(stderr, "Error in the enumeration at %s\n",
+                            numeral);
+                    result = 1;
+                    break;
+                }
+                from_arena += strlen(numeral) + 1;
+            }
+        }
+    }
+    free(arena);
+    _num_test_numerals_free(&numerals);
+    return result;
+}
+
+
+/**
+ * Verifies that the extended range agrees with the normal range within it,
+ * round-trips beyond it within the max length of each level and rejects
+ * wrong nested numerals with the errors of the long numerals.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_extended_range() {
+    char roman[NUMERUS_MAX_LENGTH];
+    char ext_roman[NUMERUS_EXT_MAX_LENGTH];
+    int errcode;
+    int ext_errcode;
+    short twelfths;
+    short ext_twelfths;
+    for (long value = NUMERUS_MIN_LONG_NONFLOAT_VALUE - 1;
+         value <= NUMERUS_MAX_LONG_NONFLOAT_VALUE + 1; value += 997) {
+        short value_twelfths = (short) (value % 23 - 11);
+        numerus_int_with_twelfth_to_roman_into(value, value_twelfths, roman,
+                                               &errcode);
+        numerus_ext_int_with_twelfth_to_roman_into(value, value_twelfths,
+                                                   ext_roman, &ext_errcode);
+        if (errcode == NUMERUS_OK
+            && (strcmp(roman, ext_roman) != 0
+                || numerus_ext_roman_to_int_part_and_twelfths(
+                        ext_roman, &ext_twelfths, &ext_errcode)
+                   != numerus_roman_to_int_part_and_twelfths(
+                        roman, &twelfths, &errcode)
+                || ext_twelfths != twelfths || ext_errcode != errcode)) {
+            fprintf(stderr, "Extended range differs at %ld: %s != %s\n",
+                    value, ext_roman, roman);
+            return 1;
+        }
+    }
+    uint64_t state = 2016;
+    for (int i = 0; i < 1000000; i++) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        int64_t value = (int64_t) (state >> 20) % (NUMERUS_EXT_MAX_VALUE + 1);
+        int64_t magnitude = value < 0 ? -value : value;
+        short levels = 0;
+        for (int64_t top = 4000; levels < NUMERUS_EXT_MAX_LEVELS
+                                 && magnitude >= top; top *= 1000) {
+            levels++;
+        }
+        short value_twelfths = (short) ((short) (state % 23) - 11);
+        short length = numerus_ext_int_with_twelfth_to_roman_into(
+                value, value_twelfths, ext_roman, &ext_errcode);
+        int64_t parsed = numerus_ext_roman_to_int_part_and_twelfths(
+                ext_roman, &ext_twelfths, &errcode);
+        if (ext_errcode != NUMERUS_OK || errcode != NUMERUS_OK
+            || parsed * 12 + ext_twelfths != value * 12 + value_twelfths
+            || length >= numerus_ext_max_length(levels)) {
+            fprintf(stderr, "Extended range error at %lld: %s\n",
+                    (long long) value, ext_roman);
+            return 1;
+        }
+    }
+    numerus_ext_int_to_roman_into(NUMERUS_EXT_MAX_VALUE + 1, ext_roman,
+                                  &ext_errcode);
+    if (ext_errcode != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+        fprintf(stderr, "Extended range accepts too big values\n");
+        return 1;
+    }
+    struct wrong_numeral { char *roman; int errcode; };
+    const struct wrong_numeral wrong_numerals[] = {
+            {"__I_", NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE},
+            {"_I__II__", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART},
+            {"__IV__M", NUMERUS_ERROR_M_IN_SHORT_PART},
+            {"____I____", NUMERUS_ERROR_VALUE_OUT_OF_RANGE},
+            {"__IS__", NUMERUS_ERROR_DECIMALS_IN_LONG_PART},
+            {"__IV__ I", NUMERUS_ERROR_WHITESPACE_CHARACTER},
+            {"-__IV__-", NUMERUS_ERROR_ILLEGAL_MINUS},
+            {"__IV____", NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART}};
+    for (size_t i = 0; i < sizeof(wrong_numerals) / sizeof(wrong_numerals[0]);
+         i++) {
+        numerus_ext_roman_to_int_part_and_twelfths(
+                wrong_numerals[i].roman, &ext_twelfths, &errcode);
+        if (errcode != wrong_numerals[i].errcode) {
+            fprintf(stderr, "Extended range error code of %s: %d\n",
+                    wrong_numerals[i].roman, errcode);
+            return 1;
+        }
+    }
+    /* An empty long part is a numeral of the normal range, as for the core */
+    if (numerus_ext_roman_to_int_part_and_twelfths("-__XS", &ext_twelfths,
+                                                   &errcode) != -10
+        || ext_twelfths != -6 || errcode != NUMERUS_OK) {
+        fprintf(stderr, "Extended range parses -__XS as the core doesn't\n");
+        return 1;
+    }
+    char styled[NUMERUS_EXT_MAX_STYLED_LENGTH];
+    numerus_ext_overline_into("-__IV___I_IS", styled, &errcode);
+    if (strcmp(styled, "-I̿V̿I̅IS") != 0) {
+        fprintf(stderr, "Extended range styled as %s\n", styled);
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies that the formatted dates have the numerals of their components,
+ * that timestamps are split like gmtime_r() does and that wrong patterns,
+ * small buffers and wrong dates are rejected.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_date_format() {
+    char formatted[128];
+    char expected[128];
+    char numerals[6][NUMERUS_MAX_LENGTH];
+    int errcode;
+    for (int64_t epoch = -62135596800LL; epoch < 253402300800LL;
+         epoch += 86400LL * 7919 + 3607) {
+        time_t epoch_time = (time_t) epoch;
+        struct tm date;
+        gmtime_r(&epoch_time, &date);
+        const long components[6] = {
+                date.tm_year + 1900L, date.tm_mon + 1L, (long) date.tm_mday,
+                (long) date.tm_hour, (long) date.tm_min, (long) date.tm_sec};
+        for (int i = 0; i < 6; i++) {
+            numerus_int_to_roman_into(components[i], numerals[i], &errcode);
+        }
+        snprintf(expected, sizeof(expected), "%s.%s.%s %s:%s:%s %%",
+                 numerals[0], numerals[1], numerals[2], numerals[3],
+                 numerals[4], numerals[5]);
+        short length = numerus_format_epoch(epoch, "%Y.%m.%d %H:%M:%S %%",
+                                            formatted, sizeof(formatted),
+                                            &errcode);
+        if (errcode != NUMERUS_OK || strcmp(formatted, expected) != 0
+            || length != (short) strlen(expected)) {
+            fprintf(stderr, "Epoch %lld formatted as %s, not %s\n",
+                    (long long) epoch, formatted, expected);
+            return 1;
+        }
+        numerus_format_date(&date, "%Y.%m.%d %H:%M:%S %%", formatted,
+                            sizeof(formatted), &errcode);
+        if (errcode != NUMERUS_OK || strcmp(formatted, expected) != 0) {
+            fprintf(stderr, "Date formatted as %s, not %s\n", formatted,
+                    expected);
+            return 1;
+        }
+    }
+    numerus_format_epoch(1476576000LL + 15 * 60, "%Y.%m.%d %H:%M", formatted,
+                         sizeof(formatted), &errcode);
+    if (strcmp(formatted, "MMXVI.X.XVI NULLA:XV") != 0) {
+        fprintf(stderr, "Date formatted as %s\n", formatted);
+        return 1;
+    }
+    numerus_format_epoch(0, "%Y %x", formatted, sizeof(formatted), &errcode);
+    if (errcode != NUMERUS_ERROR_DATE_FORMAT) {
+        fprintf(stderr, "Date pattern with unknown conversion accepted\n");
+        return 1;
+    }
+    numerus_format_epoch(0, "%Y", formatted, 6, &errcode);
+    if (errcode != NUMERUS_ERROR_DATE_FORMAT || formatted[0] != '\0') {
+        fprintf(stderr, "Formatted date overflows the buffer\n");
+        return 1;
+    }
+    numerus_format_epoch(0, "%Y", formatted, 7, &errcode);
+    if (errcode != NUMERUS_OK || strcmp(formatted, "MCMLXX") != 0) {
+        fprintf(stderr, "Formatted date doesn't fill the buffer\n");
+        return 1;
+    }
+    struct tm wrong_date;
+    memset(&wrong_date, 0, sizeof(wrong_date));
+    wrong_date.tm_year = 116;
+    wrong_date.tm_mday = 32;
+    numerus_format_date(&wrong_date, "%d", formatted, sizeof(formatted),
+                        &errcode);
+    if (errcode != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+        fprintf(stderr, "Date with a wrong day accepted\n");
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Cost of substituting a char of a malformed numeral with a char of a valid
+ * numeral, from the pairs of chars an OCR confuses listed by
+ * numerus_suggest().
+ */
+static short _num_test_substitution_cost(char bad, char good) {
+    const char *confusables[] = {"Il", "I1", "I|", "I!", "IJ", "Ij", "VU",
+                                 "Vu", "VY", "Vy", "XK", "Xk", "X%", "CO",
+                                 "C0", "Co", "CG", "C(", "C<", "DO", "D0",
+                                 "Do", "MN", "Mn", "S5", "S$", ".,", ".'",
+                                 ".`", "-~", "_-", NULL};
+    if (bad == good || (bad >= 'a' && bad <= 'z' && bad - 'a' + 'A' == good)) {
+        return 0;
+    }
+    for (const char **pair = confusables; *pair != NULL; pair++) {
+        if ((*pair)[0] == good && (*pair)[1] == bad) {
+            return NUMERUS_SUGGEST_CONFUSABLE_COST;
+        }
+    }
+    return NUMERUS_SUGGEST_EDIT_COST;
+}
+
+
+/**
+ * @internal
+ * Weighted edit distance of the suggestions, computed by brute force.
+ */
+static short _num_test_suggest_cost(const char *bad, const char *good) {
+    short rows[2][NUMERUS_MAX_LENGTH + NUMERUS_SUGGEST_MAX_EDITS + 1];
+    short *previous = rows[0];
+    short *row = rows[1];
+    size_t bad_length = strlen(bad);
+    for (size_t j = 0; j <= bad_length; j++) {
+        previous[j] = (short) (j * NUMERUS_SUGGEST_EDIT_COST);
+    }
+    for (const char *c = good; *c != '\0'; c++) {
+        row[0] = (short) (previous[0] + NUMERUS_SUGGEST_EDIT_COST);
+        for (size_t j = 1; j <= bad_length; j++) {
+            short cost = (short) (previous[j - 1]
+                                  + _num_test_substitution_cost(bad[j - 1],
+                                                                *c));
+            if (previous[j] + NUMERUS_SUGGEST_EDIT_COST < cost) {
+                cost = (short) (previous[j] + NUMERUS_SUGGEST_EDIT_COST);
+            }
+            if (row[j - 1] + NUMERUS_SUGGEST_EDIT_COST < cost) {
+                cost = (short) (row[j - 1] + NUMERUS_SUGGEST_EDIT_COST);
+            }
+            row[j] = cost;
+        }
+        short *swapped = previous;
+        previous = row;
+        row = swapped;
+    }
+    return previous[bad_length];
+}
+
+
+static int _num_test_compare_shorts(const void *a, const void *b) {
+    return *(const short *) a - *(const short *) b;
+}
+
+
+/**
+ * @internal
+ * Verifies the suggestions of one malformed numeral against the costs of
+ * all the short numerals.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_suggest_numeral(const char *bad,
+                                     const struct _num_test_numerals *numerals,
+                                     struct numerus_suggestion *suggestions,
+                                     short *expected_costs) {
+    int errcode;
+    size_t found = numerus_suggest(bad, 1, suggestions, numerals->count,
+                                   &errcode);
+    size_t expected_count = 0;
+    for (size_t i = 0; i < numerals->count; i++) {
+        short cost = _num_test_suggest_cost(
+                bad, numerals->romans + i * NUMERUS_MAX_LENGTH);
+        if (cost <= NUMERUS_SUGGEST_EDIT_COST) {
+            expected_costs[expected_count++] = cost;
+        }
+    }
+    qsort(expected_costs, expected_count, sizeof(short),
+          _num_test_compare_shorts);
+    if (found != expected_count) {
+        fprintf(stderr, "%zu suggestions for %s, not %zu\n", found, bad,
+                expected_count);
+        return 1;
+    }
+    for (size_t i = 0; i < found; i++) {
+        short twelfths;
+        long int_part = numerus_roman_to_int_part_and_twelfths(
+                suggestions[i].roman, &twelfths, &errcode);
+        if (suggestions[i].cost != expected_costs[i]
+            || _num_test_suggest_cost(bad, suggestions[i].roman)
+               != suggestions[i].cost
+            || errcode != NUMERUS_OK
+            || int_part != suggestions[i].int_part
+            || twelfths != suggestions[i].twelfths) {
+            fprintf(stderr, "Wrong suggestion %s for %s\n",
+                    suggestions[i].roman, bad);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies that the suggestions are the closest numerals found by brute
+ * force over all the short numerals, which are the only ones within one edit
+ * of a numeral without underscores, and that they are valid and sorted.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_suggest() {
+    struct numerus_enum_filter filter;
+    struct _num_test_numerals numerals;
+    numerus_enum_filter_init(&filter, NUMERUS_ENUM_ALL);
+    filter.min_int_part = -NUMERUS_MAX_SHORT_VALUE;
+    filter.max_int_part = NUMERUS_MAX_SHORT_VALUE;
+    if (_num_test_numerals_init(&numerals,
+                                2 * (NUMERUS_MAX_SHORT_VALUE * 12 + 11) + 1)
+        != 0) {
+        return 1;
+    }
+    numerus_enumerate(&filter, NUMERUS_ENUM_BY_VALUE,
+                      _num_test_collect_numeral, &numerals);
+    struct numerus_suggestion *suggestions =
+            malloc(numerals.count * sizeof(struct numerus_suggestion));
+    short *expected_costs = malloc(numerals.count * sizeof(short));
+    if (suggestions == NULL || expected_costs == NULL) {
+        fprintf(stderr, "Error allocating the suggestions\n");
+        free(suggestions);
+        free(expected_costs);
+        _num_test_numerals_free(&numerals);
+        return 1;
+    }
+    const char *bad_numerals[] = {
+            "MCMLXXXXIV", "XllV", "xiv", "-MMXVI.", "CM0XC", "IIII", "S:",
+            "VX", "NULA", "MMMM", "DCLXVIS.....", "-l", NULL};
+    int result = 0;
+    for (const char **bad = bad_numerals; *bad != NULL && result == 0;
+         bad++) {
+        result = _num_test_suggest_numeral(*bad, &numerals, suggestions,
+                                           expected_costs);
+    }
+    /* Numerals with a random edit */
+    const char edits[] = "MDCLXVIS.l10";
+    uint64_t state = 2016;
+    for (int i = 0; i < 12 && result == 0; i++) {
+        char bad[NUMERUS_MAX_LENGTH + 1];
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        strcpy(bad, numerals.romans
+                    + (state >> 33) % numerals.count * NUMERUS_MAX_LENGTH);
+        size_t length = strlen(bad);
+        size_t position = (state >> 20) % (length + 1);
+        char edit = edits[(state >> 8) % (sizeof(edits) - 1)];
+        if (state % 3 == 0 && position < length) {
+            memmove(bad + position, bad + position + 1, length - position);
+        } else if (state % 3 == 1 && position < length) {
+            bad[position] = edit;
+        } else {
+            memmove(bad + position + 1, bad + position, length - position + 1);
+            bad[position] = edit;
+        }
+        result = _num_test_suggest_numeral(bad, &numerals, suggestions,
+                                           expected_costs);
+    }
+    free(suggestions);
+    free(expected_costs);
+    _num_test_numerals_free(&numerals);
+    if (result != 0) {
+        return result;
+    }
+    struct numerus_suggestion best[3];
+    int errcode;
+    numerus_suggest("MCMLXXXXIV", 2, best, 3, &errcode);
+    if (errcode != NUMERUS_OK || strcmp(best[0].roman, "MCMLXXXIV") != 0) {
+        fprintf(stderr, "Best suggestion for MCMLXXXXIV: %s\n",
+                best[0].roman);
+        return 1;
+    }
+    if (numerus_suggest("I_IV_", 2, best, 3, NULL) == 0
+        || numerus_error_code != NUMERUS_OK
+        || strcmp(best[0].roman, "_IV_") != 0) {
+        fprintf(stderr, "Best suggestion for I_IV_: %s\n", best[0].roman);
+        return 1;
+    }
+    if (numerus_suggest(NULL, 2, best, 3, &errcode) != 0
+        || errcode != NUMERUS_ERROR_NULL_ROMAN) {
+        fprintf(stderr, "Suggestions for a NULL numeral\n");
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies that the completions of prefixes are the numerals starting with
+ * them in order of value, found by brute force on the enumeration of the
+ * short numerals and on a sample of long ones, and that the value ranges of
+ * prefixes hold their completions.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_complete() {
+    struct numerus_enum_filter filter;
+    struct _num_test_numerals numerals;
+    numerus_enum_filter_init(&filter, NUMERUS_ENUM_ALL);
+    filter.min_int_part = -NUMERUS_MAX_SHORT_VALUE;
+    filter.max_int_part = NUMERUS_MAX_SHORT_VALUE;
+    if (_num_test_numerals_init(&numerals,
+                                2 * (NUMERUS_MAX_SHORT_VALUE * 12 + 11) + 1)
+        != 0) {
+        return 1;
+    }
+    numerus_enumerate(&filter, NUMERUS_ENUM_BY_VALUE,
+                      _num_test_collect_numeral, &numerals);
+    const char *prefixes[] = {"MMX", "mmx", "XC", "-XL", "N", "NULLA", "S",
+                              "-S.", "MMMCMXCIX", "MMMM", "IIII", "Q", NULL};
+    char completions[64 * NUMERUS_MAX_LENGTH];
+    const char *expected[64];
+    for (const char **prefix = prefixes; *prefix != NULL; prefix++) {
+        char upper[NUMERUS_MAX_LENGTH];
+        size_t prefix_length = strlen(*prefix);
+        for (size_t i = 0; i <= prefix_length; i++) {
+            upper[i] = (char) toupper((*prefix)[i]);
+        }
+        size_t expected_count = 0;
+        for (size_t i = 0; i < numerals.count && expected_count < 64; i++) {
+            const char *numeral = numerals.romans + i * NUMERUS_MAX_LENGTH;
+            if (strncmp(numeral, upper, prefix_length) == 0) {
+                expected[expected_count++] = numeral;
+            }
+        }
+        size_t written = numerus_complete(*prefix, completions, 64);
+        if (written != expected_count) {
+            fprintf(stderr, "%zu completions of %s, not %zu\n", written,
+                    *prefix, expected_count);
+            _num_test_numerals_free(&numerals);
+            return 1;
+        }
+        double min_value = 0;
+        double max_value = 0;
+        if (numerus_prefix_value_range(*prefix, &min_value, &max_value)
+            != (written > 0)) {
+            fprintf(stderr, "Wrong value range of %s\n", *prefix);
+            _num_test_numerals_free(&numerals);
+            return 1;
+        }
+        for (size_t i = 0; i < written; i++) {
+            char *completion = completions + i * NUMERUS_MAX_LENGTH;
+            double value = numerus_roman_to_double(completion, NULL);
+            if (strcmp(expected[i], completion) != 0 || value < min_value
+                || value > max_value) {
+                fprintf(stderr, "Completion %zu of %s is %s, not %s\n", i,
+                        *prefix, completion, expected[i]);
+                _num_test_numerals_free(&numerals);
+                return 1;
+            }
+        }
+    }
+    _num_test_numerals_free(&numerals);
+    /* Long numerals: all the numerals of a prefix, in order of value */
+    size_t written = numerus_complete("_MMMCMXCIX_CMXCI", completions, 64);
+    long previous = 3999990;
+    short previous_twelfths = -1;
+    for (size_t i = 0; i < written; i++) {
+        short twelfths;
+        int errcode;
+        long int_part = numerus_roman_to_int_part_and_twelfths(
+                completions + i * NUMERUS_MAX_LENGTH, &twelfths, &errcode);
+        if (errcode != NUMERUS_OK
+            || int_part * 12 + twelfths <= previous * 12 + previous_twelfths) {
+            fprintf(stderr, "Long completion %s out of order\n",
+                    completions + i * NUMERUS_MAX_LENGTH);
+            return 1;
+        }
+        previous = int_part;
+        previous_twelfths = twelfths;
+    }
+    double min_value;
+    double max_value;
+    numerus_prefix_value_range("", &min_value, &max_value);
+    if (written != 5 * 12 || previous != NUMERUS_MAX_LONG_NONFLOAT_VALUE
+        || max_value != NUMERUS_MAX_LONG_NONFLOAT_VALUE + 11 / 12.0
+        || min_value != -max_value) {
+        fprintf(stderr, "Wrong long completions or full range\n");
+        return 1;
+    }
+    numerus_prefix_value_range("_IV_", &min_value, &max_value);
+    if (min_value != 4000 || max_value != 4999 + 11 / 12.0) {
+        fprintf(stderr, "Range of _IV_ is [%f, %f]\n", min_value, max_value);
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Writes values in twelfths into a packed file.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_pack_write(const char *path, const long *values,
+                                size_t count) {
+    int errcode;
+    struct numerus_pack_writer *writer = numerus_pack_writer_open(path,
+                                                                  &errcode);
+    if (writer == NULL || errcode != NUMERUS_OK) {
+        fprintf(stderr, "Error creating %s\n", path);
+        return 1;
+    }
+    for (size_t i = 0; i < count; i++) {
+        /* Twelfths with the opposite sign are normalised when appended */
+        long int_part = values[i] / 12 + (values[i] % 12 > 0);
+        short twelfths = (short) (values[i] % 12 > 0 ? values[i] % 12 - 12
+                                                     : values[i] % 12);
+        if (numerus_pack_writer_append(writer, int_part, twelfths)
+            != NUMERUS_OK) {
+            fprintf(stderr, "Error appending %ld to a packed file\n",
+                    values[i]);
+            numerus_pack_writer_close(writer);
+            return 1;
+        }
+    }
+    if (numerus_pack_writer_append(writer, NUMERUS_MAX_LONG_NONFLOAT_VALUE + 1,
+                                   0) != NUMERUS_ERROR_VALUE_OUT_OF_RANGE
+        || numerus_pack_writer_close(writer) != NUMERUS_OK) {
+        fprintf(stderr, "Error closing a packed file\n");
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Verifies that the blocks of a packed file unpack to the values, also as
+ * numerals, with the expected bits and within the range of each block.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_pack_read(struct numerus_pack *pack, const long *values,
+                               const short *expected_bits, long *int_parts,
+                               short *twelfths, char *romans,
+                               short *lengths) {
+    size_t index = 0;
+    int errcode;
+    for (size_t block = 0; block < numerus_pack_block_count(pack); block++) {
+        struct numerus_pack_block_info info;
+        size_t count = numerus_pack_decode_block(pack, block, int_parts,
+                                                 twelfths);
+        if (numerus_pack_block_info(pack, block, &info) != NUMERUS_OK
+            || info.count != count || info.bits != expected_bits[block]
+            || numerus_pack_decode_block_romans(
+                    pack, block, romans, NUMERUS_MAX_LENGTH, lengths)
+               != count) {
+            fprintf(stderr, "Error in block %zu of the packed file\n", block);
+            return 1;
+        }
+        long min_value = info.min_int_part * 12 + info.min_twelfths;
+        long max_value = info.max_int_part * 12 + info.max_twelfths;
+        for (size_t i = 0; i < count; i++, index++) {
+            char roman[NUMERUS_MAX_LENGTH];
+            long value = int_parts[i] * 12 + twelfths[i];
+            short length = numerus_int_with_twelfth_to_roman_into(
+                    int_parts[i], twelfths[i], roman, &errcode);
+            if (value != values[index] || value < min_value
+                || value > max_value || length != lengths[i]
+                || strcmp(roman, romans + i * NUMERUS_MAX_LENGTH) != 0) {
+                fprintf(stderr, "Value %zu unpacked as %ld and %s, not %ld\n",
+                        index, value, romans + i * NUMERUS_MAX_LENGTH,
+                        values[index]);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies that packed files unpack to the appended values, also as
+ * numerals, with the bits and the ranges of each block, and that failed
+ * writes, files of another kind and missing files are refused.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_pack() {
+    const char *tmpdir = getenv("TMPDIR");
+    char path[4096];
+    int errcode;
+    snprintf(path, sizeof(path), "%s/numerus_test.pack",
+             tmpdir == NULL ? "/tmp" : tmpdir);
+    /* Random values, then a constant block, then a narrow range of years */
+    const size_t count = 2 * NUMERUS_PACK_BLOCK_VALUES + 200;
+    const short expected_bits[] = {27, 0, 12};
+    long *values = malloc(count * sizeof(long));
+    long *int_parts = malloc(NUMERUS_PACK_BLOCK_VALUES * sizeof(long));
+    short *twelfths = malloc(NUMERUS_PACK_BLOCK_VALUES * sizeof(short));
+    char *romans = malloc(NUMERUS_PACK_BLOCK_VALUES * NUMERUS_MAX_LENGTH);
+    short *lengths = malloc(NUMERUS_PACK_BLOCK_VALUES * sizeof(short));
+    int result = values == NULL || int_parts == NULL || twelfths == NULL
+                 || romans == NULL || lengths == NULL;
+    if (result == 0) {
+        uint64_t state = 70;
+        size_t index = 0;
+        for (; index < NUMERUS_PACK_BLOCK_VALUES; index++) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            values[index] = (long) ((state >> 20)
+                                    % (2 * (NUMERUS_MAX_LONG_NONFLOAT_VALUE
+                                            * 12 + 11) + 1))
+                            - (NUMERUS_MAX_LONG_NONFLOAT_VALUE * 12 + 11);
+        }
+        for (; index < 2 * NUMERUS_PACK_BLOCK_VALUES; index++) {
+            values[index] = 42 * 12 + 5;
+        }
+        for (long year = 1900; year < 2100; year++) {
+            values[index++] = year * 12;
+        }
+        result = _num_test_pack_write(path, values, count);
+    } else {
+        fprintf(stderr, "Error allocating the values to pack\n");
+    }
+    if (result == 0) {
+        struct numerus_pack *pack = numerus_pack_open(path, &errcode);
+        if (pack == NULL || numerus_pack_value_count(pack) != count
+            || numerus_pack_block_count(pack) != 3) {
+            fprintf(stderr, "Error opening %s\n", path);
+            result = 1;
+        } else {
+            result = _num_test_pack_read(pack, values, expected_bits,
+                                         int_parts, twelfths, romans,
+                                         lengths);
+        }
+        numerus_pack_close(pack);
+    }
+    if (result == 0) {
+        /* Values of the last block beyond its max value, before the
+         * directory of 3 entries of 24 bytes ending the file */
+        FILE *file = fopen(path, "r+b");
+        fseek(file, -3 * 24 - 64, SEEK_END);
+        for (int i = 0; i < 32; i++) {
+            fputc(0xFF, file);
+        }
+        fclose(file);
+        struct numerus_pack *pack = numerus_pack_open(path, &errcode);
+        if (pack == NULL
+            || numerus_pack_decode_block(pack, 0, int_parts, twelfths)
+               != NUMERUS_PACK_BLOCK_VALUES
+            || numerus_pack_decode_block(pack, 2, int_parts, twelfths) != 0
+            || numerus_pack_decode_block_romans(
+                    pack, 2, romans, NUMERUS_MAX_LENGTH, lengths) != 0) {
+            fprintf(stderr, "Corrupted packed block decoded\n");
+            result = 1;
+        }
+        numerus_pack_close(pack);
+    }
+    free(values);
+    free(int_parts);
+    free(twelfths);
+    free(romans);
+    free(lengths);
+    if (result != 0) {
+        remove(path);
+        return result;
+    }
+#if defined(__linux__)
+    /* After a failed write, the appends keep failing without writing */
+    struct numerus_pack_writer *full = numerus_pack_writer_open("/dev/full",
+                                                                &errcode);
+    if (full != NULL) {
+        int append_errcode = NUMERUS_OK;
+        for (long i = 0; i < 3 * NUMERUS_PACK_BLOCK_VALUES; i++) {
+            append_errcode = numerus_pack_writer_append(
+                    full, i * 977 % NUMERUS_MAX_LONG_NONFLOAT_VALUE, 0);
+        }
+        if (append_errcode != NUMERUS_ERROR_PACK_FILE
+            || numerus_pack_writer_close(full) != NUMERUS_ERROR_PACK_FILE) {
+            fprintf(stderr, "Packed file written on a full device\n");
+            remove(path);
+            return 1;
+        }
+    }
+#endif
+    /* Truncated files and files of another kind are refused */
+    FILE *file = fopen(path, "r+b");
+    fseek(file, 0, SEEK_SET);
+    fputc('X', file);
+    fclose(file);
+    if (numerus_pack_open(path, &errcode) != NULL
+        || errcode != NUMERUS_ERROR_PACK_FILE
+        || numerus_pack_open("/nonexistent/numerus.pack", &errcode) != NULL
+        || errcode != NUMERUS_ERROR_PACK_FILE) {
+        fprintf(stderr, "Invalid packed file opened\n");
+        remove(path);
+        return 1;
+    }
+    remove(path);
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Verifies the numerals of the production workload against the parser and
+ * the mix of the preset, and that each numeral depends only on the seed and
+ * its number.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_production_workload(char *romans, long *int_parts,
+                                         short *twelfths, int *errcodes,
+                                         size_t count) {
+    struct numerus_workload workload;
+    numerus_workload_production(&workload, 2016);
+    if (numerus_workload_generate(&workload, 0, count, romans,
+                                  NUMERUS_WORKLOAD_MAX_LENGTH, int_parts,
+                                  twelfths, errcodes) != count) {
+        fprintf(stderr, "Production workload not generated\n");
+        return 1;
+    }
+    /* The expected values are the ones of the parser, with the mix asked */
+    size_t malformed = 0;
+    size_t years = 0;
+    size_t lowercase = 0;
+    for (size_t i = 0; i < count; i++) {
+        char *roman = romans + i * NUMERUS_WORKLOAD_MAX_LENGTH;
+        short parsed_twelfths;
+        int errcode;
+        long int_part = numerus_roman_to_int_part_and_twelfths(
+                roman, &parsed_twelfths, &errcode);
+        if (errcode != errcodes[i] || (errcode == NUMERUS_OK
+                                       && (int_part != int_parts[i]
+                                           || parsed_twelfths
+                                              != twelfths[i]))) {
+            fprintf(stderr, "Workload numeral %s expected as %ld, %d, %d\n",
+                    roman, int_parts[i], twelfths[i], errcodes[i]);
+            return 1;
+        }
+        malformed += errcode != NUMERUS_OK;
+        years += errcode == NUMERUS_OK && int_part >= 1900
+                 && int_part <= 2016;
+        for (char *c = roman; *c != '\0'; c++) {
+            if (islower((unsigned char) *c)) {
+                lowercase++;
+                break;
+            }
+        }
+    }
+    if (malformed < count * 15 / 1000 || malformed > count * 25 / 1000
+        || years < count / 2 || lowercase < count / 10) {
+        fprintf(stderr, "Production workload with %zu malformed numerals, "
+                        "%zu recent years and %zu lowercase ones\n",
+                malformed, years, lowercase);
+        return 1;
+    }
+    /* Each numeral depends only on the seed and its number */
+    char roman[NUMERUS_WORKLOAD_MAX_LENGTH];
+    for (size_t i = 0; i < count; i += 997) {
+        numerus_workload_generate(&workload, i, 1, roman, sizeof(roman),
+                                  NULL, NULL, NULL);
+        if (strcmp(roman, romans + i * NUMERUS_WORKLOAD_MAX_LENGTH) != 0) {
+            fprintf(stderr, "Workload numeral %zu generated as %s and %s\n",
+                    i, roman, romans + i * NUMERUS_WORKLOAD_MAX_LENGTH);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Verifies that each error the parsers give is injected exactly, even with
+ * noise, and that invalid workloads and arenas are refused.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_workload_errors(char *romans, int *errcodes) {
+    struct numerus_workload workload;
+    for (int code = NUMERUS_ERROR_GENERIC;
+         code < NUMERUS_ERROR_GENERIC + NUMERUS_WORKLOAD_ERRORS; code++) {
+        numerus_workload_uniform(&workload, (uint64_t) code);
+        workload.error_rates[code - NUMERUS_ERROR_GENERIC] = 1;
+        workload.lowercase_rate = 0.3;
+        workload.mixed_case_rate = 0.3;
+        workload.negative_rate = 0.5;
+        int injectable = code != NUMERUS_ERROR_GENERIC
+                         && code != NUMERUS_ERROR_VALUE_OUT_OF_RANGE
+                         && code != NUMERUS_ERROR_MALLOC_FAIL
+                         && code != NUMERUS_ERROR_NULL_ROMAN;
+        if ((numerus_workload_check(&workload) == NUMERUS_OK) != injectable) {
+            fprintf(stderr, "Workload injecting %d wrongly checked\n", code);
+            return 1;
+        }
+        if (!injectable) {
+            continue;
+        }
+        numerus_workload_generate(&workload, 0, 1000, romans,
+                                  NUMERUS_WORKLOAD_MAX_LENGTH, NULL, NULL,
+                                  errcodes);
+        for (size_t i = 0; i < 1000; i++) {
+            if (errcodes[i] != code) {
+                fprintf(stderr, "Workload numeral %s injected with %d, "
+                                "not %d\n",
+                        romans + i * NUMERUS_WORKLOAD_MAX_LENGTH, errcodes[i],
+                        code);
+                return 1;
+            }
+        }
+    }
+    numerus_workload_uniform(&workload, 0);
+    workload.kind_weights[NUMERUS_WORKLOAD_LONG] = -1;
+    if (numerus_workload_check(&workload) != NUMERUS_ERROR_WORKLOAD) {
+        fprintf(stderr, "Workload with a negative weight accepted\n");
+        return 1;
+    }
+    numerus_workload_uniform(&workload, 0);
+    workload.lowercase_rate = 0.6;
+    workload.mixed_case_rate = 0.6;
+    if (numerus_workload_check(&workload) != NUMERUS_ERROR_WORKLOAD) {
+        fprintf(stderr, "Workload with case rates over 1 accepted\n");
+        return 1;
+    }
+    numerus_workload_production(&workload, 0);
+    workload.whitespace_rate = 0.99;
+    if (numerus_workload_check(&workload) != NUMERUS_ERROR_WORKLOAD) {
+        fprintf(stderr, "Workload with whitespace and error rates over 1 "
+                        "accepted\n");
+        return 1;
+    }
+    numerus_workload_uniform(&workload, 0);
+    if (numerus_workload_generate(&workload, 0, 1, romans, NUMERUS_MAX_LENGTH,
+                                  NULL, NULL, NULL) != 0
+        || numerus_error_code != NUMERUS_ERROR_WORKLOAD) {
+        fprintf(stderr, "Workload generated into too small slots\n");
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Verifies that the files of a workload have the numerals of the arena, one
+ * per line, with their expected values.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_workload_files(char *romans, long *int_parts,
+                                    short *twelfths, int *errcodes) {
+    struct numerus_workload workload;
+    const char *tmpdir = getenv("TMPDIR");
+    char path[4096];
+    char expected_path[4096 + 16];
+    snprintf(path, sizeof(path), "%s/numerus_test.workload",
+             tmpdir == NULL ? "/tmp" : tmpdir);
+    snprintf(expected_path, sizeof(expected_path), "%s.expected", path);
+    numerus_workload_production(&workload, 75);
+    workload.whitespace_rate = 0.1;
+    numerus_workload_generate(&workload, 0, 100, romans,
+                              NUMERUS_WORKLOAD_MAX_LENGTH, int_parts,
+                              twelfths, errcodes);
+    if (numerus_workload_write_files(&workload, 100, path, expected_path)
+        != NUMERUS_OK) {
+        fprintf(stderr, "Error writing %s\n", path);
+        return 1;
+    }
+    FILE *file = fopen(path, "r");
+    FILE *expected_file = fopen(expected_path, "r");
+    char line[NUMERUS_WORKLOAD_MAX_LENGTH + 1];
+    int result = file == NULL || expected_file == NULL;
+    for (size_t i = 0; i < 100 && result == 0; i++) {
+        long int_part;
+        int line_twelfths;
+        int errcode;
+        if (fgets(line, sizeof(line), file) == NULL
+            || fscanf(expected_file, "%ld %d %d", &int_part, &line_twelfths,
+                      &errcode) != 3) {
+            fprintf(stderr, "Workload file %s too short\n", path);
+            result = 1;
+            break;
+        }
+        line[strcspn(line, "\n")] = '\0';
+        if (strcmp(line, romans + i * NUMERUS_WORKLOAD_MAX_LENGTH) != 0
+            || int_part != int_parts[i] || line_twelfths != twelfths[i]
+            || errcode != errcodes[i]
+            || ((line[0] == ' ' || line[0] == '\t')
+                && errcode == NUMERUS_OK)) {
+            fprintf(stderr, "Workload file line %zu: %s\n", i, line);
+            result = 1;
+        }
+    }
+    if (file != NULL) {
+        fclose(file);
+    }
+    if (expected_file != NULL) {
+        fclose(expected_file);
+    }
+    remove(path);
+    remove(expected_path);
+    if (result == 0
+        && numerus_workload_write_files(&workload, 1, "/nonexistent/workload",
+                                        NULL) != NUMERUS_ERROR_WORKLOAD) {
+        fprintf(stderr, "Workload written into a nonexistent directory\n");
+        result = 1;
+    }
+    return result;
+}
+
+
+/**
+ * Verifies that the workloads have the mix of their presets, with the
+ * expected values of the parser, that errors are injected exactly, that
+ * invalid workloads are refused and that the files hold the arena.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_workload() {
+    const size_t count = 20000;
+    char *romans = malloc(count * NUMERUS_WORKLOAD_MAX_LENGTH);
+    long *int_parts = malloc(count * sizeof(long));
+    short *twelfths = malloc(count * sizeof(short));
+    int *errcodes = malloc(count * sizeof(int));
+    int result = 1;
+    if (romans == NULL || int_parts == NULL || twelfths == NULL
+        || errcodes == NULL) {
+        fprintf(stderr, "Error allocating the workload\n");
+    } else {
+        result = _num_test_production_workload(romans, int_parts, twelfths,
+                                               errcodes, count)
+                 || _num_test_workload_errors(romans, errcodes)
+                 || _num_test_workload_files(romans, int_parts, twelfths,
+                                             errcodes);
+    }
+    free(romans);
+    free(int_parts);
+    free(twelfths);
+    free(errcodes);
+    return result;
+}
+
+
+/**
+ * @internal
+ * Writes the header of a table file into a sparse file of the size it
+ * declares, with an offset of value replaced if not 0.
+ *
+ * @returns 0 on success or 1 if the file can't be written.
+ */
+static int _num_test_write_sparse_table(const char *path,
+                                        const unsigned char *header,
+                                        size_t header_size, uint64_t file_size,
+                                        uint64_t offset_position,
+                                        uint32_t offset) {
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) {
+        return 1;
+    }
+    int failed = fwrite(header, 1, header_size, file) != header_size;
+    if (offset_position != 0) {
+        failed |= fseek(file, (long) offset_position, SEEK_SET) != 0
+                  || fwrite(&offset, sizeof(offset), 1, file) != 1;
+    }
+    failed |= fseek(file, (long) file_size - 1, SEEK_SET) != 0
+              || fputc(0, file) == EOF;
+    return fclose(file) != 0 || failed;
+}
+
+
+/**
+ * @internal
+ * Verifies on sparse copies of the header of a table file that a wrong
+ * layout is refused and that offsets pointing outside of the file are not
+ * followed.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_corrupt_table_file(const char *table_path) {
+    /* Header: magic, 4 uint32_t, offsets_start, hash_start, chars_start,
+     * file_size */
+    unsigned char header[56];
+    FILE *file = fopen(table_path, "rb");
+    if (file == NULL
+        || fread(header, 1, sizeof(header), file) != sizeof(header)) {
+        fprintf(stderr, "Error reading the header of %s\n", table_path);
+        if (file != NULL) {
+            fclose(file);
+        }
+        return 1;
+    }
+    fclose(file);
+    uint64_t offsets_start;
+    uint64_t file_size;
+    memcpy(&offsets_start, header + 24, sizeof(offsets_start));
+    memcpy(&file_size, header + 48, sizeof(file_size));
+    const char *tmpdir = getenv("TMPDIR");
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/numerus_test_corrupt.table",
+             tmpdir == NULL ? "/tmp" : tmpdir);
+    int errcode;
+    unsigned char shifted_header[sizeof(header)];
+    uint64_t shifted_offsets_start = offsets_start + sizeof(uint32_t);
+    memcpy(shifted_header, header, sizeof(header));
+    memcpy(shifted_header + 24, &shifted_offsets_start,
+           sizeof(shifted_offsets_start));
+    if (_num_test_write_sparse_table(path, shifted_header, sizeof(header),
+                                     file_size, 0, 0) != 0) {
+        fprintf(stderr, "Error writing %s\n", path);
+        remove(path);
+        return 1;
+    }
+    struct numerus_table *shifted = numerus_open_table_file(path, &errcode);
+    if (shifted != NULL || errcode != NUMERUS_ERROR_TABLE_FILE) {
+        fprintf(stderr, "Error refusing a table with shifted offsets\n");
+        numerus_close_table_file(shifted);
+        remove(path);
+        return 1;
+    }
+    /* The numeral of 1 ends past the end of the file */
+    if (_num_test_write_sparse_table(path, header, sizeof(header), file_size,
+                                     offsets_start + 13 * sizeof(uint32_t),
+                                     UINT32_MAX) != 0) {
+        fprintf(stderr, "Error writing %s\n", path);
+        remove(path);
+        return 1;
+    }
+    struct numerus_table *corrupt = numerus_open_table_file(path, &errcode);
+    char roman[NUMERUS_MAX_LENGTH];
+    short twelfths;
+    if (corrupt == NULL
+        || numerus_table_int_with_twelfth_to_roman_into(
+                corrupt, 1, 0, roman, &errcode) != 1
+        || errcode != NUMERUS_OK || strcmp(roman, "I") != 0
+        || numerus_table_roman_to_int_part_and_twelfths(
+                corrupt, roman, &twelfths, &errcode) != 1
+        || errcode != NUMERUS_OK) {
+        fprintf(stderr, "Error in conversions with a corrupt table\n");
+        numerus_close_table_file(corrupt);
+        remove(path);
+        return 1;
+    }
+    numerus_close_table_file(corrupt);
+    remove(path);
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Verifies that the table conversions agree with the computed ones on wrong
+ * numerals and on a sample of the values.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+static int _num_test_table_conversions(const struct numerus_table *table) {
+    int errcode;
+    char *wrong_numerals[] = {"nulla", "-NULLA", " XII", "xii", "MMMM",
+                              "_V_", "-_V_I", "IIII", "", NULL};
+    for (size_t i = 0; i < sizeof(wrong_numerals) / sizeof(char *); i++) {
+        int table_errcode;
+        short table_twelfths = 0;
+        short twelfths = 0;
+        long value = numerus_table_roman_to_int_part_and_twelfths(
+                table, wrong_numerals[i], &table_twelfths, &table_errcode);
+        if (value != numerus_roman_to_int_part_and_twelfths(
+                wrong_numerals[i], &twelfths, &errcode)
+            || table_errcode != errcode || table_twelfths != twelfths) {
+            fprintf(stderr, "Error in table conversion of %s\n",
+                    wrong_numerals[i] == NULL ? "NULL" : wrong_numerals[i]);
+            return 1;
+        }
+    }
+    for (long value = NUMERUS_MIN_LONG_NONFLOAT_VALUE - 1;
+         value <= NUMERUS_MAX_LONG_NONFLOAT_VALUE + 1; value += 997) {
+        for (short twelfths = -11; twelfths <= 11; twelfths += 4) {
+            char table_roman[64];
+            char roman[64];
+            int table_errcode;
+            short table_twelfths = 0;
+            short parsed_twelfths = 0;
+            numerus_table_int_with_twelfth_to_roman_into(
+                    table, value, twelfths, table_roman, &table_errcode);
+            numerus_int_with_twelfth_to_roman_into(value, twelfths, roman,
+                                                   &errcode);
+            long table_parsed = numerus_table_roman_to_int_part_and_twelfths(
+                    table, table_roman, &table_twelfths, &table_errcode);
+            long parsed = numerus_roman_to_int_part_and_twelfths(
+                    roman, &parsed_twelfths, &errcode);
+            if (strcmp(table_roman, roman) != 0 || table_parsed != parsed
+                || table_twelfths != parsed_twelfths
+                || table_errcode != errcode) {
+                fprintf(stderr, "Error in table conversion of %ld, %d\n",
+                        value, twelfths);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies that the table conversions agree with the computed ones, both
+ * without table file and, if the NUMERUS_TEST_TABLE_FILE environment
+ * variable contains the path of one, with it.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_table_file() {
+    int errcode;
+    struct numerus_table *missing = numerus_open_table_file(
+            "/nonexistent/numerus.table", &errcode);
+    if (missing != NULL || errcode != NUMERUS_ERROR_TABLE_FILE) {
+        fprintf(stderr, "Error opening a missing table file\n");
+        return 1;
+    }
+    const char *path = getenv("NUMERUS_TEST_TABLE_FILE");
+    struct numerus_table *table = path == NULL
+                                  ? NULL
+                                  : numerus_open_table_file(path, &errcode);
+    if (path != NULL && table == NULL) {
+        fprintf(stderr, "Error opening the table file %s\n", path);
+        return 1;
+    }
+    int result = (path != NULL && _num_test_corrupt_table_file(path) != 0)
+                 || _num_test_table_conversions(table) != 0;
+    numerus_close_table_file(table);
+    return result;
+}
+
+
+/**
+ * Verifies that the formatting functions writing into buffers give the same
+ * strings of the allocating ones, in buffers of the documented sizes.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_buffer_formatting() {
+    for (long value = NUMERUS_MIN_LONG_NONFLOAT_VALUE;
+         value <= NUMERUS_MAX_LONG_NONFLOAT_VALUE; value += 1009) {
+        short twelfths = (short) (value % 23 - 11);
+        char roman[NUMERUS_MAX_LENGTH];
+        char pretty_roman[NUMERUS_MAX_OVERLINED_LENGTH];
+        char pretty_value[NUMERUS_MAX_PRETTY_VALUE_LENGTH];
+        int errcode;
+        int into_errcode;
+        numerus_int_with_twelfth_to_roman_into(value, twelfths, roman,
+                                               &errcode);
+        char *expected_roman = numerus_overline_long_numerals(roman, &errcode);
+        short length = numerus_overline_long_numerals_into(roman, pretty_roman,
+                                                           &into_errcode);
+        char *expected_value = numerus_create_pretty_value_as_parts(value,
+                                                                    twelfths);
+        short value_length = numerus_pretty_value_as_parts_into(
+                value, twelfths, pretty_value);
+        int same = expected_roman != NULL && expected_value != NULL
+                   && errcode == into_errcode
+                   && strcmp(expected_roman, pretty_roman) == 0
+                   && length == (short) strlen(pretty_roman)
+                   && strcmp(expected_value, pretty_value) == 0
+                   && value_length == (short) strlen(pretty_value);
+        free(expected_roman);
+        free(expected_value);
+        if (!same) {
+            fprintf(stderr, "Error in buffer formatting of %ld, %d\n",
+                    value, twelfths);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies that the batch decoding gives the same values and error codes with
+ * each level of the SIMD kernels supported by the CPU, for valid numerals in
+ * any case and numerals with random mutations, in slots filled with roman
+ * chars after the '\0'.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_simd_levels() {
+    const size_t stride = 64;
+    const size_t count = 20000;
+    const char mutations[] = "_-.SsIiVvMmxX 0lNULLA\t";
+    char *romans = calloc(count * stride, sizeof(char));
+    long *expected_int_parts = malloc(count * sizeof(long));
+    short *expected_twelfths = malloc(count * sizeof(short));
+    int *expected_errcodes = malloc(count * sizeof(int));
+    long *int_parts = malloc(count * sizeof(long));
+    short *twelfths = malloc(count * sizeof(short));
+    int *errcodes = malloc(count * sizeof(int));
+    int initial_level = numerus_simd_level();
+    int result = 0;
+    srand(12);
+    for (size_t i = 0; i < count; i++) {
+        char *slot = romans + i * stride;
+        int errcode;
+        long value = rand() % (2 * NUMERUS_MAX_LONG_NONFLOAT_VALUE + 1)
+                     - NUMERUS_MAX_LONG_NONFLOAT_VALUE;
+        if (i % 2 == 0) {
+            value /= 1000;
+        }
+        for (size_t j = 0; j < stride; j++) {
+            slot[j] = mutations[rand() % (sizeof(mutations) - 1)];
+        }
+        numerus_int_with_twelfth_to_roman_into(
+                value, (short) (value < 0 ? -(rand() % 12) : rand() % 12),
+                slot, &errcode);
+        for (char *c = slot; *c != '\0'; c++) {
+            if (rand() % 3 == 0) {
+                *c = (char) tolower(*c);
+            }
+        }
+        for (int edits = rand() % 4; edits > 0; edits--) {
+            size_t length = strlen(slot);
+            size_t position = (size_t) rand() % (length + 1);
+            if (rand() % 2 == 0 && position < length) {
+                /* Deletions make many non-canonical numerals, like "IIV" */
+                memmove(slot + position, slot + position + 1,
+                        length - position);
+            } else if (length + 1 < stride) {
+                memmove(slot + position + 1, slot + position,
+                        length - position + 1);
+                slot[position] = mutations[rand() % (sizeof(mutations) - 1)];
+            }
+        }
+    }
+    numerus_set_simd_level(NUMERUS_SIMD_SCALAR);
+    numerus_roman_to_int_part_and_twelfths_batch(
+            romans, stride, count, expected_int_parts, expected_twelfths,
+            expected_errcodes);
+    for (int level = NUMERUS_SIMD_SSE41; level <= NUMERUS_SIMD_AVX512;
+         level++) {
+        if (numerus_set_simd_level(level) != level) {
+            break;
+        }
+        numerus_roman_to_int_part_and_twelfths_batch(
+                romans, stride, count, int_parts, twelfths, errcodes);
+        for (size_t i = 0; i < count && result == 0; i++) {
+            if (int_parts[i] != expected_int_parts[i]
+                || errcodes[i] != expected_errcodes[i]
+                || (errcodes[i] == NUMERUS_OK
+                    && twelfths[i] != expected_twelfths[i])) {
+                fprintf(stderr, "Error with SIMD level %d at %s\n",
+                        level, romans + i * stride);
+                result = 1;
+            }
+        }
+    }
+    numerus_set_simd_level(initial_level);
+    free(romans);
+    free(expected_int_parts);
+    free(expected_twelfths);
+    free(expected_errcodes);
+    free(int_parts);
+    free(twelfths);
+    free(errcodes);
+    return result;
+}
+
+
+/**
+ * Verifies that the functions of numerus_inline.h agree with the library
+ * ones: the encoders on the short values and a sample of the long ones, the
+ * short decoder on every short numeral, also in lowercase and with a wrong
+ * char appended, and the twelfths management on a grid of values.
+ *
+ * The build with the NUMERUS_INLINE_CHECK CMake option compares them on
+ * the whole range.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+int numtest_inline_functions() {
+    char roman[NUMERUS_MAX_LENGTH + 1];
+    char expected[NUMERUS_MAX_LENGTH];
+    const char extra_chars[] = "IVXLCDMS._- a";
+    int errcode;
+    int expected_errcode;
+    for (long value = NUMERUS_MIN_LONG_NONFLOAT_VALUE - 2;
+         value <= NUMERUS_MAX_LONG_NONFLOAT_VALUE + 2;
+         value += (value >= -5000 && value <= 5000) ? 1 : 997) {
+        short twelfths = (short) (value % 25 - 12);
+        short length = numerus_inline_int_with_twelfth_to_roman_into(
+                value, twelfths, roman, &errcode);
+        if (length != numerus_int_with_twelfth_to_roman_into(
+                value, twelfths, expected, &expected_errcode)
+            || errcode != expected_errcode || strcmp(roman, expected) != 0) {
+            fprintf(stderr, "Inline encoder differs at %ld, %d: %s != %s\n",
+                    value, twelfths, roman, expected);
+            return 1;
+        }
+    }
+    for (short value = -4000; value <= 4000; value++) {
+        numerus_int_to_roman_into(value, roman, NULL);
+        size_t length = strlen(roman);
+        for (size_t extra = 0; extra <= sizeof(extra_chars); extra++) {
+            if (extra == sizeof(extra_chars)) {
+                for (size_t i = 0; i < length; i++) {
+                    roman[i] = (char) tolower((unsigned char) roman[i]);
+                }
+            } else if (extra > 0) {
+                roman[length] = extra_chars[extra - 1];
+                roman[length + 1] = '\0';
+            }
+            short parsed = numerus_inline_roman_to_short_int(roman, &errcode);
+            if (parsed != numerus_roman_to_short_int(roman, &expected_errcode)
+                || errcode != expected_errcode) {
+                fprintf(stderr, "Inline short decoder differs at %s\n", roman);
+                return 1;
+            }
+            roman[length] = '\0';
+        }
+    }
+    for (long int_part = -5000; int_part <= 5000; int_part += 37) {
+        for (short twelfths = -40; twelfths <= 40; twelfths++) {
+            long shortened_int_part = int_part;
+            short shortened_twelfths = twelfths;
+            long expected_int_part = int_part;
+            short expected_twelfths = twelfths;
+            numerus_inline_shorten_and_same_sign_to_parts(
+                    &shortened_int_part, &shortened_twelfths);
+            numerus_shorten_and_same_sign_to_parts(&expected_int_part,
+                                                   &expected_twelfths);
+            double value = numerus_inline_parts_to_double(int_part, twelfths);
+            short split_twelfths;
+            short expected_split_twelfths;
+            long split = numerus_inline_double_to_parts(value / 7,
+                                                        &split_twelfths);
+            if (shortened_int_part != expected_int_part
+                || shortened_twelfths != expected_twelfths
+                || value != numerus_parts_to_double(int_part, twelfths)
+                || split != numerus_double_to_parts(value / 7,
+                                                    &expected_split_twelfths)
+                || split_twelfths != expected_split_twelfths) {
+                fprintf(stderr, "Inline parts functions differ at %ld, %d\n",
+                        int_part, twelfths);
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
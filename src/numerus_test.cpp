@@ -0,0 +1,761 @@
+/**
+ * @file numerus_test.cpp
+ * @brief Numerus test functions to verify the correctness of the C++ header.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains compile-time and runtime tests to verify that the C++
+ * header numerus.hpp behaves exactly like the C library. Tests are not nicely
+ * done and documented since are mostly used for internal testing of the
+ * library, not for public usage.
+ */
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <unordered_set>
+#include "numerus.hpp"
+#include "numerus_format.hpp"
+#include "numerus_pmr.hpp"
+#if defined(__cpp_lib_ranges)
+#include <string>
+#include <vector>
+#include "numerus_ranges.hpp"
+#endif
+#if defined(__cpp_lib_execution)
+#include <string>
+#include <vector>
+#include "numerus_parallel.hpp"
+#endif
+
+extern "C" {
+#include "numerus_internal.h"
+}
+
+using namespace numerus::literals;
+
+
+/* Compile-time conversions value -> roman */
+static_assert(numerus::int_to_roman(0) == "NULLA", "");
+static_assert(numerus::int_to_roman(14) == "XIV", "");
+static_assert(numerus::int_to_roman(-1999) == "-MCMXCIX", "");
+static_assert(numerus::int_to_roman(3999) == "MMMCMXCIX", "");
+static_assert(numerus::int_to_roman(4000) == "_IV_", "");
+static_assert(numerus::int_to_roman(3999999) == "_MMMCMXCIX_CMXCIX", "");
+static_assert(numerus::int_to_roman(4000000).empty(), "");
+static_assert(numerus::int_with_twelfth_to_roman(0, -7) == "-S.", "");
+static_assert(numerus::int_with_twelfth_to_roman(-3, 2) == "-IIS....", "");
+static_assert(numerus::int_with_twelfth_to_roman(-3888888, -11)
+              == "-_MMMDCCCLXXXVIII_DCCCLXXXVIIIS.....", "");
+static_assert(numerus::int_with_twelfth_to_roman(-3888888, -11).size()
+              == numerus::max_length - 1, "");
+
+/* Compile-time conversions roman -> value */
+static_assert("XIV"_roman == 14, "");
+static_assert("xiv"_roman == 14, "");
+static_assert("-nulla"_roman == 0, "");
+static_assert("MMMCMXCIX"_roman == 3999, "");
+static_assert("-_V_S"_roman == -5000.5, "");
+static_assert("_MMMCMXCIX_CMXCIXS....."_roman
+              == numerus::parts_to_double(3999999, 11), "");
+static_assert(numerus::roman_to_int("MMMM") == 3999999 + 10, "");
+
+/* Compile-time error codes */
+constexpr int errcode_of(std::string_view roman) {
+    int errcode = NUMERUS_OK;
+    numerus::roman_to_int(roman, &errcode);
+    return errcode;
+}
+static_assert(errcode_of("") == NUMERUS_ERROR_EMPTY_ROMAN, "");
+static_assert(errcode_of("XIV ") == NUMERUS_ERROR_WHITESPACE_CHARACTER, "");
+static_assert(errcode_of("-XVIFI") == NUMERUS_ERROR_ILLEGAL_CHARACTER, "");
+static_assert(errcode_of("MMMM") == NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS, "");
+static_assert(errcode_of("IVI") == NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "");
+static_assert(errcode_of("_MCMLI") == NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE,
+              "");
+static_assert(errcode_of("-_MCM_LI_") == NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART,
+              "");
+static_assert(errcode_of("CCX_II") == NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG, "");
+static_assert(errcode_of("_MCMS_LI") == NUMERUS_ERROR_DECIMALS_IN_LONG_PART, "");
+static_assert(errcode_of("--_MCM_LI") == NUMERUS_ERROR_ILLEGAL_MINUS, "");
+static_assert(errcode_of("_MCM_MLI") == NUMERUS_ERROR_M_IN_SHORT_PART, "");
+
+/* Compile-time grammar variants */
+template<typename Grammar>
+constexpr int grammar_errcode_of(std::string_view roman) {
+    int errcode = NUMERUS_OK;
+    numerus::roman_to_int<Grammar>(roman, &errcode);
+    return errcode;
+}
+static_assert(numerus::int_to_roman<numerus::clock_face_grammar>(4) == "IIII",
+              "");
+static_assert(numerus::int_to_roman<numerus::clock_face_grammar>(9) == "IX",
+              "");
+static_assert(numerus::int_to_roman<numerus::additive_grammar>(1999)
+              == "MDCCCCLXXXXVIIII", "");
+static_assert(numerus::int_to_roman<numerus::lenient_grammar>(4) == "IV", "");
+static_assert(numerus::int_with_twelfth_to_roman<numerus::additive_grammar>(
+        -3999999, -11).size() == numerus::max_grammar_length - 1, "");
+static_assert(sizeof(numerus::int_to_roman(1).chars) == 37, "");
+static_assert(sizeof(numerus::int_to_roman<numerus::additive_grammar>(1).chars)
+              == numerus::max_grammar_length, "");
+static_assert(numerus::roman_to_int<numerus::clock_face_grammar>("IIII") == 4,
+              "");
+static_assert(numerus::roman_to_int<numerus::additive_grammar>("VIIII") == 9,
+              "");
+static_assert(numerus::roman_to_int<numerus::lenient_grammar>("IV") == 4, "");
+static_assert(numerus::roman_to_int<numerus::lenient_grammar>("IIII") == 4, "");
+static_assert(grammar_errcode_of<numerus::clock_face_grammar>("IV")
+              == NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "");
+static_assert(grammar_errcode_of<numerus::clock_face_grammar>("VIIII")
+              == NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "");
+static_assert(grammar_errcode_of<numerus::clock_face_grammar>("LXXXX")
+              == NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "");
+static_assert(grammar_errcode_of<numerus::clock_face_grammar>("DCCCC")
+              == NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "");
+static_assert(grammar_errcode_of<numerus::clock_face_grammar>("_VIIII_")
+              == NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "");
+static_assert(grammar_errcode_of<numerus::clock_face_grammar>("XIIII")
+              == NUMERUS_OK, "");
+static_assert(grammar_errcode_of<numerus::clock_face_grammar>("VS....")
+              == NUMERUS_OK, "");
+static_assert(numerus::roman_to_int<numerus::lenient_grammar>("VIIII") == 9,
+              "");
+static_assert(grammar_errcode_of<numerus::additive_grammar>("IX")
+              == NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "");
+static_assert(grammar_errcode_of<numerus::lenient_grammar>("IIIII")
+              == NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS, "");
+static_assert(grammar_errcode_of<numerus::integer_grammar>("XS")
+              == NUMERUS_ERROR_ILLEGAL_CHARACTER, "");
+static_assert(numerus::int_with_twelfth_to_roman<numerus::integer_grammar>(
+        1, 6).empty(), "");
+
+
+/**
+ * Converts all possible values of roman numerals with both the C library
+ * functions and the `constexpr` ones evaluated at runtime, verifying that the
+ * results are identical.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_constexpr_against_c_library() {
+    long int_part;
+    short frac_part;
+    char *roman;
+    int errcode;
+    int cpp_errcode;
+    for (int_part = NUMERUS_MIN_LONG_NONFLOAT_VALUE;
+         int_part <= NUMERUS_MAX_LONG_NONFLOAT_VALUE; int_part++) {
+        for (frac_part = 0; frac_part < 12; frac_part++) {
+            frac_part = SIGN(int_part) * ABS(frac_part);
+            roman = numerus_int_with_twelfth_to_roman(int_part, frac_part,
+                                                      &errcode);
+            numerus::fixed_roman cpp_roman = numerus::int_with_twelfth_to_roman(
+                    int_part, frac_part, &cpp_errcode);
+            if (errcode != cpp_errcode || cpp_roman != roman) {
+                fprintf(stderr, "Mismatch converting %ld, %d: %s != %s\n",
+                        int_part, frac_part, roman, cpp_roman.c_str());
+                return 1;
+            }
+            short twelfths;
+            short cpp_twelfths;
+            long value = numerus_roman_to_int_part_and_twelfths(
+                    roman, &twelfths, &errcode);
+            long cpp_value = numerus::roman_to_int_part_and_twelfths(
+                    roman, &cpp_twelfths, &cpp_errcode);
+            if (errcode != cpp_errcode || value != cpp_value
+                || twelfths != cpp_twelfths) {
+                fprintf(stderr, "Mismatch converting %s: %ld, %d != %ld, %d\n",
+                        roman, value, twelfths, cpp_value, cpp_twelfths);
+                return 1;
+            }
+            frac_part = ABS(frac_part);
+            free(roman);
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies that the `constexpr` parser raises the same error codes of the C
+ * library for a series of numerals with wrong syntax.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_constexpr_syntax_errors() {
+    const char *romans[] = {
+        "-_MCM_XX_I", "-_MCM__I", "-MMCM-LI", "--_MCM_LI", "MMMCMLCI",
+        "MMMCMLIIIX", "MMMCMLIII.S", "-XVI,.", "MMCCCC", "MMDD", "MMCMD",
+        "MMSS", "MM......", "-_MCMLI", "_MCM.._LI", "_MCMs.._LI", "-CCX_II",
+        "  XIV", " -nulla", "\tX\n", "_IIII_", NULL
+    };
+    for (const char **roman = romans; *roman != NULL; roman++) {
+        char writable[64];
+        int errcode;
+        int cpp_errcode;
+        strcpy(writable, *roman);
+        numerus_roman_to_int(writable, &errcode);
+        numerus::roman_to_int(*roman, &cpp_errcode);
+        if (errcode != cpp_errcode) {
+            fprintf(stderr, "Mismatch parsing %s: %s != %s\n", *roman,
+                    numerus_explain_error(errcode),
+                    numerus_explain_error(cpp_errcode));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/* Compile-time roman value type */
+static_assert(std::is_trivially_copyable_v<numerus::roman>, "");
+static_assert(numerus::roman().view() == "NULLA", "");
+static_assert(numerus::roman(14).view() == "XIV", "");
+static_assert(numerus::roman(-3, 2).view() == "-IIS....", "");
+static_assert(numerus::roman(-3, 2).int_part() == -2, "");
+static_assert(numerus::roman(-3, 2).twelfths() == -10, "");
+static_assert(numerus::roman("xiv") == numerus::roman(14), "");
+static_assert(numerus::roman("MMMCMXCIX") + 1 == numerus::roman("_IV_"), "");
+static_assert((numerus::roman("S") * 3).view() == "IS", "");
+static_assert((numerus::roman(7) / 2).view() == "IIIS", "");
+static_assert((-numerus::roman("_V_")).view() == "-_V_", "");
+static_assert(numerus::roman("IX") < numerus::roman("X"), "");
+static_assert(numerus::roman("-I") < numerus::roman("-S"), "");
+
+
+/**
+ * Verifies the runtime behaviour of the numerus::roman value type: hashing,
+ * errors and conversions from doubles.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_roman_value_type() {
+    std::unordered_set<numerus::roman> romans;
+    for (long value = -4000; value <= 4000; value++) {
+        romans.insert(numerus::roman(value));
+    }
+    if (romans.size() != 8001 || romans.count(numerus::roman("MMXVI")) != 1) {
+        fprintf(stderr, "Error hashing romans.\n");
+        return 1;
+    }
+    if (numerus::roman(12.08333).view() != "XII.") {
+        fprintf(stderr, "Error creating roman from double.\n");
+        return 1;
+    }
+    try {
+        numerus::roman("MMMM");
+        fprintf(stderr, "Error: invalid numeral accepted.\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS) {
+            fprintf(stderr, "Error: wrong error code %d.\n", error.code());
+            return 1;
+        }
+    }
+    try {
+        numerus::roman(NUMERUS_MAX_LONG_NONFLOAT_VALUE) + 1;
+        fprintf(stderr, "Error: out of range value accepted.\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+            fprintf(stderr, "Error: wrong error code %d.\n", error.code());
+            return 1;
+        }
+    }
+    /* Products beyond the range, also overflowing a long long */
+    const long factors[] = {1001, -4000000, 1L << 40, LONG_MAX, LONG_MIN};
+    for (long factor : factors) {
+        try {
+            numerus::roman(3999) * factor;
+            fprintf(stderr, "Error: product by %ld accepted.\n", factor);
+            return 1;
+        } catch (const numerus::error &error) {
+            if (error.code() != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+                fprintf(stderr, "Error: wrong error code %d.\n",
+                        error.code());
+                return 1;
+            }
+        }
+    }
+    if (numerus::roman(3999) * 1000 != numerus::roman(3999000)
+        || numerus::roman() * LONG_MAX != numerus::roman()) {
+        fprintf(stderr, "Error multiplying romans.\n");
+        return 1;
+    }
+    try {
+        numerus::roman(static_cast<const char *>(nullptr));
+        fprintf(stderr, "Error: NULL numeral accepted.\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_NULL_ROMAN) {
+            fprintf(stderr, "Error: wrong error code %d.\n", error.code());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies the output of the roman numerals formatters with all the format
+ * specifications, if {fmt} is available.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_formatters() {
+#if defined(FMT_VERSION)
+    std::string formatted = fmt::format(
+            "{:R} {:r} {:tR} {:uR} {:oR} {} {:r} {}",
+            numerus::as_roman(2016), numerus::as_roman(2016),
+            numerus::as_roman(30), numerus::as_roman(12000),
+            numerus::as_roman(-12000), numerus::as_roman(0),
+            numerus::roman("_iv_ix"), numerus::as_roman(-2.5));
+    if (formatted != "MMXVI mmxvi IIS X\u0305I\u0305I\u0305  ___\n-XII "
+                     "NULLA _iv_ix -IIS") {
+        fprintf(stderr, "Error formatting romans: %s\n", formatted.c_str());
+        return 1;
+    }
+#endif
+    return 0;
+}
+
+
+/**
+ * Verifies the lazy range adaptors against the single conversions, if the
+ * standard library supports ranges.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_range_adaptors() {
+#if defined(__cpp_lib_ranges)
+    long expected = -5000;
+    for (const numerus::roman &roman
+            : std::views::iota(-5000L, 5000L) | numerus::views::to_roman) {
+        if (roman != numerus::roman(expected)) {
+            fprintf(stderr, "Error in to_roman at %ld\n", expected);
+            return 1;
+        }
+        expected++;
+    }
+    std::vector<std::string> lines = {
+        "XIV", "bad", "mmxvi", "-_V_S", std::string(60, ' ') + "NULLA"
+    };
+    std::string joined;
+    for (const numerus::roman &roman : lines | numerus::views::valid_numerals) {
+        joined += roman.view();
+        joined += ' ';
+    }
+    if (joined != "XIV MMXVI -_V_S NULLA ") {
+        fprintf(stderr, "Error in valid_numerals: %s\n", joined.c_str());
+        return 1;
+    }
+    joined.clear();
+    try {
+        for (const numerus::roman &roman : lines | numerus::views::from_roman) {
+            joined += roman.view();
+        }
+        fprintf(stderr, "Error: from_roman accepted invalid numerals.\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (joined != "XIV" || error.code() != NUMERUS_ERROR_ILLEGAL_CHARACTER) {
+            fprintf(stderr, "Error in from_roman: %s\n", joined.c_str());
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
+
+
+/**
+ * Verifies the parallel bulk conversions against the single conversions, if
+ * the standard library supports the execution policies.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_parallel_conversions() {
+#if defined(__cpp_lib_execution)
+    std::vector<double> values;
+    for (long value = NUMERUS_MIN_LONG_NONFLOAT_VALUE;
+         value <= NUMERUS_MAX_LONG_NONFLOAT_VALUE; value += 7) {
+        values.push_back(value + (value % 12) / 12.0);
+    }
+    numerus::roman_arena arena;
+    std::vector<numerus::roman> romans(values.size());
+    numerus::transform_to_roman(std::execution::par_unseq, values.begin(),
+                                values.end(), arena);
+    numerus::transform_to_roman(std::execution::par, values.begin(),
+                                values.end(), romans.begin());
+    std::size_t bytes = 0;
+    for (std::size_t i = 0; i < values.size(); i++) {
+        numerus::roman expected(values[i]);
+        if (arena[i] != expected.view() || romans[i] != expected) {
+            fprintf(stderr, "Error in transform_to_roman at %f\n", values[i]);
+            return 1;
+        }
+        bytes += expected.size() + 1;
+    }
+    if (arena.bytes() != bytes) {
+        fprintf(stderr, "Error: arena of %zu bytes instead of %zu\n",
+                arena.bytes(), bytes);
+        return 1;
+    }
+    std::vector<numerus::roman> decoded(values.size());
+    numerus::transform_from_roman(std::execution::par, romans.begin(),
+                                  romans.end(), decoded.begin());
+    if (decoded != romans) {
+        fprintf(stderr, "Error in transform_from_roman\n");
+        return 1;
+    }
+    std::vector<std::string> lines(1000, "mmxvi");
+    lines[700] = "IIII";
+    lines[900] = "bad";
+    try {
+        numerus::transform_from_roman(std::execution::par, lines.begin(),
+                                      lines.end(), decoded.begin());
+        fprintf(stderr, "Error: transform_from_roman accepted IIII\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS
+            || decoded[699] != numerus::roman(2016)) {
+            fprintf(stderr, "Error in transform_from_roman error handling\n");
+            return 1;
+        }
+    }
+    values.push_back(NUMERUS_MAX_VALUE + 1);
+    try {
+        numerus::transform_to_roman(std::execution::par, values.begin(),
+                                    values.end(), arena);
+        fprintf(stderr, "Error: transform_to_roman accepted out of range\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_VALUE_OUT_OF_RANGE
+            || !arena.empty()) {
+            fprintf(stderr, "Error in transform_to_roman error handling\n");
+            return 1;
+        }
+    }
+#endif
+    return 0;
+}
+
+
+/**
+ * Verifies that the conversions with a memory resource allocate the numerals
+ * only from it.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_memory_resources() {
+    char buffer[256];
+    std::pmr::monotonic_buffer_resource request(
+            buffer, sizeof(buffer), std::pmr::null_memory_resource());
+    std::string_view year = numerus::pmr::int_to_roman(2016, &request);
+    std::string_view half = numerus::pmr::double_to_roman(-0.5, &request);
+    std::pmr::string text = numerus::pmr::to_string(numerus::roman(14),
+                                                    &request);
+    if (year != "MMXVI" || half != "-S" || text != "XIV"
+        || year.data() < buffer || year.data() >= buffer + sizeof(buffer)
+        || year.data()[year.size()] != '\0') {
+        fprintf(stderr, "Error in the conversions with memory resource\n");
+        return 1;
+    }
+    try {
+        numerus::pmr::int_with_twelfth_to_roman(4000000, 0, &request);
+        fprintf(stderr, "Error: memory resource accepted out of range\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+            fprintf(stderr, "Error in the out of range error code\n");
+            return 1;
+        }
+    }
+    try {
+        for (int i = 0; i < 100; i++) {
+            numerus::pmr::int_to_roman(3888, &request);
+        }
+        fprintf(stderr, "Error: exhausted memory resource didn't throw\n");
+        return 1;
+    } catch (const std::bad_alloc &) {
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies the conversions specialised for each kind of numerals against the
+ * general ones.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_numeral_kinds() {
+    for (short value = NUMERUS_MIN_SHORT_VALUE;
+         value <= NUMERUS_MAX_SHORT_VALUE; value++) {
+        numerus::fixed_roman numeral =
+                numerus::to_roman<numerus::short_numeral>(value);
+        if (numeral != numerus::int_to_roman(value)
+            || numerus::from_roman<numerus::short_numeral>(numeral) != value
+            || numerus::from_roman<numerus::long_numeral>(numeral) != value) {
+            fprintf(stderr, "Error in short numeral %d\n", value);
+            return 1;
+        }
+    }
+    if (numerus::to_roman<numerus::long_numeral>(-12000) != "-_XII_"
+        || numerus::to_roman<numerus::float_numeral>(0.5) != "S"
+        || numerus::from_roman<numerus::float_numeral>("IIS") != 2.5
+        || numerus::from_roman<numerus::short_numeral>(" nulla") != 0) {
+        fprintf(stderr, "Error in long or float numerals\n");
+        return 1;
+    }
+    const char *outside_domain[] = {"_V_", "XS", "-_V_", "IIII", "XIV "};
+    const int expected_errcodes[] = {
+        NUMERUS_ERROR_VALUE_OUT_OF_RANGE, NUMERUS_ERROR_VALUE_OUT_OF_RANGE,
+        NUMERUS_ERROR_VALUE_OUT_OF_RANGE, NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS,
+        NUMERUS_ERROR_WHITESPACE_CHARACTER
+    };
+    for (int i = 0; i < 5; i++) {
+        try {
+            numerus::from_roman<numerus::short_numeral>(outside_domain[i]);
+            fprintf(stderr, "Error: accepted %s\n", outside_domain[i]);
+            return 1;
+        } catch (const numerus::error &error) {
+            if (error.code() != expected_errcodes[i]) {
+                fprintf(stderr, "Error code %d for %s\n", error.code(),
+                        outside_domain[i]);
+                return 1;
+            }
+        }
+    }
+    /* Wider values are refused, not truncated to a short */
+    char roman[NUMERUS_MAX_LENGTH];
+    int errcode;
+    if (numerus_short_int_to_roman_into(65537, roman, &errcode) != -1
+        || errcode != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+        fprintf(stderr, "Short numeral of a truncated value\n");
+        return 1;
+    }
+    try {
+        numerus::to_roman<numerus::short_numeral>(65537);
+        fprintf(stderr, "Error: short numeral accepted 65537\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+            fprintf(stderr, "Error code %d for 65537\n", error.code());
+            return 1;
+        }
+    }
+    try {
+        numerus::to_roman<numerus::short_numeral>(4000);
+        fprintf(stderr, "Error: short numeral accepted 4000\n");
+        return 1;
+    } catch (const numerus::error &error) {
+        if (error.code() != NUMERUS_ERROR_VALUE_OUT_OF_RANGE) {
+            fprintf(stderr, "Error code %d for 4000\n", error.code());
+            return 1;
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Converts values to roman numerals and back with each variant of the
+ * grammar, verifying that the lenient grammar accepts all of them.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+template<typename Grammar>
+static int numtest_cpp_grammar_encode_decode(const char *name) {
+    short max_twelfths = Grammar::has_twelfths ? 11 : 0;
+    for (long value = -NUMERUS_MAX_LONG_NONFLOAT_VALUE;
+         value <= NUMERUS_MAX_LONG_NONFLOAT_VALUE;
+         value += (value > -5000 && value < 5000) ? 1 : 37) {
+        for (short twelfths = 0; twelfths <= max_twelfths; twelfths += 5) {
+            int errcode;
+            int lenient_errcode;
+            short parsed_twelfths;
+            short signed_twelfths = value < 0 ? -twelfths : twelfths;
+            numerus::fixed_roman_of<Grammar> numeral =
+                    numerus::int_with_twelfth_to_roman<Grammar>(
+                            value, signed_twelfths);
+            long parsed = numerus::roman_to_int_part_and_twelfths<Grammar>(
+                    numeral, &parsed_twelfths, &errcode);
+            long lenient = numerus::roman_to_int_part_and_twelfths<
+                    numerus::lenient_grammar>(numeral, nullptr,
+                                              &lenient_errcode);
+            if (parsed != value || lenient != value
+                || errcode != NUMERUS_OK || lenient_errcode != NUMERUS_OK
+                || parsed_twelfths != signed_twelfths) {
+                fprintf(stderr, "Error in %s grammar at %ld, %d: %s\n",
+                        name, value, twelfths, numeral.c_str());
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * @internal
+ * Every spelling of a decade with "I", "V" and "X" in any of the grammars,
+ * canonical or not.
+ */
+static const char *const _NUM_TEST_DECADE_SPELLINGS[] = {
+    "", "I", "II", "III", "IIII", "IV", "V", "VI", "VII", "VIII", "VIIII", "IX"
+};
+
+
+/**
+ * @internal
+ * Twelfths with up to 6 dots, canonical or not.
+ */
+static const char *const _NUM_TEST_TWELFTHS_SPELLINGS[] = {
+    "", ".", "..", "...", "....", ".....", "......",
+    "S", "S.", "S..", "S...", "S....", "S.....", "S......"
+};
+
+
+/**
+ * @internal
+ * Appends the spelling of a decade written with the given chars for one,
+ * five and ten instead of "I", "V" and "X".
+ */
+static void _num_test_append_decade(std::string &numeral, const char *spelling,
+                                    const char *one_five_ten) {
+    for (; *spelling != '\0'; spelling++) {
+        numeral += one_five_ten[*spelling == 'I' ? 0 : *spelling == 'V' ? 1
+                                                                      : 2];
+    }
+}
+
+
+/**
+ * @internal
+ * Writes the integer numeral made of up to 3 "M" and one spelling per
+ * decade, with the index in [0, 4 * 12^3[ choosing them.
+ */
+static std::string _num_test_integer_spelling(std::size_t index) {
+    const std::size_t spellings = sizeof(_NUM_TEST_DECADE_SPELLINGS)
+                                  / sizeof(_NUM_TEST_DECADE_SPELLINGS[0]);
+    std::string numeral(index / (spellings * spellings * spellings), 'M');
+    _num_test_append_decade(
+            numeral, _NUM_TEST_DECADE_SPELLINGS[index / spellings / spellings
+                                                % spellings], "CDM");
+    _num_test_append_decade(
+            numeral, _NUM_TEST_DECADE_SPELLINGS[index / spellings % spellings],
+            "XLC");
+    _num_test_append_decade(
+            numeral, _NUM_TEST_DECADE_SPELLINGS[index % spellings], "IVX");
+    return numeral;
+}
+
+
+/**
+ * @internal
+ * Decodes a candidate numeral with the grammar and, if accepted, encodes the
+ * value back. A canonical grammar must write the same numeral, as each value
+ * has a single accepted numeral; the lenient one must write a numeral of the
+ * same value.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+template<typename Grammar>
+static int _num_test_decode_encode(const std::string &candidate,
+                                   bool canonical, const char *name) {
+    int errcode;
+    short twelfths;
+    long value = numerus::roman_to_int_part_and_twelfths<Grammar>(
+            candidate, &twelfths, &errcode);
+    if (errcode != NUMERUS_OK
+        || (candidate[0] == '_' && std::labs(value) < 4000)) {
+        return 0;
+    }
+    numerus::fixed_roman_of<Grammar> numeral =
+            numerus::int_with_twelfth_to_roman<Grammar>(value, twelfths);
+    short parsed_twelfths;
+    long parsed = numerus::roman_to_int_part_and_twelfths<Grammar>(
+            numeral, &parsed_twelfths, &errcode);
+    if ((canonical && candidate != numeral.c_str())
+        || parsed != value || parsed_twelfths != twelfths
+        || errcode != NUMERUS_OK) {
+        fprintf(stderr, "Error in %s grammar: %s accepted as %s\n",
+                name, candidate.c_str(), numeral.c_str());
+        return 1;
+    }
+    return 0;
+}
+
+
+/**
+ * Decodes every spelling of the short numerals with any decade and twelfths
+ * written in any grammar, and a sample of the long ones, verifying that the
+ * accepted ones are written back unchanged by the canonical grammars, so the
+ * non-canonical spellings are rejected.
+ *
+ * Long parts below 4000, like "_I_", are accepted by every grammar as by the
+ * C library and are skipped.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+template<typename Grammar>
+static int numtest_cpp_grammar_decode_encode(bool canonical,
+                                             const char *name) {
+    const std::size_t integers = 4 * 12 * 12 * 12;
+    const std::size_t twelfths = sizeof(_NUM_TEST_TWELFTHS_SPELLINGS)
+                                 / sizeof(_NUM_TEST_TWELFTHS_SPELLINGS[0]);
+    for (std::size_t i = 1; i < integers * twelfths; i++) {
+        std::string candidate = _num_test_integer_spelling(i / twelfths)
+                                + _NUM_TEST_TWELFTHS_SPELLINGS[i % twelfths];
+        if (_num_test_decode_encode<Grammar>(candidate, canonical, name)
+            || _num_test_decode_encode<Grammar>("-" + candidate, canonical,
+                                                name)) {
+            return 1;
+        }
+    }
+    for (std::size_t i = 1; i < integers; i += 7) {
+        for (std::size_t j = i % 97; j < integers; j += 97) {
+            std::string candidate = "_" + _num_test_integer_spelling(i) + "_"
+                                    + _num_test_integer_spelling(j).substr(
+                                            j / (12 * 12 * 12));
+            if (_num_test_decode_encode<Grammar>(candidate, canonical, name)) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+/**
+ * Verifies the variants of the grammar with round trips of many values.
+ *
+ * @returns 0 on success or outputs any error on stderr and returns 1.
+ */
+extern "C" int numtest_cpp_grammar_variants() {
+    return numtest_cpp_grammar_encode_decode<numerus::standard_grammar>(
+                   "standard")
+           | numtest_cpp_grammar_encode_decode<numerus::clock_face_grammar>(
+                   "clock face")
+           | numtest_cpp_grammar_encode_decode<numerus::additive_grammar>(
+                   "additive")
+           | numtest_cpp_grammar_encode_decode<numerus::lenient_grammar>(
+                   "lenient")
+           | numtest_cpp_grammar_encode_decode<numerus::integer_grammar>(
+                   "integer")
+           | numtest_cpp_grammar_decode_encode<numerus::standard_grammar>(
+                   true, "standard")
+           | numtest_cpp_grammar_decode_encode<numerus::clock_face_grammar>(
+                   true, "clock face")
+           | numtest_cpp_grammar_decode_encode<numerus::additive_grammar>(
+                   true, "additive")
+           | numtest_cpp_grammar_decode_encode<numerus::lenient_grammar>(
+                   false, "lenient")
+           | numtest_cpp_grammar_decode_encode<numerus::integer_grammar>(
+                   true, "integer");
+}
@@ -12,12 +12,33 @@
  */
 
 int  numtest_convert_all_floats_with_doubles();
-void numtest_roman_syntax_errors();
+int  numtest_roman_syntax_errors();
 int  numtest_convert_all_integers_with_parts();
 int  numtest_convert_all_integers_with_doubles();
 int  numtest_convert_all_floats_with_parts();
 void numtest_parts_to_from_double_functions();
-void numtest_null_handling_conversions();
-void numtest_null_handling_utils();
+int  numtest_null_handling_conversions();
+int  numtest_null_handling_utils();
 int  numtest_pretty_print_all_numerals();
 int  numtest_pretty_print_all_values();
+int  numtest_iterator();
+int  numtest_enumerate();
+int  numtest_extended_range();
+int  numtest_date_format();
+int  numtest_suggest();
+int  numtest_complete();
+int  numtest_pack();
+int  numtest_workload();
+int  numtest_table_file();
+int  numtest_buffer_formatting();
+int  numtest_simd_levels();
+int  numtest_inline_functions();
+int  numtest_cpp_constexpr_against_c_library();
+int  numtest_cpp_constexpr_syntax_errors();
+int  numtest_cpp_roman_value_type();
+int  numtest_cpp_formatters();
+int  numtest_cpp_range_adaptors();
+int  numtest_cpp_parallel_conversions();
+int  numtest_cpp_memory_resources();
+int  numtest_cpp_numeral_kinds();
+int  numtest_cpp_grammar_variants();
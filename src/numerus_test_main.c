@@ -0,0 +1,120 @@
+/**
+ * @file numerus_test_main.c
+ * @brief Numerus runner of the test functions.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Runs the test functions of numerus_test.h. CTest runs each of them as its
+ * own test, passing its name as argument.
+ *
+ * Usage: `numerus_test [--exhaustive] [NAME]...`
+ *
+ * Without names all the tests are run, except the exhaustive ones converting
+ * every value of the range, which take minutes and are run only with
+ * `--exhaustive` or when named.
+ */
+
+#include <stdio.h>   /* For `fprintf()` */
+#include <string.h>  /* For `strcmp()` */
+#include "numerus_internal.h"
+
+
+/**
+ * @internal
+ * A test function with its name and whether it converts the whole range.
+ */
+struct _num_test {
+    const char *name;
+    int (*function)();
+    short exhaustive;
+};
+
+
+static const struct _num_test _NUM_TESTS[] = {
+    {"convert_all_floats_with_parts", numtest_convert_all_floats_with_parts, 1},
+    {"convert_all_floats_with_doubles",
+            numtest_convert_all_floats_with_doubles, 1},
+    {"convert_all_integers_with_parts",
+            numtest_convert_all_integers_with_parts, 1},
+    {"convert_all_integers_with_doubles",
+            numtest_convert_all_integers_with_doubles, 1},
+    {"pretty_print_all_numerals", numtest_pretty_print_all_numerals, 1},
+    {"pretty_print_all_values", numtest_pretty_print_all_values, 1},
+    {"roman_syntax_errors", numtest_roman_syntax_errors, 0},
+    {"null_handling_conversions", numtest_null_handling_conversions, 0},
+    {"null_handling_utils", numtest_null_handling_utils, 0},
+    {"iterator", numtest_iterator, 0},
+    {"enumerate", numtest_enumerate, 0},
+    {"extended_range", numtest_extended_range, 0},
+    {"date_format", numtest_date_format, 0},
+    {"suggest", numtest_suggest, 0},
+    {"complete", numtest_complete, 0},
+    {"pack", numtest_pack, 0},
+    {"workload", numtest_workload, 0},
+    {"table_file", numtest_table_file, 0},
+    {"buffer_formatting", numtest_buffer_formatting, 0},
+    {"simd_levels", numtest_simd_levels, 0},
+    {"inline_functions", numtest_inline_functions, 0},
+    {"cpp_constexpr_against_c_library",
+            numtest_cpp_constexpr_against_c_library, 1},
+    {"cpp_constexpr_syntax_errors", numtest_cpp_constexpr_syntax_errors, 0},
+    {"cpp_roman_value_type", numtest_cpp_roman_value_type, 0},
+    {"cpp_formatters", numtest_cpp_formatters, 0},
+    {"cpp_range_adaptors", numtest_cpp_range_adaptors, 0},
+    {"cpp_parallel_conversions", numtest_cpp_parallel_conversions, 0},
+    {"cpp_memory_resources", numtest_cpp_memory_resources, 0},
+    {"cpp_numeral_kinds", numtest_cpp_numeral_kinds, 0},
+    {"cpp_grammar_variants", numtest_cpp_grammar_variants, 0},
+    {NULL, NULL, 0}
+};
+
+
+/**
+ * @internal
+ * Runs a test function, reporting its failure on stderr.
+ *
+ * @returns 0 on success or 1 if the test failed.
+ */
+static int _num_run_test(const struct _num_test *test) {
+    if (test->function() != 0) {
+        fprintf(stderr, "Test %s FAILED\n", test->name);
+        return 1;
+    }
+    printf("Test %s passed\n", test->name);
+    return 0;
+}
+
+
+int main(int argc, char **args) {
+    const struct _num_test *test;
+    int exhaustive = 0;
+    int named = 0;
+    int failures = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(args[i], "--exhaustive") == 0) {
+            exhaustive = 1;
+            continue;
+        }
+        for (test = _NUM_TESTS; test->name != NULL; test++) {
+            if (strcmp(args[i], test->name) == 0) {
+                break;
+            }
+        }
+        if (test->name == NULL) {
+            fprintf(stderr, "Unknown test: %s\n", args[i]);
+            return 1;
+        }
+        failures += _num_run_test(test);
+        named = 1;
+    }
+    if (!named) {
+        for (test = _NUM_TESTS; test->name != NULL; test++) {
+            if (exhaustive || !test->exhaustive) {
+                failures += _num_run_test(test);
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -264,19 +264,46 @@ short numerus_sign(char *roman, int *errcode) {
  * @returns short with the number of roman characters excluding underscores.
  */
 short numerus_count_roman_chars(char *roman, int *errcode) {
-    _num_headtrim_check_numeral_and_errcode(&roman, &errcode);
-    if (*errcode != NUMERUS_OK) {
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    short count = _num_count_roman_chars(roman, errcode);
+    numerus_error_code = *errcode;
+    return count;
+}
+
+
+/**
+ * Counts the number of roman characters in a roman numeral, like
+ * numerus_count_roman_chars(), without touching numerus_error_code.
+ *
+ * Being re-entrant, it's the one used by the conversions that may run on
+ * multiple threads at once.
+ *
+ * @param *roman string containing the roman numeral.
+ * @param *errcode int where to store the analysis status: NUMERUS_OK or any
+ * other error. Can NOT be NULL.
+ * @returns short with the number of roman characters excluding underscores.
+ */
+short _num_count_roman_chars(char *roman, int *errcode) {
+    if (roman == NULL) {
+        *errcode = NUMERUS_ERROR_NULL_ROMAN;
+        return -1;
+    }
+    while (isspace(*roman)) {
+        roman++;
+    }
+    if (*roman == '\0') {
+        *errcode = NUMERUS_ERROR_EMPTY_ROMAN;
         return -1;
     }
     if (_num_is_zero(roman)) {
-        numerus_error_code = NUMERUS_OK;
         *errcode = NUMERUS_OK;
         return (short) strlen(NUMERUS_ZERO);
     }
     short i = 0;
     while (*roman != '\0') {
         if (i > NUMERUS_MAX_LENGTH) {
-            numerus_error_code = NUMERUS_ERROR_TOO_LONG_NUMERAL;
             *errcode = NUMERUS_ERROR_TOO_LONG_NUMERAL;
             return -2;
         }
@@ -301,18 +328,15 @@ short numerus_count_roman_chars(char *roman, int *errcode) {
             }
             default: {
                 if (isspace(*roman)) {
-                    numerus_error_code = NUMERUS_ERROR_WHITESPACE_CHARACTER;
                     *errcode = NUMERUS_ERROR_WHITESPACE_CHARACTER;
                     return -3;
                 } else {
-                    numerus_error_code = NUMERUS_ERROR_ILLEGAL_CHARACTER;
                     *errcode = NUMERUS_ERROR_ILLEGAL_CHARACTER;
                     return -4;
                 }
             }
         }
     }
-    numerus_error_code = NUMERUS_OK;
     *errcode = NUMERUS_OK;
     return i;
 }
@@ -379,45 +403,13 @@ short numerus_compare_value(char *roman_bigger, char *roman_smaller, int *errcod
 
 
 /**
- * Analyzes how many chars are necessary to allocate the first line of the
- * pretty-printing version of a long roman numeral without security checks.
- *
- * It has to be used after the roman numeral has been already checked with
- * numerus_count_roman_chars() to prevent any errors.
- */
-static size_t _num_overlining_alloc_size(char *roman) {
-    size_t alloc_size_to_add = 0;
-    char *first_underscore = NULL;
-    char *second_underscore = NULL;
-    while (second_underscore == NULL && *roman != '\0') {
-        if (*roman == '_') {
-            if (first_underscore == NULL) {
-                first_underscore = roman;
-            } else {
-                second_underscore = roman;
-            }
-        } else {
-            alloc_size_to_add++;
-        }
-        roman++;
-    }
-    /* Includes space for a '\n' */
-    alloc_size_to_add += second_underscore - first_underscore;
-    return alloc_size_to_add;
-}
-
-
-/**
- * Allocates a string with a prettier representation of a long roman numeral
- * with actual overlining.
+ * Writes a prettier representation of a long roman numeral with actual
+ * overlining into a buffer provided by the caller.
  *
  * Generates a two lined string (newline character is '\n') by overlining the
  * part between underscores. The string is just copied if the roman numeral is
  * not long.
  *
- * Remember to free() the pretty-printed roman numeral when it's not useful
- * anymore and (depending on your necessity) also the roman numeral itself.
- *
  * Example:
  *
  * <pre>
@@ -426,51 +418,52 @@ static size_t _num_overlining_alloc_size(char *roman) {
  * VIII        =>   VIII
  * </pre>
  *
+ * Performs no allocation: the buffer must have room for at least
+ * NUMERUS_MAX_OVERLINED_LENGTH chars, including the '\0'.
+ *
  * The prettifying process status is stored in the errcode passed as parameter,
  * which can be NULL to ignore the error, although it's not recommended. If the
  * error code is different than NUMERUS_OK, an error occurred during the
- * prettifying process and the returned string is NULL. The error code may help
- * find the specific error.
+ * prettifying process and the buffer contains an empty string. The error code
+ * may help find the specific error.
  *
  * @param *roman string containing the roman numeral.
+ * @param *pretty_roman buffer of at least NUMERUS_MAX_OVERLINED_LENGTH chars
+ * where to write the prettier version of the roman numeral.
  * @param *errcode int where to store the comparison status: NUMERUS_OK or any
  * other error. Can be NULL to ignore the error (NOT recommended).
- * @returns char* allocated string with the prettier version of the roman
- * numeral or NULL if malloc() fails.
+ * @returns short length of the written string, excluding '\0', or -1 when an
+ * error occurs.
  */
-char *numerus_overline_long_numerals(char *roman, int *errcode) {
+short numerus_overline_long_numerals_into(char *roman, char *pretty_roman,
+                                          int *errcode) {
+    *pretty_roman = '\0';
     _num_headtrim_check_numeral_and_errcode(&roman, &errcode);
     if (*errcode != NUMERUS_OK) {
-        return NULL;
+        return -1;
     }
-    int length = numerus_count_roman_chars(roman, errcode);
+    numerus_count_roman_chars(roman, errcode);
     if (*errcode != NUMERUS_OK) {
         numerus_error_code = *errcode;
-        return NULL;
+        return -1;
     }
     if (numerus_is_long_numeral(roman, errcode)) {
-        char *pretty_roman_start = malloc(length + _num_overlining_alloc_size(roman));
-        if (pretty_roman_start == NULL) {
-            numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
-            *errcode = NUMERUS_ERROR_MALLOC_FAIL;
-            return NULL;
-        }
         char *roman_start = roman;
-        char *pretty_roman = pretty_roman_start;
+        char *pretty_roman_position = pretty_roman;
 
         /* Skip minus sign */
         if (*roman == '-') {
-            *(pretty_roman++) = ' ';
+            *(pretty_roman_position++) = ' ';
             roman++;
         }
 
         /* Write the overline */
         roman++; /* Skip first underscore */
         while (*roman != '_') {
-            *(pretty_roman++) = '_';
+            *(pretty_roman_position++) = '_';
             roman++;
         }
-        *(pretty_roman++) = '\n';
+        *(pretty_roman_position++) = '\n';
 
         /* Copy the numeral in the second line */
         roman = roman_start;
@@ -478,31 +471,62 @@ char *numerus_overline_long_numerals(char *roman, int *errcode) {
             if (*roman == '_') {
                 roman++;
             } else {
-                *(pretty_roman++) = *roman;
+                *(pretty_roman_position++) = *roman;
                 roman++;
             }
         }
-        *pretty_roman = '\0';
-        return pretty_roman_start;
-    } else {
+        *pretty_roman_position = '\0';
+        return (short) (pretty_roman_position - pretty_roman);
+    } else if (*errcode != NUMERUS_OK) {
         /* Not a long roman numeral or error */
-        if (*errcode != NUMERUS_OK) {
-            numerus_error_code = *errcode;
-            return NULL;
-        } else {
-            char *roman_copy = malloc(strlen(roman) + 1);
-            if (roman_copy == NULL) {
-                numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
-                *errcode = NUMERUS_ERROR_MALLOC_FAIL;
-                return NULL;
-            }
-            strcpy(roman_copy, roman);
-            return roman_copy;
-        }
+        numerus_error_code = *errcode;
+        return -1;
+    } else {
+        strcpy(pretty_roman, roman);
+        return (short) strlen(pretty_roman);
     }
 }
 
 
+#ifndef NUMERUS_NO_MALLOC
+/**
+ * Allocates a string with a prettier representation of a long roman numeral
+ * with actual overlining.
+ *
+ * Works like numerus_overline_long_numerals_into(), which avoids the
+ * allocation, but returns an allocated copy of the string.
+ *
+ * Remember to free() the pretty-printed roman numeral when it's not useful
+ * anymore and (depending on your necessity) also the roman numeral itself.
+ *
+ * @param *roman string containing the roman numeral.
+ * @param *errcode int where to store the comparison status: NUMERUS_OK or any
+ * other error. Can be NULL to ignore the error (NOT recommended).
+ * @returns char* allocated string with the prettier version of the roman
+ * numeral or NULL if an error occurs or malloc() fails.
+ */
+char *numerus_overline_long_numerals(char *roman, int *errcode) {
+    char pretty_roman[NUMERUS_MAX_OVERLINED_LENGTH];
+    if (errcode == NULL) {
+        errcode = &numerus_error_code;
+    }
+    short length = numerus_overline_long_numerals_into(roman, pretty_roman,
+                                                       errcode);
+    if (*errcode != NUMERUS_OK) {
+        return NULL;
+    }
+    char *pretty_roman_copy = malloc((size_t) length + 1);
+    if (pretty_roman_copy == NULL) {
+        numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
+        *errcode = NUMERUS_ERROR_MALLOC_FAIL;
+        return NULL;
+    }
+    memcpy(pretty_roman_copy, pretty_roman, (size_t) length + 1);
+    return pretty_roman_copy;
+}
+#endif /* NUMERUS_NO_MALLOC */
+
+
 /**
  * Computes the greatest common divisor of two values using the Euclidean
  * algorithm.
@@ -558,6 +582,58 @@ void numerus_shorten_and_same_sign_to_parts(long *int_part, short *twelfths) {
 }
 
 
+/**
+ * Writes a prettier representation of a double value of a roman numeral as
+ * integer part and shortened twelfth into a buffer provided by the caller.
+ *
+ * Example: -12.5 becomes "-12, -1/2".
+ *
+ * @param double_value double value to be converted in a pretty string.
+ * @param *pretty_value buffer of at least NUMERUS_MAX_PRETTY_VALUE_LENGTH
+ * chars where to write the prettier version of the value.
+ * @returns short length of the written string, excluding '\0'.
+ */
+short numerus_pretty_value_as_double_into(double double_value,
+                                          char *pretty_value) {
+    short twelfths;
+    long int_part = numerus_double_to_parts(double_value, &twelfths);
+    return numerus_pretty_value_as_parts_into(int_part, twelfths,
+                                              pretty_value);
+}
+
+
+/**
+ * Writes a prettier representation of a value as an integer and a number of
+ * twelfths, with the twelfths shortened, into a buffer provided by the
+ * caller.
+ *
+ * Example: `-3, 2` (= -3 + 2/12) becomes "-2, -5/6" (= -2 -10/12).
+ *
+ * @param int_part long integer part of a value to be added to the twelfths
+ * and converted to a pretty string.
+ * @param twelfths short integer as number of twelfths (1/12) to be added to the
+ * integer part and converted to a pretty string.
+ * @param *pretty_value buffer of at least NUMERUS_MAX_PRETTY_VALUE_LENGTH
+ * chars where to write the prettier version of the value.
+ * @returns short length of the written string, excluding '\0'.
+ */
+short numerus_pretty_value_as_parts_into(long int_part, short twelfths,
+                                         char *pretty_value) {
+    if (twelfths != 0) {
+        numerus_shorten_and_same_sign_to_parts(&int_part, &twelfths);
+    }
+    if (twelfths == 0) {
+        return (short) snprintf(pretty_value, NUMERUS_MAX_PRETTY_VALUE_LENGTH,
+                                "%ld", int_part);
+    }
+    /* Shorten twelfth fraction */
+    short gcd = _num_greatest_common_divisor(twelfths, 12);
+    return (short) snprintf(pretty_value, NUMERUS_MAX_PRETTY_VALUE_LENGTH,
+                            "%ld, %d/%d", int_part, twelfths / gcd, 12 / gcd);
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
 /**
  * Allocates a string with a prettier representation of a double value of a
  * roman numeral as integer part and shortened twelfth.
@@ -584,6 +660,7 @@ char *numerus_create_pretty_value_as_double(double double_value) {
  *
  * Remember to free() the pretty-printed value when it's not useful anymore.
  * If a malloc() error occurs during the operation, the returned value is NULL.
+ * To avoid the allocation, use numerus_pretty_value_as_parts_into().
  *
  * Example: `-3, 2` (= -3 + 2/12) becomes "-2, -5/6" (= -2 -10/12).
  *
@@ -595,29 +672,18 @@ char *numerus_create_pretty_value_as_double(double double_value) {
  * NULL if malloc() fails.
  */
 char *numerus_create_pretty_value_as_parts(long int_part, short twelfths) {
-    char *pretty_value;
-    if (twelfths == 0) {
-        size_t needed_space = snprintf(NULL, 0, "%ld", int_part);
-        pretty_value = malloc(needed_space + 1); /* +1 for '\0' */
-        if (pretty_value == NULL) {
-            numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
-            return NULL;
-        }
-        sprintf(pretty_value, "%ld", int_part);
-    } else {
-        numerus_shorten_and_same_sign_to_parts(&int_part, &twelfths);
-        /* Shorten twelfth fraction */
-        short gcd = _num_greatest_common_divisor(twelfths, 12);
-        size_t needed_space = snprintf(NULL, 0, "%ld, %d/%d", int_part, twelfths/gcd, 12/gcd);
-        pretty_value = malloc(needed_space + 1); /* +1 for '\0' */
-        if (pretty_value == NULL) {
-            numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
-            return NULL;
-        }
-        sprintf(pretty_value, "%ld, %d/%d", int_part, twelfths/gcd, 12/gcd);
+    char pretty_value[NUMERUS_MAX_PRETTY_VALUE_LENGTH];
+    short length = numerus_pretty_value_as_parts_into(int_part, twelfths,
+                                                      pretty_value);
+    char *pretty_value_copy = malloc((size_t) length + 1);
+    if (pretty_value_copy == NULL) {
+        numerus_error_code = NUMERUS_ERROR_MALLOC_FAIL;
+        return NULL;
     }
-    return pretty_value;
+    memcpy(pretty_value_copy, pretty_value, (size_t) length + 1);
+    return pretty_value_copy;
 }
+#endif /* NUMERUS_NO_MALLOC */
 
 
 /**
@@ -668,6 +734,14 @@ static struct _num_error_codes _NUM_ERROR_CODES[] = {
             "The roman numeral string is empty or filled with whitespace."},
     {NUMERUS_ERROR_WHITESPACE_CHARACTER,
             "The roman numeral string contains whitespace characters, even at the end."},
+    {NUMERUS_ERROR_TABLE_FILE,
+            "The table file can't be opened or mapped or is not a valid table file."},
+    {NUMERUS_ERROR_DATE_FORMAT,
+            "The date pattern has an unknown conversion or the formatted date doesn't fit in the buffer."},
+    {NUMERUS_ERROR_PACK_FILE,
+            "The packed file can't be written, opened or mapped or is not a valid packed file."},
+    {NUMERUS_ERROR_WORKLOAD,
+            "The workload configuration is not valid or its files can't be written."},
     {NUMERUS_OK,
             "Everything went all right."},
     {NUMERUS_ERROR_GENERIC,
@@ -0,0 +1,628 @@
+/**
+ * @file numerus_verify.c
+ * @brief Numerus exhaustive verifier of the conversions of every backend.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * Converts every value of the conversion range, all the 95 999 999 values
+ * in twelfths from -MMMCMXCIX_CMXCIX_S..... to MMMCMXCIX_CMXCIX_S....., to
+ * a roman numeral and back with each backend, checking them against the
+ * reference: the numeral written by numerus_int_with_twelfth_to_roman_into()
+ * and the value it stands for.
+ *
+ * The backends are:
+ *
+ * - `core`: the reference numeral parsed back by the dictionary walk of
+ *   numerus_roman_to_int_part_and_twelfths(), with the length given by
+ *   numerus_int_with_twelfth_to_roman_length();
+ * - `inline`: the encoder of numerus_inline.h and its parser of the short
+ *   numerals;
+ * - `short`: numerus_short_int_to_roman_into() and
+ *   numerus_roman_to_short_int() on the integers of the short numerals;
+ * - `iter`: numerus_iter_next() stepping by one twelfth, reusing the
+ *   previous numeral;
+ * - `ext`: the extended range functions of numerus_ext.c;
+ * - `scalar`, `sse4.1`, `avx2`, `avx512`: the batch conversions with each
+ *   SIMD level the CPU supports;
+ * - `table`: the table file, when given.
+ *
+ * The range is split in chunks taken in order by one thread per core, with
+ * buffers on their stack and no allocations, and each backend reports the
+ * smallest value it gets wrong, if any. The backends writing
+ * numerus_error_code write the copy of their thread.
+ *
+ * Usage: `numerus_verify [--threads N] [--backend NAME] [--limit N]
+ * [--table path/to/numerus.table]`
+ */
+
+#define _POSIX_C_SOURCE 200809L  /* For `sysconf()`, `clock_gettime()` */
+
+#include <pthread.h>  /* For the threads of the verification */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include <stdio.h>    /* For `printf()`, `fprintf()` */
+#include <stdlib.h>   /* For `strtol()` */
+#include <string.h>   /* For `strcmp()`, `strncmp()` */
+#include <time.h>     /* For `clock_gettime()` */
+#include <unistd.h>   /* For `sysconf()` */
+#include "numerus.h"
+#include "numerus_inline.h"
+
+
+/**
+ * @internal
+ * Values in twelfths of a chunk of the range, taken at once by a thread,
+ * and of a batch of the batch conversions within a chunk.
+ */
+#define _NUM_VERIFY_CHUNK 65536
+#define _NUM_VERIFY_BATCH 512
+
+
+/**
+ * @internal
+ * Max number of threads, as the `dump` command of the CLI.
+ */
+#define _NUM_VERIFY_MAX_THREADS 256
+
+
+/**
+ * @internal
+ * Size of the buffers of the numerals, large enough for the extended range.
+ */
+#define _NUM_VERIFY_ROMAN_SIZE 128
+
+
+/**
+ * @internal
+ * First value a backend gets wrong: what the reference writes and what the
+ * backend gives.
+ */
+struct _num_verify_mismatch {
+    long value;  /* In twelfths */
+    char expected[_NUM_VERIFY_ROMAN_SIZE];
+    char got[_NUM_VERIFY_ROMAN_SIZE];
+    long got_int_part;
+    short got_twelfths;
+    int errcode;
+};
+
+
+/**
+ * @internal
+ * Checks the values in twelfths of `[first, first + count)` with a backend,
+ * stopping at the first mismatch.
+ *
+ * @returns bool true if all the values are converted as the reference does.
+ */
+typedef bool (*_num_verify_check)(long first, long count,
+                                  struct _num_verify_mismatch *mismatch);
+
+
+/**
+ * @internal
+ * A backend and the SIMD level it needs, -1 for any.
+ */
+struct _num_verify_backend {
+    const char *name;
+    _num_verify_check check;
+    int simd_level;
+};
+
+
+/**
+ * @internal
+ * State of a verification of a backend shared by its threads: the next
+ * chunk to take and the smallest mismatch found, guarded by the mutex.
+ */
+struct _num_verify {
+    _num_verify_check check;
+    long min_value;
+    long max_value;
+    long next_chunk_start;
+    bool failed;
+    struct _num_verify_mismatch first_mismatch;
+    pthread_mutex_t mutex;
+};
+
+
+#ifndef NUMERUS_NO_MALLOC
+/**
+ * @internal
+ * Table file of the table backend, NULL when not given.
+ */
+static struct numerus_table *_num_verify_table = NULL;
+#endif
+
+
+/**
+ * @internal
+ * Splits a value in twelfths into the parts with the same sign.
+ */
+static long _num_verify_parts(long value, short *twelfths) {
+    *twelfths = (short) (value % 12);
+    return value / 12;
+}
+
+
+/**
+ * @internal
+ * Writes the reference numeral of a value in twelfths.
+ */
+static short _num_verify_reference(long value, char *roman) {
+    short twelfths;
+    long int_part = _num_verify_parts(value, &twelfths);
+    int errcode;
+    return numerus_int_with_twelfth_to_roman_into(int_part, twelfths, roman,
+                                                  &errcode);
+}
+
+
+/**
+ * @internal
+ * Records a mismatch of a value, with the reference numeral.
+ */
+static bool _num_verify_fail(struct _num_verify_mismatch *mismatch,
+                             long value, const char *got, long got_int_part,
+                             short got_twelfths, int errcode) {
+    mismatch->value = value;
+    _num_verify_reference(value, mismatch->expected);
+    snprintf(mismatch->got, sizeof(mismatch->got), "%s", got);
+    mismatch->got_int_part = got_int_part;
+    mismatch->got_twelfths = got_twelfths;
+    mismatch->errcode = errcode;
+    return false;
+}
+
+
+/**
+ * @internal
+ * Checks that a numeral given by a backend is the reference one of a value.
+ */
+static bool _num_verify_same_numeral(long value, const char *got,
+                                     short got_length,
+                                     struct _num_verify_mismatch *mismatch) {
+    char expected[_NUM_VERIFY_ROMAN_SIZE];
+    short length = _num_verify_reference(value, expected);
+    if (got_length != length || strcmp(got, expected) != 0) {
+        short twelfths;
+        long int_part = _num_verify_parts(value, &twelfths);
+        return _num_verify_fail(mismatch, value, got, int_part, twelfths,
+                                NUMERUS_OK);
+    }
+    return true;
+}
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-+-+-{   BACKENDS   }-+-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+static bool _num_verify_core(long first, long count,
+                             struct _num_verify_mismatch *mismatch) {
+    char roman[_NUM_VERIFY_ROMAN_SIZE];
+    for (long value = first; value < first + count; value++) {
+        short twelfths;
+        long int_part = _num_verify_parts(value, &twelfths);
+        int errcode;
+        short length = _num_verify_reference(value, roman);
+        short parsed_twelfths = 0;
+        long parsed = numerus_roman_to_int_part_and_twelfths(
+                roman, &parsed_twelfths, &errcode);
+        if (errcode != NUMERUS_OK || parsed != int_part
+            || parsed_twelfths != twelfths || length != (short) strlen(roman)
+            || numerus_int_with_twelfth_to_roman_length(int_part, twelfths,
+                                                        &errcode) != length) {
+            return _num_verify_fail(mismatch, value, roman, parsed,
+                                    parsed_twelfths, errcode);
+        }
+    }
+    return true;
+}
+
+
+static bool _num_verify_inline(long first, long count,
+                               struct _num_verify_mismatch *mismatch) {
+    char roman[_NUM_VERIFY_ROMAN_SIZE];
+    for (long value = first; value < first + count; value++) {
+        short twelfths;
+        long int_part = _num_verify_parts(value, &twelfths);
+        int errcode;
+        short length = numerus_inline_int_with_twelfth_to_roman_into(
+                int_part, twelfths, roman, &errcode);
+        if (!_num_verify_same_numeral(value, roman, length, mismatch)) {
+            return false;
+        }
+        if (twelfths == 0 && int_part >= NUMERUS_MIN_SHORT_VALUE
+            && int_part <= NUMERUS_MAX_SHORT_VALUE) {
+            short parsed = numerus_inline_roman_to_short_int(roman, &errcode);
+            if (errcode != NUMERUS_OK || parsed != int_part) {
+                return _num_verify_fail(mismatch, value, roman, parsed, 0,
+                                        errcode);
+            }
+        }
+    }
+    return true;
+}
+
+
+static bool _num_verify_short(long first, long count,
+                              struct _num_verify_mismatch *mismatch) {
+    char roman[_NUM_VERIFY_ROMAN_SIZE];
+    for (long value = first; value < first + count; value++) {
+        short twelfths;
+        long int_part = _num_verify_parts(value, &twelfths);
+        if (twelfths != 0 || int_part < NUMERUS_MIN_SHORT_VALUE
+            || int_part > NUMERUS_MAX_SHORT_VALUE) {
+            continue;
+        }
+        int errcode;
+        short length = numerus_short_int_to_roman_into(int_part, roman,
+                                                       &errcode);
+        if (!_num_verify_same_numeral(value, roman, length, mismatch)) {
+            return false;
+        }
+        short parsed = numerus_roman_to_short_int(roman, &errcode);
+        if (errcode != NUMERUS_OK || parsed != int_part) {
+            return _num_verify_fail(mismatch, value, roman, parsed, 0,
+                                    errcode);
+        }
+    }
+    return true;
+}
+
+
+static bool _num_verify_iter(long first, long count,
+                             struct _num_verify_mismatch *mismatch) {
+    char roman[_NUM_VERIFY_ROMAN_SIZE];
+    struct numerus_iter iter;
+    short twelfths;
+    long int_part = _num_verify_parts(first, &twelfths);
+    int errcode;
+    numerus_iter_init(&iter, int_part, twelfths, 1, &errcode);
+    for (long value = first; value < first + count; value++) {
+        short length = numerus_iter_next(&iter, roman, &errcode);
+        if (errcode != NUMERUS_OK) {
+            return _num_verify_fail(mismatch, value, "", 0, 0, errcode);
+        }
+        if (!_num_verify_same_numeral(value, roman, length, mismatch)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static bool _num_verify_ext(long first, long count,
+                            struct _num_verify_mismatch *mismatch) {
+    char roman[_NUM_VERIFY_ROMAN_SIZE];
+    for (long value = first; value < first + count; value++) {
+        short twelfths;
+        long int_part = _num_verify_parts(value, &twelfths);
+        int errcode;
+        short length = numerus_ext_int_with_twelfth_to_roman_into(
+                int_part, twelfths, roman, &errcode);
+        if (!_num_verify_same_numeral(value, roman, length, mismatch)) {
+            return false;
+        }
+        short parsed_twelfths = 0;
+        int64_t parsed = numerus_ext_roman_to_int_part_and_twelfths(
+                roman, &parsed_twelfths, &errcode);
+        if (errcode != NUMERUS_OK || parsed != int_part
+            || parsed_twelfths != twelfths) {
+            return _num_verify_fail(mismatch, value, roman, (long) parsed,
+                                    parsed_twelfths, errcode);
+        }
+    }
+    return true;
+}
+
+
+static bool _num_verify_batch(long first, long count,
+                              struct _num_verify_mismatch *mismatch) {
+    long int_parts[_NUM_VERIFY_BATCH];
+    short twelfths[_NUM_VERIFY_BATCH];
+    long parsed_int_parts[_NUM_VERIFY_BATCH];
+    short parsed_twelfths[_NUM_VERIFY_BATCH];
+    int errcodes[_NUM_VERIFY_BATCH];
+    char romans[_NUM_VERIFY_BATCH * 37];
+    for (long start = first; start < first + count;
+         start += _NUM_VERIFY_BATCH) {
+        size_t size = (size_t) (first + count - start);
+        size = size > _NUM_VERIFY_BATCH ? _NUM_VERIFY_BATCH : size;
+        for (size_t i = 0; i < size; i++) {
+            int_parts[i] = _num_verify_parts(start + (long) i, &twelfths[i]);
+        }
+        numerus_int_with_twelfth_to_roman_batch(int_parts, twelfths, size,
+                                                romans, 37, errcodes);
+        for (size_t i = 0; i < size; i++) {
+            const char *roman = romans + i * 37;
+            if (errcodes[i] != NUMERUS_OK) {
+                return _num_verify_fail(mismatch, start + (long) i, roman, 0,
+                                        0, errcodes[i]);
+            }
+            if (!_num_verify_same_numeral(start + (long) i, roman,
+                                          (short) strlen(roman), mismatch)) {
+                return false;
+            }
+        }
+        numerus_roman_to_int_part_and_twelfths_batch(
+                romans, 37, size, parsed_int_parts, parsed_twelfths, errcodes);
+        for (size_t i = 0; i < size; i++) {
+            if (errcodes[i] != NUMERUS_OK
+                || parsed_int_parts[i] != int_parts[i]
+                || parsed_twelfths[i] != twelfths[i]) {
+                return _num_verify_fail(mismatch, start + (long) i,
+                                        romans + i * 37, parsed_int_parts[i],
+                                        parsed_twelfths[i], errcodes[i]);
+            }
+        }
+    }
+    return true;
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
+static bool _num_verify_table_file(long first, long count,
+                                   struct _num_verify_mismatch *mismatch) {
+    char roman[_NUM_VERIFY_ROMAN_SIZE];
+    for (long value = first; value < first + count; value++) {
+        short twelfths;
+        long int_part = _num_verify_parts(value, &twelfths);
+        int errcode;
+        short length = numerus_table_int_with_twelfth_to_roman_into(
+                _num_verify_table, int_part, twelfths, roman, &errcode);
+        if (!_num_verify_same_numeral(value, roman, length, mismatch)) {
+            return false;
+        }
+        short parsed_twelfths = 0;
+        long parsed = numerus_table_roman_to_int_part_and_twelfths(
+                _num_verify_table, roman, &parsed_twelfths, &errcode);
+        if (errcode != NUMERUS_OK || parsed != int_part
+            || parsed_twelfths != twelfths) {
+            return _num_verify_fail(mismatch, value, roman, parsed,
+                                    parsed_twelfths, errcode);
+        }
+    }
+    return true;
+}
+#endif
+
+
+/**
+ * @internal
+ * All the backends, in the order they are verified.
+ */
+static const struct _num_verify_backend _NUM_VERIFY_BACKENDS[] = {
+    {"core", _num_verify_core, -1},
+    {"inline", _num_verify_inline, -1},
+    {"short", _num_verify_short, -1},
+    {"iter", _num_verify_iter, -1},
+    {"ext", _num_verify_ext, -1},
+    {"scalar", _num_verify_batch, NUMERUS_SIMD_SCALAR},
+    {"sse4.1", _num_verify_batch, NUMERUS_SIMD_SSE41},
+    {"avx2", _num_verify_batch, NUMERUS_SIMD_AVX2},
+    {"avx512", _num_verify_batch, NUMERUS_SIMD_AVX512},
+#ifndef NUMERUS_NO_MALLOC
+    {"table", _num_verify_table_file, -1},
+#endif
+};
+
+
+
+/*  -+-+-+-+-+-+-+-+-+-+-+-+-+-+-{   THREADS   }-+-+-+-+-+-+-+-+-+-+-+-+-+-+-  */
+
+
+/**
+ * @internal
+ * Thread verifying chunks of the range in order until they are over or a
+ * mismatch is found before the next chunk.
+ */
+static void *_num_verify_thread(void *argument) {
+    struct _num_verify *verify = argument;
+    struct _num_verify_mismatch mismatch;
+    while (true) {
+        pthread_mutex_lock(&verify->mutex);
+        long start = verify->next_chunk_start;
+        bool over = start > verify->max_value
+                    || (verify->failed
+                        && start > verify->first_mismatch.value);
+        verify->next_chunk_start += _NUM_VERIFY_CHUNK;
+        pthread_mutex_unlock(&verify->mutex);
+        if (over) {
+            return NULL;
+        }
+        long count = verify->max_value - start + 1;
+        count = count > _NUM_VERIFY_CHUNK ? _NUM_VERIFY_CHUNK : count;
+        if (!verify->check(start, count, &mismatch)) {
+            pthread_mutex_lock(&verify->mutex);
+            /* The chunks before are all taken: the smallest one is first */
+            if (!verify->failed
+                || mismatch.value < verify->first_mismatch.value) {
+                verify->failed = true;
+                verify->first_mismatch = mismatch;
+            }
+            pthread_mutex_unlock(&verify->mutex);
+        }
+    }
+}
+
+
+/**
+ * @internal
+ * Seconds since an arbitrary start.
+ */
+static double _num_verify_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+
+/**
+ * @internal
+ * Verifies a backend on the values in twelfths of [-limit, limit] with the
+ * given threads and prints the result.
+ *
+ * @returns bool true if the backend converts all of them as the reference.
+ */
+static bool _num_verify_backend(const struct _num_verify_backend *backend,
+                                long limit, long threads) {
+    struct _num_verify verify;
+    verify.check = backend->check;
+    verify.min_value = -limit;
+    verify.max_value = limit;
+    verify.next_chunk_start = -limit;
+    verify.failed = false;
+    pthread_mutex_init(&verify.mutex, NULL);
+    double start = _num_verify_now();
+    pthread_t thread_ids[_NUM_VERIFY_MAX_THREADS];
+    long started = 0;
+    while (started < threads && pthread_create(
+            &thread_ids[started], NULL, _num_verify_thread, &verify) == 0) {
+        started++;
+    }
+    if (started == 0) {
+        /* No threads available: verify everything on this one */
+        _num_verify_thread(&verify);
+    }
+    for (long i = 0; i < started; i++) {
+        pthread_join(thread_ids[i], NULL);
+    }
+    pthread_mutex_destroy(&verify.mutex);
+    double seconds = _num_verify_now() - start;
+    if (!verify.failed) {
+        printf("%-7s OK, %ld values in %.1f s\n", backend->name,
+               2 * limit + 1, seconds);
+        return true;
+    }
+    struct _num_verify_mismatch *mismatch = &verify.first_mismatch;
+    short twelfths;
+    long int_part = _num_verify_parts(mismatch->value, &twelfths);
+    printf("%-7s MISMATCH at %ld and %d/12: expected %s, got \"%s\"",
+           backend->name, int_part, twelfths, mismatch->expected,
+           mismatch->got);
+    if (mismatch->errcode != NUMERUS_OK) {
+        printf(" with error: %s\n", numerus_explain_error(mismatch->errcode));
+    } else {
+        printf(" as %ld and %d/12\n", mismatch->got_int_part,
+               mismatch->got_twelfths);
+    }
+    return false;
+}
+
+
+/**
+ * @internal
+ * Tells whether a backend is to be verified: the one named, if any, when the
+ * CPU has its SIMD level and, for the table backend, the file is open.
+ */
+static bool _num_verify_is_selected(const struct _num_verify_backend *backend,
+                                    const char *only_backend,
+                                    int best_level) {
+    if ((only_backend != NULL && strcmp(backend->name, only_backend) != 0)
+        || backend->simd_level > best_level) {
+        return false;
+    }
+#ifndef NUMERUS_NO_MALLOC
+    if (backend->check == _num_verify_table_file
+        && _num_verify_table == NULL) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+
+/**
+ * @internal
+ * Prints how to call the verifier.
+ */
+static int _num_verify_usage(const char *program) {
+    fprintf(stderr,
+            "Usage: %s [--threads N] [--backend NAME] [--limit N]\n"
+            "       [--table path/to/numerus.table]\n",
+            program);
+    return 1;
+}
+
+
+int main(int argc, char **args) {
+    long threads = sysconf(_SC_NPROCESSORS_ONLN);
+    const char *only_backend = NULL;
+    long limit = NUMERUS_MAX_LONG_NONFLOAT_VALUE;
+    const char *table_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 == argc) {
+            return _num_verify_usage(args[0]);
+        } else if (strcmp(args[i], "--threads") == 0) {
+            threads = strtol(args[++i], NULL, 10);
+        } else if (strcmp(args[i], "--backend") == 0) {
+            only_backend = args[++i];
+        } else if (strcmp(args[i], "--limit") == 0) {
+            /* Max absolute value of the integer parts verified */
+            limit = strtol(args[++i], NULL, 10);
+        } else if (strcmp(args[i], "--table") == 0) {
+            table_path = args[++i];
+        } else {
+            return _num_verify_usage(args[0]);
+        }
+    }
+    threads = threads < 1 ? 1 : threads;
+    threads = threads > _NUM_VERIFY_MAX_THREADS
+              ? _NUM_VERIFY_MAX_THREADS : threads;
+    if (limit < 0 || limit > NUMERUS_MAX_LONG_NONFLOAT_VALUE) {
+        limit = NUMERUS_MAX_LONG_NONFLOAT_VALUE;
+    }
+    /* From the limit in integer parts to the one in twelfths */
+    limit = limit * 12 + 11;
+#ifndef NUMERUS_NO_MALLOC
+    if (table_path != NULL) {
+        int errcode;
+        _num_verify_table = numerus_open_table_file(table_path, &errcode);
+        if (_num_verify_table == NULL) {
+            fprintf(stderr, "%s: %s\n", table_path,
+                    numerus_explain_error(errcode));
+            return 1;
+        }
+    }
+#else
+    if (table_path != NULL) {
+        fprintf(stderr, "No table file without malloc()\n");
+        return 1;
+    }
+#endif
+    int best_level = numerus_simd_level();
+    const size_t backend_count = sizeof(_NUM_VERIFY_BACKENDS)
+                                 / sizeof(_NUM_VERIFY_BACKENDS[0]);
+    size_t selected = 0;
+    for (size_t i = 0; i < backend_count; i++) {
+        selected += _num_verify_is_selected(&_NUM_VERIFY_BACKENDS[i],
+                                            only_backend, best_level);
+    }
+    if (only_backend != NULL && selected == 0) {
+        /* Unknown name, SIMD level above the CPU's or table without file */
+        fprintf(stderr, "No backend %s available to verify\n", only_backend);
+#ifndef NUMERUS_NO_MALLOC
+        numerus_close_table_file(_num_verify_table);
+#endif
+        return _num_verify_usage(args[0]);
+    }
+    printf("Verifying %ld values on %ld threads\n", 2 * limit + 1, threads);
+    bool all_passed = true;
+    for (size_t i = 0; i < backend_count; i++) {
+        const struct _num_verify_backend *backend = &_NUM_VERIFY_BACKENDS[i];
+        if (!_num_verify_is_selected(backend, only_backend, best_level)) {
+            continue;
+        }
+        if (backend->simd_level >= 0) {
+            numerus_set_simd_level(backend->simd_level);
+        }
+        all_passed &= _num_verify_backend(backend, limit, threads);
+        numerus_set_simd_level(best_level);
+    }
+#ifndef NUMERUS_NO_MALLOC
+    numerus_close_table_file(_num_verify_table);
+#endif
+    return all_passed ? 0 : 1;
+}
@@ -0,0 +1,730 @@
+/**
+ * @file numerus_workload.c
+ * @brief Numerus generator of workloads of numerals like real traffic.
+ * @copyright Copyright © 2015-2016, Matjaž Guštin <dev@matjaz.it>
+ * <http://matjaz.it>. All rights reserved.
+ * @license This file is part of the Numerus project which is released under
+ * the BSD 3-clause license.
+ *
+ * This file contains the generator of workloads: sequences of roman numerals
+ * drawn from configurable distributions, each with the value and the error
+ * code the parsers must give for it, so benchmarks and regression tests can
+ * run on inputs like the ones of an application instead of uniform random
+ * values.
+ *
+ * Each numeral is drawn in steps, as set by a struct numerus_workload:
+ *
+ * - its kind, short, long or float, by the kind weights, and its sign;
+ * - its value within the range of the kind, uniformly or with a Zipf
+ *   distribution decaying below a most frequent value, like the years of
+ *   dates;
+ * - its case, uppercase, lowercase or mixed, and leading blanks;
+ * - with the rate of each error code, a mutation making it malformed with
+ *   that error, as a typo would.
+ *
+ * Numeral i of a workload depends only on the seed and on i, so a workload
+ * is the same on every platform and can be generated in chunks, in any
+ * order.
+ *
+ * The expected value and error code of each numeral are the ones given by
+ * numerus_roman_to_int_part_and_twelfths(). Each mutation is checked to give
+ * exactly its error code, falling back to a fixed numeral with that error
+ * after a few failed attempts, so the rate of each error is the configured
+ * one. The parsers skip the blanks before NULLA only, so leading blanks make
+ * the other numerals malformed, on top of the injected errors.
+ */
+
+#include <ctype.h>    /* For `tolower()`, `toupper()` */
+#include <math.h>     /* For `log()`, `log1p()`, `expm1()` */
+#include <stdbool.h>  /* To use booleans `true` and `false` */
+#include <stdio.h>    /* For `fopen()`, `fprintf()` */
+#include <string.h>   /* For `memcpy()`, `memmove()`, `strlen()` */
+#include "numerus_internal.h"
+
+
+/**
+ * @internal
+ * Attempts of mutating a numeral into one with the injected error before
+ * falling back to the fixed numeral of the error.
+ */
+#define _NUM_WORKLOAD_ATTEMPTS 8
+
+
+/**
+ * @internal
+ * Numerals generated at once by numerus_workload_write_files().
+ */
+#define _NUM_WORKLOAD_CHUNK 64
+
+
+/**
+ * @internal
+ * Ranges of the absolute values of the integer parts of each kind.
+ */
+static const long _NUM_WORKLOAD_MIN_INT_PARTS[NUMERUS_WORKLOAD_KINDS] = {
+        0, 4000, 0};
+static const long _NUM_WORKLOAD_MAX_INT_PARTS[NUMERUS_WORKLOAD_KINDS] = {
+        3999, 3999999, 3999};
+
+
+/**
+ * @internal
+ * Fixed malformed numeral of each error code the parsers give, used when
+ * the mutations of a numeral don't give that error.
+ */
+struct _num_workload_malformed {
+    int errcode;
+    const char *roman;
+};
+
+static const struct _num_workload_malformed _NUM_WORKLOAD_MALFORMED[] = {
+    {NUMERUS_ERROR_ILLEGAL_CHARACTER, "MCMXCIZ"},
+    {NUMERUS_ERROR_TOO_LONG_NUMERAL,
+            "MMMDCCCLXXXVIIIMMMDCCCLXXXVIIIMMMDCCCLXXXVIII"},
+    {NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS, "MCMXCIIII"},
+    {NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE, "MCMIC"},
+    {NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE, "_XV"},
+    {NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART, "_XV_I_"},
+    {NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG, "XV_I"},
+    {NUMERUS_ERROR_DECIMALS_IN_LONG_PART, "_XVS_I"},
+    {NUMERUS_ERROR_ILLEGAL_MINUS, "XV-I"},
+    {NUMERUS_ERROR_M_IN_SHORT_PART, "_XV_MI"},
+    {NUMERUS_ERROR_EMPTY_ROMAN, ""},
+    {NUMERUS_ERROR_WHITESPACE_CHARACTER, "XV I"},
+};
+#define _NUM_WORKLOAD_MALFORMED_COUNT \
+    (sizeof(_NUM_WORKLOAD_MALFORMED) / sizeof(_NUM_WORKLOAD_MALFORMED[0]))
+
+
+/**
+ * @internal
+ * Finalizer of splitmix64, mixing all the bits of its argument.
+ */
+static uint64_t _num_workload_mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+/**
+ * @internal
+ * Next pseudorandom number of the splitmix64 generator with that state.
+ */
+static uint64_t _num_workload_random(uint64_t *state) {
+    return _num_workload_mix(*state += 0x9E3779B97F4A7C15ULL);
+}
+
+
+/**
+ * @internal
+ * Pseudorandom double uniformly distributed within [0, 1).
+ */
+static double _num_workload_uniform(uint64_t *state) {
+    return (double) (_num_workload_random(state) >> 11)
+           / 9007199254740992.0;  /* 2^53 */
+}
+
+
+/**
+ * @internal
+ * `log1p(x) / x`, also around 0.
+ */
+static double _num_workload_log1p_ratio(double x) {
+    if (fabs(x) > 1e-8) {
+        return log1p(x) / x;
+    }
+    return 1 - x / 2;
+}
+
+
+/**
+ * @internal
+ * `expm1(x) / x`, also around 0.
+ */
+static double _num_workload_expm1_ratio(double x) {
+    if (fabs(x) > 1e-8) {
+        return expm1(x) / x;
+    }
+    return 1 + x / 2;
+}
+
+
+/**
+ * @internal
+ * Integral of `x^-exponent`, the density of the Zipf ranks, from 1 to x.
+ */
+static double _num_workload_zipf_integral(double x, double exponent) {
+    double log_x = log(x);
+    return _num_workload_expm1_ratio((1 - exponent) * log_x) * log_x;
+}
+
+
+/**
+ * @internal
+ * Inverse of _num_workload_zipf_integral().
+ */
+static double _num_workload_zipf_integral_inverse(double x, double exponent) {
+    double t = x * (1 - exponent);
+    if (t < -1) {
+        t = -1;  /* Only from rounding errors */
+    }
+    return exp(_num_workload_log1p_ratio(t) * x);
+}
+
+
+/**
+ * @internal
+ * Pseudorandom rank within [1, n] with a Zipf distribution: rank r is drawn
+ * with a probability proportional to `1 / r^exponent`.
+ *
+ * Uses the rejection-inversion method of Hörmann and Derflinger, drawing in
+ * constant time from any number of ranks, without tables.
+ */
+static long _num_workload_zipf(long n, double exponent, uint64_t *state) {
+    double integral_x1 = _num_workload_zipf_integral(1.5, exponent) - 1;
+    double integral_n = _num_workload_zipf_integral(n + 0.5, exponent);
+    double threshold = 2 - _num_workload_zipf_integral_inverse(
+            _num_workload_zipf_integral(2.5, exponent) - pow(2, -exponent),
+            exponent);
+    while (true) {
+        double u = integral_n
+                   + _num_workload_uniform(state) * (integral_x1 - integral_n);
+        double x = _num_workload_zipf_integral_inverse(u, exponent);
+        long rank = (long) (x + 0.5);
+        if (rank < 1) {
+            rank = 1;
+        } else if (rank > n) {
+            rank = n;
+        }
+        if (rank - x <= threshold
+            || u >= _num_workload_zipf_integral(rank + 0.5, exponent)
+                    - pow((double) rank, -exponent)) {
+            return rank;
+        }
+    }
+}
+
+
+/**
+ * @internal
+ * Inserts the text in the numeral at that position.
+ */
+static void _num_workload_insert(char *roman, size_t position,
+                                 const char *text) {
+    size_t length = strlen(text);
+    memmove(roman + position + length, roman + position,
+            strlen(roman + position) + 1);
+    memcpy(roman + position, text, length);
+}
+
+
+/**
+ * @internal
+ * Removes the char of the numeral at that position.
+ */
+static void _num_workload_remove(char *roman, size_t position) {
+    memmove(roman + position, roman + position + 1,
+            strlen(roman + position + 1) + 1);
+}
+
+
+/**
+ * @internal
+ * Pseudorandom position within [first, last].
+ */
+static size_t _num_workload_position(size_t first, size_t last,
+                                     uint64_t *state) {
+    return first + (size_t) (_num_workload_random(state)
+                             % (uint64_t) (last - first + 1));
+}
+
+
+/**
+ * @internal
+ * Mutates a numeral in the way that most likely gives that error code, as
+ * a typo or a misuse of the syntax would.
+ *
+ * The numeral, with its leading blanks, is at most 39 chars long and
+ * becomes at most 52 chars long, within NUMERUS_WORKLOAD_MAX_LENGTH.
+ */
+static void _num_workload_mutate(char *roman, int errcode, uint64_t *state) {
+    size_t length = strlen(roman);
+    size_t start = 0;  /* First char after the blanks */
+    while (roman[start] == ' ' || roman[start] == '\t') {
+        start++;
+    }
+    size_t body = start + (roman[start] == '-');  /* After the minus */
+    const char *first_underscore = strchr(roman, '_');
+    const char *second_underscore = first_underscore == NULL
+                                    ? NULL : strchr(first_underscore + 1, '_');
+    bool is_long = second_underscore != NULL;
+    size_t after_long = is_long ? (size_t) (second_underscore - roman) + 1
+                                : body;
+    switch (errcode) {
+        case NUMERUS_ERROR_ILLEGAL_CHARACTER: {
+            roman[_num_workload_position(start, length - 1, state)] =
+                    "ABEFGHJKNOPQRTUWYZ0123456789"[
+                            _num_workload_random(state) % 28];
+            break;
+        }
+        case NUMERUS_ERROR_TOO_LONG_NUMERAL: {
+            /* Counting the chars but the blanks and the underscores */
+            size_t chars = length - start - 2 * is_long;
+            size_t target = NUMERUS_MAX_LENGTH + 3
+                            + _num_workload_random(state) % 8;
+            for (size_t i = 0; chars < target; i++, chars++) {
+                roman[length++] = "MDCLXVI"[i % 7];
+            }
+            roman[length] = '\0';
+            break;
+        }
+        case NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS: {
+            size_t positions[NUMERUS_WORKLOAD_MAX_LENGTH];
+            size_t count = 0;
+            for (size_t i = body; i < length; i++) {
+                if (strchr("IXCM", toupper(roman[i])) != NULL) {
+                    positions[count++] = i;
+                }
+            }
+            if (count > 0) {
+                size_t position = positions[
+                        _num_workload_random(state) % count];
+                char repeated[4] = {roman[position], roman[position],
+                                    roman[position], '\0'};
+                _num_workload_insert(roman, position, repeated);
+            }
+            break;
+        }
+        case NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE: {
+            if (length - body >= 2 && _num_workload_random(state) % 2) {
+                size_t position = _num_workload_position(body, length - 2,
+                                                         state);
+                char swapped = roman[position];
+                roman[position] = roman[position + 1];
+                roman[position + 1] = swapped;
+            } else {
+                char doubled = "VLDS"[_num_workload_random(state) % 4];
+                char pair[3] = {doubled, doubled, '\0'};
+                _num_workload_insert(
+                        roman, _num_workload_position(after_long, length,
+                                                      state), pair);
+            }
+            break;
+        }
+        case NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE: {
+            if (is_long) {
+                _num_workload_remove(roman, after_long - 1);
+            } else {
+                _num_workload_insert(roman, body, "_");
+            }
+            break;
+        }
+        case NUMERUS_ERROR_UNDERSCORE_AFTER_LONG_PART: {
+            if (is_long) {
+                _num_workload_insert(
+                        roman, _num_workload_position(after_long, length,
+                                                      state), "_");
+            } else {
+                /* The whole numeral becomes the long part */
+                _num_workload_insert(roman, length, "__");
+                _num_workload_insert(roman, body, "_");
+            }
+            break;
+        }
+        case NUMERUS_ERROR_UNDERSCORE_IN_NON_LONG: {
+            if (is_long) {
+                _num_workload_remove(roman, first_underscore - roman);
+            } else {
+                _num_workload_insert(
+                        roman, _num_workload_position(body + 1, length,
+                                                      state), "_");
+            }
+            break;
+        }
+        case NUMERUS_ERROR_DECIMALS_IN_LONG_PART: {
+            if (is_long) {
+                _num_workload_insert(roman, after_long - 1,
+                                     _num_workload_random(state) % 2
+                                     ? "S" : ".");
+            } else {
+                _num_workload_insert(roman, body, "_IS_");
+            }
+            break;
+        }
+        case NUMERUS_ERROR_ILLEGAL_MINUS: {
+            _num_workload_insert(
+                    roman, _num_workload_position(body + 1, length, state),
+                    "-");
+            break;
+        }
+        case NUMERUS_ERROR_M_IN_SHORT_PART: {
+            _num_workload_insert(roman, after_long, is_long ? "M" : "_I_M");
+            break;
+        }
+        case NUMERUS_ERROR_EMPTY_ROMAN: {
+            roman[start] = '\0';  /* Only the blanks, if any */
+            break;
+        }
+        case NUMERUS_ERROR_WHITESPACE_CHARACTER: {
+            _num_workload_insert(
+                    roman, _num_workload_position(start + 1, length, state),
+                    _num_workload_random(state) % 2 ? " " : "\t");
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+
+/**
+ * @internal
+ * Tells whether the parsers can give that error code on some numeral, so
+ * that it can be injected.
+ */
+static bool _num_workload_is_injectable(int errcode) {
+    for (size_t i = 0; i < _NUM_WORKLOAD_MALFORMED_COUNT; i++) {
+        if (_NUM_WORKLOAD_MALFORMED[i].errcode == errcode) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+/**
+ * @internal
+ * Generates numeral number `index` of the workload, already checked by
+ * numerus_workload_check(), with its expected value and error code.
+ */
+static void _num_workload_generate_one(const struct numerus_workload *workload,
+                                       size_t index, char *roman,
+                                       long *int_part, short *twelfths,
+                                       int *errcode) {
+    uint64_t state = _num_workload_mix(
+            workload->seed ^ _num_workload_mix((uint64_t) index + 1));
+
+    /* Kind and value */
+    double weights = 0;
+    for (int kind = 0; kind < NUMERUS_WORKLOAD_KINDS; kind++) {
+        weights += workload->kind_weights[kind];
+    }
+    double draw = _num_workload_uniform(&state) * weights;
+    int kind = 0;
+    while (kind < NUMERUS_WORKLOAD_KINDS - 1
+           && (draw -= workload->kind_weights[kind]) >= 0) {
+        kind++;
+    }
+    while (workload->kind_weights[kind] == 0) {
+        kind--;  /* Only from rounding errors, reaching the last kinds */
+    }
+    long min = _NUM_WORKLOAD_MIN_INT_PARTS[kind];
+    long max = _NUM_WORKLOAD_MAX_INT_PARTS[kind];
+    long value_int_part;
+    if (workload->distribution == NUMERUS_WORKLOAD_ZIPF) {
+        long center = workload->zipf_center < min ? min
+                      : workload->zipf_center > max ? max
+                      : workload->zipf_center;
+        long span = max - min + 1;
+        long rank = _num_workload_zipf(span, workload->zipf_exponent,
+                                       &state);
+        /* Below the center, wrapping to the top of the range */
+        value_int_part = min + ((center - min - (rank - 1)) % span + span)
+                               % span;
+    } else {
+        value_int_part = min + (long) (_num_workload_random(&state)
+                                       % (uint64_t) (max - min + 1));
+    }
+    short value_twelfths = 0;
+    if (kind == NUMERUS_WORKLOAD_FLOAT) {
+        value_twelfths = (short) (1 + _num_workload_random(&state) % 11);
+    }
+    if (_num_workload_uniform(&state) < workload->negative_rate) {
+        value_int_part = -value_int_part;
+        value_twelfths = (short) -value_twelfths;
+    }
+    int encoding_errcode;
+    char clean[NUMERUS_WORKLOAD_MAX_LENGTH];
+    size_t start = 0;
+
+    /* Noise: leading blanks, which the parsers refuse, so part of the error
+     * budget */
+    if (_num_workload_uniform(&state) < workload->whitespace_rate) {
+        for (uint64_t blanks = 1 + _num_workload_random(&state) % 3;
+             blanks > 0; blanks--) {
+            clean[start++] = _num_workload_random(&state) % 2 ? ' ' : '\t';
+        }
+    }
+    numerus_int_with_twelfth_to_roman_into(value_int_part, value_twelfths,
+                                           clean + start, &encoding_errcode);
+    draw = _num_workload_uniform(&state);
+    if (draw < workload->lowercase_rate) {
+        for (char *c = clean + start; *c != '\0'; c++) {
+            *c = (char) tolower(*c);
+        }
+    } else if (draw < workload->lowercase_rate + workload->mixed_case_rate) {
+        uint64_t cases = _num_workload_random(&state);
+        for (char *c = clean + start; *c != '\0'; c++, cases >>= 1) {
+            if (cases & 1) {
+                *c = (char) tolower(*c);
+            }
+        }
+    }
+
+    /* Injected error */
+    int injected = NUMERUS_OK;
+    draw = _num_workload_uniform(&state);
+    for (int i = 0; i < NUMERUS_WORKLOAD_ERRORS; i++) {
+        if (workload->error_rates[i] > 0
+            && (draw -= workload->error_rates[i]) < 0) {
+            injected = NUMERUS_ERROR_GENERIC + i;
+            break;
+        }
+    }
+    memcpy(roman, clean, NUMERUS_WORKLOAD_MAX_LENGTH);
+    *int_part = numerus_roman_to_int_part_and_twelfths(roman, twelfths,
+                                                       errcode);
+    if (injected == NUMERUS_OK) {
+        return;
+    }
+    for (int attempt = 0; attempt < _NUM_WORKLOAD_ATTEMPTS; attempt++) {
+        memcpy(roman, clean, NUMERUS_WORKLOAD_MAX_LENGTH);
+        _num_workload_mutate(roman, injected, &state);
+        *int_part = numerus_roman_to_int_part_and_twelfths(roman, twelfths,
+                                                           errcode);
+        if (*errcode == injected) {
+            return;
+        }
+    }
+    for (size_t i = 0; i < _NUM_WORKLOAD_MALFORMED_COUNT; i++) {
+        if (_NUM_WORKLOAD_MALFORMED[i].errcode == injected) {
+            strcpy(roman, _NUM_WORKLOAD_MALFORMED[i].roman);
+        }
+    }
+    *int_part = numerus_roman_to_int_part_and_twelfths(roman, twelfths,
+                                                       errcode);
+}
+
+
+/**
+ * Sets the workload to uniform values of the three kinds in equal parts,
+ * without negative or malformed numerals and without noise, like the
+ * inputs of numerus_bench.
+ *
+ * @param *workload to set.
+ * @param seed of the pseudorandom numerals.
+ */
+void numerus_workload_uniform(struct numerus_workload *workload,
+                              uint64_t seed) {
+    memset(workload, 0, sizeof(*workload));
+    workload->seed = seed;
+    workload->distribution = NUMERUS_WORKLOAD_UNIFORM;
+    workload->zipf_exponent = 1;
+    workload->kind_weights[NUMERUS_WORKLOAD_SHORT] = 1;
+    workload->kind_weights[NUMERUS_WORKLOAD_LONG] = 1;
+    workload->kind_weights[NUMERUS_WORKLOAD_FLOAT] = 1;
+}
+
+
+/**
+ * Sets the workload to the mix of the traffic of an application converting
+ * dates and amounts: Zipf-distributed values, most often the current years,
+ * mostly short numerals with a tail of long and float ones, 2% of malformed
+ * numerals from typos and a fifth of lowercase or mixed-case numerals.
+ *
+ * @param *workload to set.
+ * @param seed of the pseudorandom numerals.
+ */
+void numerus_workload_production(struct numerus_workload *workload,
+                                 uint64_t seed) {
+    numerus_workload_uniform(workload, seed);
+    workload->distribution = NUMERUS_WORKLOAD_ZIPF;
+    workload->zipf_exponent = 1.1;
+    workload->zipf_center = 2016;
+    workload->kind_weights[NUMERUS_WORKLOAD_SHORT] = 0.90;
+    workload->kind_weights[NUMERUS_WORKLOAD_LONG] = 0.05;
+    workload->kind_weights[NUMERUS_WORKLOAD_FLOAT] = 0.05;
+    workload->negative_rate = 0.01;
+    double *rates = workload->error_rates - NUMERUS_ERROR_GENERIC;
+    rates[NUMERUS_ERROR_ILLEGAL_CHARACTER] = 0.005;
+    rates[NUMERUS_ERROR_TOO_MANY_REPEATED_CHARS] = 0.004;
+    rates[NUMERUS_ERROR_ILLEGAL_CHAR_SEQUENCE] = 0.005;
+    rates[NUMERUS_ERROR_WHITESPACE_CHARACTER] = 0.003;
+    rates[NUMERUS_ERROR_EMPTY_ROMAN] = 0.002;
+    rates[NUMERUS_ERROR_ILLEGAL_MINUS] = 0.0005;
+    rates[NUMERUS_ERROR_MISSING_SECOND_UNDERSCORE] = 0.0005;
+    workload->lowercase_rate = 0.15;
+    workload->mixed_case_rate = 0.05;
+}
+
+
+/**
+ * Checks that the workload can be generated: weights and rates not
+ * negative, some kind with a positive weight, a positive Zipf exponent and
+ * a center not negative, rates within [0, 1], with the rates of the errors
+ * and the rate of whitespace summing up to 1 at most, as the rates of
+ * lowercase and mixed case, and only rates of errors that the parsers give.
+ *
+ * The whitespace noise counts as an error: the parsers refuse the numerals
+ * with leading blanks.
+ *
+ * The error codes of the parsers are the ones from
+ * NUMERUS_ERROR_ILLEGAL_CHARACTER to NUMERUS_ERROR_WHITESPACE_CHARACTER but
+ * NUMERUS_ERROR_MALLOC_FAIL and NUMERUS_ERROR_NULL_ROMAN.
+ *
+ * @param *workload to check.
+ * @returns int NUMERUS_OK or NUMERUS_ERROR_WORKLOAD. Also stored in
+ * numerus_error_code.
+ */
+int numerus_workload_check(const struct numerus_workload *workload) {
+    numerus_error_code = NUMERUS_ERROR_WORKLOAD;
+    if (workload == NULL
+        || (workload->distribution != NUMERUS_WORKLOAD_UNIFORM
+            && workload->distribution != NUMERUS_WORKLOAD_ZIPF)
+        || !(workload->zipf_exponent > 0) || workload->zipf_center < 0) {
+        return NUMERUS_ERROR_WORKLOAD;
+    }
+    double weights = 0;
+    for (int kind = 0; kind < NUMERUS_WORKLOAD_KINDS; kind++) {
+        if (!(workload->kind_weights[kind] >= 0)) {
+            return NUMERUS_ERROR_WORKLOAD;
+        }
+        weights += workload->kind_weights[kind];
+    }
+    double error_rates = 0;
+    for (int i = 0; i < NUMERUS_WORKLOAD_ERRORS; i++) {
+        double rate = workload->error_rates[i];
+        if (!(rate >= 0) || (rate > 0 && !_num_workload_is_injectable(
+                NUMERUS_ERROR_GENERIC + i))) {
+            return NUMERUS_ERROR_WORKLOAD;
+        }
+        error_rates += rate;
+    }
+    if (!(weights > 0) || !(workload->whitespace_rate >= 0)
+        || error_rates + workload->whitespace_rate > 1
+        || !(workload->negative_rate >= 0) || workload->negative_rate > 1
+        || !(workload->lowercase_rate >= 0) || !(workload->mixed_case_rate >= 0)
+        || workload->lowercase_rate + workload->mixed_case_rate > 1) {
+        return NUMERUS_ERROR_WORKLOAD;
+    }
+    numerus_error_code = NUMERUS_OK;
+    return NUMERUS_OK;
+}
+
+
+/**
+ * Generates the numerals from number `first` to number `first + count - 1`
+ * of the workload into an arena, with the value and the error code the
+ * parsers give for each one.
+ *
+ * The numerals are written in slots of `stride` chars, the same layout of
+ * numerus_roman_to_int_part_and_twelfths_batch(), which can parse them
+ * straight from the arena. A workload can be generated in any number of
+ * chunks in any order: numeral i is always the same for the same seed.
+ *
+ * @param *workload to generate, see numerus_workload_check().
+ * @param first number of the first numeral to generate.
+ * @param count number of numerals to generate.
+ * @param *romans arena of `count` slots of `stride` chars.
+ * @param stride chars of each slot, at least NUMERUS_WORKLOAD_MAX_LENGTH.
+ * @param *int_parts where to store the integer part of each numeral, the
+ * same of numerus_roman_to_int_part_and_twelfths(). Can be NULL.
+ * @param *twelfths where to store the twelfths of each numeral. Can be NULL.
+ * @param *errcodes where to store the error code of each numeral, NUMERUS_OK
+ * for the valid ones. Can be NULL.
+ * @returns size_t number of numerals generated: `count` or 0 when the
+ * workload is not valid or the stride is too small, with
+ * NUMERUS_ERROR_WORKLOAD in numerus_error_code.
+ */
+size_t numerus_workload_generate(const struct numerus_workload *workload,
+                                 size_t first, size_t count, char *romans,
+                                 size_t stride, long *int_parts,
+                                 short *twelfths, int *errcodes) {
+    if (numerus_workload_check(workload) != NUMERUS_OK) {
+        return 0;
+    }
+    if (stride < NUMERUS_WORKLOAD_MAX_LENGTH) {
+        numerus_error_code = NUMERUS_ERROR_WORKLOAD;
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        long int_part;
+        short numeral_twelfths;
+        int errcode;
+        _num_workload_generate_one(workload, first + i, romans + i * stride,
+                                   &int_part, &numeral_twelfths, &errcode);
+        if (int_parts != NULL) {
+            int_parts[i] = int_part;
+        }
+        if (twelfths != NULL) {
+            twelfths[i] = numeral_twelfths;
+        }
+        if (errcodes != NULL) {
+            errcodes[i] = errcode;
+        }
+    }
+    numerus_error_code = NUMERUS_OK;
+    return count;
+}
+
+
+#ifndef NUMERUS_NO_MALLOC
+/**
+ * Writes the first `count` numerals of the workload into a text file, one
+ * per line, and their expected values into another one, if given.
+ *
+ * Each line of the file of the expected values has the integer part, the
+ * twelfths and the error code of the numeral on the same line of the file
+ * of the numerals, separated by spaces, as given by
+ * numerus_roman_to_int_part_and_twelfths().
+ *
+ * @param *workload to generate, see numerus_workload_check().
+ * @param count number of numerals to write.
+ * @param *romans_path path of the file of the numerals.
+ * @param *expected_path path of the file of the expected values. Can be NULL
+ * to skip it.
+ * @returns int NUMERUS_OK or NUMERUS_ERROR_WORKLOAD when the workload is not
+ * valid or a file can't be written. Also stored in numerus_error_code.
+ */
+int numerus_workload_write_files(const struct numerus_workload *workload,
+                                 size_t count, const char *romans_path,
+                                 const char *expected_path) {
+    if (numerus_workload_check(workload) != NUMERUS_OK) {
+        return NUMERUS_ERROR_WORKLOAD;
+    }
+    FILE *romans_file = fopen(romans_path, "w");
+    FILE *expected_file = expected_path == NULL
+                          ? NULL : fopen(expected_path, "w");
+    bool failed = romans_file == NULL
+                  || (expected_path != NULL && expected_file == NULL);
+    char romans[_NUM_WORKLOAD_CHUNK][NUMERUS_WORKLOAD_MAX_LENGTH];
+    long int_parts[_NUM_WORKLOAD_CHUNK];
+    short twelfths[_NUM_WORKLOAD_CHUNK];
+    int errcodes[_NUM_WORKLOAD_CHUNK];
+    for (size_t first = 0; first < count && !failed;
+         first += _NUM_WORKLOAD_CHUNK) {
+        size_t chunk = count - first < _NUM_WORKLOAD_CHUNK
+                       ? count - first : _NUM_WORKLOAD_CHUNK;
+        numerus_workload_generate(workload, first, chunk, romans[0],
+                                  NUMERUS_WORKLOAD_MAX_LENGTH, int_parts,
+                                  twelfths, errcodes);
+        for (size_t i = 0; i < chunk && !failed; i++) {
+            failed = fprintf(romans_file, "%s\n", romans[i]) < 0
+                     || (expected_file != NULL
+                         && fprintf(expected_file, "%ld %d %d\n",
+                                    int_parts[i], twelfths[i],
+                                    errcodes[i]) < 0);
+        }
+    }
+    if (romans_file != NULL && fclose(romans_file) != 0) {
+        failed = true;
+    }
+    if (expected_file != NULL && fclose(expected_file) != 0) {
+        failed = true;
+    }
+    numerus_error_code = failed ? NUMERUS_ERROR_WORKLOAD : NUMERUS_OK;
+    return numerus_error_code;
+}
+#endif